@@ -304,6 +304,7 @@ int load(Arguments& info)
     ESM::ESMReader& esm = info.reader;
     ToUTF8::Utf8Encoder encoder (ToUTF8::calculateEncoding(info.encoding));
     esm.setEncoder(&encoder);
+    esm.setMemoryMapped(true);
 
     std::string filename = info.filename;
     std::cout << "Loading file: " << filename << std::endl;
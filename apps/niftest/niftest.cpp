@@ -3,12 +3,19 @@
 #include <iostream>
 #include <fstream>
 #include <cstdlib>
+#include <algorithm>
+
+#include <OpenThreads/Thread>
 
 #include <components/nif/niffile.hpp>
 #include <components/files/constrainedfilestream.hpp>
 #include <components/vfs/manager.hpp>
 #include <components/vfs/bsaarchive.hpp>
 #include <components/vfs/filesystemarchive.hpp>
+#include <components/resource/resourcesystem.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/resource/scenefilecache.hpp>
+#include <components/sceneutil/workqueue.hpp>
 
 #include <boost/program_options.hpp>
 #include <boost/filesystem.hpp>
@@ -52,10 +59,10 @@ void readVFS(VFS::Archive* anArchive,std::string archivePath = "")
     myManager.addArchive(anArchive);
     myManager.buildIndex();
 
-    std::map<std::string, VFS::File*> files=myManager.getIndex();
-    for(std::map<std::string, VFS::File*>::const_iterator it=files.begin(); it!=files.end(); ++it)
+    const VFS::FileIndex& files=myManager.getIndex();
+    for(VFS::FileIndex::const_iterator it=files.begin(); it!=files.end(); ++it)
     {
-        std::string name = it->first;
+        std::string name = it->getName();
 
         try{
             if(isNIF(name))
@@ -80,16 +87,111 @@ void readVFS(VFS::Archive* anArchive,std::string archivePath = "")
     }
 }
 
-std::vector<std::string> parseOptions (int argc, char** argv)
+/// Loads one scene through the SceneManager, which stores it in the scene file cache
+class CacheSceneWorkItem : public SceneUtil::WorkItem
+{
+public:
+    CacheSceneWorkItem(Resource::SceneManager* sceneManager, const std::string& name)
+        : mSceneManager(sceneManager)
+        , mName(name)
+        , mCached(false)
+    {
+    }
+
+    virtual const char* getName() const { return "Scene caching"; }
+
+    virtual void doWork()
+    {
+        try
+        {
+            osg::ref_ptr<const osg::Node> scene = mSceneManager->getTemplate(mName);
+            mCached = Resource::SceneFileCache::canCache(*scene);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "ERROR, an exception has occurred:  " << e.what() << std::endl;
+        }
+    }
+
+    bool isCached() const { return mCached; }
+
+private:
+    Resource::SceneManager* mSceneManager;
+    std::string mName;
+    bool mCached;
+};
+
+/// Convert all nif files found in \a inputs and store them in the scene file cache at \a cachePath.
+/// \note The inputs are combined into a single VFS in the given order, so they should be listed in the same order as the
+/// data directories and archives the game uses.
+void buildSceneFileCache(const std::vector<std::string>& inputs, const std::string& cachePath, int numThreads)
+{
+    VFS::Manager vfs(false);
+    for(std::vector<std::string>::const_iterator it=inputs.begin(); it!=inputs.end(); ++it)
+    {
+        if(isBSA(*it))
+            vfs.addArchive(new VFS::BsaArchive(*it));
+        else if(bfs::is_directory(bfs::path(*it)))
+            vfs.addArchive(new VFS::FileSystemArchive(*it));
+        else
+            std::cerr << "ERROR:  \"" << *it << "\" is not a bsa file or directory!" << std::endl;
+    }
+    vfs.buildIndex();
+
+    Resource::ResourceSystem resourceSystem(&vfs);
+    Resource::SceneManager* sceneManager = resourceSystem.getSceneManager();
+    sceneManager->setSceneFileCachePath(cachePath);
+
+    std::vector<std::string> names;
+    const VFS::FileIndex& files = vfs.getIndex();
+    for(VFS::FileIndex::const_iterator it=files.begin(); it!=files.end(); ++it)
+    {
+        if(isNIF(it->getName()))
+            names.push_back(it->getName());
+    }
+
+    osg::ref_ptr<SceneUtil::WorkQueue> workQueue = new SceneUtil::WorkQueue(numThreads);
+
+    // Work in batches, so the resource caches can be cleared in between
+    const std::size_t batchSize = 256;
+    std::size_t numCached = 0;
+    for(std::size_t first=0; first<names.size(); first+=batchSize)
+    {
+        std::vector<osg::ref_ptr<CacheSceneWorkItem> > items;
+        for(std::size_t i=first; i<std::min(first+batchSize, names.size()); ++i)
+        {
+            items.push_back(new CacheSceneWorkItem(sceneManager, names[i]));
+            workQueue->addWorkItem(items.back());
+        }
+        for(std::vector<osg::ref_ptr<CacheSceneWorkItem> >::const_iterator it=items.begin(); it!=items.end(); ++it)
+        {
+            (*it)->waitTillDone();
+            if((*it)->isCached())
+                ++numCached;
+        }
+        resourceSystem.clearCache();
+    }
+
+    std::cout << "Converted " << names.size() << " nif files, " << numCached << " of them are cached in "
+              << cachePath << std::endl;
+}
+
+std::vector<std::string> parseOptions (int argc, char** argv, std::string& cachePath, int& numThreads)
 {
     bpo::options_description desc("Ensure that OpenMW can use the provided NIF and BSA files\n\n"
         "Usages:\n"
         "  niftool <nif files, BSA files, or directories>\n"
-        "      Scan the file or directories for nif errors.\n\n"
+        "      Scan the file or directories for nif errors.\n"
+        "  niftool --cache <cache directory> <BSA files or directories>\n"
+        "      Convert all nif files in the data directories and BSA files and store them in the scene file cache.\n"
+        "      List the data directories and BSA files in the same order as the game uses them.\n\n"
         "Allowed options");
     desc.add_options()
         ("help,h", "print help message.")
         ("input-file", bpo::value< std::vector<std::string> >(), "input file")
+        ("cache", bpo::value<std::string>(), "build the scene file cache in the given directory")
+        ("threads", bpo::value<int>()->default_value(std::max(1, OpenThreads::GetNumberOfProcessors())),
+            "number of threads to build the scene file cache with")
         ;
 
     //Default option if none provided
@@ -116,6 +218,9 @@ std::vector<std::string> parseOptions (int argc, char** argv)
         std::cout << desc << std::endl;
         exit(1);
     }
+    if (variables.count("cache"))
+        cachePath = variables["cache"].as<std::string>();
+    numThreads = std::max(1, variables["threads"].as<int>());
     if (variables.count("input-file"))
     {
         return variables["input-file"].as< std::vector<std::string> >();
@@ -128,7 +233,23 @@ std::vector<std::string> parseOptions (int argc, char** argv)
 
 int main(int argc, char **argv)
 {
-    std::vector<std::string> files = parseOptions (argc, argv);
+    std::string cachePath;
+    int numThreads = 1;
+    std::vector<std::string> files = parseOptions (argc, argv, cachePath, numThreads);
+
+    if (!cachePath.empty())
+    {
+        try
+        {
+            buildSceneFileCache(files, cachePath, numThreads);
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "ERROR, an exception has occurred:  " << e.what() << std::endl;
+            return 1;
+        }
+        return 0;
+    }
 
 //     std::cout << "Reading Files" << std::endl;
     for(std::vector<std::string>::const_iterator it=files.begin(); it!=files.end(); ++it)
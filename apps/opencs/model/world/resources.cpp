@@ -22,10 +22,10 @@ void CSMWorld::Resources::recreate(const VFS::Manager* vfs, const char * const *
 
     int baseSize = mBaseDirectory.size();
 
-    const std::map<std::string, VFS::File*>& index = vfs->getIndex();
-    for (std::map<std::string, VFS::File*>::const_iterator it = index.begin(); it != index.end(); ++it)
+    const VFS::FileIndex& index = vfs->getIndex();
+    for (VFS::FileIndex::const_iterator it = index.begin(); it != index.end(); ++it)
     {
-        std::string filepath = it->first;
+        std::string filepath = it->getName();
         if (static_cast<int> (filepath.size())<baseSize+1 ||
             filepath.substr (0, baseSize)!=mBaseDirectory ||
             (filepath[baseSize]!='/' && filepath[baseSize]!='\\'))
@@ -1,8 +1,11 @@
 #include "engine.hpp"
 
 #include <iomanip>
+#include <limits>
+#include <sstream>
 
 #include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
 
 #include <osgViewer/ViewerEventHandlers>
 #include <osgDB/ReadFile>
@@ -11,6 +14,7 @@
 #include <SDL.h>
 
 #include <components/misc/rng.hpp>
+#include <components/sceneutil/profiler.hpp>
 
 #include <components/vfs/manager.hpp>
 #include <components/vfs/registerarchives.hpp>
@@ -25,6 +29,7 @@
 #include <components/compiler/extensions0.hpp>
 
 #include <components/sceneutil/workqueue.hpp>
+#include <components/sceneutil/riggeometry.hpp>
 
 #include <components/files/configurationmanager.hpp>
 
@@ -63,6 +68,27 @@ namespace
         if (ret != 0)
             std::cerr << "SDL error: " << SDL_GetError() << std::endl;
     }
+
+    /// Describes everything besides the script texts that compiled scripts depend on
+    std::string getScriptCacheSignature(const Files::Collections& fileCollections, const std::vector<std::string>& contentFiles,
+                                        const std::string& version, int warningsMode)
+    {
+        std::ostringstream signature;
+        signature << version << "\nwarnings " << warningsMode << "\n";
+        for (std::vector<std::string>::const_iterator it = contentFiles.begin(); it != contentFiles.end(); ++it)
+        {
+            signature << *it;
+            const Files::MultiDirCollection& collection = fileCollections.getCollection(boost::filesystem::path(*it).extension().string());
+            if (collection.doesExist(*it))
+            {
+                const boost::filesystem::path path = collection.getPath(*it);
+                boost::system::error_code error;
+                signature << " " << boost::filesystem::file_size(path, error) << " " << boost::filesystem::last_write_time(path, error);
+            }
+            signature << "\n";
+        }
+        return signature.str();
+    }
 }
 
 void OMW::Engine::executeLocalScripts()
@@ -70,12 +96,13 @@ void OMW::Engine::executeLocalScripts()
     MWWorld::LocalScripts& localScripts = mEnvironment.getWorld()->getLocalScripts();
 
     localScripts.startIteration();
-    std::pair<std::string, MWWorld::Ptr> script;
+    MWWorld::LocalScripts::Script script;
     while (localScripts.getNext(script))
     {
+        OPENMW_PROFILE_ZONE(script.mName);
         MWScript::InterpreterContext interpreterContext (
-            &script.second.getRefData().getLocals(), script.second);
-        mEnvironment.getScriptManager()->run (script.first, interpreterContext);
+            &script.mPtr.getRefData().getLocals(), script.mPtr);
+        mEnvironment.getScriptManager()->run (script.mHandle, interpreterContext);
     }
 }
 
@@ -88,17 +115,23 @@ bool OMW::Engine::frame(float frametime)
         mEnvironment.setFrameDuration(frametime);
 
         // update input
-        mEnvironment.getInputManager()->update(frametime, false);
+        {
+            OPENMW_PROFILE_ZONE("Input");
+            mEnvironment.getInputManager()->update(frametime, false);
+        }
 
         // When the window is minimized, pause the game. Currently this *has* to be here to work around a MyGUI bug.
         // If we are not currently rendering, then RenderItems will not be reused resulting in a memory leak upon changing widget textures (fixed in MyGUI 3.3.2),
         // and destroyed widgets will not be deleted (not fixed yet, https://github.com/MyGUI/mygui/issues/21)
-        if (!mEnvironment.getInputManager()->isWindowVisible())
+        if (!mHeadless && !mEnvironment.getInputManager()->isWindowVisible())
             return false;
 
         // sound
         if (mUseSound)
+        {
+            OPENMW_PROFILE_ZONE("Sound");
             mEnvironment.getSoundManager()->update(frametime);
+        }
 
         // Main menu opened? Then scripts are also paused.
         bool paused = mEnvironment.getWindowManager()->containsMode(MWGui::GM_MainMenu);
@@ -116,6 +149,8 @@ bool OMW::Engine::frame(float frametime)
             {
                 if (mEnvironment.getWorld()->getScriptsEnabled())
                 {
+                    OPENMW_PROFILE_ZONE("Scripts");
+
                     // local scripts
                     executeLocalScripts();
 
@@ -139,6 +174,7 @@ bool OMW::Engine::frame(float frametime)
         if (mEnvironment.getStateManager()->getState()!=
             MWBase::StateManager::State_NoGame)
         {
+            OPENMW_PROFILE_ZONE("Mechanics");
             mEnvironment.getMechanicsManager()->update(frametime,
                 guiActive);
         }
@@ -157,12 +193,16 @@ bool OMW::Engine::frame(float frametime)
         if (mEnvironment.getStateManager()->getState()!=
             MWBase::StateManager::State_NoGame)
         {
+            OPENMW_PROFILE_ZONE("World");
             mEnvironment.getWorld()->update(frametime, guiActive);
         }
         osg::Timer_t afterPhysicsTick = osg::Timer::instance()->tick();
 
         // update GUI
-        mEnvironment.getWindowManager()->onFrame(frametime);
+        {
+            OPENMW_PROFILE_ZONE("GUI");
+            mEnvironment.getWindowManager()->onFrame(frametime);
+        }
 
         unsigned int frameNumber = mViewer->getFrameStamp()->getFrameNumber();
         osg::Stats* stats = mViewer->getViewerStats();
@@ -211,12 +251,16 @@ OMW::Engine::Engine(Files::ConfigurationManager& configurationManager)
   , mFSStrict (false)
   , mScriptBlacklistUse (true)
   , mNewGame (false)
+  , mHeadless (false)
+  , mHeadlessFrames (0)
+  , mHeadlessTimestep (0.f)
   , mCfgMgr(configurationManager)
 {
     Misc::Rng::init();
     MWClass::registerClasses();
 
-    Uint32 flags = SDL_INIT_VIDEO|SDL_INIT_NOPARACHUTE|SDL_INIT_GAMECONTROLLER|SDL_INIT_JOYSTICK;
+    // Video is initialised in go(), once we know if we run headless
+    Uint32 flags = SDL_INIT_NOPARACHUTE|SDL_INIT_GAMECONTROLLER|SDL_INIT_JOYSTICK;
     if(SDL_WasInit(flags) == 0)
     {
         SDL_SetMainReady();
@@ -242,6 +286,10 @@ OMW::Engine::~Engine()
 
     mViewer = NULL;
 
+    // Skinning is queued from the cull traversal, so the queue can go once the viewer is gone
+    SceneUtil::RigGeometry::setWorkQueue(NULL);
+    mSkinningWorkQueue = NULL;
+
     if (mWindow)
     {
         SDL_DestroyWindow(mWindow);
@@ -319,6 +367,20 @@ void OMW::Engine::createWindow(Settings::Manager& settings)
     int screen = settings.getInt("screen", "Video");
     int width = settings.getInt("resolution x", "Video");
     int height = settings.getInt("resolution y", "Video");
+
+    if (mHeadless)
+    {
+        // The input manager needs a window, so create one with SDL's dummy video driver. The viewer gets no graphics
+        // context and is never realized, so it can run the event and update traversals, but nothing is rendered.
+        mWindow = SDL_CreateWindow("OpenMW", 0, 0, width, height, SDL_WINDOW_HIDDEN);
+        if (!mWindow)
+            throw std::runtime_error("Failed to create SDL window: " + std::string(SDL_GetError()));
+
+        mViewer->getCamera()->setViewport(0, 0, width, height);
+        mViewer->getEventQueue()->getCurrentEventState()->setWindowRectangle(0, 0, width, height);
+        return;
+    }
+
     bool fullscreen = settings.getBool("fullscreen", "Video");
     bool windowBorder = settings.getBool("window border", "Video");
     bool vsync = settings.getBool("vsync", "Video");
@@ -437,7 +499,7 @@ void OMW::Engine::setWindowIcon()
 void OMW::Engine::prepareEngine (Settings::Manager & settings)
 {
     mEnvironment.setStateManager (
-        new MWState::StateManager (mCfgMgr.getUserDataPath() / "saves", mContentFiles.at (0)));
+        new MWState::StateManager (mCfgMgr.getUserDataPath() / "saves", mContentFiles.at (0), mHeadless));
 
     createWindow(settings);
 
@@ -446,7 +508,8 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
 
     mVFS.reset(new VFS::Manager(mFSStrict));
 
-    VFS::registerArchives(mVFS.get(), mFileCollections, mArchives, true);
+    VFS::registerArchives(mVFS.get(), mFileCollections, mArchives, true,
+        Settings::Manager::getBool("memory mapped archives", "General"));
 
     mResourceSystem.reset(new Resource::ResourceSystem(mVFS.get()));
     mResourceSystem->getSceneManager()->setUnRefImageDataAfterApply(false); // keep to Off for now to allow better state sharing
@@ -456,12 +519,23 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
         Settings::Manager::getString("texture mipmap", "General"),
         Settings::Manager::getInt("anisotropy", "General")
     );
+    if (Settings::Manager::getBool("scene file cache", "General"))
+        mResourceSystem->getSceneManager()->setSceneFileCachePath((mCfgMgr.getCachePath() / "scenes").string());
 
     int numThreads = Settings::Manager::getInt("preload num threads", "Cells");
-    if (numThreads <= 0)
-        throw std::runtime_error("Invalid setting: 'preload num threads' must be >0");
+    if (numThreads < 0)
+        throw std::runtime_error("Invalid setting: 'preload num threads' must be >=0");
     mWorkQueue = new SceneUtil::WorkQueue(numThreads);
 
+    int skinningThreads = Settings::Manager::getInt("skinning threads", "General");
+    if (skinningThreads < 0)
+        throw std::runtime_error("Invalid setting: 'skinning threads' must be >=0");
+    if (skinningThreads > 0)
+    {
+        mSkinningWorkQueue = new SceneUtil::WorkQueue(skinningThreads);
+        SceneUtil::RigGeometry::setWorkQueue(mSkinningWorkQueue.get());
+    }
+
     // Create input and UI first to set up a bootstrapping environment for
     // showing a loading screen and keeping the window responsive while doing so
 
@@ -487,7 +561,7 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     else
         gameControllerdb = ""; //if it doesn't exist, pass in an empty string
 
-    MWInput::InputManager* input = new MWInput::InputManager (mWindow, mViewer, mScreenCaptureHandler, keybinderUser, keybinderUserExists, gameControllerdb, mGrab);
+    MWInput::InputManager* input = new MWInput::InputManager (mWindow, mViewer, mScreenCaptureHandler, keybinderUser, keybinderUserExists, gameControllerdb, mGrab && !mHeadless);
     mEnvironment.setInputManager (input);
 
     std::string myguiResources = (mResDir / "mygui").string();
@@ -498,13 +572,13 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     MWGui::WindowManager* window = new MWGui::WindowManager(mViewer, guiRoot, mResourceSystem.get(), mWorkQueue.get(),
                 mCfgMgr.getLogPath().string() + std::string("/"), myguiResources,
                 mScriptConsoleMode, mTranslationDataStorage, mEncoding, mExportFonts, mFallbackMap,
-                Version::getOpenmwVersionDescription(mResDir.string()));
+                Version::getOpenmwVersionDescription(mResDir.string()), mHeadless);
     mEnvironment.setWindowManager (window);
 
     // Create sound system
-    mEnvironment.setSoundManager (new MWSound::SoundManager(mVFS.get(), mFallbackMap, mUseSound));
+    mEnvironment.setSoundManager (new MWSound::SoundManager(mVFS.get(), mFallbackMap, mUseSound, mHeadless));
 
-    if (!mSkipMenu)
+    if (!mSkipMenu && !mHeadless)
     {
         std::string logo = mFallbackMap["Movies_Company_Logo"];
         if (!logo.empty())
@@ -532,8 +606,12 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     mScriptContext = new MWScript::CompilerContext (MWScript::CompilerContext::Type_Full);
     mScriptContext->setExtensions (&mExtensions);
 
-    mEnvironment.setScriptManager (new MWScript::ScriptManager (mEnvironment.getWorld()->getStore(), *mScriptContext, mWarningsMode,
-        mScriptBlacklistUse ? mScriptBlacklist : std::vector<std::string>()));
+    MWScript::ScriptManager* scriptManager = new MWScript::ScriptManager (mEnvironment.getWorld()->getStore(), *mScriptContext, mWarningsMode,
+        mScriptBlacklistUse ? mScriptBlacklist : std::vector<std::string>());
+    mEnvironment.setScriptManager (scriptManager);
+    if (Settings::Manager::getBool("script cache", "General"))
+        scriptManager->useCache((mCfgMgr.getCachePath() / "scripts.cache").string(),
+            getScriptCacheSignature(mFileCollections, mContentFiles, Version::getOpenmwVersionDescription(mResDir.string()), mWarningsMode));
 
     // Create game mechanics system
     MWMechanics::MechanicsManager* mechanics = new MWMechanics::MechanicsManager;
@@ -544,7 +622,7 @@ void OMW::Engine::prepareEngine (Settings::Manager & settings)
     mEnvironment.setDialogueManager (new MWDialogue::DialogueManager (mExtensions, mTranslationDataStorage));
 
     // scripts
-    if (mCompileAll)
+    if (mCompileAll || Settings::Manager::getBool("compile scripts on startup", "General"))
     {
         std::pair<int, int> result = mEnvironment.getScriptManager()->compileAll();
         if (result.first)
@@ -622,6 +700,15 @@ void OMW::Engine::go()
 
     std::cout << "OSG version: " << osgGetVersion() << std::endl;
 
+    if (mHeadless)
+    {
+        SDL_setenv("SDL_VIDEODRIVER", "dummy", 1);
+        // Seed the RNG with a constant, so that runs with the same content and options are comparable
+        Misc::Rng::init(1);
+    }
+    if (SDL_WasInit(SDL_INIT_VIDEO) == 0 && SDL_InitSubSystem(SDL_INIT_VIDEO) != 0)
+        throw std::runtime_error("Could not initialize SDL video! " + std::string(SDL_GetError()));
+
     mViewer = new osgViewer::Viewer;
     mViewer->setReleaseContextAtEndOfFrameHint(false);
 
@@ -648,6 +735,9 @@ void OMW::Engine::go()
         Settings::Manager::getString("screenshot format", "General")));
     mViewer->addEventHandler(mScreenCaptureHandler);
 
+    SceneUtil::Profiler::instance().setTraceDirectory(mCfgMgr.getUserDataPath().string());
+    SceneUtil::Profiler::instance().setThreadName("Main");
+
     mEnvironment.setFrameRateLimit(Settings::Manager::getFloat("framerate limit", "Video"));
 
     // Create encoder
@@ -660,7 +750,7 @@ void OMW::Engine::go()
     {
         mEnvironment.getStateManager()->loadGame(mSaveGameFile);
     }
-    else if (!mSkipMenu)
+    else if (!mSkipMenu && !mHeadless)
     {
         // start in main menu
         mEnvironment.getWindowManager()->pushGuiMode (MWGui::GM_MainMenu);
@@ -680,6 +770,12 @@ void OMW::Engine::go()
         mEnvironment.getStateManager()->newGame (!mNewGame);
     }
 
+    if (mHeadless)
+    {
+        runHeadless();
+        return;
+    }
+
     // Start the main rendering loop
     osg::Timer frameTimer;
     double simulationTime = 0.0;
@@ -691,6 +787,9 @@ void OMW::Engine::go()
 
         mViewer->advance(simulationTime);
 
+        SceneUtil::Profiler::instance().newFrame(mViewer->getFrameStamp()->getFrameNumber());
+        OPENMW_PROFILE_ZONE("Frame");
+
         if (!frame(dt))
         {
             OpenThreads::Thread::microSleep(5000);
@@ -703,7 +802,10 @@ void OMW::Engine::go()
 
             mEnvironment.getWorld()->updateWindowManager();
 
-            mViewer->renderingTraversals();
+            {
+                OPENMW_PROFILE_ZONE("Rendering");
+                mViewer->renderingTraversals();
+            }
 
             bool guiActive = mEnvironment.getWindowManager()->isGuiMode();
             if (!guiActive)
@@ -719,6 +821,82 @@ void OMW::Engine::go()
     std::cout << "Quitting peacefully." << std::endl;
 }
 
+void OMW::Engine::runHeadless()
+{
+    std::cout << "Running " << mHeadlessFrames << " headless frames of " << mHeadlessTimestep * 1000.0 << " ms" << std::endl;
+
+    // Measured by frame(), except for the scene graph update
+    const char* subsystems[] = { "Scripts", "Mechanics", "World", "Scene graph" };
+    const char* attributes[] = { "script_time_taken", "mechanics_time_taken", "physics_time_taken", NULL };
+    const std::size_t numSubsystems = sizeof(subsystems) / sizeof(subsystems[0]);
+    std::vector<double> subsystemTimes(numSubsystems, 0.0);
+
+    double totalTime = 0.0;
+    double minFrameTime = std::numeric_limits<double>::max();
+    double maxFrameTime = 0.0;
+    unsigned int numFrames = 0;
+
+    const osg::Timer* timer = osg::Timer::instance();
+    double simulationTime = 0.0;
+    while (numFrames < mHeadlessFrames && !mEnvironment.getStateManager()->hasQuitRequest())
+    {
+        mViewer->advance(simulationTime);
+        const unsigned int frameNumber = mViewer->getFrameStamp()->getFrameNumber();
+        SceneUtil::Profiler::instance().newFrame(frameNumber);
+
+        const osg::Timer_t frameStart = timer->tick();
+        osg::Timer_t beforeUpdateTick;
+        osg::Timer_t afterUpdateTick;
+        {
+            OPENMW_PROFILE_ZONE("Frame");
+
+            frame(mHeadlessTimestep);
+
+            beforeUpdateTick = timer->tick();
+            {
+                OPENMW_PROFILE_ZONE("Scene graph");
+                mViewer->eventTraversal();
+                mViewer->updateTraversal();
+            }
+            afterUpdateTick = timer->tick();
+
+            mEnvironment.getWorld()->updateWindowManager();
+        }
+        const osg::Timer_t frameEnd = timer->tick();
+
+        osg::Stats* stats = mViewer->getViewerStats();
+        for (std::size_t i = 0; i < numSubsystems; ++i)
+        {
+            double value = 0.0;
+            if (attributes[i] && stats->getAttribute(frameNumber, attributes[i], value))
+                subsystemTimes[i] += value;
+        }
+        subsystemTimes.back() += timer->delta_s(beforeUpdateTick, afterUpdateTick);
+
+        const double frameTime = timer->delta_s(frameStart, frameEnd);
+        totalTime += frameTime;
+        minFrameTime = std::min(minFrameTime, frameTime);
+        maxFrameTime = std::max(maxFrameTime, frameTime);
+        ++numFrames;
+
+        simulationTime += mHeadlessTimestep;
+    }
+
+    if (numFrames == 0)
+        return;
+
+    std::cout << std::fixed << std::setprecision(3);
+    std::cout << "Simulated " << numFrames << " frames in " << totalTime << " s: frame time average "
+              << totalTime / numFrames * 1000.0 << " ms, min " << minFrameTime * 1000.0 << " ms, max " << maxFrameTime * 1000.0
+              << " ms" << std::endl;
+    for (std::size_t i = 0; i < numSubsystems; ++i)
+    {
+        std::cout << "  " << std::left << std::setw(12) << subsystems[i] << std::right << std::setw(10)
+                  << subsystemTimes[i] / numFrames * 1000.0 << " ms per frame, " << std::setw(6)
+                  << subsystemTimes[i] / totalTime * 100.0 << " %" << std::endl;
+    }
+}
+
 void OMW::Engine::setCompileAll (bool all)
 {
     mCompileAll = all;
@@ -783,3 +961,19 @@ void OMW::Engine::setSaveGameFile(const std::string &savegame)
 {
     mSaveGameFile = savegame;
 }
+
+void OMW::Engine::setHeadless(bool headless, unsigned int numFrames, float timestep)
+{
+    mHeadless = headless;
+    mHeadlessFrames = numFrames;
+    mHeadlessTimestep = timestep;
+}
+
+void OMW::Engine::setTraceFrames(unsigned int first, unsigned int last)
+{
+#ifdef OPENMW_ENABLE_PROFILER
+    SceneUtil::Profiler::instance().captureFrames(first, last);
+#else
+    std::cerr << "Warning: trace-frames is not available, OpenMW was built without OPENMW_ENABLE_PROFILER" << std::endl;
+#endif
+}
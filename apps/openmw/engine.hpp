@@ -74,6 +74,7 @@ namespace OMW
             std::unique_ptr<VFS::Manager> mVFS;
             std::unique_ptr<Resource::ResourceSystem> mResourceSystem;
             osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
+            osg::ref_ptr<SceneUtil::WorkQueue> mSkinningWorkQueue;
             MWBase::Environment mEnvironment;
             ToUTF8::FromType mEncoding;
             ToUTF8::Utf8Encoder* mEncoder;
@@ -110,6 +111,10 @@ namespace OMW
             bool mScriptBlacklistUse;
             bool mNewGame;
 
+            bool mHeadless;
+            unsigned int mHeadlessFrames;
+            float mHeadlessTimestep;
+
             osg::Timer_t mStartTick;
 
             // not implemented
@@ -129,6 +134,9 @@ namespace OMW
             void createWindow(Settings::Manager& settings);
             void setWindowIcon();
 
+            /// Step the game with a fixed timestep and without rendering, then print the time taken by each subsystem
+            void runHeadless();
+
         public:
             Engine(Files::ConfigurationManager& configurationManager);
             virtual ~Engine();
@@ -202,6 +210,13 @@ namespace OMW
             /// Set the save game file to load after initialising the engine.
             void setSaveGameFile(const std::string& savegame);
 
+            /// Run without window, rendering and sound output, for \a numFrames frames of \a timestep seconds each.
+            /// Implies skipping the main menu.
+            void setHeadless(bool headless, unsigned int numFrames, float timestep);
+
+            /// Write a profiler trace of the frames from \a first to \a last to the user data directory.
+            void setTraceFrames(unsigned int first, unsigned int last);
+
         private:
             Files::ConfigurationManager& mCfgMgr;
     };
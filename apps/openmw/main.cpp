@@ -1,3 +1,4 @@
+#include <cstdio>
 #include <iostream>
 
 #include <components/version/version.hpp>
@@ -148,7 +149,18 @@ bool parseOptions (int argc, char** argv, OMW::Engine& engine, Files::Configurat
         ("export-fonts", bpo::value<bool>()->implicit_value(true)
             ->default_value(false), "Export Morrowind .fnt fonts to PNG image and XML file in current directory")
 
-        ("activate-dist", bpo::value <int> ()->default_value (-1), "activation distance override");
+        ("activate-dist", bpo::value <int> ()->default_value (-1), "activation distance override")
+
+        ("headless", bpo::value<bool>()->implicit_value(true)
+            ->default_value(false), "run without window, rendering and sound output for a fixed number of frames, "
+            "then print the time taken by each subsystem (implies skip-menu)")
+
+        ("headless-frames", bpo::value<unsigned int>()->default_value(1000), "number of frames to run headless")
+
+        ("headless-fps", bpo::value<unsigned int>()->default_value(60), "frames per simulated second when running headless")
+
+        ("trace-frames", bpo::value<Files::EscapeHashString>()->default_value(""),
+            "write a profiler trace of the given frames (e.g. 100-200) to the user data directory, to be opened in chrome://tracing");
 
     bpo::parsed_options valid_opts = bpo::command_line_parser(argc, argv)
         .options(desc).allow_unregistered().run();
@@ -249,6 +261,25 @@ bool parseOptions (int argc, char** argv, OMW::Engine& engine, Files::Configurat
     engine.setActivationDistanceOverride (variables["activate-dist"].as<int>());
     engine.enableFontExport(variables["export-fonts"].as<bool>());
 
+    unsigned int headlessFps = variables["headless-fps"].as<unsigned int>();
+    if (headlessFps == 0)
+    {
+        std::cerr << "Warning: headless-fps must be positive, using 60" << std::endl;
+        headlessFps = 60;
+    }
+    engine.setHeadless(variables["headless"].as<bool>(), variables["headless-frames"].as<unsigned int>(), 1.f / headlessFps);
+
+    std::string traceFrames(variables["trace-frames"].as<Files::EscapeHashString>().toStdString());
+    if (!traceFrames.empty())
+    {
+        unsigned int first = 0;
+        unsigned int last = 0;
+        if (std::sscanf(traceFrames.c_str(), "%u-%u", &first, &last) == 2 && first <= last)
+            engine.setTraceFrames(first, last);
+        else
+            std::cerr << "Warning: invalid frame range for trace-frames: " << traceFrames << std::endl;
+    }
+
     return true;
 }
 
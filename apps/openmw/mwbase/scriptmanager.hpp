@@ -38,6 +38,13 @@ namespace MWBase
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext) = 0;
             ///< Run the script with the given name (compile first, if not compiled yet)
 
+            virtual int getScriptHandle (const std::string& name) = 0;
+            ///< Return a handle to run the script with the given name without looking it up by name
+            /// (compile first, if not compiled yet). Handles stay valid for the lifetime of the script manager.
+
+            virtual void run (int handle, Interpreter::Context& interpreterContext) = 0;
+            ///< Run the script with the given handle
+
             virtual bool compile (const std::string& name) = 0;
             ///< Compile script with the given namen
             /// \return Success?
@@ -50,6 +57,10 @@ namespace MWBase
             ///< Return locals for script \a name.
 
             virtual MWScript::GlobalScripts& getGlobalScripts() = 0;
+
+            virtual void clear() = 0;
+            ///< Clear the global scripts and forget the objects that member variables were resolved in,
+            /// when the game is cleared.
    };
 }
 
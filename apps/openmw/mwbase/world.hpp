@@ -110,6 +110,13 @@ namespace MWBase
 
             virtual MWWorld::CellStore *getExterior (int x, int y) = 0;
 
+            virtual MWWorld::CellStore *getExteriorInBackground (int x, int y, float priority) = 0;
+            ///< Get an exterior cell without loading it on this thread, see finishBackgroundLoad().
+
+            virtual bool finishBackgroundLoad (MWWorld::CellStore *cell) = 0;
+            ///< Load \a cell once its references have been read in the background.
+            /// \return Is \a cell loaded?
+
             virtual MWWorld::CellStore *getInterior (const std::string& name) = 0;
 
             virtual MWWorld::CellStore *getCell (const ESM::CellId& id) = 0;
@@ -162,6 +169,23 @@ namespace MWBase
             virtual char getGlobalVariableType (const std::string& name) const = 0;
             ///< Return ' ', if there is no global variable with this name.
 
+            virtual int getGlobalSlot (const std::string& name) const = 0;
+            ///< Return the slot of a global variable, to access it with the functions below.
+            /// Slots stay the same while the content files do not change.
+            /// Throws, if there is no global variable with this name.
+
+            virtual void setGlobalInt (int slot, int value) = 0;
+            ///< Set value independently from real type.
+
+            virtual void setGlobalFloat (int slot, float value) = 0;
+            ///< Set value independently from real type.
+
+            virtual int getGlobalInt (int slot) const = 0;
+            ///< Get value independently from real type.
+
+            virtual float getGlobalFloat (int slot) const = 0;
+            ///< Get value independently from real type.
+
             virtual std::string getCellName (const MWWorld::CellStore *cell = 0) const = 0;
             ///< Return name of the cell.
             ///
@@ -268,6 +292,10 @@ namespace MWBase
             virtual void deleteObject (const MWWorld::Ptr& ptr) = 0;
             virtual void undeleteObject (const MWWorld::Ptr& ptr) = 0;
 
+            virtual void pagingBlacklistChangedObjects (const MWWorld::CellStore& cell) = 0;
+            ///< Stop drawing the objects of \a cell that were changed from their state in the content
+            /// files as distant objects, e.g. after the state of the cell was loaded from a saved game.
+
             virtual MWWorld::Ptr moveObject (const MWWorld::Ptr& ptr, float x, float y, float z) = 0;
             ///< @return an updated Ptr in case the Ptr's cell changes
 
@@ -449,7 +477,8 @@ namespace MWBase
             virtual void reattachPlayerCamera() = 0;
 
             /// \todo this does not belong here
-            virtual void screenshot (osg::Image* image, int w, int h) = 0;
+            /// @return Was the screenshot taken? If not, the image must not be used.
+            virtual bool screenshot (osg::Image* image, int w, int h) = 0;
 
             /// Find default position inside exterior cell specified by name
             /// \return false if exterior with given name not exists, true otherwise
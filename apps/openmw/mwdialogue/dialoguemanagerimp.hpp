@@ -14,6 +14,8 @@
 
 #include "../mwscript/compilercontext.hpp"
 
+#include "filterindex.hpp"
+
 namespace ESM
 {
     struct Dialogue;
@@ -36,6 +38,8 @@ namespace MWDialogue
             std::ostream mErrorStream;
             Compiler::StreamErrorHandler mErrorHandler;
 
+            FilterIndex mFilterIndex;
+
             MWWorld::Ptr mActor;
             bool mTalkedTo;
 
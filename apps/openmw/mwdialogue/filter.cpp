@@ -148,9 +148,9 @@ bool MWDialogue::Filter::testPlayer (const ESM::DialInfo& info) const
     return true;
 }
 
-bool MWDialogue::Filter::testSelectStructs (const ESM::DialInfo& info) const
+bool MWDialogue::Filter::testSelectStructs (const FilterIndex::Info& info) const
 {
-    for (std::vector<ESM::DialInfo::SelectStruct>::const_iterator iter (info.mSelects.begin());
+    for (std::vector<SelectWrapper>::const_iterator iter (info.mSelects.begin());
         iter != info.mSelects.end(); ++iter)
         if (!testSelectStruct (*iter))
             return false;
@@ -611,9 +611,34 @@ bool MWDialogue::Filter::hasFactionRankReputationRequirements (const MWWorld::Pt
     return stats.getFactionReputation (factionId)>=faction.mData.mRankData[rank].mFactReaction;
 }
 
-MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer)
-: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer)
-{}
+MWDialogue::Filter::Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer, const FilterIndex& index)
+: mActor (actor), mChoice (choice), mTalkedToPlayer (talkedToPlayer), mIndex (index)
+{
+    mSpeaker.mId = Misc::StringUtils::lowerCase (mActor.getCellRef().getRefId());
+    mSpeaker.mIsCreature = (mActor.getTypeName() != typeid (ESM::NPC).name());
+
+    if (!mSpeaker.mIsCreature)
+    {
+        MWWorld::LiveCellRef<ESM::NPC> *cellRef = mActor.get<ESM::NPC>();
+        mSpeaker.mRace = Misc::StringUtils::lowerCase (cellRef->mBase->mRace);
+        mSpeaker.mClass = Misc::StringUtils::lowerCase (cellRef->mBase->mClass);
+        mSpeaker.mFaction = Misc::StringUtils::lowerCase (mActor.getClass().getPrimaryFaction (mActor));
+    }
+}
+
+void MWDialogue::Filter::getCandidates (const ESM::Dialogue& dialogue, FilterIndex::Topic& scratch,
+    std::vector<const FilterIndex::Info *>& candidates) const
+{
+    const FilterIndex::Topic *topic = mIndex.search (dialogue);
+
+    if (!topic)
+    {
+        FilterIndex::compile (dialogue, scratch);
+        topic = &scratch;
+    }
+
+    topic->getCandidates (mSpeaker, candidates);
+}
 
 const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue, const bool fallbackToInfoRefusal) const
 {
@@ -627,11 +652,15 @@ const ESM::DialInfo* MWDialogue::Filter::search (const ESM::Dialogue& dialogue,
 
 std::vector<const ESM::DialInfo *> MWDialogue::Filter::listAll (const ESM::Dialogue& dialogue) const
 {
+    FilterIndex::Topic scratch;
+    std::vector<const FilterIndex::Info *> candidates;
+    getCandidates (dialogue, scratch, candidates);
+
     std::vector<const ESM::DialInfo *> infos;
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin(); iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<const FilterIndex::Info *>::const_iterator iter = candidates.begin(); iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter))
-            infos.push_back(&*iter);
+        if (testActor (*(*iter)->mInfo))
+            infos.push_back((*iter)->mInfo);
     }
     return infos;
 }
@@ -643,14 +672,20 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
     bool infoRefusal = false;
 
+    FilterIndex::Topic scratch;
+    std::vector<const FilterIndex::Info *> candidates;
+    getCandidates (dialogue, scratch, candidates);
+
     // Iterate over topic responses to find a matching one
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    for (std::vector<const FilterIndex::Info *>::const_iterator iter = candidates.begin();
+        iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        const ESM::DialInfo& info = *(*iter)->mInfo;
+
+        if (testActor (info) && testPlayer (info) && testSelectStructs (**iter))
         {
-            if (testDisposition (*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+            if (testDisposition (info, invertDisposition)) {
+                infos.push_back(&info);
                 if (!searchAll)
                     break;
             }
@@ -669,13 +704,19 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
         const ESM::Dialogue& infoRefusalDialogue = *dialogues.find ("Info Refusal");
 
-        for (ESM::Dialogue::InfoContainer::const_iterator iter = infoRefusalDialogue.mInfo.begin();
-            iter!=infoRefusalDialogue.mInfo.end(); ++iter)
-            if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter) && testDisposition(*iter, invertDisposition)) {
-                infos.push_back(&*iter);
+        getCandidates (infoRefusalDialogue, scratch, candidates);
+
+        for (std::vector<const FilterIndex::Info *>::const_iterator iter = candidates.begin();
+            iter!=candidates.end(); ++iter)
+        {
+            const ESM::DialInfo& info = *(*iter)->mInfo;
+
+            if (testActor (info) && testPlayer (info) && testSelectStructs (**iter) && testDisposition(info, invertDisposition)) {
+                infos.push_back(&info);
                 if (!searchAll)
                     break;
             }
+        }
     }
 
     return infos;
@@ -683,10 +724,16 @@ std::vector<const ESM::DialInfo *> MWDialogue::Filter::list (const ESM::Dialogue
 
 bool MWDialogue::Filter::responseAvailable (const ESM::Dialogue& dialogue) const
 {
-    for (ESM::Dialogue::InfoContainer::const_iterator iter = dialogue.mInfo.begin();
-        iter!=dialogue.mInfo.end(); ++iter)
+    FilterIndex::Topic scratch;
+    std::vector<const FilterIndex::Info *> candidates;
+    getCandidates (dialogue, scratch, candidates);
+
+    for (std::vector<const FilterIndex::Info *>::const_iterator iter = candidates.begin();
+        iter!=candidates.end(); ++iter)
     {
-        if (testActor (*iter) && testPlayer (*iter) && testSelectStructs (*iter))
+        const ESM::DialInfo& info = *(*iter)->mInfo;
+
+        if (testActor (info) && testPlayer (info) && testSelectStructs (**iter))
             return true;
     }
 
@@ -5,6 +5,8 @@
 
 #include "../mwworld/ptr.hpp"
 
+#include "filterindex.hpp"
+
 namespace ESM
 {
     struct DialInfo;
@@ -13,13 +15,18 @@ namespace ESM
 
 namespace MWDialogue
 {
-    class SelectWrapper;
-
     class Filter
     {
             MWWorld::Ptr mActor;
             int mChoice;
             bool mTalkedToPlayer;
+            const FilterIndex& mIndex;
+            FilterIndex::Speaker mSpeaker;
+
+            void getCandidates (const ESM::Dialogue& dialogue, FilterIndex::Topic& scratch,
+                std::vector<const FilterIndex::Info *>& candidates) const;
+            ///< Get the infos of \a dialogue that could be used on the actor, judging by the static
+            /// speaker conditions only. \a scratch is used for dialogues missing from the index.
 
             bool testActor (const ESM::DialInfo& info) const;
             ///< Is this the right actor for this \a info?
@@ -27,7 +34,7 @@ namespace MWDialogue
             bool testPlayer (const ESM::DialInfo& info) const;
             ///< Do the player and the cell the player is currently in match \a info?
 
-            bool testSelectStructs (const ESM::DialInfo& info) const;
+            bool testSelectStructs (const FilterIndex::Info& info) const;
             ///< Are all select structs matching?
 
             bool testDisposition (const ESM::DialInfo& info, bool invert=false) const;
@@ -53,7 +60,7 @@ namespace MWDialogue
 
         public:
 
-            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer);
+            Filter (const MWWorld::Ptr& actor, int choice, bool talkedToPlayer, const FilterIndex& index);
 
             std::vector<const ESM::DialInfo *> list (const ESM::Dialogue& dialogue,
                 bool fallbackToInfoRefusal, bool searchAll, bool invertDisposition=false) const;
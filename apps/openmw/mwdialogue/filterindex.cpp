@@ -0,0 +1,112 @@
+#include "filterindex.hpp"
+
+#include <algorithm>
+
+#include <components/esm/loaddial.hpp>
+#include <components/misc/stringops.hpp>
+
+#include "../mwworld/store.hpp"
+
+namespace
+{
+    void addBucket (const MWDialogue::FilterIndex::Topic::Buckets& buckets, const std::string& key,
+        std::vector<int>& indices)
+    {
+        if (key.empty())
+            return;
+
+        MWDialogue::FilterIndex::Topic::Buckets::const_iterator iter = buckets.find (key);
+
+        if (iter!=buckets.end())
+            indices.insert (indices.end(), iter->second.begin(), iter->second.end());
+    }
+}
+
+MWDialogue::FilterIndex::Speaker::Speaker() : mIsCreature (false) {}
+
+void MWDialogue::FilterIndex::Topic::getCandidates (const Speaker& speaker,
+    std::vector<const Info *>& candidates) const
+{
+    candidates.clear();
+
+    std::vector<int> indices;
+
+    addBucket (mActors, speaker.mId, indices);
+
+    // Creatures can only use infos specific to their ID
+    if (!speaker.mIsCreature)
+    {
+        addBucket (mRaces, speaker.mRace, indices);
+        addBucket (mClasses, speaker.mClass, indices);
+        addBucket (mFactions, speaker.mFaction, indices);
+        indices.insert (indices.end(), mGeneric.begin(), mGeneric.end());
+
+        // Each info is in exactly one bucket, so the buckets only need to be merged back into order
+        std::sort (indices.begin(), indices.end());
+    }
+
+    candidates.reserve (indices.size());
+    for (std::vector<int>::const_iterator iter (indices.begin()); iter!=indices.end(); ++iter)
+        candidates.push_back (&mInfos[*iter]);
+}
+
+void MWDialogue::FilterIndex::compile (const ESM::Dialogue& dialogue, Topic& topic)
+{
+    topic.mInfos.clear();
+    topic.mActors.clear();
+    topic.mRaces.clear();
+    topic.mClasses.clear();
+    topic.mFactions.clear();
+    topic.mGeneric.clear();
+
+    topic.mInfos.reserve (dialogue.mInfo.size());
+
+    for (ESM::Dialogue::InfoContainer::const_iterator iter (dialogue.mInfo.begin());
+        iter!=dialogue.mInfo.end(); ++iter)
+    {
+        int index = static_cast<int> (topic.mInfos.size());
+
+        topic.mInfos.push_back (Info());
+        Info& info = topic.mInfos.back();
+        info.mInfo = &*iter;
+        info.mSelects.reserve (iter->mSelects.size());
+        for (std::vector<ESM::DialInfo::SelectStruct>::const_iterator select (iter->mSelects.begin());
+            select!=iter->mSelects.end(); ++select)
+            info.mSelects.push_back (SelectWrapper (*select));
+
+        // Only the most specific condition is used; Filter::testActor still checks all of them.
+        if (!iter->mActor.empty())
+            topic.mActors[Misc::StringUtils::lowerCase (iter->mActor)].push_back (index);
+        else if (!iter->mRace.empty())
+            topic.mRaces[Misc::StringUtils::lowerCase (iter->mRace)].push_back (index);
+        else if (!iter->mClass.empty())
+            topic.mClasses[Misc::StringUtils::lowerCase (iter->mClass)].push_back (index);
+        else if (!iter->mFactionLess && !iter->mFaction.empty())
+            topic.mFactions[Misc::StringUtils::lowerCase (iter->mFaction)].push_back (index);
+        else
+            topic.mGeneric.push_back (index);
+    }
+}
+
+void MWDialogue::FilterIndex::build (const MWWorld::Store<ESM::Dialogue>& dialogues)
+{
+    mTopics.clear();
+
+    for (MWWorld::Store<ESM::Dialogue>::iterator iter = dialogues.begin(); iter!=dialogues.end(); ++iter)
+        compile (*iter, mTopics[&*iter]);
+}
+
+const MWDialogue::FilterIndex::Topic *MWDialogue::FilterIndex::search (const ESM::Dialogue& dialogue) const
+{
+    std::map<const ESM::Dialogue *, Topic>::const_iterator iter = mTopics.find (&dialogue);
+
+    if (iter==mTopics.end())
+        return 0;
+
+    return &iter->second;
+}
+
+std::size_t MWDialogue::FilterIndex::size() const
+{
+    return mTopics.size();
+}
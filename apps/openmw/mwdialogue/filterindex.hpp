@@ -0,0 +1,83 @@
+#ifndef GAME_MWDIALOGUE_FILTERINDEX_H
+#define GAME_MWDIALOGUE_FILTERINDEX_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "selectwrapper.hpp"
+
+namespace ESM
+{
+    struct DialInfo;
+    struct Dialogue;
+}
+
+namespace MWWorld
+{
+    template<typename T>
+    class Store;
+}
+
+namespace MWDialogue
+{
+    /// \brief Precompiled lookup of the infos of each dialogue that a given speaker could use
+    ///
+    /// Infos are bucketed by their most specific static speaker condition (actor ID, then race, then
+    /// class, then faction), and their select structs are decoded once. A query only returns the infos
+    /// from the buckets matching the speaker and the infos without any of these conditions, so the
+    /// filter only needs to test those. Candidates are returned in the order of the dialogue.
+    class FilterIndex
+    {
+        public:
+
+            struct Info
+            {
+                const ESM::DialInfo *mInfo;
+                std::vector<SelectWrapper> mSelects;
+            };
+
+            /// Static properties of the speaker the index is queried for; all IDs are lower case.
+            struct Speaker
+            {
+                std::string mId;
+                std::string mRace;
+                std::string mClass;
+                std::string mFaction;
+                bool mIsCreature;
+
+                Speaker();
+            };
+
+            struct Topic
+            {
+                typedef std::map<std::string, std::vector<int> > Buckets;
+
+                std::vector<Info> mInfos;
+                Buckets mActors;
+                Buckets mRaces;
+                Buckets mClasses;
+                Buckets mFactions;
+                std::vector<int> mGeneric;
+
+                void getCandidates (const Speaker& speaker, std::vector<const Info *>& candidates) const;
+                ///< Replaces the content of \a candidates.
+            };
+
+            static void compile (const ESM::Dialogue& dialogue, Topic& topic);
+
+            void build (const MWWorld::Store<ESM::Dialogue>& dialogues);
+            ///< Replaces the current content of the index.
+
+            const Topic *search (const ESM::Dialogue& dialogue) const;
+            ///< \return 0, if \a dialogue is not indexed.
+
+            std::size_t size() const;
+
+        private:
+
+            std::map<const ESM::Dialogue *, Topic> mTopics;
+    };
+}
+
+#endif
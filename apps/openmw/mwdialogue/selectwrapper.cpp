@@ -44,13 +44,18 @@ namespace
     }
 }
 
-MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunction() const
+int MWDialogue::SelectWrapper::decodeIndex() const
 {
     int index = 0;
 
     std::istringstream (mSelect.mSelectRule.substr(2,2)) >> index;
 
-    switch (index)
+    return index;
+}
+
+MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunction() const
+{
+    switch (decodeIndex())
     {
         case  0: return Function_RankLow;
         case  1: return Function_RankHigh;
@@ -97,9 +102,23 @@ MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunction()
     return Function_False;
 }
 
-MWDialogue::SelectWrapper::SelectWrapper (const ESM::DialInfo::SelectStruct& select) : mSelect (select) {}
+MWDialogue::SelectWrapper::SelectWrapper (const ESM::DialInfo::SelectStruct& select) : mSelect (select)
+{
+    mFunction = decodeFunctionType();
+    mArgument = decodeArgument();
+    mType = decodeType();
+    mNpcOnly = decodeNpcOnly();
+
+    if (mSelect.mSelectRule.size()>5)
+        mName = Misc::StringUtils::lowerCase (mSelect.mSelectRule.substr (5));
+}
 
 MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::getFunction() const
+{
+    return mFunction;
+}
+
+MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::decodeFunctionType() const
 {
     char type = mSelect.mSelectRule[1];
 
@@ -123,15 +142,16 @@ MWDialogue::SelectWrapper::Function MWDialogue::SelectWrapper::getFunction() con
 }
 
 int MWDialogue::SelectWrapper::getArgument() const
+{
+    return mArgument;
+}
+
+int MWDialogue::SelectWrapper::decodeArgument() const
 {
     if (mSelect.mSelectRule[1]!='1')
         return 0;
 
-    int index = 0;
-
-    std::istringstream (mSelect.mSelectRule.substr(2,2)) >> index;
-
-    switch (index)
+    switch (decodeIndex())
     {
         // AI settings
         case 67: return 1;
@@ -188,6 +208,11 @@ int MWDialogue::SelectWrapper::getArgument() const
 }
 
 MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::getType() const
+{
+    return mType;
+}
+
+MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::decodeType() const
 {
     static const Function integerFunctions[] =
     {
@@ -236,7 +261,7 @@ MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::getType() const
         Function_None // end marker
     };
 
-    Function function = getFunction();
+    Function function = mFunction;
 
     for (int i=0; integerFunctions[i]!=Function_None; ++i)
         if (integerFunctions[i]==function)
@@ -258,6 +283,11 @@ MWDialogue::SelectWrapper::Type MWDialogue::SelectWrapper::getType() const
 }
 
 bool MWDialogue::SelectWrapper::isNpcOnly() const
+{
+    return mNpcOnly;
+}
+
+bool MWDialogue::SelectWrapper::decodeNpcOnly() const
 {
     static const Function functions[] =
     {
@@ -270,7 +300,7 @@ bool MWDialogue::SelectWrapper::isNpcOnly() const
         Function_None // end marker
     };
 
-    Function function = getFunction();
+    Function function = mFunction;
 
     for (int i=0; functions[i]!=Function_None; ++i)
         if (functions[i]==function)
@@ -294,7 +324,7 @@ bool MWDialogue::SelectWrapper::selectCompare (bool value) const
     return selectCompareImp (mSelect, static_cast<int> (value));
 }
 
-std::string MWDialogue::SelectWrapper::getName() const
+const std::string& MWDialogue::SelectWrapper::getName() const
 {
-    return Misc::StringUtils::lowerCase (mSelect.mSelectRule.substr (5));
+    return mName;
 }
@@ -1,10 +1,16 @@
 #ifndef GAME_MWDIALOGUE_SELECTWRAPPER_H
 #define GAME_MWDIALOGUE_SELECTWRAPPER_H
 
+#include <string>
+
 #include <components/esm/loadinfo.hpp>
 
 namespace MWDialogue
 {
+    /// \brief Decoded form of a dialogue info select struct
+    ///
+    /// The select rule is decoded once on construction, so wrappers kept around (see FilterIndex)
+    /// can be evaluated repeatedly without parsing the rule again.
     class SelectWrapper
     {
             const ESM::DialInfo::SelectStruct& mSelect;
@@ -57,8 +63,24 @@ namespace MWDialogue
 
         private:
 
+            Function mFunction;
+            int mArgument;
+            Type mType;
+            bool mNpcOnly;
+            std::string mName;
+
+            int decodeIndex() const;
+
             Function decodeFunction() const;
 
+            Function decodeFunctionType() const;
+
+            int decodeArgument() const;
+
+            Type decodeType() const;
+
+            bool decodeNpcOnly() const;
+
         public:
 
             SelectWrapper (const ESM::DialInfo::SelectStruct& select);
@@ -78,7 +100,7 @@ namespace MWDialogue
 
             bool selectCompare (bool value) const;
 
-            std::string getName() const;
+            const std::string& getName() const;
             ///< Return case-smashed name.
     };
 }
@@ -1,5 +1,7 @@
 #include "loadingscreen.hpp"
 
+#include <iostream>
+
 #include <osgViewer/Viewer>
 
 #include <osg/Texture2D>
@@ -39,6 +41,7 @@ namespace MWGui
         , mImportantLabel(false)
         , mProgress(0)
         , mShowWallpaper(true)
+        , mReportTimes(Settings::Manager::getBool("report content loading times", "General"))
     {
         mMainWidget->setSize(MyGUI::RenderManager::getInstance().getViewSize());
 
@@ -62,35 +65,24 @@ namespace MWGui
 
     void LoadingScreen::findSplashScreens()
     {
-        const std::map<std::string, VFS::File*>& index = mVFS->getIndex();
-        std::string pattern = "Splash/";
-        mVFS->normalizeFilename(pattern);
-
         /* priority given to the left */
         std::list<std::string> supported_extensions = {".tga", ".dds", ".ktx", ".png", ".bmp", ".jpeg", ".jpg"};
 
-        auto found = index.lower_bound(pattern);
-        while (found != index.end())
+        for (const VFS::FileIndex::Entry& entry : mVFS->getFilesWithPrefix("Splash/"))
         {
-            const std::string& name = found->first;
-            if (name.size() >= pattern.size() && name.substr(0, pattern.size()) == pattern)
+            const std::string name = entry.getName();
+            size_t pos = name.find_last_of('.');
+            if (pos != std::string::npos)
             {
-                size_t pos = name.find_last_of('.');
-                if (pos != std::string::npos)
+                for(auto const extension: supported_extensions)
                 {
-                    for(auto const extension: supported_extensions)
+                    if (name.compare(pos, name.size() - pos, extension) == 0)
                     {
-                        if (name.compare(pos, name.size() - pos, extension) == 0)
-                        {
-                            mSplashScreens.push_back(found->first);
-                            break;  /* based on priority */
-                        }
+                        mSplashScreens.push_back(name);
+                        break;  /* based on priority */
                     }
                 }
             }
-            else
-                break;
-            ++found;
         }
         if (mSplashScreens.empty())
             std::cerr << "No splash screens found!" << std::endl;
@@ -232,6 +224,12 @@ namespace MWGui
         mProgress = 0;
     }
 
+    void LoadingScreen::reportTime (const std::string& task, double milliseconds)
+    {
+        if (mReportTimes)
+            std::cout << task << ": " << milliseconds << " ms" << std::endl;
+    }
+
     void LoadingScreen::setProgress (size_t value)
     {
         // skip expensive update if there isn't enough visible progress
@@ -307,6 +305,10 @@ namespace MWGui
 
     void LoadingScreen::draw()
     {
+        // Nothing to draw to when running headless
+        if (!mViewer->isRealized())
+            return;
+
         if (!needToDrawLoadingScreen())
             return;
 
@@ -40,6 +40,7 @@ namespace MWGui
         virtual void setProgressRange (size_t range);
         virtual void setProgress (size_t value);
         virtual void increaseProgress (size_t increase=1);
+        virtual void reportTime (const std::string& task, double milliseconds);
 
         virtual void setVisible(bool visible);
 
@@ -67,6 +68,8 @@ namespace MWGui
 
         bool mShowWallpaper;
 
+        bool mReportTimes;
+
         MyGUI::Widget* mLoadingBox;
 
         MyGUI::TextBox* mLoadingText;
@@ -158,6 +158,12 @@ namespace MWGui
         return false;
     }
 
+    void MessageBoxManager::pressButton (int button)
+    {
+        if (mInterMessageBoxe != NULL)
+            mInterMessageBoxe->pressButton(button);
+    }
+
     int MessageBoxManager::readPressedButton (bool reset)
     {
         int pressed = mLastButtonPressed;
@@ -395,6 +401,12 @@ namespace MWGui
         }
     }
 
+    void InteractiveMessageBox::pressButton (int button)
+    {
+        if (button >= 0 && button < static_cast<int>(mButtons.size()))
+            buttonActivated(mButtons[button]);
+    }
+
     int InteractiveMessageBox::readPressedButton ()
     {
         return mButtonPressed;
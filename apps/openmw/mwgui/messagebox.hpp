@@ -36,6 +36,9 @@ namespace MWGui
             /// @param reset Reset the pressed button to -1 after reading it.
             int readPressedButton (bool reset=true);
 
+            /// Press a button of the interactive message box, as if the player clicked it. It is closed on the next frame.
+            void pressButton (int button);
+
             typedef MyGUI::delegates::CMultiDelegate1<int> EventHandle_Int;
 
             // Note: this delegate unassigns itself after it was fired, i.e. works once.
@@ -75,6 +78,7 @@ namespace MWGui
         public:
             InteractiveMessageBox (MessageBoxManager& parMessageBoxManager, const std::string& message, const std::vector<std::string>& buttons);
             void mousePressed (MyGUI::Widget* _widget);
+            void pressButton (int button);
             int readPressedButton ();
 
             virtual bool exit() { return false; }
@@ -131,12 +131,14 @@ namespace MWGui
     WindowManager::WindowManager(
             osgViewer::Viewer* viewer, osg::Group* guiRoot, Resource::ResourceSystem* resourceSystem, SceneUtil::WorkQueue* workQueue,
             const std::string& logpath, const std::string& resourcePath, bool consoleOnlyScripts,
-            Translation::Storage& translationDataStorage, ToUTF8::FromType encoding, bool exportFonts, const std::map<std::string, std::string>& fallbackMap, const std::string& versionDescription)
+            Translation::Storage& translationDataStorage, ToUTF8::FromType encoding, bool exportFonts, const std::map<std::string, std::string>& fallbackMap, const std::string& versionDescription,
+            bool headless)
       : mStore(NULL)
       , mResourceSystem(resourceSystem)
       , mWorkQueue(workQueue)
       , mViewer(viewer)
       , mConsoleOnlyScripts(consoleOnlyScripts)
+      , mHeadless(headless)
       , mCurrentModals()
       , mHud(NULL)
       , mMap(NULL)
@@ -764,6 +766,14 @@ namespace MWGui
         mMessageBoxManager->createInteractiveMessageBox(message, buttons);
         updateVisible();
 
+        if (mHeadless)
+        {
+            // Take the first choice, as no frames are drawn and no input arrives that could answer the box
+            mMessageBoxManager->pressButton(0);
+            mMessageBoxManager->onFrame(0.f);
+            return;
+        }
+
         if (block)
         {
             osg::Timer frameTimer;
@@ -8,6 +8,7 @@
 #include <components/esm/loadnpc.hpp>
 
 #include <components/sceneutil/positionattitudetransform.hpp>
+#include <components/sceneutil/profiler.hpp>
 
 #include <components/settings/settings.hpp>
 
@@ -143,6 +144,23 @@ namespace MWMechanics
     const float aiProcessingDistance = 7168;
     const float sqrAiProcessingDistance = aiProcessingDistance*aiProcessingDistance;
 
+    // Size of the cells of the spatial grid used for range queries. Should be in the order of the radius of the
+    // most frequent queries (head tracking, alarm radius); larger queries like the AI processing distance just cover more rows.
+    const float actorGridCellSize = 1024;
+
+    float getMaxHeadTrackDistance(const MWWorld::Ptr& actor)
+    {
+        static const float fMaxHeadTrackDistance = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
+                .find("fMaxHeadTrackDistance")->getFloat();
+        static const float fInteriorHeadTrackMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
+                .find("fInteriorHeadTrackMult")->getFloat();
+        float maxDistance = fMaxHeadTrackDistance;
+        const ESM::Cell* currentCell = actor.getCell()->getCell();
+        if (!currentCell->isExterior() && !(currentCell->mData.mFlags & ESM::Cell::QuasiEx))
+            maxDistance *= fInteriorHeadTrackMult;
+        return maxDistance;
+    }
+
     class SoulTrap : public MWMechanics::EffectSourceVisitor
     {
         MWWorld::Ptr mCreature;
@@ -242,14 +260,7 @@ namespace MWMechanics
     void Actors::updateHeadTracking(const MWWorld::Ptr& actor, const MWWorld::Ptr& targetActor,
                                     MWWorld::Ptr& headTrackTarget, float& sqrHeadTrackDistance)
     {
-        static const float fMaxHeadTrackDistance = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                .find("fMaxHeadTrackDistance")->getFloat();
-        static const float fInteriorHeadTrackMult = MWBase::Environment::get().getWorld()->getStore().get<ESM::GameSetting>()
-                .find("fInteriorHeadTrackMult")->getFloat();
-        float maxDistance = fMaxHeadTrackDistance;
-        const ESM::Cell* currentCell = actor.getCell()->getCell();
-        if (!currentCell->isExterior() && !(currentCell->mData.mFlags & ESM::Cell::QuasiEx))
-            maxDistance *= fInteriorHeadTrackMult;
+        const float maxDistance = getMaxHeadTrackDistance(actor);
 
         const ESM::Position& actor1Pos = actor.getRefData().getPosition();
         const ESM::Position& actor2Pos = targetActor.getRefData().getPosition();
@@ -1056,7 +1067,10 @@ namespace MWMechanics
         }
     }
 
-    Actors::Actors() {
+    Actors::Actors()
+        : mGrid(actorGridCellSize)
+        , mGridDirty(false)
+    {
         mTimerDisposeSummonsCorpses = 0.2f; // We should add a delay between summoned creature death and its corpse despawning
     }
 
@@ -1073,6 +1087,7 @@ namespace MWMechanics
         if (!anim)
             return;
         mActors.insert(std::make_pair(ptr, new Actor(ptr, anim)));
+        mGridDirty = true;
         if (updateImmediately)
             mActors[ptr]->getCharacterController()->update(0);
     }
@@ -1084,6 +1099,7 @@ namespace MWMechanics
         {
             delete iter->second;
             mActors.erase(iter);
+            mGridDirty = true;
         }
     }
 
@@ -1130,6 +1146,7 @@ namespace MWMechanics
 
             actor->updatePtr(ptr);
             mActors.insert(std::make_pair(ptr, actor));
+            mGridDirty = true;
         }
     }
 
@@ -1142,6 +1159,7 @@ namespace MWMechanics
             {
                 delete iter->second;
                 mActors.erase(iter++);
+                mGridDirty = true;
             }
             else
                 ++iter;
@@ -1150,6 +1168,8 @@ namespace MWMechanics
 
     void Actors::update (float duration, bool paused)
     {
+        OPENMW_PROFILE_ZONE("Actors");
+
         if(!paused)
         {
             static float timerUpdateAITargets = 0;
@@ -1171,6 +1191,9 @@ namespace MWMechanics
 
             std::map<const MWWorld::Ptr, const std::set<MWWorld::Ptr> > cachedAllies; // will be filled as engageCombat iterates
 
+            updateGrid();
+            std::vector<MWWorld::Ptr> neighbours;
+
              // AI and magic effects update
             for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
             {
@@ -1205,7 +1228,10 @@ namespace MWMechanics
                 {
                     bool cellChanged = MWBase::Environment::get().getWorld()->hasCellChanged();
                     MWWorld::Ptr actor = iter->first; // make a copy of the map key to avoid it being invalidated when the player teleports
-                    updateActor(actor, duration);
+                    {
+                        OPENMW_PROFILE_ZONE("Actors: mechanics");
+                        updateActor(actor, duration);
+                    }
                     if (!cellChanged && MWBase::Environment::get().getWorld()->hasCellChanged())
                     {
                         return; // for now abort update of the old cell when cell changes by teleportation magic effect
@@ -1215,18 +1241,28 @@ namespace MWMechanics
                     {
                         if (timerUpdateAITargets == 0)
                         {
+                            OPENMW_PROFILE_ZONE("Actors: proximity");
+
                             if (iter->first != player)
                                 adjustCommandedActor(iter->first);
 
-                            for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                            // engageCombat ignores actors outside of the AI processing distance
+                            if (iter->first != player) // player is not AI-controlled
                             {
-                                if (it->first == iter->first || iter->first == player) // player is not AI-controlled
-                                    continue;
-                                engageCombat(iter->first, it->first, cachedAllies, it->first == player);
+                                neighbours.clear();
+                                getObjectsInRange(iter->first.getRefData().getPosition().asVec3(), aiProcessingDistance, neighbours);
+                                for(std::vector<MWWorld::Ptr>::const_iterator it(neighbours.begin()); it != neighbours.end(); ++it)
+                                {
+                                    if (*it == iter->first)
+                                        continue;
+                                    engageCombat(iter->first, *it, cachedAllies, *it == player);
+                                }
                             }
                         }
                         if (timerUpdateHeadTrack == 0)
                         {
+                            OPENMW_PROFILE_ZONE("Actors: proximity");
+
                             float sqrHeadTrackDistance = std::numeric_limits<float>::max();
                             MWWorld::Ptr headTrackTarget;
 
@@ -1238,11 +1274,13 @@ namespace MWMechanics
                                 !stats.getAiSequence().isInCombat() &&
                                 !stats.getAiSequence().hasPackage(AiPackage::TypeIdPursue))
                             {
-                                for(PtrActorMap::iterator it(mActors.begin()); it != mActors.end(); ++it)
+                                neighbours.clear();
+                                getObjectsInRange(iter->first.getRefData().getPosition().asVec3(), getMaxHeadTrackDistance(iter->first), neighbours);
+                                for(std::vector<MWWorld::Ptr>::const_iterator it(neighbours.begin()); it != neighbours.end(); ++it)
                                 {
-                                    if (it->first == iter->first)
+                                    if (*it == iter->first)
                                         continue;
-                                    updateHeadTracking(iter->first, it->first, headTrackTarget, sqrHeadTrackDistance);
+                                    updateHeadTracking(iter->first, *it, headTrackTarget, sqrHeadTrackDistance);
                                 }
                             }
 
@@ -1254,6 +1292,8 @@ namespace MWMechanics
 
                         if (iter->first != player)
                         {
+                            OPENMW_PROFILE_ZONE("Actors: AI packages");
+
                             CreatureStats &stats = iter->first.getClass().getCreatureStats(iter->first);
                             if (isConscious(iter->first))
                                 stats.getAiSequence().execute(iter->first, *iter->second->getCharacterController(), iter->second->getAiState(), duration);
@@ -1264,6 +1304,8 @@ namespace MWMechanics
 
                     if(iter->first.getTypeName() == typeid(ESM::NPC).name())
                     {
+                        OPENMW_PROFILE_ZONE("Actors: mechanics");
+
                         updateNpc(iter->first, duration);
 
                         if (timerUpdateEquippedLight == 0)
@@ -1277,38 +1319,42 @@ namespace MWMechanics
             timerUpdateEquippedLight += duration;
             mTimerDisposeSummonsCorpses += duration;
 
-            // Looping magic VFX update
-            // Note: we need to do this before any of the animations are updated.
-            // Reaching the text keys may trigger Hit / Spellcast (and as such, particles),
-            // so updating VFX immediately after that would just remove the particle effects instantly.
-            // There needs to be a magic effect update in between.
-            for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
-                iter->second->getCharacterController()->updateContinuousVfx();
-
-            // Animation/movement update
             CharacterController* playerCharacter = NULL;
-            for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
             {
-                if (iter->first != player &&
-                        (player.getRefData().getPosition().asVec3() - iter->first.getRefData().getPosition().asVec3()).length2()
-                        > sqrAiProcessingDistance)
-                    continue;
+                OPENMW_PROFILE_ZONE("Actors: animation");
+
+                // Looping magic VFX update
+                // Note: we need to do this before any of the animations are updated.
+                // Reaching the text keys may trigger Hit / Spellcast (and as such, particles),
+                // so updating VFX immediately after that would just remove the particle effects instantly.
+                // There needs to be a magic effect update in between.
+                for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
+                    iter->second->getCharacterController()->updateContinuousVfx();
+
+                // Animation/movement update
+                for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
+                {
+                    if (iter->first != player &&
+                            (player.getRefData().getPosition().asVec3() - iter->first.getRefData().getPosition().asVec3()).length2()
+                            > sqrAiProcessingDistance)
+                        continue;
 
-                if (iter->first.getClass().getCreatureStats(iter->first).isParalyzed())
-                    iter->second->getCharacterController()->skipAnim();
+                    if (iter->first.getClass().getCreatureStats(iter->first).isParalyzed())
+                        iter->second->getCharacterController()->skipAnim();
 
-                // Handle player last, in case a cell transition occurs by casting a teleportation spell
-                // (would invalidate the iterator)
-                if (iter->first == getPlayer())
-                {
-                    playerCharacter = iter->second->getCharacterController();
-                    continue;
+                    // Handle player last, in case a cell transition occurs by casting a teleportation spell
+                    // (would invalidate the iterator)
+                    if (iter->first == getPlayer())
+                    {
+                        playerCharacter = iter->second->getCharacterController();
+                        continue;
+                    }
+                    iter->second->getCharacterController()->update(duration);
                 }
-                iter->second->getCharacterController()->update(duration);
-            }
 
-            if (playerCharacter)
-                playerCharacter->update(duration);
+                if (playerCharacter)
+                    playerCharacter->update(duration);
+            }
 
             for(PtrActorMap::iterator iter(mActors.begin()); iter != mActors.end(); ++iter)
             {
@@ -1329,7 +1375,10 @@ namespace MWMechanics
                 }
             }
 
-            killDeadActors();
+            {
+                OPENMW_PROFILE_ZONE("Actors: death handling");
+                killDeadActors();
+            }
 
             // check if we still have any player enemies to switch music
             static int currentMusic = 0;
@@ -1351,6 +1400,8 @@ namespace MWMechanics
             // if player is in sneak state see if anyone detects him
             if (playerCharacter && playerCharacter->isSneaking())
             {
+                OPENMW_PROFILE_ZONE("Actors: sneak checks");
+
                 static float sneakSkillTimer = 0.f; // times sneak skill progress from "avoid notice"
 
                 const MWWorld::ESMStore& esmStore = MWBase::Environment::get().getWorld()->getStore();
@@ -1411,6 +1462,9 @@ namespace MWMechanics
                 sneakTimer = 0.f;
                 MWBase::Environment::get().getWindowManager()->setSneakVisibility(false);
             }
+
+            // Physics apply the queued movement after this, so the grid has to be rebuilt before it is queried again
+            mGridDirty = true;
         }
     }
 
@@ -1618,13 +1672,30 @@ namespace MWMechanics
             iter->second->getCharacterController()->persistAnimationState();
     }
 
-    void Actors::getObjectsInRange(const osg::Vec3f& position, float radius, std::vector<MWWorld::Ptr>& out)
+    void Actors::updateGrid()
     {
+        if (!mGridDirty)
+            return;
+
+        mGrid.clear();
+        mGridActors.clear();
         for (PtrActorMap::iterator iter = mActors.begin(); iter != mActors.end(); ++iter)
         {
-            if ((iter->first.getRefData().getPosition().asVec3() - position).length2() <= radius*radius)
-                out.push_back(iter->first);
+            mGrid.add(mGridActors.size(), iter->first.getRefData().getPosition().asVec3());
+            mGridActors.push_back(iter->first);
         }
+        mGrid.build();
+        mGridDirty = false;
+    }
+
+    void Actors::getObjectsInRange(const osg::Vec3f& position, float radius, std::vector<MWWorld::Ptr>& out)
+    {
+        updateGrid();
+
+        std::vector<std::size_t> indices;
+        mGrid.query(position, radius, indices);
+        for (std::vector<std::size_t>::const_iterator it = indices.begin(); it != indices.end(); ++it)
+            out.push_back(mGridActors[*it]);
     }
 
     std::list<MWWorld::Ptr> Actors::getActorsSidingWith(const MWWorld::Ptr& actor)
@@ -1828,6 +1899,7 @@ namespace MWMechanics
             it->second = NULL;
         }
         mActors.clear();
+        mGridDirty = true;
         mDeathCount.clear();
     }
 
@@ -10,6 +10,7 @@
 #include "../mwbase/world.hpp"
 
 #include "movement.hpp"
+#include "spatialgrid.hpp"
 
 namespace MWWorld
 {
@@ -47,6 +48,9 @@ namespace MWMechanics
 
             void purgeSpellEffects (int casterActorId);
 
+            /// Rebuild the spatial grid from the current actor positions, if it is out of date.
+            void updateGrid();
+
         public:
 
             Actors();
@@ -122,6 +126,9 @@ namespace MWMechanics
         bool checkAnimationPlaying(const MWWorld::Ptr& ptr, const std::string& groupName);
         void persistAnimationStates();
 
+            /// Find the actors within \a radius of \a position, in the same order as they are iterated by begin() / end().
+            /// \note Uses the actor positions at the time the spatial grid was last rebuilt, which happens whenever
+            /// actors are added or removed and once per frame, after physics have moved them.
             void getObjectsInRange(const osg::Vec3f& position, float radius, std::vector<MWWorld::Ptr>& out);
 
             void cleanupSummonedCreature (CreatureStats& casterStats, int creatureActorId);
@@ -161,6 +168,11 @@ namespace MWMechanics
         PtrActorMap mActors;
         float mTimerDisposeSummonsCorpses;
 
+        /// Actor positions for range queries. The grid indices point into mGridActors, which is in mActors order.
+        SpatialGrid mGrid;
+        std::vector<MWWorld::Ptr> mGridActors;
+        bool mGridDirty;
+
     };
 }
 
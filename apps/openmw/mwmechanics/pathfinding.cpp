@@ -218,8 +218,8 @@ namespace MWMechanics
         // AiWander has logic that depends on whether a path was created,
         // deleting allowed nodes if not.  Hence a path needs to be created
         // even if the start and the end points are the same.
-        // NOTE: aStarSearch will return an empty path if the start and end
-        //       nodes are the same
+        // NOTE: aStarSearch returns a path of only one point if the start
+        //       and end nodes are the same
         if(startNode == endNode.first)
         {
             ESM::Pathgrid::Point temp(mPathgrid->mPoints[startNode]);
@@ -228,12 +228,14 @@ namespace MWMechanics
         }
         else
         {
-            mPath = mCell->aStarSearch(startNode, endNode.first);
+            mCell->aStarSearch(startNode, endNode.first, mPathgridPoints);
 
             // convert supplied path to world coordinates
-            for (std::list<ESM::Pathgrid::Point>::iterator iter(mPath.begin()); iter != mPath.end(); ++iter)
+            for (std::vector<int>::const_iterator iter(mPathgridPoints.begin()); iter != mPathgridPoints.end(); ++iter)
             {
-                converter.toWorld(*iter);
+                ESM::Pathgrid::Point temp(mPathgrid->mPoints[*iter]);
+                converter.toWorld(temp);
+                mPath.push_back(temp);
             }
         }
 
@@ -1,13 +1,13 @@
 #include "pathgrid.hpp"
 
-#include "../mwbase/world.hpp"
-#include "../mwbase/environment.hpp"
-
-#include "../mwworld/cellstore.hpp"
-#include "../mwworld/esmstore.hpp"
+#include <algorithm>
+#include <cstdlib>
 
 namespace
 {
+    // Number of (start, goal) pairs whose paths are cached per pathgrid
+    const std::size_t pathCacheSize = 32;
+
     // See http://theory.stanford.edu/~amitp/GameProgramming/Heuristics.html
     //
     // One of the smallest cost in Seyda Neen is between points 77 & 78:
@@ -50,9 +50,7 @@ namespace
 namespace MWMechanics
 {
     PathgridGraph::PathgridGraph()
-        : mCell(NULL)
-        , mPathgrid(NULL)
-        , mIsExterior(0)
+        : mPathgrid(NULL)
         , mGraph(0)
         , mIsGraphConstructed(false)
         , mSCCId(0)
@@ -60,6 +58,48 @@ namespace MWMechanics
     {
     }
 
+    PathgridGraph::PathgridGraph(const PathgridGraph& other)
+        : mPathgrid(other.mPathgrid)
+        , mGraph(other.mGraph)
+        , mIsGraphConstructed(other.mIsGraphConstructed)
+        , mSCCId(other.mSCCId)
+        , mSCCIndex(other.mSCCIndex)
+        , mSCCStack(other.mSCCStack)
+        , mSCCPoint(other.mSCCPoint)
+        , mGScore(other.mGScore)
+        , mFScore(other.mFScore)
+        , mParent(other.mParent)
+        , mHeapPos(other.mHeapPos)
+        , mClosed(other.mClosed)
+        , mHeap(other.mHeap)
+    {
+        // mPathCacheIndex holds iterators into other.mPathCache, so the copy starts with an empty cache
+    }
+
+    PathgridGraph& PathgridGraph::operator=(const PathgridGraph& other)
+    {
+        if(this != &other)
+        {
+            PathgridGraph copy(other);
+            mPathgrid = copy.mPathgrid;
+            mGraph.swap(copy.mGraph);
+            mIsGraphConstructed = copy.mIsGraphConstructed;
+            mSCCId = copy.mSCCId;
+            mSCCIndex = copy.mSCCIndex;
+            mSCCStack.swap(copy.mSCCStack);
+            mSCCPoint.swap(copy.mSCCPoint);
+            mGScore.swap(copy.mGScore);
+            mFScore.swap(copy.mFScore);
+            mParent.swap(copy.mParent);
+            mHeapPos.swap(copy.mHeapPos);
+            mClosed.swap(copy.mClosed);
+            mHeap.swap(copy.mHeap);
+            mPathCache.clear();
+            mPathCacheIndex.clear();
+        }
+        return *this;
+    }
+
     /*
      * mGraph is populated with the cost of each allowed edge.
      *
@@ -96,17 +136,12 @@ namespace MWMechanics
      *    +---------------->
      *      high cost
      */
-    bool PathgridGraph::load(const MWWorld::CellStore *cell)
+    bool PathgridGraph::load(const ESM::Pathgrid *pathgrid)
     {
-        if(!cell)
-            return false;
-
         if(mIsGraphConstructed)
             return true;
 
-        mCell = cell->getCell();
-        mIsExterior = cell->getCell()->isExterior();
-        mPathgrid = MWBase::Environment::get().getWorld()->getStore().get<ESM::Pathgrid>().search(*cell->getCell());
+        mPathgrid = pathgrid;
         if(!mPathgrid)
             return false;
 
@@ -126,6 +161,15 @@ namespace MWMechanics
             //mGraph[mPathgrid->mEdges[i].mV1].edges.push_back(neighbour);
         }
         buildConnectedPoints();
+
+        const std::size_t pointsSize = mPathgrid->mPoints.size();
+        mGScore.resize(pointsSize);
+        mFScore.resize(pointsSize);
+        mParent.resize(pointsSize);
+        mHeapPos.resize(pointsSize);
+        mClosed.resize(pointsSize);
+        mHeap.reserve(pointsSize);
+
         mIsGraphConstructed = true;
         return true;
     }
@@ -214,6 +258,35 @@ namespace MWMechanics
         return (mGraph[start].componentId == mGraph[end].componentId);
     }
 
+    bool PathgridGraph::aStarSearch(const int start, const int goal, std::vector<int>& path) const
+    {
+        path.clear();
+        if(!isPointConnected(start, goal))
+            return false; // there is no path
+
+        const PathKey key(start, goal);
+        std::map<PathKey, PathCache::iterator>::iterator cached = mPathCacheIndex.find(key);
+        if(cached != mPathCacheIndex.end())
+        {
+            // move to the back, as the most recently used
+            mPathCache.splice(mPathCache.end(), mPathCache, cached->second);
+            path = cached->second->second;
+            return true;
+        }
+
+        if(!search(start, goal, path))
+            return false;
+
+        if(mPathCache.size() >= pathCacheSize)
+        {
+            mPathCacheIndex.erase(mPathCache.front().first);
+            mPathCache.pop_front();
+        }
+        mPathCache.push_back(std::make_pair(key, path));
+        mPathCacheIndex[key] = --mPathCache.end();
+        return true;
+    }
+
     /*
      * NOTE: Based on buildPath2(), please check git history if interested
      *       Should consider using a 3rd party library version (e.g. boost)
@@ -222,106 +295,132 @@ namespace MWMechanics
      * Uses mGraph which has pre-computed costs for allowed edges.  It is assumed
      * that mGraph is already constructed.
      *
-     * Should be possible to make this MT safe.
-     *
-     * Returns path which may be empty.  path contains pathgrid points in local
-     * cell coordinates (indoors) or world coordinates (external).
+     * Returns path as pathgrid point indexes, which may be empty.
      *
      * Input params:
      *   start, goal - pathgrid point indexes (for this cell)
      *
      * Variables:
-     *   openset - point indexes to be traversed, lowest cost at the front
-     *   closedset - point indexes already traversed
-     *   gScore - past accumulated costs vector indexed by point index
-     *   fScore - future estimated costs vector indexed by point index
-     *
-     * TODO: An intersting exercise might be to cache the paths created for a
-     *       start/goal pair.  To cache the results the paths need to be in
-     *       pathgrid points form (currently they are converted to world
-     *       coordinates).  Essentially trading speed w/ memory.
+     *   mHeap - point indexes to be traversed (open set), a binary heap with
+     *           the lowest fScore at the front. mHeapPos allows updating the
+     *           score of points that are already in the heap.
+     *   mClosed - point indexes already traversed
+     *   mGScore - past accumulated costs vector indexed by point index
+     *   mFScore - future estimated costs vector indexed by point index
      */
-    std::list<ESM::Pathgrid::Point> PathgridGraph::aStarSearch(const int start,
-                                                               const int goal) const
+    bool PathgridGraph::search(const int start, const int goal, std::vector<int>& path) const
     {
-        std::list<ESM::Pathgrid::Point> path;
-        if(!isPointConnected(start, goal))
-        {
-            return path; // there is no path, return an empty path
-        }
+        std::fill(mParent.begin(), mParent.end(), -1);
+        std::fill(mHeapPos.begin(), mHeapPos.end(), -1);
+        std::fill(mClosed.begin(), mClosed.end(), false);
+        mHeap.clear();
 
-        int graphSize = static_cast<int> (mGraph.size());
-        std::vector<float> gScore (graphSize, -1);
-        std::vector<float> fScore (graphSize, -1);
-        std::vector<int> graphParent (graphSize, -1);
-
-        // gScore & fScore keep costs for each pathgrid point in mPoints
-        gScore[start] = 0;
-        fScore[start] = costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]);
-
-        std::list<int> openset;
-        std::list<int> closedset;
-        openset.push_back(start);
+        mGScore[start] = 0;
+        mFScore[start] = costAStar(mPathgrid->mPoints[start], mPathgrid->mPoints[goal]);
+        heapPush(start);
 
         int current = -1;
 
-        while(!openset.empty())
+        while(!mHeap.empty())
         {
-            current = openset.front(); // front has the lowest cost
-            openset.pop_front();
+            current = heapPop(); // lowest cost
 
             if(current == goal)
                 break;
 
-            closedset.push_back(current); // remember we've been here
+            mClosed[current] = true; // remember we've been here
 
             // check all edges for the current point index
-            for(int j = 0; j < static_cast<int> (mGraph[current].edges.size()); j++)
+            const std::vector<ConnectedPoint>& edges = mGraph[current].edges;
+            for(std::vector<ConnectedPoint>::const_iterator edge = edges.begin(); edge != edges.end(); ++edge)
             {
-                if(std::find(closedset.begin(), closedset.end(), mGraph[current].edges[j].index) ==
-                   closedset.end())
+                const int dest = edge->index;
+                if(mClosed[dest])
+                    continue; // traversed this edge destination already
+
+                const float tentative_g = mGScore[current] + edge->cost;
+                const bool isInOpenSet = mHeapPos[dest] != -1;
+                if(!isInOpenSet || tentative_g < mGScore[dest])
                 {
-                    // not in closedset - i.e. have not traversed this edge destination
-                    int dest = mGraph[current].edges[j].index;
-                    float tentative_g = gScore[current] + mGraph[current].edges[j].cost;
-                    bool isInOpenSet = std::find(openset.begin(), openset.end(), dest) != openset.end();
-                    if(!isInOpenSet
-                        || tentative_g < gScore[dest])
-                    {
-                        graphParent[dest] = current;
-                        gScore[dest] = tentative_g;
-                        fScore[dest] = tentative_g + costAStar(mPathgrid->mPoints[dest],
-                                                               mPathgrid->mPoints[goal]);
-                        if(!isInOpenSet)
-                        {
-                            // add this edge to openset, lowest cost goes to the front
-                            // TODO: if this causes performance problems a hash table may help
-                            std::list<int>::iterator it = openset.begin();
-                            for(it = openset.begin(); it!= openset.end(); ++it)
-                            {
-                                if(fScore[*it] > fScore[dest])
-                                    break;
-                            }
-                            openset.insert(it, dest);
-                        }
-                    }
-                } // if in closedset, i.e. traversed this edge already, try the next edge
+                    mParent[dest] = current;
+                    mGScore[dest] = tentative_g;
+                    mFScore[dest] = tentative_g + costAStar(mPathgrid->mPoints[dest],
+                                                            mPathgrid->mPoints[goal]);
+                    if(isInOpenSet)
+                        heapSiftUp(mHeapPos[dest]); // the cost only ever decreases
+                    else
+                        heapPush(dest);
+                }
             }
         }
 
         if(current != goal)
-            return path; // for some reason couldn't build a path
+            return false; // for some reason couldn't build a path
+
+        // reconstruct path to return
+        for(int point = current; point != -1; point = mParent[point])
+            path.push_back(point);
+        std::reverse(path.begin(), path.end());
+        return true;
+    }
+
+    void PathgridGraph::heapPush(int point) const
+    {
+        mHeapPos[point] = static_cast<int>(mHeap.size());
+        mHeap.push_back(point);
+        heapSiftUp(mHeap.size() - 1);
+    }
+
+    int PathgridGraph::heapPop() const
+    {
+        const int top = mHeap.front();
+        mHeapPos[top] = -1;
 
-        // reconstruct path to return, using local coordinates
-        while(graphParent[current] != -1)
+        const int last = mHeap.back();
+        mHeap.pop_back();
+        if(!mHeap.empty())
         {
-            path.push_front(mPathgrid->mPoints[current]);
-            current = graphParent[current];
+            mHeap[0] = last;
+            mHeapPos[last] = 0;
+            heapSiftDown(0);
         }
+        return top;
+    }
 
-        // add first node to path explicitly
-        path.push_front(mPathgrid->mPoints[start]);
-        return path;
+    void PathgridGraph::heapSiftUp(std::size_t pos) const
+    {
+        const int point = mHeap[pos];
+        while(pos > 0)
+        {
+            const std::size_t parent = (pos - 1) / 2;
+            if(mFScore[mHeap[parent]] <= mFScore[point])
+                break;
+            mHeap[pos] = mHeap[parent];
+            mHeapPos[mHeap[pos]] = static_cast<int>(pos);
+            pos = parent;
+        }
+        mHeap[pos] = point;
+        mHeapPos[point] = static_cast<int>(pos);
     }
-}
 
+    void PathgridGraph::heapSiftDown(std::size_t pos) const
+    {
+        const int point = mHeap[pos];
+        const std::size_t size = mHeap.size();
+        while(true)
+        {
+            std::size_t child = pos * 2 + 1;
+            if(child >= size)
+                break;
+            if(child + 1 < size && mFScore[mHeap[child + 1]] < mFScore[mHeap[child]])
+                ++child;
+            if(mFScore[point] <= mFScore[mHeap[child]])
+                break;
+            mHeap[pos] = mHeap[child];
+            mHeapPos[mHeap[pos]] = static_cast<int>(pos);
+            pos = child;
+        }
+        mHeap[pos] = point;
+        mHeapPos[point] = static_cast<int>(pos);
+    }
+}
@@ -2,19 +2,12 @@
 #define GAME_MWMECHANICS_PATHGRID_H
 
 #include <list>
+#include <map>
+#include <utility>
+#include <vector>
 
 #include <components/esm/loadpgrd.hpp>
 
-namespace ESM
-{
-    struct Cell;
-}
-
-namespace MWWorld
-{
-    class CellStore;
-}
-
 namespace MWMechanics
 {
     class PathgridGraph
@@ -22,24 +15,28 @@ namespace MWMechanics
         public:
             PathgridGraph();
 
-            bool load(const MWWorld::CellStore *cell);
+            /// Copies the graph, but not the cache of recently found paths.
+            PathgridGraph(const PathgridGraph& other);
+            PathgridGraph& operator=(const PathgridGraph& other);
+
+            /// Build the graph for the pathgrid of a cell. Only the first successful call has any effect.
+            /// \note The pathgrid must outlive the graph.
+            bool load(const ESM::Pathgrid *pathgrid);
 
             // returns true if end point is strongly connected (i.e. reachable
             // from start point) both start and end are pathgrid point indexes
             bool isPointConnected(const int start, const int end) const;
 
-            // the input parameters are pathgrid point indexes
-            // the output list is in local (internal cells) or world (external
-            // cells) coordinates
-            //
-            // NOTE: if start equals end an empty path is returned
-            std::list<ESM::Pathgrid::Point> aStarSearch(const int start,
-                                                        const int end) const;
+            /// Find a path between two pathgrid points, both of them included.
+            /// If start equals end the path only contains that point.
+            /// \param path Receives the pathgrid point indexes along the path. Cleared first.
+            /// \return Was a path found?
+            /// \note Reuses buffers owned by the graph and caches recent results, so this is not thread safe.
+            bool aStarSearch(const int start, const int end, std::vector<int>& path) const;
+
         private:
 
-            const ESM::Cell *mCell;
             const ESM::Pathgrid *mPathgrid;
-            bool mIsExterior;
 
             struct ConnectedPoint // edge
             {
@@ -74,6 +71,28 @@ namespace MWMechanics
             // methods used to calculate connected components
             void recursiveStrongConnect(int v);
             void buildConnectedPoints();
+
+            bool search(const int start, const int goal, std::vector<int>& path) const;
+
+            // indexed binary heap of open pathgrid points, ordered by mFScore
+            void heapPush(int point) const;
+            int heapPop() const;
+            void heapSiftUp(std::size_t pos) const;
+            void heapSiftDown(std::size_t pos) const;
+
+            // scratch buffers for search(), indexed by pathgrid point
+            mutable std::vector<float> mGScore;
+            mutable std::vector<float> mFScore;
+            mutable std::vector<int> mParent;
+            mutable std::vector<int> mHeapPos; // position in mHeap, or -1 if not in the open set
+            mutable std::vector<bool> mClosed;
+            mutable std::vector<int> mHeap;
+
+            // recently found paths, by (start, goal), least recently used first
+            typedef std::pair<int, int> PathKey;
+            typedef std::list<std::pair<PathKey, std::vector<int> > > PathCache;
+            mutable PathCache mPathCache;
+            mutable std::map<PathKey, PathCache::iterator> mPathCacheIndex;
     };
 }
 
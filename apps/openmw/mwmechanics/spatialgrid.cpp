@@ -0,0 +1,103 @@
+#include "spatialgrid.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+namespace MWMechanics
+{
+    bool SpatialGrid::Entry::operator< (const Entry& other) const
+    {
+        if (mRow != other.mRow)
+            return mRow < other.mRow;
+        if (mColumn != other.mColumn)
+            return mColumn < other.mColumn;
+        return mIndex < other.mIndex;
+    }
+
+    SpatialGrid::SpatialGrid(float cellSize)
+        : mCellSize(cellSize)
+        , mMinRow(0)
+        , mMaxRow(-1)
+        , mMinColumn(0)
+        , mMaxColumn(-1)
+    {
+    }
+
+    void SpatialGrid::clear()
+    {
+        mEntries.clear();
+        mEntriesByIndex.clear();
+        mMinRow = mMinColumn = 0;
+        mMaxRow = mMaxColumn = -1;
+    }
+
+    void SpatialGrid::add(std::size_t index, const osg::Vec3f& position)
+    {
+        Entry entry;
+        entry.mRow = toCell(position.y());
+        entry.mColumn = toCell(position.x());
+        entry.mIndex = index;
+        entry.mPosition = position;
+        mEntries.push_back(entry);
+    }
+
+    void SpatialGrid::build()
+    {
+        mEntriesByIndex = mEntries;
+        std::sort(mEntriesByIndex.begin(), mEntriesByIndex.end(), IndexLess());
+        std::sort(mEntries.begin(), mEntries.end());
+
+        if (mEntries.empty())
+            return;
+        mMinRow = mEntries.front().mRow;
+        mMaxRow = mEntries.back().mRow;
+        mMinColumn = mMaxColumn = mEntries.front().mColumn;
+        for (std::vector<Entry>::const_iterator it = mEntries.begin(); it != mEntries.end(); ++it)
+        {
+            mMinColumn = std::min(mMinColumn, it->mColumn);
+            mMaxColumn = std::max(mMaxColumn, it->mColumn);
+        }
+    }
+
+    void SpatialGrid::query(const osg::Vec3f& position, float radius, std::vector<std::size_t>& out) const
+    {
+        const float sqrRadius = radius * radius;
+        const int minColumn = std::max(toCell(position.x() - radius), mMinColumn);
+        const int maxColumn = std::min(toCell(position.x() + radius), mMaxColumn);
+        const int minRow = std::max(toCell(position.y() - radius), mMinRow);
+        const int maxRow = std::min(toCell(position.y() + radius), mMaxRow);
+
+        if (minColumn == mMinColumn && maxColumn == mMaxColumn && minRow == mMinRow && maxRow == mMaxRow)
+        {
+            // Every point is a candidate, so there is nothing to gain from the grid
+            for (std::vector<Entry>::const_iterator it = mEntriesByIndex.begin(); it != mEntriesByIndex.end(); ++it)
+            {
+                if ((it->mPosition - position).length2() <= sqrRadius)
+                    out.push_back(it->mIndex);
+            }
+            return;
+        }
+
+        const std::size_t first = out.size();
+        Entry key;
+        key.mColumn = minColumn;
+        key.mIndex = 0;
+        for (int row = minRow; row <= maxRow; ++row)
+        {
+            key.mRow = row;
+            std::vector<Entry>::const_iterator it = std::lower_bound(mEntries.begin(), mEntries.end(), key);
+            for (; it != mEntries.end() && it->mRow == row && it->mColumn <= maxColumn; ++it)
+            {
+                if ((it->mPosition - position).length2() <= sqrRadius)
+                    out.push_back(it->mIndex);
+            }
+        }
+
+        std::sort(out.begin() + first, out.end());
+    }
+
+    int SpatialGrid::toCell(float coordinate) const
+    {
+        return static_cast<int>(std::floor(coordinate / mCellSize));
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef GAME_MWMECHANICS_SPATIALGRID_H
+#define GAME_MWMECHANICS_SPATIALGRID_H
+
+#include <cstddef>
+#include <vector>
+
+#include <osg/Vec3f>
+
+namespace MWMechanics
+{
+    /// \brief Uniform grid over the XY plane for radius queries on a set of points.
+    ///
+    /// Points are identified by the index they were added with. The grid is meant to be
+    /// rebuilt from scratch whenever the points move: add() them all, then call build().
+    /// Entries are kept sorted by (row, column), so a query does one binary search per row it covers.
+    /// Queries that cover all occupied cells just scan the points in index order instead.
+    class SpatialGrid
+    {
+        public:
+            SpatialGrid(float cellSize);
+
+            void clear();
+
+            /// Add a point. Indices should be unique; queries return them in ascending order.
+            void add(std::size_t index, const osg::Vec3f& position);
+
+            /// Sort the points added since the last clear(). Must be called before querying.
+            void build();
+
+            /// Append the indices of all points within \a radius of \a position (in 3D) to \a out, in ascending order.
+            void query(const osg::Vec3f& position, float radius, std::vector<std::size_t>& out) const;
+
+            std::size_t size() const { return mEntries.size(); }
+            bool empty() const { return mEntries.empty(); }
+
+        private:
+            struct Entry
+            {
+                int mRow;
+                int mColumn;
+                std::size_t mIndex;
+                osg::Vec3f mPosition;
+
+                bool operator< (const Entry& other) const;
+            };
+
+            struct IndexLess
+            {
+                bool operator() (const Entry& left, const Entry& right) const { return left.mIndex < right.mIndex; }
+            };
+
+            int toCell(float coordinate) const;
+
+            float mCellSize;
+            /// Sorted by (row, column, index)
+            std::vector<Entry> mEntries;
+            /// The same entries, sorted by index
+            std::vector<Entry> mEntriesByIndex;
+
+            /// Bounds of the occupied cells
+            int mMinRow;
+            int mMaxRow;
+            int mMinColumn;
+            int mMaxColumn;
+    };
+}
+
+#endif
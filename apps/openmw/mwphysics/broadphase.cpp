@@ -0,0 +1,51 @@
+#include "broadphase.hpp"
+
+#include <LinearMath/btScalar.h>
+
+namespace MWPhysics
+{
+
+    namespace
+    {
+        struct RayTester : public btDbvt::ICollide
+        {
+            RayTester(btBroadphaseRayCallback& callback)
+                : mCallback(callback)
+            {
+            }
+
+            virtual void Process(const btDbvtNode* leaf)
+            {
+                mCallback.process(static_cast<btBroadphaseProxy*>(leaf->data));
+            }
+
+            btBroadphaseRayCallback& mCallback;
+        };
+    }
+
+    void ThreadSafeBroadphase::rayTest(const btVector3& rayFrom, const btVector3& rayTo, btBroadphaseRayCallback& rayCallback,
+                                       const btVector3& aabbMin, const btVector3& aabbMax)
+    {
+        // Collect everything in the box swept by the (expanded) ray. That is a superset of what the ray itself touches,
+        // but the callback tests each candidate exactly anyway. collideTV() keeps its traversal stack on the caller's stack.
+        btVector3 sweptMin = rayFrom;
+        sweptMin.setMin(rayTo);
+        btVector3 sweptMax = rayFrom;
+        sweptMax.setMax(rayTo);
+        const btDbvtVolume bounds = btDbvtVolume::FromMM(sweptMin + aabbMin, sweptMax + aabbMax);
+
+        RayTester tester(rayCallback);
+        m_sets[0].collideTV(m_sets[0].m_root, bounds, tester);
+        m_sets[1].collideTV(m_sets[1].m_root, bounds, tester);
+    }
+
+    bool isBulletThreadSafe()
+    {
+#if BT_BULLET_VERSION >= 287
+        return true;
+#else
+        return false;
+#endif
+    }
+
+}
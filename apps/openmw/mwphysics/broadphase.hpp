@@ -0,0 +1,26 @@
+#ifndef OPENMW_MWPHYSICS_BROADPHASE_H
+#define OPENMW_MWPHYSICS_BROADPHASE_H
+
+#include <BulletCollision/BroadphaseCollision/btDbvtBroadphase.h>
+
+namespace MWPhysics
+{
+
+    /// @brief A btDbvtBroadphase that can be queried by several threads at once.
+    /// @par btDbvtBroadphase::rayTest, which is also used for convex sweeps, shares one traversal stack between all callers.
+    /// This version collects the candidates with a stack of its own instead, so that ray casts and convex sweeps may run
+    /// in parallel as long as no thread adds, removes or moves collision objects at the same time.
+    class ThreadSafeBroadphase : public btDbvtBroadphase
+    {
+    public:
+        virtual void rayTest(const btVector3& rayFrom, const btVector3& rayTo, btBroadphaseRayCallback& rayCallback,
+                             const btVector3& aabbMin = btVector3(0,0,0), const btVector3& aabbMax = btVector3(0,0,0));
+    };
+
+    /// Whether the Bullet library we are built against can run collision queries on more than one thread.
+    /// Older versions record profiling samples of each query in a global, unprotected tree.
+    bool isBulletThreadSafe();
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+#ifndef OPENMW_MWPHYSICS_MOVEMENTSOLVERBATCH_H
+#define OPENMW_MWPHYSICS_MOVEMENTSOLVERBATCH_H
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <components/sceneutil/profiler.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+namespace MWPhysics
+{
+
+    /// @brief Solves one physics step for a range of actors.
+    /// @par The Solver must provide:
+    /// - a Result type, for what a batch collects besides the actor positions, e.g. standing collisions;
+    /// - void solve(std::size_t actor, Result& result), which only writes the state of that actor and \a result, and does
+    ///   not move any collision objects, so that several batches can run at the same time;
+    /// - void merge(const Result& result), called on the main thread for each batch after the step;
+    /// - void commit(), called on the main thread after the step, to move the actors to their solved positions.
+    template <class Solver>
+    class MovementSolverBatch : public SceneUtil::WorkItem
+    {
+    public:
+        MovementSolverBatch(Solver& solver, std::size_t begin, std::size_t end)
+            : mSolver(solver)
+            , mBegin(begin)
+            , mEnd(end)
+        {
+        }
+
+        virtual const char* getName() const { return "Physics actor batch"; }
+
+        virtual void doWork()
+        {
+            OPENMW_PROFILE_ZONE("Physics: solve actor batch");
+            try
+            {
+                for (std::size_t i = mBegin; i < mEnd; ++i)
+                    mSolver.solve(i, mResult);
+            }
+            catch (const std::exception& e)
+            {
+                mError = std::string("Failed to solve actor movement: ") + e.what();
+            }
+        }
+
+        typename Solver::Result mResult;
+        /// Set if solving failed, to be reported on the main thread
+        std::string mError;
+
+    private:
+        Solver& mSolver;
+        std::size_t mBegin;
+        std::size_t mEnd;
+    };
+
+    /// Solve \a numSteps physics steps for \a numActors actors. Each step is solved for all actors, then committed, so that
+    /// the actors see each other moved in the next step. The actors of a step are split into batches that run on \a queue
+    /// and on the calling thread, or all run on the calling thread if \a queue is NULL; either way the result is the same.
+    /// @throw std::runtime_error if solving an actor failed
+    template <class Solver>
+    void solveMovement(Solver& solver, std::size_t numActors, int numSteps, SceneUtil::WorkQueue* queue)
+    {
+        if (numActors == 0)
+            return;
+
+        const std::size_t numBatches = queue ? std::min(numActors, static_cast<std::size_t>(queue->getNumThreads() + 1)) : 1;
+        for (int step=0; step<numSteps; ++step)
+        {
+            std::vector<osg::ref_ptr<MovementSolverBatch<Solver> > > batches;
+            for (std::size_t batch=0; batch<numBatches; ++batch)
+                batches.push_back(new MovementSolverBatch<Solver>(solver, numActors * batch / numBatches,
+                                                                  numActors * (batch+1) / numBatches));
+
+            // the calling thread takes the last batch
+            for (std::size_t batch=0; batch+1<numBatches; ++batch)
+                queue->addWorkItem(batches[batch]);
+            batches.back()->doWork();
+            for (std::size_t batch=0; batch+1<numBatches; ++batch)
+                batches[batch]->waitTillDone();
+
+            for (std::size_t batch=0; batch<numBatches; ++batch)
+            {
+                if (!batches[batch]->mError.empty())
+                    throw std::runtime_error(batches[batch]->mError);
+                solver.merge(batches[batch]->mResult);
+            }
+
+            solver.commit();
+        }
+    }
+
+}
+
+#endif
@@ -23,8 +23,11 @@
 #include <components/resource/bulletshapemanager.hpp>
 
 #include <components/esm/loadgmst.hpp>
+#include <components/sceneutil/profiler.hpp>
 #include <components/sceneutil/positionattitudetransform.hpp>
 #include <components/sceneutil/unrefqueue.hpp>
+#include <components/sceneutil/workqueue.hpp>
+#include <components/settings/settings.hpp>
 
 #include <components/nifosg/particle.hpp> // FindRecIndexVisitor
 
@@ -47,7 +50,9 @@
 
 #include "collisiontype.hpp"
 #include "actor.hpp"
+#include "broadphase.hpp"
 #include "convert.hpp"
+#include "movementsolverbatch.hpp"
 #include "trace.h"
 
 namespace MWPhysics
@@ -503,6 +508,72 @@ namespace MWPhysics
         }
     };
 
+    /// Movement of one actor during a call to applyQueuedMovement
+    struct ActorFrameData
+    {
+        MWWorld::Ptr mPtr;
+        Actor* mActor;
+        osg::Vec3f mMovement;
+        float mWaterlevel;
+        float mSlowFall;
+        bool mFlying;
+        bool mWasOnGround;
+        float mOldHeight;
+        /// Solved position after the current step
+        osg::Vec3f mPosition;
+        bool mPositionChanged;
+    };
+
+    /// Solves the movement of the actors of a call to applyQueuedMovement, see solveMovement
+    class ActorMovementSolver
+    {
+    public:
+        typedef std::map<MWWorld::Ptr, MWWorld::Ptr> Result;
+
+        ActorMovementSolver(std::vector<ActorFrameData>& actors, float time, btCollisionWorld* collisionWorld,
+                            std::map<MWWorld::Ptr, MWWorld::Ptr>& standingCollisions)
+            : mActors(actors)
+            , mTime(time)
+            , mCollisionWorld(collisionWorld)
+            , mStandingCollisions(standingCollisions)
+        {
+        }
+
+        void solve(std::size_t actor, Result& standingCollisions)
+        {
+            ActorFrameData& data = mActors[actor];
+            data.mPosition = MovementSolver::move(data.mPosition, data.mActor->getPtr(), data.mActor, data.mMovement, mTime,
+                                                  data.mFlying, data.mWaterlevel, data.mSlowFall, mCollisionWorld, standingCollisions);
+        }
+
+        void merge(const Result& standingCollisions)
+        {
+            for (Result::const_iterator it = standingCollisions.begin(); it != standingCollisions.end(); ++it)
+                mStandingCollisions[it->first] = it->second;
+        }
+
+        void commit()
+        {
+            for (std::vector<ActorFrameData>::iterator it = mActors.begin(); it != mActors.end(); ++it)
+            {
+                if (it->mPosition != it->mActor->getPosition())
+                {
+                    it->mPositionChanged = true;
+                    it->mActor->setPosition(it->mPosition);
+                    mCollisionWorld->updateSingleAabb(it->mActor->getCollisionObject());
+                }
+                else
+                    it->mActor->setPosition(it->mPosition); // always set even if unchanged to make sure interpolation is correct
+            }
+        }
+
+    private:
+        std::vector<ActorFrameData>& mActors;
+        float mTime;
+        btCollisionWorld* mCollisionWorld;
+        std::map<MWWorld::Ptr, MWWorld::Ptr>& mStandingCollisions;
+    };
+
 
     // ---------------------------------------------------------------
 
@@ -689,7 +760,25 @@ namespace MWPhysics
 
         mCollisionConfiguration = new btDefaultCollisionConfiguration();
         mDispatcher = new btCollisionDispatcher(mCollisionConfiguration);
-        mBroadphase = new btDbvtBroadphase();
+
+        int solverThreads = Settings::Manager::getInt("solver num threads", "Physics");
+        if (solverThreads <= 0)
+            solverThreads = SceneUtil::WorkQueue::getDefaultNumThreads() + 1;
+        if (solverThreads > 1 && !isBulletThreadSafe())
+        {
+            std::cerr << "Warning: this version of Bullet does not support collision queries from several threads, "
+                      << "actor movement will be solved on the main thread." << std::endl;
+            solverThreads = 1;
+        }
+
+        if (solverThreads > 1)
+        {
+            mBroadphase = new ThreadSafeBroadphase();
+            // the main thread solves a batch of its own
+            mSolverQueue = new SceneUtil::WorkQueue(solverThreads - 1);
+        }
+        else
+            mBroadphase = new btDbvtBroadphase();
 
         mCollisionWorld = new btCollisionWorld(mDispatcher, mBroadphase, mCollisionConfiguration);
 
@@ -1367,6 +1456,8 @@ namespace MWPhysics
 
     const PtrVelocityList& PhysicsSystem::applyQueuedMovement(float dt)
     {
+        OPENMW_PROFILE_ZONE("Physics: actor movement");
+
         mMovementResults.clear();
 
         mTimeAccum += dt;
@@ -1384,6 +1475,8 @@ namespace MWPhysics
         }
 
         const MWBase::World *world = MWBase::Environment::get().getWorld();
+        std::vector<ActorFrameData> actors;
+        actors.reserve(mMovementQueue.size());
         PtrVelocityList::iterator iter = mMovementQueue.begin();
         for(;iter != mMovementQueue.end();++iter)
         {
@@ -1413,38 +1506,40 @@ namespace MWPhysics
             }
             physicActor->setCanWaterWalk(waterCollision);
 
+            ActorFrameData data;
+            data.mPtr = iter->first;
+            data.mActor = physicActor;
+            data.mMovement = iter->second;
+            data.mWaterlevel = waterlevel;
             // Slow fall reduces fall speed by a factor of (effect magnitude / 200)
-            float slowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
-
-            bool flying = world->isFlying(iter->first);
+            data.mSlowFall = 1.f - std::max(0.f, std::min(1.f, effects.get(ESM::MagicEffect::SlowFall).getMagnitude() * 0.005f));
+            data.mFlying = world->isFlying(iter->first);
+            data.mWasOnGround = physicActor->getOnGround();
+            data.mPosition = physicActor->getPosition();
+            data.mOldHeight = data.mPosition.z();
+            data.mPositionChanged = false;
+            actors.push_back(data);
+        }
 
-            bool wasOnGround = physicActor->getOnGround();
-            osg::Vec3f position = physicActor->getPosition();
-            float oldHeight = position.z();
-            bool positionChanged = false;
-            for (int i=0; i<numSteps; ++i)
-            {
-                position = MovementSolver::move(position, physicActor->getPtr(), physicActor, iter->second, mPhysicsDt,
-                                                flying, waterlevel, slowFall, mCollisionWorld, mStandingCollisions);
-                if (position != physicActor->getPosition())
-                    positionChanged = true;
-                physicActor->setPosition(position); // always set even if unchanged to make sure interpolation is correct
-            }
-            if (positionChanged)
-                mCollisionWorld->updateSingleAabb(physicActor->getCollisionObject());
+        ActorMovementSolver solver(actors, mPhysicsDt, mCollisionWorld, mStandingCollisions);
+        solveMovement(solver, actors.size(), numSteps, mSolverQueue.get());
 
+        // Commit the results in queue order
+        for (std::vector<ActorFrameData>::const_iterator it = actors.begin(); it != actors.end(); ++it)
+        {
+            const Actor* physicActor = it->mActor;
             float interpolationFactor = mTimeAccum / mPhysicsDt;
-            osg::Vec3f interpolated = position * interpolationFactor + physicActor->getPreviousPosition() * (1.f - interpolationFactor);
+            osg::Vec3f interpolated = it->mPosition * interpolationFactor + physicActor->getPreviousPosition() * (1.f - interpolationFactor);
 
-            float heightDiff = position.z() - oldHeight;
+            float heightDiff = it->mPosition.z() - it->mOldHeight;
 
-            MWMechanics::CreatureStats& stats = iter->first.getClass().getCreatureStats(iter->first);
-            if ((wasOnGround && physicActor->getOnGround()) || flying || world->isSwimming(iter->first) || slowFall < 1)
+            MWMechanics::CreatureStats& stats = it->mPtr.getClass().getCreatureStats(it->mPtr);
+            if ((it->mWasOnGround && physicActor->getOnGround()) || it->mFlying || world->isSwimming(it->mPtr) || it->mSlowFall < 1)
                 stats.land();
             else if (heightDiff < 0)
                 stats.addToFallHeight(-heightDiff);
 
-            mMovementResults.push_back(std::make_pair(iter->first, interpolated));
+            mMovementResults.push_back(std::make_pair(it->mPtr, interpolated));
         }
 
         mMovementQueue.clear();
@@ -32,6 +32,7 @@ namespace Resource
 namespace SceneUtil
 {
     class UnrefQueue;
+    class WorkQueue;
 }
 
 class btCollisionWorld;
@@ -142,6 +143,8 @@ namespace MWPhysics
             void queueObjectMovement(const MWWorld::Ptr &ptr, const osg::Vec3f &velocity);
 
             /// Apply all queued movements, then clear the list.
+            /// @note With more than one "solver num threads", the actors of each physics step are solved in parallel batches,
+            /// against the positions that all actors had after the previous step. The results are committed in queue order.
             const PtrVelocityList& applyQueuedMovement(float dt);
 
             /// Clear the queued movements list without applying.
@@ -222,6 +225,9 @@ namespace MWPhysics
 
             float mPhysicsDt;
 
+            /// Worker threads for solving actor movement in parallel, NULL if movement is solved on the main thread only
+            osg::ref_ptr<SceneUtil::WorkQueue> mSolverQueue;
+
             PhysicsSystem (const PhysicsSystem&);
             PhysicsSystem& operator= (const PhysicsSystem&);
     };
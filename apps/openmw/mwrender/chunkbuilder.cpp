@@ -0,0 +1,133 @@
+#include "chunkbuilder.hpp"
+
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+#include <osg/PositionAttitudeTransform>
+
+#include <osgParticle/ParticleProcessor>
+#include <osgParticle/ParticleSystemUpdater>
+
+#include <components/sceneutil/lightmanager.hpp>
+#include <components/sceneutil/optimizer.hpp>
+
+namespace
+{
+
+    /// Copies the parts of an object that can be merged, i.e. plain geometry, with all callbacks removed.
+    /// Nodes, drawables and their arrays are copied, as the optimizer changes them in place. State is shared.
+    class StaticCopyOp : public osg::CopyOp
+    {
+    public:
+        StaticCopyOp()
+            : osg::CopyOp(osg::CopyOp::DEEP_COPY_NODES | osg::CopyOp::DEEP_COPY_DRAWABLES
+                          | osg::CopyOp::DEEP_COPY_ARRAYS | osg::CopyOp::DEEP_COPY_PRIMITIVES)
+        {
+        }
+
+        virtual osg::Node* operator() (const osg::Node* node) const
+        {
+            if (!node)
+                return NULL;
+            if (const osg::Drawable* drawable = node->asDrawable())
+                return operator()(drawable);
+
+            // Hidden nodes (e.g. collision shapes), particle emitters and programs, lights
+            if (node->getNodeMask() == 0 || dynamic_cast<const osgParticle::ParticleProcessor*>(node)
+                    || dynamic_cast<const osgParticle::ParticleSystemUpdater*>(node)
+                    || dynamic_cast<const SceneUtil::LightSource*>(node))
+                return NULL;
+
+            osg::Node* cloned = osg::clone(node, *this);
+            makeStatic(*cloned);
+            return cloned;
+        }
+
+        virtual osg::Drawable* operator() (const osg::Drawable* drawable) const
+        {
+            // Particle systems, rigged and morphed geometry can not be transformed or merged
+            if (!drawable || drawable->getNodeMask() == 0 || drawable->className() != std::string("Geometry"))
+                return NULL;
+
+            osg::Drawable* cloned = osg::clone(drawable, *this);
+            makeStatic(*cloned);
+            return cloned;
+        }
+
+    private:
+        static void makeStatic(osg::Node& node)
+        {
+            node.setUpdateCallback(NULL);
+            node.setEventCallback(NULL);
+            node.setCullCallback(NULL);
+            node.setUserDataContainer(NULL);
+            node.setDataVariance(osg::Object::STATIC);
+        }
+    };
+
+    /// The default permissions rule out nodes with state, which would keep the objects of a chunk from being merged.
+    /// The optimizer's visitors keep nodes with different state apart on their own.
+    class CanOptimizeCallback : public SceneUtil::Optimizer::IsOperationPermissibleForObjectCallback
+    {
+    public:
+        virtual bool isOperationPermissibleForObjectImplementation(const SceneUtil::Optimizer* optimizer, const osg::Node* node, unsigned int option) const
+        {
+            return (option & optimizer->getPermissibleOptimizationsForObject(node)) != 0;
+        }
+    };
+
+}
+
+namespace MWRender
+{
+
+ChunkBuilder::ChunkBuilder(const osg::Vec3f &origin)
+    : mOrigin(origin)
+    , mGroup(new osg::Group)
+{
+}
+
+void ChunkBuilder::add(const Reference &reference)
+{
+    osg::ref_ptr<osg::Node> cloned = StaticCopyOp()(reference.mTemplate.get());
+    if (!cloned)
+        return;
+
+    osg::ref_ptr<osg::MatrixTransform> transform = new osg::MatrixTransform(osg::Matrix::scale(reference.mScale, reference.mScale, reference.mScale)
+                                                                            * osg::Matrix::rotate(reference.mAttitude)
+                                                                            * osg::Matrix::translate(reference.mPosition - mOrigin));
+    transform->setDataVariance(osg::Object::STATIC);
+    transform->addChild(cloned);
+    mGroup->addChild(transform);
+}
+
+unsigned int ChunkBuilder::getNumReferences() const
+{
+    return mGroup->getNumChildren();
+}
+
+osg::ref_ptr<osg::Node> ChunkBuilder::build()
+{
+    if (!mGroup->getNumChildren())
+        return NULL;
+
+    SceneUtil::Optimizer optimizer;
+    optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
+    optimizer.optimize(mGroup, SceneUtil::Optimizer::FLATTEN_STATIC_TRANSFORMS
+                       | SceneUtil::Optimizer::REMOVE_REDUNDANT_NODES
+                       | SceneUtil::Optimizer::MERGE_GEOMETRY);
+
+    osg::ref_ptr<osg::PositionAttitudeTransform> chunk = new osg::PositionAttitudeTransform;
+    chunk->setPosition(mOrigin);
+    chunk->setDataVariance(osg::Object::STATIC);
+    chunk->addChild(mGroup);
+
+    mGroup = new osg::Group;
+    return chunk;
+}
+
+bool ChunkBuilder::isLargeEnough(float radius, float chunkSize, float minSize)
+{
+    return radius * 2.f >= chunkSize * minSize;
+}
+
+}
@@ -0,0 +1,50 @@
+#ifndef OPENMW_MWRENDER_CHUNKBUILDER_H
+#define OPENMW_MWRENDER_CHUNKBUILDER_H
+
+#include <osg/Group>
+#include <osg/Quat>
+#include <osg/Vec3f>
+#include <osg/ref_ptr>
+
+namespace MWRender
+{
+
+    /// @brief Merges the static geometry of many objects into a few drawables, to draw them with few draw calls.
+    /// @par Each object is copied without anything that can not be merged (particles, rigged geometry, lights,
+    /// controllers), and the copies are flattened and merged by the SceneUtil::Optimizer. The templates are not changed.
+    /// @note Not thread safe, use one builder per thread. The templates may be shared between threads.
+    class ChunkBuilder
+    {
+    public:
+        struct Reference
+        {
+            osg::ref_ptr<const osg::Node> mTemplate;
+            osg::Vec3f mPosition;
+            osg::Quat mAttitude;
+            float mScale;
+        };
+
+        /// @param origin Position of the built chunk, to keep vertex positions close to it for precision
+        ChunkBuilder(const osg::Vec3f& origin);
+
+        void add(const Reference& reference);
+
+        /// Number of references added since the last build()
+        unsigned int getNumReferences() const;
+
+        /// Merge the references added since the last build().
+        /// @return A transform at the origin holding the merged geometry, or NULL if there is nothing to draw.
+        osg::ref_ptr<osg::Node> build();
+
+        /// Is an object with bounding sphere @a radius worth drawing in a chunk @a chunkSize units wide?
+        /// @param minSize Minimum size of the object relative to the chunk size
+        static bool isLargeEnough(float radius, float chunkSize, float minSize);
+
+    private:
+        osg::Vec3f mOrigin;
+        osg::ref_ptr<osg::Group> mGroup;
+    };
+
+}
+
+#endif
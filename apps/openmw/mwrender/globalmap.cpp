@@ -105,6 +105,8 @@ namespace MWRender
         {
         }
 
+        virtual const char* getName() const { return "Global map creation"; }
+
         virtual void doWork()
         {
             osg::ref_ptr<osg::Image> image = new osg::Image;
@@ -0,0 +1,589 @@
+#include "objectpaging.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <sstream>
+
+#include <osg/Group>
+#include <osg/Stats>
+
+#include <osgUtil/IncrementalCompileOperation>
+
+#include <components/esm/loadcell.hpp>
+#include <components/esm/loadland.hpp>
+#include <components/esm/loadstat.hpp>
+#include <components/misc/stringops.hpp>
+#include <components/resource/objectcache.hpp>
+#include <components/resource/scenemanager.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+#include "../mwworld/cellstore.hpp"
+#include "../mwworld/esmstore.hpp"
+#include "../mwworld/ptr.hpp"
+
+#include "chunkbuilder.hpp"
+#include "vismask.hpp"
+
+namespace
+{
+
+    /// Marker objects that have a hardcoded function in the game logic, and are hidden from the player
+    bool isHiddenMarker(const std::string& id)
+    {
+        return id == "prisonmarker" || id == "divinemarker" || id == "templemarker" || id == "northmarker";
+    }
+
+    /// Rotation of an object as loaded from the content files, see MWWorld::Scene
+    osg::Quat getAttitude(const ESM::Position& position)
+    {
+        return osg::Quat(position.rot[2], osg::Vec3f(0,0,-1))
+                * osg::Quat(position.rot[1], osg::Vec3f(0,-1,0))
+                * osg::Quat(position.rot[0], osg::Vec3f(-1,0,0));
+    }
+
+    /// Can a paged object have been changed from its state in the content files?
+    bool isPagedObject(const MWWorld::ConstPtr& ptr)
+    {
+        return ptr.getTypeName() == typeid(ESM::Static).name() && ptr.getCellRef().hasContentFile()
+                && ptr.getCell()->getCell()->isExterior();
+    }
+
+    typedef std::pair<int, int> CellIndex;
+
+    /// The cells whose references are read for a chunk, as objects can be placed outside of the bounds of their cell
+    void getChunkCells(float size, const osg::Vec2f& center, int& startX, int& startY, int& endX, int& endY)
+    {
+        startX = static_cast<int>(std::floor(center.x() - size / 2.f)) - 1;
+        startY = static_cast<int>(std::floor(center.y() - size / 2.f)) - 1;
+        endX = static_cast<int>(std::ceil(center.x() + size / 2.f)) + 1;
+        endY = static_cast<int>(std::ceil(center.y() + size / 2.f)) + 1;
+    }
+
+    /// Matches the keys of the chunks that are made from any of the given cells, see ObjectPaging::getChunkKey()
+    struct ChunkOfCells
+    {
+        ChunkOfCells(const std::set<CellIndex>& cells) : mCells(cells) {}
+
+        bool operator() (const std::string& key) const
+        {
+            std::istringstream stream(key);
+            float size = 0.f;
+            float centerX = 0.f;
+            float centerY = 0.f;
+            stream >> size >> centerX >> centerY;
+
+            int startX, startY, endX, endY;
+            getChunkCells(size, osg::Vec2f(centerX, centerY), startX, startY, endX, endY);
+            for (std::set<CellIndex>::const_iterator it = mCells.begin(); it != mCells.end(); ++it)
+            {
+                if (it->first >= startX && it->first < endX && it->second >= startY && it->second < endY)
+                    return true;
+            }
+            return false;
+        }
+
+        const std::set<CellIndex>& mCells;
+    };
+
+    struct CollectChangedObjects
+    {
+        std::vector<ESM::RefNum> mRefNums;
+
+        bool operator() (const MWWorld::ConstPtr& ptr)
+        {
+            if (isPagedObject(ptr) && (ptr.getRefData().hasChanged() || ptr.getCellRef().hasChanged()))
+                mRefNums.push_back(ptr.getCellRef().getRefNum());
+            return true;
+        }
+    };
+
+}
+
+namespace MWRender
+{
+
+class ChunkWorkItem : public SceneUtil::WorkItem
+{
+public:
+    ChunkWorkItem(ObjectPaging* objectPaging, float size, const osg::Vec2f& center, const std::set<ObjectPaging::CellIndex>& activeCells)
+        : mObjectPaging(objectPaging)
+        , mSize(size)
+        , mCenter(center)
+        , mActiveCells(activeCells)
+    {
+    }
+
+    virtual const char* getName() const { return "Object paging chunk"; }
+
+    virtual void doWork()
+    {
+        mChunk = mObjectPaging->createChunk(mSize, mCenter, mActiveCells);
+    }
+
+    /// @note Only valid once the item is done. NULL if the item was cancelled.
+    osg::ref_ptr<osg::Node> getChunk() const
+    {
+        return mChunk;
+    }
+
+private:
+    ObjectPaging* mObjectPaging;
+    float mSize;
+    osg::Vec2f mCenter;
+    std::set<ObjectPaging::CellIndex> mActiveCells;
+    osg::ref_ptr<osg::Node> mChunk;
+};
+
+ObjectPaging::ObjectPaging(Resource::SceneManager *sceneManager, SceneUtil::WorkQueue *workQueue)
+    : ResourceManager(NULL)
+    , mSceneManager(sceneManager)
+    , mWorkQueue(workQueue)
+    , mMinSize(0.01f)
+    , mStore(NULL)
+    , mGeneration(0)
+{
+}
+
+ObjectPaging::~ObjectPaging()
+{
+    std::vector<osg::ref_ptr<SceneUtil::WorkItem> > items;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        for (std::map<std::string, osg::ref_ptr<SceneUtil::WorkItem> >::iterator it = mPendingChunks.begin(); it != mPendingChunks.end(); ++it)
+        {
+            it->second->cancel();
+            items.push_back(it->second);
+        }
+    }
+
+    // items that are being worked on refer to this object
+    for (std::vector<osg::ref_ptr<SceneUtil::WorkItem> >::iterator it = items.begin(); it != items.end(); ++it)
+        (*it)->waitTillDone();
+}
+
+osg::ref_ptr<osg::Node> ObjectPaging::getChunk(float size, const osg::Vec2f &center, bool wait, bool &pending)
+{
+    std::set<CellIndex> activeCells;
+    const std::string key = getChunkKey(size, center, activeCells);
+
+    osg::ref_ptr<osg::Object> obj = mCache->getRefFromObjectCache(key);
+    if (!obj)
+    {
+        osg::ref_ptr<osg::Node> chunk;
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            std::map<std::string, osg::ref_ptr<SceneUtil::WorkItem> >::iterator found = mPendingChunks.find(key);
+            if (found != mPendingChunks.end() && found->second->isDone() && !found->second->isCancelled())
+            {
+                chunk = static_cast<ChunkWorkItem*>(found->second.get())->getChunk();
+                mPendingChunks.erase(found);
+            }
+            // the objects of active cells are only drawn by the chunks
+            else if (!wait && mWorkQueue && activeCells.empty())
+            {
+                if (found == mPendingChunks.end())
+                {
+                    osg::ref_ptr<SceneUtil::WorkItem> item = new ChunkWorkItem(this, size, center, activeCells);
+                    // smaller chunks are closer to the viewer
+                    item->setPriority(-size);
+                    mPendingChunks[key] = item;
+                    mWorkQueue->addWorkItem(item);
+                }
+                pending = true;
+                return NULL;
+            }
+        }
+
+        // Do not wait for a pending item, the calling thread could be the one that is supposed to work on it
+        if (!chunk)
+            chunk = createChunk(size, center, activeCells);
+
+        mCache->addEntryToObjectCache(key, chunk.get());
+        obj = chunk;
+    }
+
+    // an empty group marks a chunk without objects
+    osg::ref_ptr<osg::Group> chunk = static_cast<osg::Group*>(obj.get());
+    if (!chunk->getNumChildren())
+        return NULL;
+    return chunk;
+}
+
+void ObjectPaging::setContent(const MWWorld::ESMStore &store, const std::vector<ESM::ESMReader> &readers)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    mStore = &store;
+
+    mReaders = readers;
+    for (std::vector<ESM::ESMReader>::iterator it = mReaders.begin(); it != mReaders.end(); ++it)
+    {
+        // The encoder is not thread safe. Object IDs are plain ASCII.
+        it->setEncoder(NULL);
+        it->close();
+    }
+
+    // The cells of the content files are not changed after loading, unlike the store's dynamic cells
+    mCells.clear();
+    const MWWorld::Store<ESM::Cell>& cells = store.get<ESM::Cell>();
+    for (MWWorld::Store<ESM::Cell>::iterator it = cells.extBegin(); it != cells.extEnd(); ++it)
+    {
+        if (!it->mContextList.empty())
+            mCells[CellIndex(it->getGridX(), it->getGridY())] = &*it;
+    }
+
+    mCellReferences.clear();
+    mReferenceCells.clear();
+    resetChunks();
+}
+
+bool ObjectPaging::addActiveCell(int x, int y)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    return mActiveCells.insert(CellIndex(x, y)).second;
+}
+
+bool ObjectPaging::removeActiveCell(int x, int y)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    return mActiveCells.erase(CellIndex(x, y)) != 0;
+}
+
+bool ObjectPaging::drawsObject(const MWWorld::ConstPtr &ptr)
+{
+    if (!ptr.isInCell() || !isPagedObject(ptr) || ptr.getRefData().hasChanged() || ptr.getCellRef().hasChanged())
+        return false;
+
+    // chunks only read the references of the cells next to them, see getChunkCells()
+    const ESM::Cell* cell = ptr.getCell()->getCell();
+    const float* position = ptr.getRefData().getPosition().pos;
+    const int x = static_cast<int>(std::floor(position[0] / ESM::Land::REAL_SIZE));
+    const int y = static_cast<int>(std::floor(position[1] / ESM::Land::REAL_SIZE));
+    if (std::abs(x - cell->getGridX()) > 1 || std::abs(y - cell->getGridY()) > 1)
+        return false;
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    return mStore && !mBlacklist.count(ptr.getCellRef().getRefNum());
+}
+
+bool ObjectPaging::blacklistChangedObjects(const MWWorld::CellStore &cell)
+{
+    if (!cell.getCell()->isExterior())
+        return false;
+
+    CollectChangedObjects visitor;
+    cell.forEachConst(visitor);
+    return addToBlacklist(visitor.mRefNums);
+}
+
+bool ObjectPaging::blacklistObject(const MWWorld::ConstPtr &ptr)
+{
+    if (!ptr.isInCell() || !isPagedObject(ptr))
+        return false;
+
+    return addToBlacklist(std::vector<ESM::RefNum>(1, ptr.getCellRef().getRefNum()));
+}
+
+void ObjectPaging::clear()
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    if (mBlacklist.empty())
+        return;
+
+    mBlacklist.clear();
+    resetChunks();
+}
+
+void ObjectPaging::setMinSize(float minSize)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    mMinSize = minSize;
+    resetChunks();
+}
+
+void ObjectPaging::updateCache(double referenceTime)
+{
+    {
+        // Keep chunks that were not asked for again after they were done, so that they can expire
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        for (std::map<std::string, osg::ref_ptr<SceneUtil::WorkItem> >::iterator it = mPendingChunks.begin(); it != mPendingChunks.end();)
+        {
+            if (it->second->isDone())
+            {
+                osg::ref_ptr<osg::Node> chunk = static_cast<ChunkWorkItem*>(it->second.get())->getChunk();
+                if (chunk && !it->second->isCancelled())
+                    mCache->addEntryToObjectCache(it->first, chunk.get());
+                mPendingChunks.erase(it++);
+            }
+            else
+                ++it;
+        }
+    }
+
+    ResourceManager::updateCache(referenceTime);
+}
+
+void ObjectPaging::clearCache()
+{
+    ResourceManager::clearCache();
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    mCellReferences.clear();
+}
+
+void ObjectPaging::reportStats(unsigned int frameNumber, osg::Stats *stats) const
+{
+    reportCacheStats(frameNumber, stats, "Object Chunk");
+}
+
+std::string ObjectPaging::getChunkKey(float size, const osg::Vec2f &center, std::set<CellIndex> &activeCells)
+{
+    int startX, startY, endX, endY;
+    getChunkCells(size, center, startX, startY, endX, endY);
+
+    std::ostringstream stream;
+    stream << size << " " << center.x() << " " << center.y();
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    stream << " " << mGeneration;
+    for (std::map<CellIndex, unsigned int>::const_iterator it = mCellVersions.lower_bound(CellIndex(startX, std::numeric_limits<int>::min()));
+         it != mCellVersions.end() && it->first.first < endX; ++it)
+    {
+        if (it->first.second >= startY && it->first.second < endY)
+            stream << " " << it->first.first << "," << it->first.second << "=" << it->second;
+    }
+
+    stream << " active";
+    for (std::set<CellIndex>::const_iterator it = mActiveCells.begin(); it != mActiveCells.end(); ++it)
+    {
+        if (it->first >= startX && it->first < endX && it->second >= startY && it->second < endY)
+        {
+            activeCells.insert(*it);
+            stream << " " << it->first << "," << it->second;
+        }
+    }
+    return stream.str();
+}
+
+osg::ref_ptr<osg::Node> ObjectPaging::createChunk(float size, const osg::Vec2f &center, const std::set<CellIndex> &activeCells)
+{
+    const float cellSize = ESM::Land::REAL_SIZE;
+    const float chunkSize = size * cellSize;
+    const osg::Vec2f min = (center - osg::Vec2f(size, size) / 2.f) * cellSize;
+    const osg::Vec2f max = (center + osg::Vec2f(size, size) / 2.f) * cellSize;
+
+    int startX, startY, endX, endY;
+    getChunkCells(size, center, startX, startY, endX, endY);
+
+    std::vector<std::pair<std::shared_ptr<const CellReferences>, bool> > cellReferences;
+    std::vector<ESM::ESMReader> readers;
+    for (int x = startX; x < endX; ++x)
+    {
+        for (int y = startY; y < endY; ++y)
+        {
+            const CellIndex cellIndex(x, y);
+            std::shared_ptr<const CellReferences> references = getCellReferences(cellIndex, readers);
+            if (references)
+                cellReferences.push_back(std::make_pair(references, activeCells.count(cellIndex) != 0));
+        }
+    }
+
+    // Copy the blacklist only once the references are read. An object that is blacklisted later is known to be in one
+    // of these cells then, so blacklisting it changes the key of this chunk, see addToBlacklist().
+    std::set<ESM::RefNum> blacklist;
+    float minSize;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        blacklist = mBlacklist;
+        minSize = mMinSize;
+    }
+
+    ChunkBuilder builder(osg::Vec3f(center.x() * cellSize, center.y() * cellSize, 0.f));
+
+    for (std::vector<std::pair<std::shared_ptr<const CellReferences>, bool> >::const_iterator references = cellReferences.begin(); references != cellReferences.end(); ++references)
+    {
+        // the objects of active cells are not drawn otherwise, see drawsObject()
+        const bool active = references->second;
+        for (CellReferences::const_iterator it = references->first->begin(); it != references->first->end(); ++it)
+        {
+            const osg::Vec3f position = it->mPosition.asVec3();
+            if (position.x() < min.x() || position.x() >= max.x() || position.y() < min.y() || position.y() >= max.y())
+                continue;
+            if (blacklist.count(it->mRefNum))
+                continue;
+
+            osg::ref_ptr<const osg::Node> templateNode;
+            try
+            {
+                templateNode = mSceneManager->getTemplate(it->mModel);
+            }
+            catch (std::exception&)
+            {
+                // ignore error (will be shown when the object is loaded proper)
+                continue;
+            }
+
+            if (!active && !ChunkBuilder::isLargeEnough(templateNode->getBound().radius() * it->mScale, chunkSize, minSize))
+                continue;
+
+            ChunkBuilder::Reference reference;
+            reference.mTemplate = templateNode;
+            reference.mPosition = position;
+            reference.mAttitude = getAttitude(it->mPosition);
+            reference.mScale = it->mScale;
+            builder.add(reference);
+        }
+    }
+
+    osg::ref_ptr<osg::Node> chunk = builder.build();
+    if (!chunk)
+        return new osg::Group;
+
+    chunk->setNodeMask(Mask_Static);
+    if (mSceneManager->getIncrementalCompileOperation())
+        mSceneManager->getIncrementalCompileOperation()->add(chunk);
+    return chunk;
+}
+
+std::shared_ptr<const ObjectPaging::CellReferences> ObjectPaging::getCellReferences(const CellIndex &cellIndex, std::vector<ESM::ESMReader> &readers)
+{
+    const ESM::Cell* cell = NULL;
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        std::map<CellIndex, std::shared_ptr<const CellReferences> >::const_iterator found = mCellReferences.find(cellIndex);
+        if (found != mCellReferences.end())
+            return found->second;
+
+        std::map<CellIndex, const ESM::Cell*>::const_iterator foundCell = mCells.find(cellIndex);
+        if (foundCell == mCells.end())
+            return std::shared_ptr<const CellReferences>();
+        cell = foundCell->second;
+
+        if (readers.empty())
+            readers = mReaders;
+    }
+
+    std::shared_ptr<const CellReferences> references = readCellReferences(*cell, readers);
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    mCellReferences[cellIndex] = references;
+    for (CellReferences::const_iterator it = references->begin(); it != references->end(); ++it)
+        mReferenceCells[it->mRefNum] = cellIndex;
+    return references;
+}
+
+std::shared_ptr<const ObjectPaging::CellReferences> ObjectPaging::readCellReferences(const ESM::Cell &cell, std::vector<ESM::ESMReader> &readers)
+{
+    // Same as MWWorld::CellStore::loadRefs(), later content files replace or delete the references of earlier ones
+    std::map<ESM::RefNum, ESM::CellRef> refs;
+    for (std::size_t i = 0; i < cell.mContextList.size(); ++i)
+    {
+        try
+        {
+            const int index = cell.mContextList[i].index;
+            cell.restore(readers[index], i);
+
+            ESM::CellRef ref;
+            ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
+            bool deleted = false;
+            while (ESM::Cell::getNextRef(readers[index], ref, deleted))
+            {
+                // moved to a different cell
+                if (std::find(cell.mMovedRefs.begin(), cell.mMovedRefs.end(), ref.mRefNum) != cell.mMovedRefs.end())
+                    continue;
+
+                if (deleted)
+                    refs.erase(ref.mRefNum);
+                else
+                    refs[ref.mRefNum] = ref;
+            }
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "An error occurred reading references of cell " << cell.getDescription() << " for object paging: " << e.what() << std::endl;
+        }
+    }
+
+    for (ESM::CellRefTracker::const_iterator it = cell.mLeasedRefs.begin(); it != cell.mLeasedRefs.end(); ++it)
+    {
+        if (it->second)
+            refs.erase(it->first.mRefNum);
+        else
+            refs[it->first.mRefNum] = it->first;
+    }
+
+    const MWWorld::Store<ESM::Static>& statics = mStore->get<ESM::Static>();
+
+    std::shared_ptr<CellReferences> references = std::make_shared<CellReferences>();
+    for (std::map<ESM::RefNum, ESM::CellRef>::const_iterator it = refs.begin(); it != refs.end(); ++it)
+    {
+        const std::string id = Misc::StringUtils::lowerCase(it->second.mRefID);
+        if (isHiddenMarker(id))
+            continue;
+
+        const ESM::Static* object = statics.search(id);
+        if (!object || object->mModel.empty())
+            continue;
+
+        Reference reference;
+        reference.mRefNum = it->first;
+        reference.mModel = "meshes\\" + object->mModel;
+        reference.mPosition = it->second.mPos;
+        reference.mScale = it->second.mScale;
+        references->push_back(reference);
+    }
+    return references;
+}
+
+bool ObjectPaging::addToBlacklist(const std::vector<ESM::RefNum> &refNums)
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    std::set<CellIndex> cells;
+    for (std::vector<ESM::RefNum>::const_iterator it = refNums.begin(); it != refNums.end(); ++it)
+    {
+        if (!mBlacklist.insert(*it).second)
+            continue;
+
+        // Objects of cells that were not read yet are not in any chunk, and chunks copy the blacklist after reading
+        std::map<ESM::RefNum, CellIndex>::const_iterator found = mReferenceCells.find(*it);
+        if (found != mReferenceCells.end())
+            cells.insert(found->second);
+    }
+
+    if (cells.empty())
+        return false;
+
+    resetChunks(cells);
+    return true;
+}
+
+void ObjectPaging::resetChunks()
+{
+    ++mGeneration;
+    mCellVersions.clear();
+
+    // The keys of pending chunks are outdated now. Keep the items until they are done, as they refer to this object.
+    for (std::map<std::string, osg::ref_ptr<SceneUtil::WorkItem> >::iterator it = mPendingChunks.begin(); it != mPendingChunks.end(); ++it)
+        it->second->cancel();
+
+    mCache->clear();
+}
+
+void ObjectPaging::resetChunks(const std::set<CellIndex> &cells)
+{
+    for (std::set<CellIndex>::const_iterator it = cells.begin(); it != cells.end(); ++it)
+        ++mCellVersions[*it];
+
+    ChunkOfCells isChunkOfCells(cells);
+    for (std::map<std::string, osg::ref_ptr<SceneUtil::WorkItem> >::iterator it = mPendingChunks.begin(); it != mPendingChunks.end(); ++it)
+    {
+        if (isChunkOfCells(it->first))
+            it->second->cancel();
+    }
+
+    mCache->removeIf(isChunkOfCells);
+}
+
+}
@@ -0,0 +1,156 @@
+#ifndef OPENMW_MWRENDER_OBJECTPAGING_H
+#define OPENMW_MWRENDER_OBJECTPAGING_H
+
+#include <map>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <OpenThreads/Mutex>
+
+#include <components/esm/cellref.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/resource/resourcemanager.hpp>
+#include <components/terrain/quadtreeworld.hpp>
+
+namespace ESM
+{
+    struct Cell;
+}
+
+namespace Resource
+{
+    class SceneManager;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+    class WorkItem;
+}
+
+namespace MWWorld
+{
+    class CellStore;
+    class ConstPtr;
+    class ESMStore;
+}
+
+namespace MWRender
+{
+
+    /// @brief Draws the static objects of exterior cells in merged chunks along with the distant terrain.
+    /// @par References are read from the content files, and the objects of a chunk are merged by a ChunkBuilder in the
+    /// background. Objects that were changed from their state in the content files, e.g. disabled or moved, are left
+    /// out and drawn by MWRender::Objects instead.
+    /// @par The unchanged static objects of active cells are merged as well, with no minimum size, and their nodes in
+    /// MWRender::Objects are hidden, see drawsObject(). Chunks that contain active cells are created right away, as
+    /// these objects would not be drawn at all otherwise.
+    /// @par The key of a chunk includes a version of each cell it is made from, so that blacklisting an object only
+    /// outdates the chunks around its cell.
+    class ObjectPaging : public Resource::ResourceManager, public Terrain::ChunkProvider
+    {
+    public:
+        ObjectPaging(Resource::SceneManager* sceneManager, SceneUtil::WorkQueue* workQueue);
+        ~ObjectPaging();
+
+        osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, bool wait, bool& pending) override;
+
+        /// Set the content to read references from. Chunks are empty until this is called.
+        /// @note Keeps copies of the readers, closed, to open them again for each chunk.
+        void setContent(const MWWorld::ESMStore& store, const std::vector<ESM::ESMReader>& readers);
+
+        /// Merge all static objects of an exterior cell that was loaded, regardless of their size.
+        /// @return Did this change any chunks?
+        bool addActiveCell(int x, int y);
+        bool removeActiveCell(int x, int y);
+
+        /// Is @a ptr drawn in the chunks, so that its own node is not to be drawn?
+        bool drawsObject(const MWWorld::ConstPtr& ptr);
+
+        /// Leave out the objects of @a cell that were changed from their state in the content files.
+        /// @return Did this change any chunks?
+        bool blacklistChangedObjects(const MWWorld::CellStore& cell);
+
+        /// Leave out @a ptr, which was changed from its state in the content files.
+        /// @return Did this change any chunks?
+        bool blacklistObject(const MWWorld::ConstPtr& ptr);
+
+        /// Forget about changed objects, e.g. to load another game.
+        void clear();
+
+        /// @param minSize Minimum size of an object relative to the size of its chunk
+        void setMinSize(float minSize);
+
+        void updateCache(double referenceTime) override;
+
+        void clearCache() override;
+
+        void reportStats(unsigned int frameNumber, osg::Stats* stats) const override;
+
+    private:
+        friend class ChunkWorkItem;
+
+        struct Reference
+        {
+            ESM::RefNum mRefNum;
+            std::string mModel;
+            ESM::Position mPosition;
+            float mScale;
+        };
+        typedef std::vector<Reference> CellReferences;
+
+        typedef std::pair<int, int> CellIndex;
+
+        /// Get the key of a chunk, which includes everything that the contents of the chunk depend on.
+        std::string getChunkKey(float size, const osg::Vec2f& center, std::set<CellIndex>& activeCells);
+
+        osg::ref_ptr<osg::Node> createChunk(float size, const osg::Vec2f& center, const std::set<CellIndex>& activeCells);
+
+        /// @param readers Copies of mReaders for the calling thread, created on first use
+        std::shared_ptr<const CellReferences> getCellReferences(const CellIndex& cellIndex, std::vector<ESM::ESMReader>& readers);
+
+        std::shared_ptr<const CellReferences> readCellReferences(const ESM::Cell& cell, std::vector<ESM::ESMReader>& readers);
+
+        /// @return Did this change any chunks?
+        bool addToBlacklist(const std::vector<ESM::RefNum>& refNums);
+
+        /// Drop all cached and pending chunks, e.g. after the content changed.
+        /// @note mMutex must be locked.
+        void resetChunks();
+
+        /// Drop the cached and pending chunks made from @a cells, after objects of these cells were blacklisted.
+        /// @note mMutex must be locked.
+        void resetChunks(const std::set<CellIndex>& cells);
+
+        Resource::SceneManager* mSceneManager;
+        SceneUtil::WorkQueue* mWorkQueue;
+        float mMinSize;
+
+        /// Protects the members below
+        OpenThreads::Mutex mMutex;
+
+        const MWWorld::ESMStore* mStore;
+        std::vector<ESM::ESMReader> mReaders;
+        /// The exterior cells of the content files
+        std::map<CellIndex, const ESM::Cell*> mCells;
+        std::map<CellIndex, std::shared_ptr<const CellReferences> > mCellReferences;
+        /// The cell each reference was read from, to find the chunks a blacklisted object may be drawn in.
+        /// Kept when mCellReferences is cleared, for chunks that are still being created from them.
+        std::map<ESM::RefNum, CellIndex> mReferenceCells;
+
+        std::set<CellIndex> mActiveCells;
+        std::set<ESM::RefNum> mBlacklist;
+        /// Changed when objects of the cell are blacklisted, so that chunks made with an outdated blacklist are not used
+        std::map<CellIndex, unsigned int> mCellVersions;
+        /// Changed when all chunks are outdated
+        unsigned int mGeneration;
+
+        /// Chunks that are being created in the background, by key
+        std::map<std::string, osg::ref_ptr<SceneUtil::WorkItem> > mPendingChunks;
+    };
+
+}
+
+#endif
@@ -3,6 +3,10 @@
 #include <stdexcept>
 #include <limits>
 #include <cstdlib>
+#include <cmath>
+#include <iostream>
+
+#include <OpenThreads/ScopedLock>
 
 #include <osg/Light>
 #include <osg/LightModel>
@@ -12,6 +16,7 @@
 #include <osg/Group>
 #include <osg/UserDataContainer>
 #include <osg/ComputeBoundsVisitor>
+#include <osg/Timer>
 
 #include <osgUtil/LineSegmentIntersector>
 #include <osgUtil/IncrementalCompileOperation>
@@ -49,6 +54,7 @@
 #include "camera.hpp"
 #include "water.hpp"
 #include "terrainstorage.hpp"
+#include "objectpaging.hpp"
 #include "util.hpp"
 
 namespace MWRender
@@ -141,6 +147,8 @@ namespace MWRender
         {
         }
 
+        virtual const char* getName() const { return "Common asset preload"; }
+
         virtual void doWork()
         {
             try
@@ -219,7 +227,18 @@ namespace MWRender
                                              Settings::Manager::getBool("auto use terrain specular maps", "Shaders"));
 
         if (distantTerrain)
-            mTerrain.reset(new Terrain::QuadTreeWorld(sceneRoot, mRootNode, mResourceSystem, mTerrainStorage, Mask_Terrain, Mask_PreCompile));
+        {
+            Terrain::QuadTreeWorld* quadTreeWorld = new Terrain::QuadTreeWorld(sceneRoot, mRootNode, mResourceSystem, mTerrainStorage, Mask_Terrain, Mask_PreCompile);
+            mTerrain.reset(quadTreeWorld);
+
+            if (Settings::Manager::getBool("object paging", "Terrain"))
+            {
+                mObjectPaging.reset(new ObjectPaging(mResourceSystem->getSceneManager(), mWorkQueue.get()));
+                mObjectPaging->setMinSize(Settings::Manager::getFloat("object paging min size", "Terrain"));
+                quadTreeWorld->addChunkProvider(mObjectPaging.get());
+                mResourceSystem->addResourceManager(mObjectPaging.get());
+            }
+        }
         else
             mTerrain.reset(new Terrain::TerrainGrid(sceneRoot, mRootNode, mResourceSystem, mTerrainStorage, Mask_Terrain, Mask_PreCompile));
         mTerrain->setDefaultViewer(mViewer->getCamera());
@@ -294,6 +313,13 @@ namespace MWRender
 
     RenderingManager::~RenderingManager()
     {
+        if (mObjectPaging)
+        {
+            mResourceSystem->removeResourceManager(mObjectPaging.get());
+            // waits for the chunks that are being created in the background
+            mObjectPaging.reset();
+        }
+
         // let background loading thread finish before we delete anything else
         mWorkQueue = NULL;
     }
@@ -419,7 +445,12 @@ namespace MWRender
         mWater->changeCell(store);
 
         if (store->getCell()->isExterior())
+        {
             mTerrain->loadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
+
+            if (mObjectPaging && mObjectPaging->addActiveCell(store->getCell()->getGridX(), store->getCell()->getGridY()))
+                resetObjectPaging();
+        }
     }
     void RenderingManager::removeCell(const MWWorld::CellStore *store)
     {
@@ -427,11 +458,59 @@ namespace MWRender
         mObjects->removeCell(store);
 
         if (store->getCell()->isExterior())
+        {
             mTerrain->unloadCell(store->getCell()->getGridX(), store->getCell()->getGridY());
 
+            if (mObjectPaging)
+            {
+                // objects that were changed while the cell was active are not drawn from the content files again
+                mObjectPaging->blacklistChangedObjects(*store);
+                mObjectPaging->removeActiveCell(store->getCell()->getGridX(), store->getCell()->getGridY());
+                resetObjectPaging();
+            }
+        }
+
         mWater->removeCell(store);
     }
 
+    void RenderingManager::setObjectPagingContent(const MWWorld::ESMStore& store, const std::vector<ESM::ESMReader>& readers)
+    {
+        if (mObjectPaging)
+            mObjectPaging->setContent(store, readers);
+    }
+
+    void RenderingManager::pagingBlacklistChangedObjects(const MWWorld::CellStore& store)
+    {
+        if (mObjectPaging && mObjectPaging->blacklistChangedObjects(store))
+            resetObjectPaging();
+    }
+
+    void RenderingManager::pagingBlacklistObject(const MWWorld::Ptr& ptr)
+    {
+        if (!mObjectPaging)
+            return;
+
+        if (mObjectPaging->blacklistObject(ptr))
+            resetObjectPaging();
+
+        // show the node that was hidden by pagingHideObject(), even if no chunk had the object yet
+        if (ptr.getRefData().getBaseNode() && !ptr.getRefData().getBaseNode()->getNodeMask())
+            ptr.getRefData().getBaseNode()->setNodeMask(~0u);
+    }
+
+    void RenderingManager::pagingHideObject(const MWWorld::Ptr& ptr)
+    {
+        // the node is still needed to place the object, e.g. by the physics
+        if (mObjectPaging && ptr.getRefData().getBaseNode() && mObjectPaging->drawsObject(ptr))
+            ptr.getRefData().getBaseNode()->setNodeMask(0);
+    }
+
+    void RenderingManager::resetObjectPaging()
+    {
+        // object paging is only enabled with distant terrain
+        static_cast<Terrain::QuadTreeWorld*>(mTerrain.get())->resetProviderChunks();
+    }
+
     void RenderingManager::enableTerrain(bool enable)
     {
         mTerrain->enable(enable);
@@ -606,13 +685,19 @@ namespace MWRender
             mCondition.signal();
         }
 
-        void waitTillDone()
+        /// @return Was the draw completed within the given time?
+        bool waitTillDone(double timeoutMilliseconds)
         {
-            mMutex.lock();
-            if (mDone)
-                return;
-            mCondition.wait(&mMutex);
-            mMutex.unlock();
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            const osg::Timer_t start = osg::Timer::instance()->tick();
+            while (!mDone)
+            {
+                const double remaining = timeoutMilliseconds - osg::Timer::instance()->delta_m(start, osg::Timer::instance()->tick());
+                if (remaining <= 0)
+                    return false;
+                mCondition.wait(&mMutex, static_cast<unsigned long>(std::ceil(remaining)));
+            }
+            return true;
         }
 
         mutable OpenThreads::Condition mCondition;
@@ -620,8 +705,12 @@ namespace MWRender
         mutable bool mDone;
     };
 
-    void RenderingManager::screenshot(osg::Image *image, int w, int h)
+    bool RenderingManager::screenshot(osg::Image *image, int w, int h)
     {
+        // Without a window, e.g. while it is being recreated, no frame would be drawn to take the screenshot from
+        if (!mViewer->isRealized())
+            return false;
+
         osg::ref_ptr<osg::Camera> rttCamera (new osg::Camera);
         rttCamera->setNodeMask(Mask_RenderToTexture);
         rttCamera->attach(osg::Camera::COLOR_BUFFER, image);
@@ -660,13 +749,18 @@ namespace MWRender
         mViewer->updateTraversal();
         mViewer->renderingTraversals();
 
-        callback->waitTillDone();
+        // Do not hang if the frame is never drawn, e.g. because the graphics context was lost
+        const bool done = callback->waitTillDone(1000.0);
+        if (!done)
+            std::cerr << "Warning: screenshot timed out, the frame was not drawn" << std::endl;
 
         // now that we've "used up" the current frame, get a fresh framenumber for the next frame() following after the screenshot is completed
         mViewer->advance(mViewer->getFrameStamp()->getSimulationTime());
 
         rttCamera->removeChildren(0, rttCamera->getNumChildren());
         mRootNode->removeChild(rttCamera);
+
+        return done;
     }
 
     osg::Vec4f RenderingManager::getScreenBounds(const MWWorld::Ptr& ptr)
@@ -748,7 +842,7 @@ namespace MWRender
         mIntersectionVisitor->setIntersector(intersector);
 
         int mask = ~0;
-        mask &= ~(Mask_RenderToTexture|Mask_Sky|Mask_Debug|Mask_Effect|Mask_Water|Mask_SimpleWater);
+        mask &= ~(Mask_RenderToTexture|Mask_Sky|Mask_Debug|Mask_Effect|Mask_Water|Mask_SimpleWater|Mask_Static);
         if (ignorePlayer)
             mask &= ~(Mask_Player);
         if (ignoreActors)
@@ -807,6 +901,12 @@ namespace MWRender
     {
         mSky->setMoonColour(false);
 
+        if (mObjectPaging)
+        {
+            mObjectPaging->clear();
+            resetObjectPaging();
+        }
+
         notifyWorldSpaceChanged();
     }
 
@@ -36,6 +36,7 @@ namespace osgViewer
 namespace ESM
 {
     struct Cell;
+    class ESMReader;
 }
 
 namespace Terrain
@@ -43,6 +44,12 @@ namespace Terrain
     class World;
 }
 
+namespace MWWorld
+{
+    class ESMStore;
+    class ConstPtr;
+}
+
 namespace Fallback
 {
     class Map;
@@ -67,6 +74,7 @@ namespace MWRender
     class Water;
     class TerrainStorage;
     class LandManager;
+    class ObjectPaging;
 
     class RenderingManager : public MWRender::RenderingInterface
     {
@@ -113,6 +121,19 @@ namespace MWRender
 
         void enableTerrain(bool enable);
 
+        /// Set the content that distant objects are read from.
+        void setObjectPagingContent(const MWWorld::ESMStore& store, const std::vector<ESM::ESMReader>& readers);
+
+        /// Stop drawing the objects of \a store that were changed from their state in the content files as distant objects.
+        void pagingBlacklistChangedObjects(const MWWorld::CellStore& store);
+
+        /// Stop drawing \a ptr, which was changed from its state in the content files, in the merged chunks, and show
+        /// its own node instead.
+        void pagingBlacklistObject(const MWWorld::Ptr& ptr);
+
+        /// Hide the node of \a ptr, which was just inserted, if the object is drawn in the merged chunks.
+        void pagingHideObject(const MWWorld::Ptr& ptr);
+
         void updatePtr(const MWWorld::Ptr& old, const MWWorld::Ptr& updated);
 
         void rotateObject(const MWWorld::Ptr& ptr, const osg::Quat& rot);
@@ -125,7 +146,9 @@ namespace MWRender
         void setWaterHeight(float level);
 
         /// Take a screenshot of w*h onto the given image, not including the GUI.
-        void screenshot(osg::Image* image, int w, int h);
+        /// @return Was the screenshot taken? Fails if there is no window to draw in, or if the frame was not drawn within a
+        /// second, in which case the image must not be used, as it may still be written to.
+        bool screenshot(osg::Image* image, int w, int h);
 
         struct RayResult
         {
@@ -213,6 +236,9 @@ namespace MWRender
 
         void reportStats() const;
 
+        /// Have the terrain ask for the distant object chunks again.
+        void resetObjectPaging();
+
         osg::ref_ptr<osgUtil::IntersectionVisitor> getIntersectionVisitor(osgUtil::Intersector* intersector, bool ignorePlayer, bool ignoreActors);
 
         osg::ref_ptr<osgUtil::IntersectionVisitor> mIntersectionVisitor;
@@ -232,6 +258,7 @@ namespace MWRender
         std::unique_ptr<Water> mWater;
         std::unique_ptr<Terrain::World> mTerrain;
         TerrainStorage* mTerrainStorage;
+        std::unique_ptr<ObjectPaging> mObjectPaging;
         std::unique_ptr<SkyManager> mSky;
         std::unique_ptr<EffectManager> mEffectManager;
         osg::ref_ptr<NpcAnimation> mPlayerAnimation;
@@ -51,7 +51,10 @@ namespace MWRender
         Mask_PreCompile = (1<<16),
 
         // Set on a camera's cull mask to enable the LightManager
-        Mask_Lighting = (1<<17)
+        Mask_Lighting = (1<<17),
+
+        // Distant static objects, child of Terrain
+        Mask_Static = (1<<18)
     };
 
 }
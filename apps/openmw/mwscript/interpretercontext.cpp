@@ -69,45 +69,50 @@ namespace MWScript
         }
     }
 
-    const Locals& InterpreterContext::getMemberLocals (std::string& id, bool global)
-        const
+    Locals& InterpreterContext::getMemberLocals (Interpreter::MemberSlot& slot, bool global,
+        char type) const
     {
-        if (global)
-        {
-            return MWBase::Environment::get().getScriptManager()->getGlobalScripts().
-                getLocals (id);
-        }
-        else
+        if (slot.mObject)
         {
-            const MWWorld::Ptr ptr = getReferenceImp (id, false);
-
-             id = ptr.getClass().getScript (ptr);
+            if (global)
+                return *static_cast<Locals *> (slot.mObject);
 
-            ptr.getRefData().setLocals (
-                *MWBase::Environment::get().getWorld()->getStore().get<ESM::Script>().find (id));
+            // References stay in place while they move between cells, but not when they are copied
+            // and the original is left behind with a count of 0.
+            MWWorld::LiveCellRefBase& ref = *static_cast<MWWorld::LiveCellRefBase *> (slot.mObject);
 
-            return ptr.getRefData().getLocals();
+            if (MWWorld::CellStore::isAccessible (ref.mData, ref.mRef))
+                return ref.mData.getLocals();
         }
-    }
 
-    Locals& InterpreterContext::getMemberLocals (std::string& id, bool global)
-    {
+        Locals *locals = 0;
+        std::string scriptId = slot.mId;
+
         if (global)
         {
-            return MWBase::Environment::get().getScriptManager()->getGlobalScripts().
-                getLocals (id);
+            locals = &MWBase::Environment::get().getScriptManager()->getGlobalScripts().
+                getLocals (scriptId);
+
+            slot.mObject = locals;
         }
         else
         {
-            const MWWorld::Ptr ptr = getReferenceImp (id, false);
+            const MWWorld::Ptr ptr = getReferenceImp (slot.mId, false);
 
-            id = ptr.getClass().getScript (ptr);
+            scriptId = ptr.getClass().getScript (ptr);
 
             ptr.getRefData().setLocals (
-                *MWBase::Environment::get().getWorld()->getStore().get<ESM::Script>().find (id));
+                *MWBase::Environment::get().getWorld()->getStore().get<ESM::Script>().find (scriptId));
+
+            locals = &ptr.getRefData().getLocals();
 
-            return ptr.getRefData().getLocals();
+            // Items in containers do not stay in place, so they are looked up again on every access.
+            slot.mObject = ptr.isInCell() ? ptr.getBase() : 0;
         }
+
+        slot.mIndex = findLocalVariableIndex (scriptId, slot.mName, type);
+
+        return *locals;
     }
 
     int InterpreterContext::findLocalVariableIndex (const std::string& scriptId,
@@ -135,7 +140,6 @@ namespace MWScript
         throw std::runtime_error (stream.str().c_str());
     }
 
-
     InterpreterContext::InterpreterContext (
         MWScript::Locals *locals, const MWWorld::Ptr& reference, const std::string& targetId)
     : mLocals (locals), mReference (reference), mTargetId (targetId)
@@ -244,6 +248,41 @@ namespace MWScript
         MWBase::Environment::get().getWorld()->setGlobalFloat (name, value);
     }
 
+    int InterpreterContext::getGlobalSlot (const std::string& name) const
+    {
+        return MWBase::Environment::get().getWorld()->getGlobalSlot (name);
+    }
+
+    int InterpreterContext::getGlobalShort (int slot) const
+    {
+        return MWBase::Environment::get().getWorld()->getGlobalInt (slot);
+    }
+
+    int InterpreterContext::getGlobalLong (int slot) const
+    {
+        return MWBase::Environment::get().getWorld()->getGlobalInt (slot);
+    }
+
+    float InterpreterContext::getGlobalFloat (int slot) const
+    {
+        return MWBase::Environment::get().getWorld()->getGlobalFloat (slot);
+    }
+
+    void InterpreterContext::setGlobalShort (int slot, int value)
+    {
+        MWBase::Environment::get().getWorld()->setGlobalInt (slot, value);
+    }
+
+    void InterpreterContext::setGlobalLong (int slot, int value)
+    {
+        MWBase::Environment::get().getWorld()->setGlobalInt (slot, value);
+    }
+
+    void InterpreterContext::setGlobalFloat (int slot, float value)
+    {
+        MWBase::Environment::get().getWorld()->setGlobalFloat (slot, value);
+    }
+
     std::vector<std::string> InterpreterContext::getGlobals() const
     {
         std::vector<std::string> ids;
@@ -509,62 +548,46 @@ namespace MWScript
         MWBase::Environment::get().getWorld()->disable (ref);
     }
 
-    int InterpreterContext::getMemberShort (const std::string& id, const std::string& name,
-        bool global) const
+    int InterpreterContext::getMemberShort (Interpreter::MemberSlot& slot, bool global) const
     {
-        std::string scriptId (id);
-
-        const Locals& locals = getMemberLocals (scriptId, global);
+        const Locals& locals = getMemberLocals (slot, global, 's');
 
-        return locals.mShorts[findLocalVariableIndex (scriptId, name, 's')];
+        return locals.mShorts[slot.mIndex];
     }
 
-    int InterpreterContext::getMemberLong (const std::string& id, const std::string& name,
-        bool global) const
+    int InterpreterContext::getMemberLong (Interpreter::MemberSlot& slot, bool global) const
     {
-        std::string scriptId (id);
+        const Locals& locals = getMemberLocals (slot, global, 'l');
 
-        const Locals& locals = getMemberLocals (scriptId, global);
-
-        return locals.mLongs[findLocalVariableIndex (scriptId, name, 'l')];
+        return locals.mLongs[slot.mIndex];
     }
 
-    float InterpreterContext::getMemberFloat (const std::string& id, const std::string& name,
-        bool global) const
+    float InterpreterContext::getMemberFloat (Interpreter::MemberSlot& slot, bool global) const
     {
-        std::string scriptId (id);
-
-        const Locals& locals = getMemberLocals (scriptId, global);
+        const Locals& locals = getMemberLocals (slot, global, 'f');
 
-        return locals.mFloats[findLocalVariableIndex (scriptId, name, 'f')];
+        return locals.mFloats[slot.mIndex];
     }
 
-    void InterpreterContext::setMemberShort (const std::string& id, const std::string& name,
-        int value, bool global)
+    void InterpreterContext::setMemberShort (Interpreter::MemberSlot& slot, int value, bool global)
     {
-        std::string scriptId (id);
-
-        Locals& locals = getMemberLocals (scriptId, global);
+        Locals& locals = getMemberLocals (slot, global, 's');
 
-        locals.mShorts[findLocalVariableIndex (scriptId, name, 's')] = value;
+        locals.mShorts[slot.mIndex] = value;
     }
 
-    void InterpreterContext::setMemberLong (const std::string& id, const std::string& name, int value, bool global)
+    void InterpreterContext::setMemberLong (Interpreter::MemberSlot& slot, int value, bool global)
     {
-        std::string scriptId (id);
+        Locals& locals = getMemberLocals (slot, global, 'l');
 
-        Locals& locals = getMemberLocals (scriptId, global);
-
-        locals.mLongs[findLocalVariableIndex (scriptId, name, 'l')] = value;
+        locals.mLongs[slot.mIndex] = value;
     }
 
-    void InterpreterContext::setMemberFloat (const std::string& id, const std::string& name, float value, bool global)
+    void InterpreterContext::setMemberFloat (Interpreter::MemberSlot& slot, float value, bool global)
     {
-        std::string scriptId (id);
-
-        Locals& locals = getMemberLocals (scriptId, global);
+        Locals& locals = getMemberLocals (slot, global, 'f');
 
-        locals.mFloats[findLocalVariableIndex (scriptId, name, 'f')] = value;
+        locals.mFloats[slot.mIndex] = value;
     }
 
     MWWorld::Ptr InterpreterContext::getReference(bool required)
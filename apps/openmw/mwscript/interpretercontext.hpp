@@ -37,11 +37,10 @@ namespace MWScript
             const MWWorld::Ptr getReferenceImp (const std::string& id = "",
                 bool activeOnly = false, bool doThrow=true) const;
 
-            const Locals& getMemberLocals (std::string& id, bool global) const;
-            ///< \a id is changed to the respective script ID, if \a id wasn't a script ID before
-
-            Locals& getMemberLocals (std::string& id, bool global);
-            ///< \a id is changed to the respective script ID, if \a id wasn't a script ID before
+            /// Return the locals of the reference or global script named by \a slot, and the index of the
+            /// variable in them in \a slot. Both are only looked up if \a slot was not resolved yet, or
+            /// for another reference.
+            Locals& getMemberLocals (Interpreter::MemberSlot& slot, bool global, char type) const;
 
             /// Throws an exception if local variable can't be found.
             int findLocalVariableIndex (const std::string& scriptId, const std::string& name,
@@ -87,6 +86,20 @@ namespace MWScript
 
             virtual void setGlobalFloat (const std::string& name, float value);
 
+            virtual int getGlobalSlot (const std::string& name) const;
+
+            virtual int getGlobalShort (int slot) const;
+
+            virtual int getGlobalLong (int slot) const;
+
+            virtual float getGlobalFloat (int slot) const;
+
+            virtual void setGlobalShort (int slot, int value);
+
+            virtual void setGlobalLong (int slot, int value);
+
+            virtual void setGlobalFloat (int slot, float value);
+
             virtual std::vector<std::string> getGlobals () const;
 
             virtual char getGlobalType (const std::string& name) const;
@@ -137,17 +150,17 @@ namespace MWScript
 
             virtual void disable (const std::string& id = "");
 
-            virtual int getMemberShort (const std::string& id, const std::string& name, bool global) const;
+            virtual int getMemberShort (Interpreter::MemberSlot& slot, bool global) const;
 
-            virtual int getMemberLong (const std::string& id, const std::string& name, bool global) const;
+            virtual int getMemberLong (Interpreter::MemberSlot& slot, bool global) const;
 
-            virtual float getMemberFloat (const std::string& id, const std::string& name, bool global) const;
+            virtual float getMemberFloat (Interpreter::MemberSlot& slot, bool global) const;
 
-            virtual void setMemberShort (const std::string& id, const std::string& name, int value, bool global);
+            virtual void setMemberShort (Interpreter::MemberSlot& slot, int value, bool global);
 
-            virtual void setMemberLong (const std::string& id, const std::string& name, int value, bool global);
+            virtual void setMemberLong (Interpreter::MemberSlot& slot, int value, bool global);
 
-            virtual void setMemberFloat (const std::string& id, const std::string& name, float value, bool global);
+            virtual void setMemberFloat (Interpreter::MemberSlot& slot, float value, bool global);
 
             MWWorld::Ptr getReference(bool required=true);
             ///< Reference, that the script is running from (can be empty)
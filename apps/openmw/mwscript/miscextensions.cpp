@@ -13,6 +13,8 @@
 #include <components/esm/loadmgef.hpp>
 #include <components/esm/loadcrea.hpp>
 
+#include <components/sceneutil/profiler.hpp>
+
 #include "../mwbase/environment.hpp"
 #include "../mwbase/windowmanager.hpp"
 #include "../mwbase/scriptmanager.hpp"
@@ -1017,6 +1019,31 @@ namespace MWScript
             }
         };
 
+        class OpToggleProfiler : public Interpreter::Opcode0
+        {
+        public:
+            virtual void execute (Interpreter::Runtime& runtime)
+            {
+#ifdef OPENMW_ENABLE_PROFILER
+                SceneUtil::Profiler& profiler = SceneUtil::Profiler::instance();
+                if (!profiler.stopCapture())
+                {
+                    profiler.startCapture();
+                    runtime.getContext().report("Profiler -> On");
+                    return;
+                }
+
+                const std::string path = profiler.writeTraceFile();
+                if (path.empty())
+                    runtime.getContext().report("Profiler -> Off, failed to write the trace");
+                else
+                    runtime.getContext().report("Profiler -> Off, trace written to " + path);
+#else
+                runtime.getContext().report("Profiler is not available, OpenMW was built without OPENMW_ENABLE_PROFILER");
+#endif
+            }
+        };
+
         class OpToggleGodMode : public Interpreter::Opcode0
         {
             public:
@@ -1358,6 +1385,7 @@ namespace MWScript
             interpreter.installSegment5 (Compiler::Misc::opcodeShowExplicit, new OpShow<ExplicitRef>);
             interpreter.installSegment5 (Compiler::Misc::opcodeToggleGodMode, new OpToggleGodMode);
             interpreter.installSegment5 (Compiler::Misc::opcodeToggleScripts, new OpToggleScripts);
+            interpreter.installSegment5 (Compiler::Misc::opcodeToggleProfiler, new OpToggleProfiler);
             interpreter.installSegment5 (Compiler::Misc::opcodeDisableLevitation, new OpEnableLevitation<false>);
             interpreter.installSegment5 (Compiler::Misc::opcodeEnableLevitation, new OpEnableLevitation<true>);
             interpreter.installSegment5 (Compiler::Misc::opcodeCast, new OpCast<ImplicitRef>);
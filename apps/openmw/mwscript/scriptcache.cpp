@@ -0,0 +1,222 @@
+#include "scriptcache.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+namespace
+{
+    /// Bump when the file format or the generated code changes in a way the signature does not cover
+    const char* const sHeader = "OpenMW script cache 1\n";
+
+    /// Reject sizes that can only come from a corrupted file, before allocating for them
+    const uint32_t sMaxSize = 1 << 24;
+
+    const char sLocalTypes[] = { 's', 'l', 'f' };
+
+    void writeUInt (std::ostream& stream, uint32_t value)
+    {
+        stream.write (reinterpret_cast<const char*> (&value), sizeof (value));
+    }
+
+    bool readUInt (std::istream& stream, uint32_t& value)
+    {
+        stream.read (reinterpret_cast<char*> (&value), sizeof (value));
+        return stream.good();
+    }
+
+    void writeString (std::ostream& stream, const std::string& string)
+    {
+        writeUInt (stream, static_cast<uint32_t> (string.size()));
+        stream.write (string.data(), string.size());
+    }
+
+    bool readString (std::istream& stream, std::string& string)
+    {
+        uint32_t size = 0;
+        if (!readUInt (stream, size) || size > sMaxSize)
+            return false;
+        string.resize (size);
+        if (size)
+            stream.read (&string[0], size);
+        return stream.good();
+    }
+}
+
+namespace MWScript
+{
+    ScriptCache::ScriptCache (const std::string& path, const std::string& signature)
+    : mPath (path), mSignature (signature), mChanged (false)
+    {}
+
+    bool ScriptCache::readFile()
+    {
+        boost::filesystem::ifstream stream (boost::filesystem::path (mPath), std::ios::binary);
+        if (!stream.is_open())
+            return false;
+
+        if (!read (stream))
+        {
+            std::cout << "Script cache " << mPath << " is outdated, scripts will be compiled again" << std::endl;
+            return false;
+        }
+        return true;
+    }
+
+    bool ScriptCache::writeFile()
+    {
+        if (!mChanged)
+            return true;
+
+        const boost::filesystem::path path (mPath);
+        const boost::filesystem::path tmpPath (mPath + ".tmp");
+        try
+        {
+            if (path.has_parent_path())
+                boost::filesystem::create_directories (path.parent_path());
+
+            boost::filesystem::ofstream stream (tmpPath, std::ios::binary);
+            write (stream);
+            stream.close();
+            if (stream.fail())
+                throw std::runtime_error ("failed to write " + tmpPath.string());
+
+            // Replace the old cache only once the new one is complete
+            boost::filesystem::rename (tmpPath, path);
+        }
+        catch (const std::exception& e)
+        {
+            std::cerr << "Error: failed to write script cache " << mPath << ": " << e.what() << std::endl;
+            return false;
+        }
+
+        mChanged = false;
+        return true;
+    }
+
+    bool ScriptCache::read (std::istream& stream)
+    {
+        mScripts.clear();
+        mChanged = true;
+
+        std::string header (std::char_traits<char>::length (sHeader), '\0');
+        stream.read (&header[0], header.size());
+        if (!stream.good() || header != sHeader)
+            return false;
+
+        std::string signature;
+        if (!readString (stream, signature) || signature != mSignature)
+            return false;
+
+        uint32_t count = 0;
+        if (!readUInt (stream, count) || count > sMaxSize)
+            return false;
+
+        std::map<std::string, Entry> scripts;
+        for (uint32_t i=0; i<count; ++i)
+        {
+            std::string name;
+            if (!readString (stream, name))
+                return false;
+
+            Entry& entry = scripts[name];
+
+            stream.read (reinterpret_cast<char*> (&entry.mHash), sizeof (entry.mHash));
+
+            for (std::size_t type=0; type<sizeof (sLocalTypes); ++type)
+            {
+                uint32_t numLocals = 0;
+                if (!readUInt (stream, numLocals) || numLocals > sMaxSize)
+                    return false;
+                for (uint32_t local=0; local<numLocals; ++local)
+                {
+                    std::string localName;
+                    if (!readString (stream, localName))
+                        return false;
+                    entry.mScript.second.declare (sLocalTypes[type], localName);
+                }
+            }
+
+            uint32_t codeSize = 0;
+            if (!readUInt (stream, codeSize) || codeSize > sMaxSize)
+                return false;
+            std::vector<Interpreter::Type_Code>& code = entry.mScript.first;
+            code.resize (codeSize);
+            if (codeSize)
+                stream.read (reinterpret_cast<char*> (&code[0]), codeSize * sizeof (Interpreter::Type_Code));
+            if (!stream.good())
+                return false;
+        }
+
+        mScripts.swap (scripts);
+        mChanged = false;
+        return true;
+    }
+
+    void ScriptCache::write (std::ostream& stream) const
+    {
+        stream.write (sHeader, std::char_traits<char>::length (sHeader));
+        writeString (stream, mSignature);
+        writeUInt (stream, static_cast<uint32_t> (mScripts.size()));
+
+        for (std::map<std::string, Entry>::const_iterator iter = mScripts.begin(); iter != mScripts.end(); ++iter)
+        {
+            writeString (stream, iter->first);
+            stream.write (reinterpret_cast<const char*> (&iter->second.mHash), sizeof (iter->second.mHash));
+
+            for (std::size_t type=0; type<sizeof (sLocalTypes); ++type)
+            {
+                const std::vector<std::string>& locals = iter->second.mScript.second.get (sLocalTypes[type]);
+                writeUInt (stream, static_cast<uint32_t> (locals.size()));
+                for (std::vector<std::string>::const_iterator local = locals.begin(); local != locals.end(); ++local)
+                    writeString (stream, *local);
+            }
+
+            const std::vector<Interpreter::Type_Code>& code = iter->second.mScript.first;
+            writeUInt (stream, static_cast<uint32_t> (code.size()));
+            if (!code.empty())
+                stream.write (reinterpret_cast<const char*> (&code[0]), code.size() * sizeof (Interpreter::Type_Code));
+        }
+    }
+
+    const ScriptCache::CompiledScript *ScriptCache::get (const std::string& name, const std::string& text) const
+    {
+        std::map<std::string, Entry>::const_iterator iter = mScripts.find (name);
+
+        if (iter==mScripts.end() || iter->second.mHash!=hash (text))
+            return 0;
+
+        return &iter->second.mScript;
+    }
+
+    void ScriptCache::add (const std::string& name, const std::string& text, const CompiledScript& script)
+    {
+        Entry& entry = mScripts[name];
+        entry.mHash = hash (text);
+        entry.mScript = script;
+        mChanged = true;
+    }
+
+    std::size_t ScriptCache::getSize() const
+    {
+        return mScripts.size();
+    }
+
+    const std::string& ScriptCache::getPath() const
+    {
+        return mPath;
+    }
+
+    uint64_t ScriptCache::hash (const std::string& text)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (std::string::const_iterator iter = text.begin(); iter != text.end(); ++iter)
+        {
+            hash ^= static_cast<unsigned char> (*iter);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+}
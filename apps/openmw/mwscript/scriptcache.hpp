@@ -0,0 +1,73 @@
+#ifndef GAME_SCRIPT_SCRIPTCACHE_H
+#define GAME_SCRIPT_SCRIPTCACHE_H
+
+#include <istream>
+#include <map>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <stdint.h>
+
+#include <components/compiler/locals.hpp>
+
+#include <components/interpreter/types.hpp>
+
+namespace MWScript
+{
+    /// \brief Compiled scripts that are kept on disk, to be loaded on startup instead of compiling the scripts again
+    ///
+    /// The cache is bound to a signature, which describes everything besides the script text that the compiled code
+    /// depends on (content files, engine version, compiler settings). A cache with a different signature is discarded.
+    /// Each script is stored with a hash of its text, and is only used while the text is unchanged.
+    class ScriptCache
+    {
+        public:
+
+            typedef std::pair<std::vector<Interpreter::Type_Code>, Compiler::Locals> CompiledScript;
+
+            ScriptCache (const std::string& path, const std::string& signature);
+
+            bool readFile();
+            ///< Load the cache file.
+            /// \return Was a cache with the same signature found?
+
+            bool writeFile();
+            ///< Write the cache file, if scripts were added since it was last read or written.
+            /// \return Success?
+
+            bool read (std::istream& stream);
+            ///< Replace the cached scripts with those read from \a stream.
+            /// \return Does \a stream hold a valid cache with the same signature?
+
+            void write (std::ostream& stream) const;
+
+            const CompiledScript *get (const std::string& name, const std::string& text) const;
+            ///< \return The cached script \a name, or 0 if there is none that was compiled from \a text.
+
+            void add (const std::string& name, const std::string& text, const CompiledScript& script);
+
+            std::size_t getSize() const;
+            ///< \return Number of cached scripts.
+
+            const std::string& getPath() const;
+
+            static uint64_t hash (const std::string& text);
+            ///< FNV-1a hash, which unlike std::hash does not change between builds.
+
+        private:
+
+            struct Entry
+            {
+                uint64_t mHash;
+                CompiledScript mScript;
+            };
+
+            std::string mPath;
+            std::string mSignature;
+            std::map<std::string, Entry> mScripts;
+            bool mChanged;
+    };
+}
+
+#endif
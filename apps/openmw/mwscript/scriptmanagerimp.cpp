@@ -15,10 +15,121 @@
 #include <components/compiler/exception.hpp>
 #include <components/compiler/quickfileparser.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
+#include <OpenThreads/ScopedLock>
+
 #include "../mwworld/esmstore.hpp"
 
 #include "extensions.hpp"
 
+namespace
+{
+    /// Compile \a script with the given parser, and report errors to the error handler's stream
+    /// and failures to \a log.
+    bool compileScript (const std::string& name, const ESM::Script& script, Compiler::FileParser& parser,
+        Compiler::StreamErrorHandler& errorHandler, const Compiler::Context& context, std::ostream& log)
+    {
+        parser.reset();
+        errorHandler.reset();
+
+        errorHandler.setContext(name);
+
+        bool Success = true;
+        try
+        {
+            std::istringstream input (script.mScriptText);
+
+            Compiler::Scanner scanner (errorHandler, input, context.getExtensions());
+
+            scanner.scan (parser);
+
+            if (!errorHandler.isGood())
+                Success = false;
+        }
+        catch (const Compiler::SourceException&)
+        {
+            // error has already been reported via error handler
+            Success = false;
+        }
+        catch (const std::exception& error)
+        {
+            log << "Error: An exception has been thrown: " << error.what() << std::endl;
+            Success = false;
+        }
+
+        if (!Success)
+        {
+            log
+                << "Warning: compiling failed: " << name << std::endl;
+        }
+
+        return Success;
+    }
+
+    /// Log of the batch the current thread compiles, which also takes the errors of the local variable declarations
+    /// that its scripts refer to, see ScriptManager::getLocals()
+    thread_local std::ostream* sBatchLog = NULL;
+
+    /// Compiles a share of the scripts for ScriptManager::compileAll(), with a parser and an error handler of its own
+    class CompileBatch : public SceneUtil::WorkItem
+    {
+        public:
+
+            struct Result
+            {
+                bool mSuccess;
+                MWScript::ScriptCache::CompiledScript mScript;
+                /// Errors and warnings, to be printed in the order of the scripts once all batches are done
+                std::string mLog;
+
+                Result() : mSuccess (false) {}
+            };
+
+            CompileBatch (Compiler::Context& context, int warningsMode)
+            : mErrorHandler (mLog), mParser (mErrorHandler, context), mContext (context)
+            {
+                mErrorHandler.setWarningsMode (warningsMode);
+            }
+
+            void add (const ESM::Script *script, Result *result)
+            {
+                mScripts.push_back (std::make_pair (script, result));
+            }
+
+            virtual const char* getName() const { return "Script compilation"; }
+
+            virtual void doWork()
+            {
+                sBatchLog = &mLog;
+                for (std::vector<std::pair<const ESM::Script *, Result *> >::iterator iter = mScripts.begin();
+                    iter != mScripts.end(); ++iter)
+                {
+                    Result& result = *iter->second;
+                    mLog.str ("");
+
+                    result.mSuccess = compileScript (iter->first->mId, *iter->first, mParser, mErrorHandler, mContext, mLog);
+                    if (result.mSuccess)
+                    {
+                        mParser.getCode (result.mScript.first);
+                        result.mScript.second = mParser.getLocals();
+                    }
+
+                    result.mLog = mLog.str();
+                }
+                sBatchLog = NULL;
+            }
+
+        private:
+
+            std::ostringstream mLog;
+            Compiler::StreamErrorHandler mErrorHandler;
+            Compiler::FileParser mParser;
+            const Compiler::Context& mContext;
+            std::vector<std::pair<const ESM::Script *, Result *> > mScripts;
+    };
+}
+
 namespace MWScript
 {
     ScriptManager::ScriptManager (const MWWorld::ESMStore& store,
@@ -26,7 +137,7 @@ namespace MWScript
         const std::vector<std::string>& scriptBlacklist)
     : mErrorHandler (std::cerr), mStore (store),
       mCompilerContext (compilerContext), mParser (mErrorHandler, mCompilerContext),
-      mOpcodesInstalled (false), mGlobalScripts (store)
+      mOpcodesInstalled (false), mGlobalScripts (store), mWarningsMode (warningsMode)
     {
         mErrorHandler.setWarningsMode (warningsMode);
 
@@ -37,49 +148,42 @@ namespace MWScript
         std::sort (mScriptBlacklist.begin(), mScriptBlacklist.end());
     }
 
-    bool ScriptManager::compile (const std::string& name)
+    ScriptManager::~ScriptManager()
     {
-        mParser.reset();
-        mErrorHandler.reset();
-
-        if (const ESM::Script *script = mStore.get<ESM::Script>().find (name))
-        {
-            mErrorHandler.setContext(name);
-
-            bool Success = true;
-            try
-            {
-                std::istringstream input (script->mScriptText);
+        if (mCache)
+            mCache->writeFile();
+    }
 
-                Compiler::Scanner scanner (mErrorHandler, input, mCompilerContext.getExtensions());
+    void ScriptManager::useCache (const std::string& path, const std::string& signature)
+    {
+        mCache.reset (new ScriptCache (path, signature));
 
-                scanner.scan (mParser);
+        if (mCache->readFile())
+            std::cout << "Loaded " << mCache->getSize() << " compiled scripts from " << path << std::endl;
+    }
 
-                if (!mErrorHandler.isGood())
-                    Success = false;
-            }
-            catch (const Compiler::SourceException&)
-            {
-                // error has already been reported via error handler
-                Success = false;
-            }
-            catch (const std::exception& error)
+    bool ScriptManager::compile (const std::string& name)
+    {
+        if (const ESM::Script *script = mStore.get<ESM::Script>().find (name))
+        {
+            if (mCache)
             {
-                std::cerr << "Error: An exception has been thrown: " << error.what() << std::endl;
-                Success = false;
+                if (const CompiledScript *cached = mCache->get (name, script->mScriptText))
+                {
+                    mScripts.insert (std::make_pair (name, *cached));
+                    return true;
+                }
             }
 
-            if (!Success)
+            if (compileScript (name, *script, mParser, mErrorHandler, mCompilerContext, std::cerr))
             {
-                std::cerr
-                    << "Warning: compiling failed: " << name << std::endl;
-            }
+                CompiledScript compiled;
+                mParser.getCode (compiled.first);
+                compiled.second = mParser.getLocals();
+                mScripts.insert (std::make_pair (name, compiled));
 
-            if (Success)
-            {
-                std::vector<Interpreter::Type_Code> code;
-                mParser.getCode (code);
-                mScripts.insert (std::make_pair (name, std::make_pair (code, mParser.getLocals())));
+                if (mCache)
+                    mCache->add (name, script->mScriptText, compiled);
 
                 return true;
             }
@@ -90,6 +194,16 @@ namespace MWScript
 
     void ScriptManager::run (const std::string& name, Interpreter::Context& interpreterContext)
     {
+        run (getScriptHandle (name), interpreterContext);
+    }
+
+    int ScriptManager::getScriptHandle (const std::string& name)
+    {
+        std::map<std::string, int>::const_iterator handle = mHandles.find (name);
+
+        if (handle!=mHandles.end())
+            return handle->second;
+
         // compile script
         ScriptCollection::iterator iter = mScripts.find (name);
 
@@ -100,15 +214,30 @@ namespace MWScript
                 // failed -> ignore script from now on.
                 std::vector<Interpreter::Type_Code> empty;
                 mScripts.insert (std::make_pair (name, std::make_pair (empty, Compiler::Locals())));
-                return;
             }
 
             iter = mScripts.find (name);
             assert (iter!=mScripts.end());
         }
 
+        BoundScript script;
+        script.mName = name;
+        script.mScript = &iter->second;
+        mBoundScripts.push_back (script);
+
+        const int index = static_cast<int> (mBoundScripts.size())-1;
+        mHandles.insert (std::make_pair (name, index));
+        return index;
+    }
+
+    void ScriptManager::run (int handle, Interpreter::Context& interpreterContext)
+    {
+        assert (handle>=0 && handle<static_cast<int> (mBoundScripts.size()));
+        BoundScript& script = mBoundScripts[handle];
+        std::vector<Interpreter::Type_Code>& code = script.mScript->first;
+
         // execute script
-        if (!iter->second.first.empty())
+        if (!code.empty())
             try
             {
                 if (!mOpcodesInstalled)
@@ -117,14 +246,14 @@ namespace MWScript
                     mOpcodesInstalled = true;
                 }
 
-                mInterpreter.run (&iter->second.first[0], iter->second.first.size(), interpreterContext);
+                mInterpreter.run (&code[0], code.size(), interpreterContext, &script.mLinks);
             }
             catch (const std::exception& e)
             {
-                std::cerr << "Execution of script " << name << " failed:" << std::endl;
+                std::cerr << "Execution of script " << script.mName << " failed:" << std::endl;
                 std::cerr << e.what() << std::endl;
 
-                iter->second.first.clear(); // don't execute again.
+                code.clear(); // don't execute again.
             }
     }
 
@@ -135,6 +264,8 @@ namespace MWScript
 
         const MWWorld::Store<ESM::Script>& scripts = mStore.get<ESM::Script>();
 
+        std::vector<const ESM::Script *> toCompile;
+
         for (MWWorld::Store<ESM::Script>::iterator iter = scripts.begin();
             iter != scripts.end(); ++iter)
             if (!std::binary_search (mScriptBlacklist.begin(), mScriptBlacklist.end(),
@@ -142,10 +273,58 @@ namespace MWScript
             {
                 ++count;
 
-                if (compile (iter->mId))
-                    ++success;
+                if (mCache)
+                {
+                    if (const CompiledScript *cached = mCache->get (iter->mId, iter->mScriptText))
+                    {
+                        mScripts.insert (std::make_pair (iter->mId, *cached));
+                        ++success;
+                        continue;
+                    }
+                }
+
+                toCompile.push_back (&*iter);
             }
 
+        if (toCompile.empty())
+            return std::make_pair (count, success);
+
+        // The main thread compiles the last batch
+        const int numThreads = SceneUtil::WorkQueue::getDefaultNumThreads();
+        std::vector<CompileBatch::Result> results (toCompile.size());
+        std::vector<osg::ref_ptr<CompileBatch> > batches;
+        for (int i=0; i<=numThreads; ++i)
+            batches.push_back (new CompileBatch (mCompilerContext, mWarningsMode));
+        for (std::size_t i=0; i<toCompile.size(); ++i)
+            batches[i % batches.size()]->add (toCompile[i], &results[i]);
+
+        {
+            osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue (numThreads);
+            for (std::size_t i=0; i+1<batches.size(); ++i)
+                queue->addWorkItem (batches[i]);
+            batches.back()->doWork();
+            for (std::size_t i=0; i+1<batches.size(); ++i)
+                batches[i]->waitTillDone();
+        }
+
+        for (std::size_t i=0; i<toCompile.size(); ++i)
+        {
+            std::cerr << results[i].mLog;
+
+            if (results[i].mSuccess)
+            {
+                mScripts.insert (std::make_pair (toCompile[i]->mId, results[i].mScript));
+
+                if (mCache)
+                    mCache->add (toCompile[i]->mId, toCompile[i]->mScriptText, results[i].mScript);
+
+                ++success;
+            }
+        }
+
+        if (mCache)
+            mCache->writeFile();
+
         return std::make_pair (count, success);
     }
 
@@ -153,6 +332,8 @@ namespace MWScript
     {
         std::string name2 = Misc::StringUtils::lowerCase (name);
 
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock (mLocalsMutex);
+
         {
             ScriptCollection::iterator iter = mScripts.find (name2);
 
@@ -171,11 +352,14 @@ namespace MWScript
         {
             Compiler::Locals locals;
 
-            mErrorHandler.setContext(name2 + "[local variables]");
+            // Errors go with those of the script that refers to these locals, if it is compiled by compileAll()
+            Compiler::StreamErrorHandler errorHandler (sBatchLog ? *sBatchLog : std::cerr);
+            errorHandler.setWarningsMode (mWarningsMode);
+            errorHandler.setContext(name2 + "[local variables]");
 
             std::istringstream stream (script->mScriptText);
-            Compiler::QuickFileParser parser (mErrorHandler, mCompilerContext, locals);
-            Compiler::Scanner scanner (mErrorHandler, stream, mCompilerContext.getExtensions());
+            Compiler::QuickFileParser parser (errorHandler, mCompilerContext, locals);
+            Compiler::Scanner scanner (errorHandler, stream, mCompilerContext.getExtensions());
             scanner.scan (parser);
 
             std::map<std::string, Compiler::Locals>::iterator iter =
@@ -191,4 +375,13 @@ namespace MWScript
     {
         return mGlobalScripts;
     }
+
+    void ScriptManager::clear()
+    {
+        mGlobalScripts.clear();
+
+        for (std::deque<BoundScript>::iterator iter (mBoundScripts.begin()); iter!=mBoundScripts.end();
+            ++iter)
+            iter->mLinks.clearMembers();
+    }
 }
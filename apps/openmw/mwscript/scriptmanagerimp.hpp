@@ -1,18 +1,24 @@
 #ifndef GAME_SCRIPT_SCRIPTMANAGER_H
 #define GAME_SCRIPT_SCRIPTMANAGER_H
 
+#include <deque>
 #include <map>
+#include <memory>
 #include <string>
 
+#include <OpenThreads/Mutex>
+
 #include <components/compiler/streamerrorhandler.hpp>
 #include <components/compiler/fileparser.hpp>
 
 #include <components/interpreter/interpreter.hpp>
+#include <components/interpreter/linktable.hpp>
 #include <components/interpreter/types.hpp>
 
 #include "../mwbase/scriptmanager.hpp"
 
 #include "globalscripts.hpp"
+#include "scriptcache.hpp"
 
 namespace MWWorld
 {
@@ -41,13 +47,32 @@ namespace MWScript
             Interpreter::Interpreter mInterpreter;
             bool mOpcodesInstalled;
 
-            typedef std::pair<std::vector<Interpreter::Type_Code>, Compiler::Locals> CompiledScript;
+            typedef ScriptCache::CompiledScript CompiledScript;
             typedef std::map<std::string, CompiledScript> ScriptCollection;
 
             ScriptCollection mScripts;
+
+            /// A compiled script that is bound to a handle, with the variables its code refers to
+            struct BoundScript
+            {
+                std::string mName;
+                CompiledScript *mScript;
+                Interpreter::LinkTable mLinks;
+            };
+
+            /// Indexed by handle; a deque, so that the link table of a running script stays in place
+            /// while the script binds others, e.g. by placing objects with local scripts
+            std::deque<BoundScript> mBoundScripts;
+            std::map<std::string, int> mHandles;
+
             GlobalScripts mGlobalScripts;
             std::map<std::string, Compiler::Locals> mOtherLocals;
             std::vector<std::string> mScriptBlacklist;
+            int mWarningsMode;
+            std::unique_ptr<ScriptCache> mCache;
+
+            /// Protects mOtherLocals in getLocals(), which is called by the compiler from the threads of compileAll()
+            OpenThreads::Mutex mLocalsMutex;
 
         public:
 
@@ -55,21 +80,39 @@ namespace MWScript
                 Compiler::Context& compilerContext, int warningsMode,
                 const std::vector<std::string>& scriptBlacklist);
 
+            virtual ~ScriptManager();
+
+            void useCache (const std::string& path, const std::string& signature);
+            ///< Load compiled scripts from the cache file at \a path instead of compiling them,
+            /// and store newly compiled scripts in it.
+            /// \param signature Describes the content files and settings that the scripts were compiled with.
+
             virtual void run (const std::string& name, Interpreter::Context& interpreterContext);
             ///< Run the script with the given name (compile first, if not compiled yet)
 
+            virtual int getScriptHandle (const std::string& name);
+            ///< Return a handle to run the script with the given name without looking it up by name
+            /// (compile first, if not compiled yet). Handles stay valid for the lifetime of the script manager.
+
+            virtual void run (int handle, Interpreter::Context& interpreterContext);
+            ///< Run the script with the given handle
+
             virtual bool compile (const std::string& name);
             ///< Compile script with the given namen
             /// \return Success?
 
             virtual std::pair<int, int> compileAll();
-            ///< Compile all scripts
+            ///< Compile all scripts, on all hardware threads
             /// \return count, success
 
             virtual const Compiler::Locals& getLocals (const std::string& name);
             ///< Return locals for script \a name.
 
             virtual GlobalScripts& getGlobalScripts();
+
+            virtual void clear();
+            ///< Clear the global scripts and forget the objects that member variables were resolved in,
+            /// when the game is cleared.
     };
 }
 
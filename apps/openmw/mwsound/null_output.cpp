@@ -0,0 +1,162 @@
+#include "null_output.hpp"
+
+#include <algorithm>
+
+#include "sound_decoder.hpp"
+#include "sound.hpp"
+
+namespace MWSound
+{
+
+namespace
+{
+    template <class T>
+    void remove(std::vector<T*>& active, T* sound)
+    {
+        active.erase(std::remove(active.begin(), active.end(), sound), active.end());
+    }
+
+    template <class T>
+    bool contains(const std::vector<T*>& active, T* sound)
+    {
+        return std::find(active.begin(), active.end(), sound) != active.end();
+    }
+}
+
+// Sound buffers hold no data, their handles only need to be valid
+static char sBuffer;
+
+Null_Output::Null_Output()
+{
+}
+
+Null_Output::~Null_Output()
+{
+    deinit();
+}
+
+std::vector<std::string> Null_Output::enumerate()
+{
+    return std::vector<std::string>();
+}
+
+bool Null_Output::init(const std::string &devname, const std::string &hrtfname, HrtfMode hrtfmode)
+{
+    mInitialized = true;
+    return true;
+}
+
+void Null_Output::deinit()
+{
+    mActiveSounds.clear();
+    mActiveStreams.clear();
+    mInitialized = false;
+}
+
+std::vector<std::string> Null_Output::enumerateHrtf()
+{
+    return std::vector<std::string>();
+}
+
+void Null_Output::setHrtf(const std::string &hrtfname, HrtfMode hrtfmode)
+{
+}
+
+std::pair<Sound_Handle,size_t> Null_Output::loadSound(const std::string &fname)
+{
+    return std::make_pair(&sBuffer, 0);
+}
+
+size_t Null_Output::unloadSound(Sound_Handle data)
+{
+    return 0;
+}
+
+bool Null_Output::playSound(Sound *sound, Sound_Handle data, float offset)
+{
+    if(sound->getIsLooping())
+        mActiveSounds.push_back(sound);
+    return true;
+}
+
+bool Null_Output::playSound3D(Sound *sound, Sound_Handle data, float offset)
+{
+    return playSound(sound, data, offset);
+}
+
+void Null_Output::finishSound(Sound *sound)
+{
+    remove(mActiveSounds, sound);
+}
+
+bool Null_Output::isSoundPlaying(Sound *sound)
+{
+    return contains(mActiveSounds, sound);
+}
+
+void Null_Output::updateSound(Sound *sound)
+{
+}
+
+bool Null_Output::streamSound(DecoderPtr decoder, Stream *sound)
+{
+    if(sound->getIsLooping() || sound->getPlayType() == Type::Music)
+        mActiveStreams.push_back(sound);
+    return true;
+}
+
+bool Null_Output::streamSound3D(DecoderPtr decoder, Stream *sound, bool getLoudnessData)
+{
+    return streamSound(decoder, sound);
+}
+
+void Null_Output::finishStream(Stream *sound)
+{
+    remove(mActiveStreams, sound);
+}
+
+double Null_Output::getStreamDelay(Stream *sound)
+{
+    return 0.0;
+}
+
+double Null_Output::getStreamOffset(Stream *sound)
+{
+    return 0.0;
+}
+
+float Null_Output::getStreamLoudness(Stream *sound)
+{
+    return 0.0f;
+}
+
+bool Null_Output::isStreamPlaying(Stream *sound)
+{
+    return contains(mActiveStreams, sound);
+}
+
+void Null_Output::updateStream(Stream *sound)
+{
+}
+
+void Null_Output::startUpdate()
+{
+}
+
+void Null_Output::finishUpdate()
+{
+}
+
+void Null_Output::updateListener(const osg::Vec3f &pos, const osg::Vec3f &atdir, const osg::Vec3f &updir, Environment env)
+{
+}
+
+void Null_Output::pauseSounds(int types)
+{
+}
+
+void Null_Output::resumeSounds(int types)
+{
+}
+
+}
@@ -0,0 +1,66 @@
+#ifndef GAME_SOUND_NULL_OUTPUT_H
+#define GAME_SOUND_NULL_OUTPUT_H
+
+#include <string>
+#include <vector>
+
+#include "sound_output.hpp"
+
+namespace MWSound
+{
+    class Sound;
+    class Stream;
+
+    /// @brief Sound output that plays to nowhere, for running without an audio device, e.g. headless.
+    /// @par The sound manager does all its work as usual. Looping sounds and music play until they are stopped, all
+    /// other sounds and streams are over as soon as they started, so that nothing waits for them to end.
+    class Null_Output : public Sound_Output
+    {
+        typedef std::vector<Sound*> SoundVec;
+        SoundVec mActiveSounds;
+        typedef std::vector<Stream*> StreamVec;
+        StreamVec mActiveStreams;
+
+        Null_Output& operator=(const Null_Output &rhs);
+        Null_Output(const Null_Output &rhs);
+
+    public:
+        virtual std::vector<std::string> enumerate();
+        virtual bool init(const std::string &devname, const std::string &hrtfname, HrtfMode hrtfmode);
+        virtual void deinit();
+
+        virtual std::vector<std::string> enumerateHrtf();
+        virtual void setHrtf(const std::string &hrtfname, HrtfMode hrtfmode);
+
+        virtual std::pair<Sound_Handle,size_t> loadSound(const std::string &fname);
+        virtual size_t unloadSound(Sound_Handle data);
+
+        virtual bool playSound(Sound *sound, Sound_Handle data, float offset);
+        virtual bool playSound3D(Sound *sound, Sound_Handle data, float offset);
+        virtual void finishSound(Sound *sound);
+        virtual bool isSoundPlaying(Sound *sound);
+        virtual void updateSound(Sound *sound);
+
+        virtual bool streamSound(DecoderPtr decoder, Stream *sound);
+        virtual bool streamSound3D(DecoderPtr decoder, Stream *sound, bool getLoudnessData);
+        virtual void finishStream(Stream *sound);
+        virtual double getStreamDelay(Stream *sound);
+        virtual double getStreamOffset(Stream *sound);
+        virtual float getStreamLoudness(Stream *sound);
+        virtual bool isStreamPlaying(Stream *sound);
+        virtual void updateStream(Stream *sound);
+
+        virtual void startUpdate();
+        virtual void finishUpdate();
+
+        virtual void updateListener(const osg::Vec3f &pos, const osg::Vec3f &atdir, const osg::Vec3f &updir, Environment env);
+
+        virtual void pauseSounds(int types);
+        virtual void resumeSounds(int types);
+
+        Null_Output();
+        virtual ~Null_Output();
+    };
+}
+
+#endif
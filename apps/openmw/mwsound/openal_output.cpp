@@ -945,7 +945,7 @@ std::pair<Sound_Handle,size_t> OpenAL_Output::loadSound(const std::string &fname
 {
     getALError();
 
-    DecoderPtr decoder = mManager.getDecoder();
+    DecoderPtr decoder = mManager->getDecoder();
     // Workaround: Bethesda at some point converted some of the files to mp3, but the references were kept as .wav.
     if(decoder->mResourceMgr->exists(fname))
         decoder->open(fname);
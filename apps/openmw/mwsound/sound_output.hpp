@@ -27,7 +27,8 @@ namespace MWSound
 
     class Sound_Output
     {
-        SoundManager &mManager;
+        /// NULL for outputs that never decode sounds
+        SoundManager *mManager;
 
         virtual std::vector<std::string> enumerate() = 0;
         virtual bool init(const std::string &devname, const std::string &hrtfname, HrtfMode hrtfmode) = 0;
@@ -69,7 +70,10 @@ namespace MWSound
         bool mInitialized;
 
         Sound_Output(SoundManager &mgr)
-          : mManager(mgr), mInitialized(false)
+          : mManager(&mgr), mInitialized(false)
+        { }
+        Sound_Output()
+          : mManager(nullptr), mInitialized(false)
         { }
     public:
         virtual ~Sound_Output() { }
@@ -26,6 +26,7 @@
 #include "sound.hpp"
 
 #include "openal_output.hpp"
+#include "null_output.hpp"
 #include "ffmpeg_decoder.hpp"
 
 
@@ -34,10 +35,10 @@ namespace MWSound
     // For combining PlayMode and Type flags
     inline int operator|(PlayMode a, Type b) { return static_cast<int>(a) | static_cast<int>(b); }
 
-    SoundManager::SoundManager(const VFS::Manager* vfs, const std::map<std::string, std::string>& fallbackMap, bool useSound)
+    SoundManager::SoundManager(const VFS::Manager* vfs, const std::map<std::string, std::string>& fallbackMap, bool useSound, bool nullOutput)
         : mVFS(vfs)
         , mFallback(fallbackMap)
-        , mOutput(new DEFAULT_OUTPUT(*this))
+        , mOutput(nullOutput ? static_cast<Sound_Output*>(new Null_Output) : new DEFAULT_OUTPUT(*this))
         , mMasterVolume(1.0f)
         , mSFXVolume(1.0f)
         , mMusicVolume(1.0f)
@@ -397,20 +398,8 @@ namespace MWSound
         auto &tracklist = mMusicToPlay[mCurrentPlaylist];
         if (mMusicFiles.find(mCurrentPlaylist) == mMusicFiles.end())
         {
-            const std::map<std::string, VFS::File*>& index = mVFS->getIndex();
-
-            std::string pattern = "Music/" + mCurrentPlaylist;
-            mVFS->normalizeFilename(pattern);
-
-            std::map<std::string, VFS::File*>::const_iterator found = index.lower_bound(pattern);
-            while (found != index.end())
-            {
-                if (found->first.size() >= pattern.size() && found->first.substr(0, pattern.size()) == pattern)
-                    filelist.push_back(found->first);
-                else
-                    break;
-                ++found;
-            }
+            for (const VFS::FileIndex::Entry& entry : mVFS->getFilesWithPrefix("Music/" + mCurrentPlaylist))
+                filelist.push_back(entry.getName());
 
             mMusicFiles[mCurrentPlaylist] = filelist;
         }
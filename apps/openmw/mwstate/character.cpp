@@ -36,14 +36,12 @@ void MWState::Character::addSlot (const boost::filesystem::path& path, const std
     mSlots.push_back (slot);
 }
 
-void MWState::Character::addSlot (const ESM::SavedGame& profile)
+boost::filesystem::path MWState::Character::getNewSlotPath (const std::string& description) const
 {
-    Slot slot;
-
     std::ostringstream stream;
 
     // The profile description is user-supplied, so we need to escape the path
-    for (std::string::const_iterator it = profile.mDescription.begin(); it != profile.mDescription.end(); ++it)
+    for (std::string::const_iterator it = description.begin(); it != description.end(); ++it)
     {
         if (std::isalnum(*it))  // Ignores multibyte characters and non alphanumeric characters
             stream << *it;
@@ -52,22 +50,19 @@ void MWState::Character::addSlot (const ESM::SavedGame& profile)
     }
 
     const std::string ext = ".omwsave";
-    slot.mPath = mPath / (stream.str() + ext);
+    boost::filesystem::path path = mPath / (stream.str() + ext);
 
     // Append an index if necessary to ensure a unique file
     int i=0;
-    while (boost::filesystem::exists(slot.mPath))
+    while (boost::filesystem::exists(path))
     {
            std::ostringstream test;
            test << stream.str();
            test << " - " << ++i;
-           slot.mPath = mPath / (test.str() + ext);
+           path = mPath / (test.str() + ext);
     }
 
-    slot.mProfile = profile;
-    slot.mTimeStamp = std::time (0);
-
-    mSlots.push_back (slot);
+    return path;
 }
 
 MWState::Character::Character (const boost::filesystem::path& saves, const std::string& game)
@@ -84,6 +79,9 @@ MWState::Character::Character (const boost::filesystem::path& saves, const std::
         {
             boost::filesystem::path slotPath = *iter;
 
+            if (slotPath.extension() == ".tmp")
+                continue; // left behind by a save that did not finish
+
             try
             {
                 addSlot (slotPath, game);
@@ -110,9 +108,14 @@ void MWState::Character::cleanup()
     }
 }
 
-const MWState::Slot *MWState::Character::createSlot (const ESM::SavedGame& profile)
+const MWState::Slot *MWState::Character::createSlot (const boost::filesystem::path& path, const ESM::SavedGame& profile)
 {
-    addSlot (profile);
+    Slot slot;
+    slot.mPath = path;
+    slot.mProfile = profile;
+    slot.mTimeStamp = std::time (0);
+
+    mSlots.push_back (slot);
 
     return &mSlots.back();
 }
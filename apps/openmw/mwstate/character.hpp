@@ -29,8 +29,6 @@ namespace MWState
 
             void addSlot (const boost::filesystem::path& path, const std::string& game);
 
-            void addSlot (const ESM::SavedGame& profile);
-
         public:
 
             Character (const boost::filesystem::path& saves, const std::string& game);
@@ -38,8 +36,11 @@ namespace MWState
             void cleanup();
             ///< Delete the directory we used, if it is empty
 
-            const Slot *createSlot (const ESM::SavedGame& profile);
-            ///< Create new slot.
+            boost::filesystem::path getNewSlotPath (const std::string& description) const;
+            ///< Return a path for a new slot with \a description, that no existing file uses.
+
+            const Slot *createSlot (const boost::filesystem::path& path, const ESM::SavedGame& profile);
+            ///< Create new slot for a file that has been written to \a path.
             ///
             /// \attention The ownership of the slot is not transferred.
 
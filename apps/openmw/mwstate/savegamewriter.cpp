@@ -0,0 +1,131 @@
+#include "savegamewriter.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+
+#include <osg/Image>
+
+#include <osgDB/Registry>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/operations.hpp>
+
+#include <components/esm/esmwriter.hpp>
+#include <components/esm/defs.hpp>
+
+MWState::SaveGameWriter::SaveGameWriter (const boost::filesystem::path& path, const ESM::SavedGame& profile,
+    osg::ref_ptr<osg::Image> screenshot, const std::vector<std::string>& masters, int recordCount, const std::string& records)
+: mPath (path), mProfile (profile), mScreenshot (screenshot), mMasters (masters), mRecordCount (recordCount), mRecords (records)
+{
+}
+
+void MWState::SaveGameWriter::doWork()
+{
+    try
+    {
+        encodeScreenshot();
+        writeFile();
+    }
+    catch (const std::exception& e)
+    {
+        mError = e.what();
+    }
+
+    // no longer needed, and may be large
+    mScreenshot = NULL;
+    std::string().swap (mRecords);
+}
+
+const boost::filesystem::path& MWState::SaveGameWriter::getPath() const
+{
+    return mPath;
+}
+
+const ESM::SavedGame& MWState::SaveGameWriter::getProfile() const
+{
+    return mProfile;
+}
+
+const std::string& MWState::SaveGameWriter::getError() const
+{
+    return mError;
+}
+
+void MWState::SaveGameWriter::encodeScreenshot()
+{
+    if (!mScreenshot)
+        return;
+
+    osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("jpg");
+    if (!readerwriter)
+    {
+        std::cerr << "Error: Unable to write screenshot, can't find a jpg ReaderWriter" << std::endl;
+        return;
+    }
+
+    std::ostringstream ostream;
+    osgDB::ReaderWriter::WriteResult result = readerwriter->writeImage(*mScreenshot, ostream);
+    if (!result.success())
+    {
+        std::cerr << "Error: Unable to write screenshot: " << result.message() << " code " << result.status() << std::endl;
+        return;
+    }
+
+    std::string data = ostream.str();
+    mProfile.mScreenshot = std::vector<char>(data.begin(), data.end());
+}
+
+void MWState::SaveGameWriter::writeFile()
+{
+    boost::filesystem::path tempPath = mPath;
+    tempPath += ".tmp";
+
+    {
+        boost::filesystem::ofstream filestream (tempPath, std::ios::binary);
+
+        ESM::ESMWriter writer;
+
+        for (std::vector<std::string>::const_iterator iter (mMasters.begin()); iter!=mMasters.end(); ++iter)
+            writer.addMaster (*iter, 0); // not using the size information anyway -> use value of 0
+
+        writer.setFormat (ESM::SavedGame::sCurrentFormat);
+
+        // all unused
+        writer.setVersion(0);
+        writer.setType(0);
+        writer.setAuthor("");
+        writer.setDescription("");
+
+        writer.setRecordCount (mRecordCount);
+
+        writer.save (filestream);
+
+        writer.startRecord (ESM::REC_SAVE);
+        mProfile.save (writer);
+        writer.endRecord (ESM::REC_SAVE);
+
+        writer.write (mRecords.data(), mRecords.size());
+
+        writer.close();
+
+        filestream.flush();
+        if (filestream.fail())
+        {
+            filestream.close();
+            boost::system::error_code error;
+            boost::filesystem::remove (tempPath, error);
+            throw std::runtime_error("Write operation failed (file stream)");
+        }
+    }
+
+    // Replace the previous file only once the new one is complete
+    boost::system::error_code error;
+    boost::filesystem::rename (tempPath, mPath, error);
+    if (error)
+    {
+        boost::system::error_code removeError;
+        boost::filesystem::remove (tempPath, removeError);
+        throw std::runtime_error("Failed to replace " + mPath.string() + ": " + error.message());
+    }
+}
@@ -0,0 +1,66 @@
+#ifndef GAME_STATE_SAVEGAMEWRITER_H
+#define GAME_STATE_SAVEGAMEWRITER_H
+
+#include <string>
+#include <vector>
+
+#include <boost/filesystem/path.hpp>
+
+#include <osg/ref_ptr>
+
+#include <components/esm/savedgame.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+namespace osg
+{
+    class Image;
+}
+
+namespace MWState
+{
+    /// @brief Finishes a saved game that has been serialized to memory, usually on a background thread.
+    /// @par Encodes the screenshot and writes the file under a temporary name first, then renames it to the slot's path,
+    /// so that a failed save never replaces the previous file with a broken one.
+    class SaveGameWriter : public SceneUtil::WorkItem
+    {
+        public:
+
+            /// @param profile The profile of the saved game, without the screenshot.
+            /// @param screenshot Raw screenshot to encode into the profile, may be NULL.
+            /// @param masters Content files of the game.
+            /// @param recordCount Number of records in the file, not counting the header.
+            /// @param records All records following the profile, as written by ESM::ESMWriter::saveRecords.
+            SaveGameWriter (const boost::filesystem::path& path, const ESM::SavedGame& profile, osg::ref_ptr<osg::Image> screenshot,
+                const std::vector<std::string>& masters, int recordCount, const std::string& records);
+
+            virtual const char* getName() const { return "Save game"; }
+
+            virtual void doWork();
+
+            const boost::filesystem::path& getPath() const;
+
+            /// The profile including the encoded screenshot.
+            /// @note Only valid once the item is done.
+            const ESM::SavedGame& getProfile() const;
+
+            /// Why saving failed, empty if the game was saved.
+            /// @note Only valid once the item is done.
+            const std::string& getError() const;
+
+        private:
+
+            void encodeScreenshot();
+
+            void writeFile();
+
+            boost::filesystem::path mPath;
+            ESM::SavedGame mProfile;
+            osg::ref_ptr<osg::Image> mScreenshot;
+            std::vector<std::string> mMasters;
+            int mRecordCount;
+            std::string mRecords;
+            std::string mError;
+    };
+}
+
+#endif
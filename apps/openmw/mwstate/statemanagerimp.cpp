@@ -11,9 +11,6 @@
 
 #include <osg/Image>
 
-#include <osgDB/Registry>
-
-#include <boost/filesystem/fstream.hpp>
 #include <boost/filesystem/operations.hpp>
 
 #include "../mwbase/environment.hpp"
@@ -37,6 +34,8 @@
 
 #include "../mwscript/globalscripts.hpp"
 
+#include "savegamewriter.hpp"
+
 void MWState::StateManager::cleanup (bool force)
 {
     if (mState!=State_NoGame || force)
@@ -44,7 +43,7 @@ void MWState::StateManager::cleanup (bool force)
         MWBase::Environment::get().getSoundManager()->clear();
         MWBase::Environment::get().getDialogueManager()->clear();
         MWBase::Environment::get().getJournal()->clear();
-        MWBase::Environment::get().getScriptManager()->getGlobalScripts().clear();
+        MWBase::Environment::get().getScriptManager()->clear();
         MWBase::Environment::get().getWorld()->clear();
         MWBase::Environment::get().getWindowManager()->clear();
         MWBase::Environment::get().getInputManager()->clear();
@@ -83,12 +82,25 @@ std::map<int, int> MWState::StateManager::buildContentFileIndexMap (const ESM::E
     return map;
 }
 
-MWState::StateManager::StateManager (const boost::filesystem::path& saves, const std::string& game)
+MWState::StateManager::StateManager (const boost::filesystem::path& saves, const std::string& game, bool headless)
 : mQuitRequest (false), mAskLoadRecent(false), mState (State_NoGame), mCharacterManager (saves, game), mTimePlayed (0)
+, mHeadless (headless)
+, mSaveQueue (new SceneUtil::WorkQueue (1)), mPendingSaveCharacter (NULL)
 {
 
 }
 
+MWState::StateManager::~StateManager()
+{
+    // Don't quit before the last save is on disk. There is no UI left to report errors to.
+    if (mPendingSave)
+    {
+        mPendingSave->waitTillDone();
+        if (!mPendingSave->getError().empty())
+            std::cerr << "Failed to save game: " << mPendingSave->getError() << std::endl;
+    }
+}
+
 void MWState::StateManager::requestQuit()
 {
     mQuitRequest = true;
@@ -173,6 +185,14 @@ void MWState::StateManager::endGame()
 
 void MWState::StateManager::saveGame (const std::string& description, const Slot *slot)
 {
+    saveGame (description, slot, false);
+}
+
+void MWState::StateManager::saveGame (const std::string& description, const Slot *slot, bool async)
+{
+    // One save at a time, also because finishing the previous one may still update the slots
+    finishSaveGame (true);
+
     MWState::Character* character = getCurrentCharacter();
 
     try
@@ -212,37 +232,24 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         profile.mTimePlayed = mTimePlayed;
         profile.mDescription = description;
 
-        writeScreenshot(profile.mScreenshot);
+        // Encoded into the profile by the SaveGameWriter
+        osg::ref_ptr<osg::Image> screenshot = takeScreenshot();
 
-        if (!slot)
-            slot = character->createSlot (profile);
-        else
-            slot = character->updateSlot (slot, profile);
+        // The slot is only created or updated once the file is written
+        boost::filesystem::path path = slot ? slot->mPath : character->getNewSlotPath (description);
 
         // Make sure the animation state held by references is up to date before saving the game.
         MWBase::Environment::get().getMechanicsManager()->persistAnimationStates();
 
-        // Write to a memory stream first. If there is an exception during the save process, we don't want to trash the
-        // existing save file we are overwriting.
+        // Take a snapshot of the game state into a memory stream. This has to happen on the main thread, while encoding
+        // the screenshot and writing the file is left to the SaveGameWriter. If there is an exception during the save process,
+        // we don't want to trash the existing save file we are overwriting.
         std::stringstream stream;
 
         ESM::ESMWriter writer;
 
-        const std::vector<std::string>& current =
-            MWBase::Environment::get().getWorld()->getContentFiles();
-
-        for (std::vector<std::string>::const_iterator iter (current.begin()); iter!=current.end();
-            ++iter)
-            writer.addMaster (*iter, 0); // not using the size information anyway -> use value of 0
-
         writer.setFormat (ESM::SavedGame::sCurrentFormat);
 
-        // all unused
-        writer.setVersion(0);
-        writer.setType(0);
-        writer.setAuthor("");
-        writer.setDescription("");
-
         int recordCount =         1 // saved game header
                 +MWBase::Environment::get().getJournal()->countSavedGameRecords()
                 +MWBase::Environment::get().getWorld()->countSavedGameRecords()
@@ -251,9 +258,8 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
                 +MWBase::Environment::get().getWindowManager()->countSavedGameRecords()
                 +MWBase::Environment::get().getMechanicsManager()->countSavedGameRecords()
                 +MWBase::Environment::get().getInputManager()->countSavedGameRecords();
-        writer.setRecordCount (recordCount);
 
-        writer.save (stream);
+        writer.saveRecords (stream);
 
         Loading::Listener& listener = *MWBase::Environment::get().getWindowManager()->getLoadingScreen();
         // Using only Cells for progress information, since they typically have the largest records by far
@@ -262,10 +268,6 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
 
         Loading::ScopedLoad load(&listener);
 
-        writer.startRecord (ESM::REC_SAVE);
-        slot->mProfile.save (writer);
-        writer.endRecord (ESM::REC_SAVE);
-
         MWBase::Environment::get().getJournal()->write (writer, listener);
         MWBase::Environment::get().getDialogueManager()->write (writer, listener);
         MWBase::Environment::get().getWorld()->write (writer, listener);
@@ -274,43 +276,85 @@ void MWState::StateManager::saveGame (const std::string& description, const Slot
         MWBase::Environment::get().getMechanicsManager()->write(writer, listener);
         MWBase::Environment::get().getInputManager()->write(writer, listener);
 
-        // Ensure we have written the number of records that was estimated
-        if (writer.getRecordCount() != recordCount+1) // 1 extra for TES3 record
-            std::cerr << "Warning: number of written savegame records does not match. Estimated: " << recordCount+1 << ", written: " << writer.getRecordCount() << std::endl;
+        // Ensure we have written the number of records that was estimated, apart from the saved game header written by the SaveGameWriter
+        const int estimatedRecordCount = recordCount - 1;
+        if (writer.getRecordCount() != estimatedRecordCount)
+            std::cerr << "Warning: number of written savegame records does not match. Estimated: " << estimatedRecordCount << ", written: " << writer.getRecordCount() << std::endl;
 
         writer.close();
 
         if (stream.fail())
             throw std::runtime_error("Write operation failed (memory stream)");
 
-        // All good, write to file
-        boost::filesystem::ofstream filestream (slot->mPath, std::ios::binary);
-        filestream << stream.rdbuf();
-
-        if (filestream.fail())
-            throw std::runtime_error("Write operation failed (file stream)");
-
-        Settings::Manager::setString ("character", "Saves",
-            slot->mPath.parent_path().filename().string());
+        mPendingSave = new SaveGameWriter (path, profile, screenshot, world.getContentFiles(), recordCount, stream.str());
+        mPendingSaveCharacter = character;
     }
     catch (const std::exception& e)
     {
-        std::stringstream error;
-        error << "Failed to save game: " << e.what();
+        reportSaveError (e.what(), character);
+        return;
+    }
 
-        std::cerr << error.str() << std::endl;
+    mSaveQueue->addWorkItem (mPendingSave);
 
-        std::vector<std::string> buttons;
-        buttons.push_back("#{sOk}");
-        MWBase::Environment::get().getWindowManager()->interactiveMessageBox(error.str(), buttons);
+    if (!async)
+        finishSaveGame (true);
+}
 
-        // If no file was written, clean up the slot
-        if (character && slot && !boost::filesystem::exists(slot->mPath))
-        {
-            character->deleteSlot(slot);
-            character->cleanup();
-        }
+void MWState::StateManager::finishSaveGame (bool wait)
+{
+    if (!mPendingSave)
+        return;
+
+    if (!mPendingSave->isDone())
+    {
+        if (!wait)
+            return;
+        mPendingSave->waitTillDone();
+    }
+
+    osg::ref_ptr<SaveGameWriter> save = mPendingSave;
+    mPendingSave = NULL;
+    Character* character = mPendingSaveCharacter;
+    mPendingSaveCharacter = NULL;
+
+    const Slot* slot = NULL;
+    for (Character::SlotIterator it = character->begin(); it != character->end(); ++it)
+    {
+        if (it->mPath == save->getPath())
+            slot = &*it;
+    }
+
+    if (!save->getError().empty())
+    {
+        reportSaveError (save->getError(), character);
+        return;
     }
+
+    // the profile now includes the screenshot
+    if (slot)
+        character->updateSlot (slot, save->getProfile());
+    else
+        character->createSlot (save->getPath(), save->getProfile());
+
+    Settings::Manager::setString ("character", "Saves",
+        save->getPath().parent_path().filename().string());
+}
+
+void MWState::StateManager::reportSaveError (const std::string& message, Character* character)
+{
+    std::stringstream error;
+    error << "Failed to save game: " << message;
+
+    std::cerr << error.str() << std::endl;
+
+    std::vector<std::string> buttons;
+    buttons.push_back("#{sOk}");
+    MWBase::Environment::get().getWindowManager()->interactiveMessageBox(error.str(), buttons);
+
+    // If the first save of a character failed, clean up its directory
+    if (character)
+        character->cleanup();
 }
 
 void MWState::StateManager::quickSave (std::string name)
@@ -324,6 +368,9 @@ void MWState::StateManager::quickSave (std::string name)
         return;
     }
 
+    // Finish a previous quicksave first, which may still update the slots
+    finishSaveGame (true);
+
     const Slot* slot = NULL;
     Character* currentCharacter = getCurrentCharacter(); //Get current character
 
@@ -337,7 +384,7 @@ void MWState::StateManager::quickSave (std::string name)
         }
     }
 
-    saveGame(name, slot);
+    saveGame(name, slot, true);
 }
 
 void MWState::StateManager::loadGame(const std::string& filepath)
@@ -362,6 +409,9 @@ void MWState::StateManager::loadGame(const std::string& filepath)
 
 void MWState::StateManager::loadGame (const Character *character, const std::string& filepath)
 {
+    // The file may still be being written
+    finishSaveGame (true);
+
     try
     {
         cleanup();
@@ -560,6 +610,8 @@ void MWState::StateManager::quickLoad()
 
 void MWState::StateManager::deleteGame(const MWState::Character *character, const MWState::Slot *slot)
 {
+    finishSaveGame (true);
+
     mCharacterManager.deleteSlot(character, slot);
 }
 
@@ -582,6 +634,8 @@ void MWState::StateManager::update (float duration)
 {
     mTimePlayed += duration;
 
+    finishSaveGame (false);
+
     // Note: It would be nicer to trigger this from InputManager, i.e. the very beginning of the frame update.
     if (mAskLoadRecent)
     {
@@ -630,30 +684,18 @@ bool MWState::StateManager::verifyProfile(const ESM::SavedGame& profile) const
     return true;
 }
 
-void MWState::StateManager::writeScreenshot(std::vector<char> &imageData) const
+osg::ref_ptr<osg::Image> MWState::StateManager::takeScreenshot() const
 {
+    if (mHeadless)
+        return NULL;
+
     int screenshotW = 259*2, screenshotH = 133*2; // *2 to get some nice antialiasing
 
     osg::ref_ptr<osg::Image> screenshot (new osg::Image);
 
-    MWBase::Environment::get().getWorld()->screenshot(screenshot.get(), screenshotW, screenshotH);
-
-    osgDB::ReaderWriter* readerwriter = osgDB::Registry::instance()->getReaderWriterForExtension("jpg");
-    if (!readerwriter)
-    {
-        std::cerr << "Error: Unable to write screenshot, can't find a jpg ReaderWriter" << std::endl;
-        return;
-    }
-
-    std::ostringstream ostream;
-    osgDB::ReaderWriter::WriteResult result = readerwriter->writeImage(*screenshot, ostream);
-    if (!result.success())
-    {
-        std::cerr << "Error: Unable to write screenshot: " << result.message() << " code " << result.status() << std::endl;
-        return;
-    }
-
-    std::string data = ostream.str();
-    imageData = std::vector<char>(data.begin(), data.end());
+    // Save without a screenshot rather than waiting for a frame that is never drawn
+    if (!MWBase::Environment::get().getWorld()->screenshot(screenshot.get(), screenshotW, screenshotH))
+        return NULL;
 
+    return screenshot;
 }
@@ -7,10 +7,24 @@
 
 #include <boost/filesystem/path.hpp>
 
+#include <osg/ref_ptr>
+
 #include "charactermanager.hpp"
 
+namespace osg
+{
+    class Image;
+}
+
+namespace SceneUtil
+{
+    class WorkQueue;
+}
+
 namespace MWState
 {
+    class SaveGameWriter;
+
     class StateManager : public MWBase::StateManager
     {
             bool mQuitRequest;
@@ -18,6 +32,14 @@ namespace MWState
             State mState;
             CharacterManager mCharacterManager;
             double mTimePlayed;
+            /// No frames are drawn to take screenshots from
+            bool mHeadless;
+
+            /// Thread for writing saved games
+            osg::ref_ptr<SceneUtil::WorkQueue> mSaveQueue;
+            /// Save that is being written, if any
+            osg::ref_ptr<SaveGameWriter> mPendingSave;
+            Character* mPendingSaveCharacter;
 
         private:
 
@@ -25,13 +47,28 @@ namespace MWState
 
             bool verifyProfile (const ESM::SavedGame& profile) const;
 
-            void writeScreenshot (std::vector<char>& imageData) const;
+            /// @return NULL if no screenshot could be taken
+            osg::ref_ptr<osg::Image> takeScreenshot() const;
+
+            void saveGame (const std::string& description, const Slot *slot, bool async);
+            ///< Take a snapshot of the game, and write it to \a slot or a new slot on the save thread.
+            ///
+            /// \param async Return as soon as the snapshot is taken, and report the result from update().
+
+            void finishSaveGame (bool wait);
+            ///< Report the result of a pending save and create or update its slot, once it is written.
+            ///
+            /// \param wait Block until the pending save is written.
+
+            void reportSaveError (const std::string& message, Character* character);
 
             std::map<int, int> buildContentFileIndexMap (const ESM::ESMReader& reader) const;
 
         public:
 
-            StateManager (const boost::filesystem::path& saves, const std::string& game);
+            StateManager (const boost::filesystem::path& saves, const std::string& game, bool headless);
+
+            virtual ~StateManager();
 
             virtual void requestQuit();
 
@@ -57,7 +94,8 @@ namespace MWState
             /// \note Slot must belong to the current character.
 
             ///Saves a file, using supplied filename, overwritting if needed
-            /** This is mostly used for quicksaving and autosaving, for they use the same name over and over again
+            /** This is mostly used for quicksaving and autosaving, for they use the same name over and over again.
+                The file is written in the background, so that the game only pauses for taking a snapshot.
                 \param name Name of save, defaults to "Quicksave"**/
             virtual void quickSave(std::string name = "Quicksave");
 
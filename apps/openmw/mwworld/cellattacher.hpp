@@ -0,0 +1,100 @@
+#ifndef GAME_MWWORLD_CELLATTACHER_H
+#define GAME_MWWORLD_CELLATTACHER_H
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+namespace MWWorld
+{
+    /// \brief Inserts the objects of a cell into the scene over several frames.
+    ///
+    /// The cell is active while it is attached, but its own scripts do not run yet. Scripts of other cells may enable,
+    /// disable, delete, place or move its objects meanwhile. Objects that are in the scene already are not inserted again,
+    /// objects that move to another cell must be forgotten, and finish() brings the scene in line with the state of the
+    /// objects before the scripts of the cell start.
+    ///
+    /// The \a Scene passed to the functions provides, for objects of type \a Object:
+    /// - bool isInScene (const Object&)
+    /// - bool shouldBeInScene (const Object&): enabled and not deleted
+    /// - void insert (const Object&): only called for objects that are not in the scene and should be
+    /// - void remove (const Object&): only called for objects that are in the scene and should not be
+    template <class Object>
+    class CellAttacher
+    {
+        public:
+
+            CellAttacher() : mNext (0) {}
+
+            /// Objects to insert, in order
+            CellAttacher (const std::vector<Object>& objects) : mObjects (objects), mNext (0) {}
+
+            bool isDone() const { return mNext >= mObjects.size(); }
+
+            /// Insert the next object, unless it is in the scene already or should not be.
+            /// \return The object
+            /// \attention Must not be called once isDone().
+            template <class Scene>
+            const Object& attachNext (Scene& scene)
+            {
+                const Object& object = mObjects[mNext++];
+                if (scene.shouldBeInScene (object) && !scene.isInScene (object))
+                    scene.insert (object);
+                return object;
+            }
+
+            /// Neither insert nor check \a object any more, as it moves to another cell.
+            /// \return Was it still to be inserted?
+            bool forget (const Object& object)
+            {
+                typename std::vector<Object>::iterator found = std::find (mObjects.begin(), mObjects.end(), object);
+                if (found == mObjects.end())
+                    return false;
+
+                const std::size_t index = static_cast<std::size_t> (found - mObjects.begin());
+                mObjects.erase (found);
+                if (index >= mNext)
+                    return true;
+                --mNext;
+                return false;
+            }
+
+            /// Bring the scene in line with the state the objects were left in by scripts while attaching: insert those
+            /// that should be in the scene and are not, e.g. enabled or placed while attaching, and remove those that are
+            /// and should not be, e.g. disabled or deleted while attaching.
+            /// \param objects The objects now in the cell. Deleted objects are not listed, so the objects passed to the
+            /// constructor are checked as well.
+            template <class Scene>
+            void finish (Scene& scene, const std::vector<Object>& objects)
+            {
+                reconcile (scene, mObjects);
+                reconcile (scene, objects);
+
+                mObjects.clear();
+                mNext = 0;
+            }
+
+        private:
+
+            template <class Scene>
+            static void reconcile (Scene& scene, const std::vector<Object>& objects)
+            {
+                for (typename std::vector<Object>::const_iterator it = objects.begin(); it != objects.end(); ++it)
+                {
+                    const bool inScene = scene.isInScene (*it);
+                    if (scene.shouldBeInScene (*it))
+                    {
+                        if (!inScene)
+                            scene.insert (*it);
+                    }
+                    else if (inScene)
+                        scene.remove (*it);
+                }
+            }
+
+            std::vector<Object> mObjects;
+            std::size_t mNext;
+    };
+}
+
+#endif
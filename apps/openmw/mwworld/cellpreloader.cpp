@@ -88,6 +88,8 @@ namespace MWWorld
         }
 
         /// Preload work to be called from the worker thread.
+        virtual const char* getName() const { return "Cell preload"; }
+
         virtual void doWork()
         {
             if (mIsExterior)
@@ -178,6 +180,8 @@ namespace MWWorld
         {
         }
 
+        virtual const char* getName() const { return "Resource cache update"; }
+
         virtual void doWork()
         {
             mResourceSystem->updateCache(mReferenceTime);
@@ -205,7 +209,7 @@ namespace MWWorld
     {
         if (mTerrainPreloadItem)
         {
-            mTerrainPreloadItem->abort();
+            mTerrainPreloadItem->cancel();
             mTerrainPreloadItem->waitTillDone();
             mTerrainPreloadItem = NULL;
         }
@@ -217,7 +221,7 @@ namespace MWWorld
         }
 
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();++it)
-            it->second.mWorkItem->abort();
+            it->second.mWorkItem->cancel();
 
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();++it)
             it->second.mWorkItem->waitTillDone();
@@ -225,7 +229,7 @@ namespace MWWorld
         mPreloadCells.clear();
     }
 
-    void CellPreloader::preload(CellStore *cell, double timestamp)
+    void CellPreloader::preload(CellStore *cell, double timestamp, float distance)
     {
         if (!mWorkQueue)
         {
@@ -263,7 +267,7 @@ namespace MWWorld
 
             if (oldestTimestamp + threshold < timestamp)
             {
-                oldestCell->second.mWorkItem->abort();
+                oldestCell->second.mWorkItem->cancel();
                 mPreloadCells.erase(oldestCell);
             }
             else
@@ -271,6 +275,7 @@ namespace MWWorld
         }
 
         osg::ref_ptr<PreloadItem> item (new PreloadItem(cell, mResourceSystem->getSceneManager(), mBulletShapeManager, mResourceSystem->getKeyframeManager(), mTerrain, mLandManager, mPreloadInstances));
+        item->setPriority(-distance);
         mWorkQueue->addWorkItem(item);
 
         mPreloadCells[cell] = PreloadEntry(timestamp, item);
@@ -284,7 +289,7 @@ namespace MWWorld
             // do the deletion in the background thread
             if (found->second.mWorkItem)
             {
-                found->second.mWorkItem->abort();
+                found->second.mWorkItem->cancel();
                 mUnrefQueue->push(mPreloadCells[cell].mWorkItem);
             }
 
@@ -292,13 +297,21 @@ namespace MWWorld
         }
     }
 
+    const SceneUtil::WorkItem* CellPreloader::getWorkItem(const CellStore* cell) const
+    {
+        PreloadMap::const_iterator found = mPreloadCells.find(cell);
+        if (found == mPreloadCells.end())
+            return NULL;
+        return found->second.mWorkItem.get();
+    }
+
     void CellPreloader::clear()
     {
         for (PreloadMap::iterator it = mPreloadCells.begin(); it != mPreloadCells.end();)
         {
             if (it->second.mWorkItem)
             {
-                it->second.mWorkItem->abort();
+                it->second.mWorkItem->cancel();
                 mUnrefQueue->push(it->second.mWorkItem);
             }
 
@@ -314,7 +327,7 @@ namespace MWWorld
             {
                 if (it->second.mWorkItem)
                 {
-                    it->second.mWorkItem->abort();
+                    it->second.mWorkItem->cancel();
                     mUnrefQueue->push(it->second.mWorkItem);
                 }
                 mPreloadCells.erase(it++);
@@ -378,6 +391,8 @@ namespace MWWorld
         {
         }
 
+        virtual const char* getName() const { return "Terrain preload"; }
+
         virtual void doWork()
         {
             for (unsigned int i=0; i<mTerrainViews.size() && i<mPreloadPositions.size() && !mAbort; ++i)
@@ -39,11 +39,15 @@ namespace MWWorld
         ~CellPreloader();
 
         /// Ask a background thread to preload rendering meshes and collision shapes for objects in this cell.
+        /// @param distance How far the player is from the cell; closer cells are preloaded first.
         /// @note The cell itself must be in State_Loaded or State_Preloaded.
-        void preload(MWWorld::CellStore* cell, double timestamp);
+        void preload(MWWorld::CellStore* cell, double timestamp, float distance = 0.f);
 
         void notifyLoaded(MWWorld::CellStore* cell);
 
+        /// The item that preloads this cell in the background, or NULL if the cell is not being preloaded.
+        const SceneUtil::WorkItem* getWorkItem(const MWWorld::CellStore* cell) const;
+
         void clear();
 
         /// Removes preloaded cells that have not had a preload request for a while.
@@ -0,0 +1,72 @@
+#ifndef GAME_MWWORLD_CELLREFINDEX_H
+#define GAME_MWWORLD_CELLREFINDEX_H
+
+#include <algorithm>
+#include <string>
+#include <vector>
+
+#include "recordmap.hpp"
+
+namespace MWWorld
+{
+    /// \brief Index from reference ID to the cells that may hold a reference with that ID
+    ///
+    /// The references of the content files are indexed once, after loading. References that are moved to another cell
+    /// or created at runtime are added as that happens, and dropped again by clearRuntimeRefs() when the game is cleared.
+    /// A cell stays listed when a reference leaves it, as other references with the same ID may still be there, so the
+    /// index may list cells that no longer hold a reference, but never misses one.
+    template <class Cell>
+    class CellRefIndex
+    {
+        public:
+
+            typedef std::vector<const Cell *> CellList;
+            typedef RecordMap<CellList> Map;
+
+            /// Replace the content file references with \a refs, which are left with the previous ones.
+            void swapContentRefs (Map& refs)
+            {
+                mContentRefs.swap (refs);
+            }
+
+            /// A reference with \a id was moved to or created in \a cell.
+            void addRuntimeRef (const std::string& id, const Cell *cell)
+            {
+                if (mayHaveRef (id, cell))
+                    return;
+                mRuntimeRefs[id].push_back (cell);
+            }
+
+            void clearRuntimeRefs()
+            {
+                mRuntimeRefs.clear();
+            }
+
+            /// Append the cells that may hold a reference with \a id: the content file cells in the order they were
+            /// indexed in, then the cells that references were moved to or created in, in the order that happened in.
+            void getCells (const std::string& id, CellList& out) const
+            {
+                if (const CellList *cells = mContentRefs.search (id))
+                    out.insert (out.end(), cells->begin(), cells->end());
+                if (const CellList *cells = mRuntimeRefs.search (id))
+                    out.insert (out.end(), cells->begin(), cells->end());
+            }
+
+            bool mayHaveRef (const std::string& id, const Cell *cell) const
+            {
+                return contains (mContentRefs.search (id), cell) || contains (mRuntimeRefs.search (id), cell);
+            }
+
+        private:
+
+            static bool contains (const CellList *cells, const Cell *cell)
+            {
+                return cells && std::find (cells->begin(), cells->end(), cell) != cells->end();
+            }
+
+            Map mContentRefs;
+            Map mRuntimeRefs;
+    };
+}
+
+#endif
@@ -1,13 +1,18 @@
 #include "cells.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <memory>
+#include <set>
 
 #include <components/esm/esmreader.hpp>
 #include <components/esm/esmwriter.hpp>
 #include <components/esm/defs.hpp>
 #include <components/esm/cellstate.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
+#include <components/sceneutil/workqueue.hpp>
 #include <components/settings/settings.hpp>
+#include <components/to_utf8/to_utf8.hpp>
 
 #include "../mwbase/environment.hpp"
 #include "../mwbase/world.hpp"
@@ -17,6 +22,121 @@
 #include "containerstore.hpp"
 #include "cellstore.hpp"
 
+namespace
+{
+    typedef MWWorld::CellRefIndex<ESM::Cell>::Map RefIndex;
+
+    void fillRefIndex (const std::vector<const ESM::Cell *>& cells, std::vector<ESM::ESMReader>& readers, RefIndex& index)
+    {
+        std::vector<std::string> ids;
+        for (std::vector<const ESM::Cell *>::const_iterator cell = cells.begin(); cell != cells.end(); ++cell)
+        {
+            ids.clear();
+            MWWorld::CellStore::listRefs (*cell, readers, ids);
+
+            std::sort (ids.begin(), ids.end());
+            ids.erase (std::unique (ids.begin(), ids.end()), ids.end());
+
+            for (std::vector<std::string>::const_iterator id = ids.begin(); id != ids.end(); ++id)
+                index[*id].push_back (*cell);
+        }
+    }
+
+    /// Reads the content files on a worker thread, with its own copies of the readers, as the main thread keeps using
+    /// the original ones to load cells
+    class ReaderWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        ReaderWorkItem (const std::vector<ESM::ESMReader>& readers, const ToUTF8::Utf8Encoder* encoder)
+            : mReaders (readers)
+        {
+            // The encoder keeps a conversion buffer, so the worker needs its own
+            if (encoder)
+                mEncoder.reset (new ToUTF8::Utf8Encoder (*encoder));
+
+            for (std::vector<ESM::ESMReader>::iterator it = mReaders.begin(); it != mReaders.end(); ++it)
+            {
+                it->setEncoder (mEncoder.get());
+                // Reopened by the cells' contexts
+                it->close();
+            }
+        }
+
+    protected:
+        std::vector<ESM::ESMReader> mReaders;
+
+    private:
+        std::unique_ptr<ToUTF8::Utf8Encoder> mEncoder;
+    };
+
+    /// Lists the references of the content files' cells
+    class RefIndexWorkItem : public ReaderWorkItem
+    {
+    public:
+        RefIndexWorkItem (const std::vector<const ESM::Cell *>& cells, const std::vector<ESM::ESMReader>& readers,
+                          const ToUTF8::Utf8Encoder* encoder)
+            : ReaderWorkItem (readers, encoder)
+            , mCells (cells)
+        {
+        }
+
+        virtual const char* getName() const { return "Reference index"; }
+
+        virtual void doWork()
+        {
+            fillRefIndex (mCells, mReaders, mIndex);
+        }
+
+        RefIndex& getIndex() { return mIndex; }
+
+    private:
+        std::vector<const ESM::Cell *> mCells;
+        RefIndex mIndex;
+    };
+
+    /// Reads the references of a cell, for MWWorld::CellStore::load
+    class CellLoadWorkItem : public ReaderWorkItem
+    {
+    public:
+        CellLoadWorkItem (const ESM::Cell *cell, const std::vector<ESM::ESMReader>& readers,
+                          const ToUTF8::Utf8Encoder* encoder)
+            : ReaderWorkItem (readers, encoder)
+            , mCell (cell)
+        {
+        }
+
+        virtual const char* getName() const { return "Cell reference loading"; }
+
+        virtual void doWork()
+        {
+            MWWorld::CellStore::readRefs (mCell, mReaders, mRefs);
+            // no longer needed, and hold the buffers of the files
+            std::vector<ESM::ESMReader>().swap (mReaders);
+        }
+
+        MWWorld::CellStore::RefRecords& getRefs() { return mRefs; }
+
+    private:
+        const ESM::Cell *mCell;
+        MWWorld::CellStore::RefRecords mRefs;
+    };
+
+    /// The cells of the content files, exteriors first. Cells created at runtime do not have any references to index.
+    std::vector<const ESM::Cell *> getContentCells (const MWWorld::ESMStore& store)
+    {
+        const MWWorld::Store<ESM::Cell> &cells = store.get<ESM::Cell>();
+
+        std::vector<const ESM::Cell *> ordered;
+        for (MWWorld::Store<ESM::Cell>::iterator iter = cells.extBegin(); iter != cells.extEnd(); ++iter)
+            if (!iter->mContextList.empty())
+                ordered.push_back (&*iter);
+        for (MWWorld::Store<ESM::Cell>::iterator iter = cells.intBegin(); iter != cells.intEnd(); ++iter)
+            if (!iter->mContextList.empty())
+                ordered.push_back (&*iter);
+        return ordered;
+    }
+}
+
 MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
 {
     if (cell->mData.mFlags & ESM::Cell::Interior)
@@ -49,8 +169,14 @@ MWWorld::CellStore *MWWorld::Cells::getCellStore (const ESM::Cell *cell)
 
 void MWWorld::Cells::clear()
 {
+    // The items only read the cells of the store, so they can finish on their own
+    for (std::map<const CellStore *, osg::ref_ptr<SceneUtil::WorkItem> >::iterator it = mLoadItems.begin(); it != mLoadItems.end(); ++it)
+        it->second->cancel();
+    mLoadItems.clear();
+
     mInteriors.clear();
     mExteriors.clear();
+    mRefIndex.clearRuntimeRefs();
     std::fill(mIdCache.begin(), mIdCache.end(), std::make_pair("", (MWWorld::CellStore*)0));
     mIdCacheIndex = 0;
 }
@@ -72,8 +198,7 @@ MWWorld::Ptr MWWorld::Cells::getPtrAndCache (const std::string& name, CellStore&
 
 void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
 {
-    if (cell.getState()!=CellStore::State_Loaded)
-        cell.load ();
+    loadCell (cell);
 
     ESM::CellState cellState;
 
@@ -90,10 +215,118 @@ void MWWorld::Cells::writeCell (ESM::ESMWriter& writer, CellStore& cell) const
 MWWorld::Cells::Cells (const MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& reader)
 : mStore (store), mReader (reader),
   mIdCache (Settings::Manager::getInt("pointers cache size", "Cells"), std::pair<std::string, CellStore *> ("", (CellStore*)0)),
-  mIdCacheIndex (0)
+  mIdCacheIndex (0),
+  mEncoder (NULL),
+  mRefIndexBuilt (false)
 {}
 
-MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
+MWWorld::Cells::~Cells()
+{
+    // The workers read the cells of the store
+    if (mRefIndexItem)
+    {
+        mRefIndexItem->cancel();
+        mRefIndexItem->waitTillDone();
+    }
+
+    for (std::map<const CellStore *, osg::ref_ptr<SceneUtil::WorkItem> >::iterator it = mLoadItems.begin(); it != mLoadItems.end(); ++it)
+    {
+        it->second->cancel();
+        it->second->waitTillDone();
+    }
+}
+
+void MWWorld::Cells::setWorkQueue (SceneUtil::WorkQueue* workQueue, const ToUTF8::Utf8Encoder* encoder)
+{
+    mWorkQueue = workQueue;
+    mEncoder = encoder;
+}
+
+void MWWorld::Cells::buildRefIndex()
+{
+    mRefIndexItem = new RefIndexWorkItem (getContentCells (mStore), mReader, mEncoder);
+    mWorkQueue->addWorkItem (mRefIndexItem);
+}
+
+void MWWorld::Cells::addRef (const std::string& name, const CellStore& cell)
+{
+    mRefIndex.addRuntimeRef (name, cell.getCell());
+}
+
+namespace
+{
+    struct AddRefsVisitor
+    {
+        MWWorld::Cells& mCells;
+        const MWWorld::CellStore& mCell;
+
+        AddRefsVisitor (MWWorld::Cells& cells, const MWWorld::CellStore& cell) : mCells (cells), mCell (cell) {}
+
+        bool operator() (const MWWorld::ConstPtr& ptr)
+        {
+            mCells.addRef (ptr.getCellRef().getRefId(), mCell);
+            return true;
+        }
+    };
+}
+
+void MWWorld::Cells::addRefs (CellStore& cell)
+{
+    AddRefsVisitor visitor (*this, cell);
+    cell.forEachConst (visitor);
+}
+
+void MWWorld::Cells::loadCell (CellStore& cell) const
+{
+    if (cell.getState()==CellStore::State_Loaded)
+        return;
+
+    std::map<const CellStore *, osg::ref_ptr<SceneUtil::WorkItem> >::iterator found = mLoadItems.find (&cell);
+    if (found == mLoadItems.end())
+    {
+        cell.load();
+        return;
+    }
+
+    // Rarely blocks, as cells that are read in the background are usually not needed right away
+    osg::ref_ptr<SceneUtil::WorkItem> item = found->second;
+    mLoadItems.erase (found);
+    item->waitTillDone();
+
+    cell.load (static_cast<CellLoadWorkItem*> (item.get())->getRefs());
+}
+
+void MWWorld::Cells::finishRefIndex()
+{
+    if (mRefIndexItem)
+    {
+        // Only blocks if a lookup comes in right after loading
+        mRefIndexItem->waitTillDone();
+        mRefIndex.swapContentRefs (static_cast<RefIndexWorkItem*> (mRefIndexItem.get())->getIndex());
+        mRefIndexItem = NULL;
+        mRefIndexBuilt = true;
+    }
+    else if (!mRefIndexBuilt)
+    {
+        RefIndex::Map refs;
+        fillRefIndex (getContentCells (mStore), mReader, refs);
+        mRefIndex.swapContentRefs (refs);
+        mRefIndexBuilt = true;
+    }
+}
+
+bool MWWorld::Cells::mayHaveRef (const std::string& name, const ESM::Cell *cell) const
+{
+    if (mRefIndex.mayHaveRef (name, cell))
+        return true;
+
+    if (cell->mData.mFlags & ESM::Cell::Interior)
+        return mInteriors.find (Misc::StringUtils::lowerCase (cell->mName)) != mInteriors.end();
+
+    return mExteriors.find (std::make_pair (cell->getGridX(), cell->getGridY())) != mExteriors.end();
+}
+
+MWWorld::CellStore *MWWorld::Cells::getExteriorStore (int x, int y)
 {
     std::map<std::pair<int, int>, CellStore>::iterator result =
         mExteriors.find (std::make_pair (x, y));
@@ -124,12 +357,41 @@ MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
             std::make_pair (x, y), CellStore (cell, mStore, mReader))).first;
     }
 
-    if (result->second.getState()!=CellStore::State_Loaded)
+    return &result->second;
+}
+
+MWWorld::CellStore *MWWorld::Cells::getExterior (int x, int y)
+{
+    CellStore* cell = getExteriorStore (x, y);
+
+    loadCell (*cell);
+
+    return cell;
+}
+
+MWWorld::CellStore *MWWorld::Cells::getExteriorInBackground (int x, int y, float priority)
+{
+    CellStore* cell = getExteriorStore (x, y);
+
+    if (cell->getState()!=CellStore::State_Loaded && mLoadItems.find (cell) == mLoadItems.end())
     {
-        result->second.load ();
+        osg::ref_ptr<SceneUtil::WorkItem> item = new CellLoadWorkItem (cell->getCell(), mReader, mEncoder);
+        item->setPriority (priority);
+        mWorkQueue->addWorkItem (item);
+        mLoadItems[cell] = item;
     }
 
-    return &result->second;
+    return cell;
+}
+
+bool MWWorld::Cells::finishBackgroundLoad (CellStore *cell)
+{
+    std::map<const CellStore *, osg::ref_ptr<SceneUtil::WorkItem> >::iterator found = mLoadItems.find (cell);
+    if (found != mLoadItems.end() && !found->second->isDone())
+        return false;
+
+    loadCell (*cell);
+    return true;
 }
 
 MWWorld::CellStore *MWWorld::Cells::getInterior (const std::string& name)
@@ -144,10 +406,7 @@ MWWorld::CellStore *MWWorld::Cells::getInterior (const std::string& name)
         result = mInteriors.insert (std::make_pair (lowerName, CellStore (cell, mStore, mReader))).first;
     }
 
-    if (result->second.getState()!=CellStore::State_Loaded)
-    {
-        result->second.load ();
-    }
+    loadCell (result->second);
 
     return &result->second;
 }
@@ -170,7 +429,7 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name, CellStore& cell,
     {
         if (cell.hasId (name))
         {
-            cell.load ();
+            loadCell (cell);
         }
         else
             return Ptr();
@@ -218,23 +477,13 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
             return ptr;
     }
 
-    // Now try the other cells
-    const MWWorld::Store<ESM::Cell> &cells = mStore.get<ESM::Cell>();
-    MWWorld::Store<ESM::Cell>::iterator iter;
-
-    for (iter = cells.extBegin(); iter != cells.extEnd(); ++iter)
+    // Now try the other cells that may hold a reference to name
+    finishRefIndex();
+    CellList cells;
+    mRefIndex.getCells (name, cells);
+    for (CellList::const_iterator iter = cells.begin(); iter != cells.end(); ++iter)
     {
-        CellStore *cellStore = getCellStore (&(*iter));
-
-        Ptr ptr = getPtrAndCache (name, *cellStore);
-
-        if (!ptr.isEmpty())
-            return ptr;
-    }
-
-    for (iter = cells.intBegin(); iter != cells.intEnd(); ++iter)
-    {
-        CellStore *cellStore = getCellStore (&(*iter));
+        CellStore *cellStore = getCellStore (*iter);
 
         Ptr ptr = getPtrAndCache (name, *cellStore);
 
@@ -248,9 +497,13 @@ MWWorld::Ptr MWWorld::Cells::getPtr (const std::string& name)
 
 void MWWorld::Cells::getExteriorPtrs(const std::string &name, std::vector<MWWorld::Ptr> &out)
 {
+    finishRefIndex();
     const MWWorld::Store<ESM::Cell> &cells = mStore.get<ESM::Cell>();
     for (MWWorld::Store<ESM::Cell>::iterator iter = cells.extBegin(); iter != cells.extEnd(); ++iter)
     {
+        if (!mayHaveRef (name, &(*iter)))
+            continue;
+
         CellStore *cellStore = getCellStore (&(*iter));
 
         Ptr ptr = getPtrAndCache (name, *cellStore);
@@ -262,9 +515,13 @@ void MWWorld::Cells::getExteriorPtrs(const std::string &name, std::vector<MWWorl
 
 void MWWorld::Cells::getInteriorPtrs(const std::string &name, std::vector<MWWorld::Ptr> &out)
 {
+    finishRefIndex();
     const MWWorld::Store<ESM::Cell> &cells = mStore.get<ESM::Cell>();
     for (MWWorld::Store<ESM::Cell>::iterator iter = cells.intBegin(); iter != cells.intEnd(); ++iter)
     {
+        if (!mayHaveRef (name, &(*iter)))
+            continue;
+
         CellStore *cellStore = getCellStore (&(*iter));
 
         Ptr ptr = getPtrAndCache (name, *cellStore);
@@ -320,11 +577,16 @@ public:
 
     MWWorld::Cells& mCells;
 
+    /// The cells that references were moved to
+    std::set<MWWorld::CellStore*> mTargets;
+
     virtual MWWorld::CellStore* getCellStore(const ESM::CellId& cellId)
     {
         try
         {
-            return mCells.getCell(cellId);
+            MWWorld::CellStore* cell = mCells.getCell(cellId);
+            mTargets.insert(cell);
+            return cell;
         }
         catch (...)
         {
@@ -361,13 +623,20 @@ bool MWWorld::Cells::readRecord (ESM::ESMReader& reader, uint32_t type,
         if (state.mHasFogOfWar)
             cellStore->readFog(reader);
 
-        if (cellStore->getState()!=CellStore::State_Loaded)
-            cellStore->load ();
+        loadCell (*cellStore);
 
         GetCellStoreCallback callback(*this);
 
         cellStore->readReferences (reader, contentFileMap, &callback);
 
+        // The saved game may have created references in the cell, or moved them to other cells
+        finishRefIndex();
+        addRefs (*cellStore);
+        for (std::set<CellStore*>::const_iterator iter = callback.mTargets.begin(); iter != callback.mTargets.end(); ++iter)
+            addRefs (**iter);
+
+        MWBase::Environment::get().getWorld()->pagingBlacklistChangedObjects (*cellStore);
+
         return true;
     }
 
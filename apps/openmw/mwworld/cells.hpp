@@ -4,7 +4,11 @@
 #include <map>
 #include <list>
 #include <string>
+#include <vector>
 
+#include <osg/ref_ptr>
+
+#include "cellrefindex.hpp"
 #include "ptr.hpp"
 
 namespace ESM
@@ -20,6 +24,17 @@ namespace Loading
     class Listener;
 }
 
+namespace SceneUtil
+{
+    class WorkQueue;
+    class WorkItem;
+}
+
+namespace ToUTF8
+{
+    class Utf8Encoder;
+}
+
 namespace MWWorld
 {
     class ESMStore;
@@ -34,11 +49,46 @@ namespace MWWorld
             std::vector<std::pair<std::string, CellStore *> > mIdCache;
             std::size_t mIdCacheIndex;
 
+            osg::ref_ptr<SceneUtil::WorkQueue> mWorkQueue;
+            const ToUTF8::Utf8Encoder* mEncoder;
+
+            /// For each reference ID, the cells that the content files place a reference with that ID in,
+            /// exteriors first, in the order of the cell store, and the cells it was moved to or created in since.
+            /// See buildRefIndex() and addRef().
+            typedef CellRefIndex<ESM::Cell> RefIndex;
+            typedef RefIndex::CellList CellList;
+            RefIndex mRefIndex;
+            bool mRefIndexBuilt;
+            /// Builds the index in the background, until its result is moved to mRefIndex
+            osg::ref_ptr<SceneUtil::WorkItem> mRefIndexItem;
+
+            /// Items that read the references of cells in the background, see getExteriorInBackground(). Mutable like the
+            /// cells, which are loaded on demand.
+            mutable std::map<const CellStore *, osg::ref_ptr<SceneUtil::WorkItem> > mLoadItems;
+
             Cells (const Cells&);
             Cells& operator= (const Cells&);
 
             CellStore *getCellStore (const ESM::Cell *cell);
 
+            /// Get the CellStore for an exterior cell, creating the cell if the content files do not define it,
+            /// without loading it.
+            CellStore *getExteriorStore (int x, int y);
+
+            /// Load \a cell, with the references read in the background if getExteriorInBackground() was called for it.
+            void loadCell (CellStore& cell) const;
+
+            /// Wait for the content file references to be indexed if they are still being read, or index them right away
+            /// if buildRefIndex() was not called.
+            void finishRefIndex();
+
+            /// May \a cell hold a reference to \a name? True if the index lists \a cell, or if there is a CellStore for it
+            /// already.
+            bool mayHaveRef (const std::string& name, const ESM::Cell *cell) const;
+
+            /// Add the references of \a cell to the index that it does not list for \a cell yet, see addRef().
+            void addRefs (CellStore& cell);
+
             Ptr getPtrAndCache (const std::string& name, CellStore& cellStore);
 
             void writeCell (ESM::ESMWriter& writer, CellStore& cell) const;
@@ -49,8 +99,31 @@ namespace MWWorld
 
             Cells (const MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& reader);
 
+            ~Cells();
+
+            /// Set the queue to read content files on in the background.
+            /// @param encoder Copied for the worker threads, may be NULL
+            void setWorkQueue (SceneUtil::WorkQueue* workQueue, const ToUTF8::Utf8Encoder* encoder);
+
+            /// Start reading the references of all cells in the content files on the work queue, to index them by ID
+            /// for getPtr(). Call once the content files are loaded.
+            void buildRefIndex();
+
+            /// A reference to \a name was moved to or created in \a cell, so getPtr() needs to look for it there.
+            /// @note Dropped again by clear().
+            void addRef (const std::string& name, const CellStore& cell);
+
             CellStore *getExterior (int x, int y);
 
+            /// Get an exterior cell without loading it on this thread. If it is not loaded yet, its references are
+            /// read on the work queue with the given \a priority.
+            /// @note Any call that needs the cell loaded before finishBackgroundLoad() succeeds waits for the references.
+            CellStore *getExteriorInBackground (int x, int y, float priority);
+
+            /// Load \a cell if its references have been read in the background, or if they are not being read.
+            /// @return Is \a cell loaded?
+            bool finishBackgroundLoad (CellStore *cell);
+
             CellStore *getInterior (const std::string& name);
 
             CellStore *getCell (const ESM::CellId& id);
@@ -436,19 +436,29 @@ namespace MWWorld
     }
 
     void CellStore::load ()
+    {
+        if (mState!=State_Loaded)
+        {
+            RefRecords refs;
+            readRefs (mCell, mReader, refs);
+            load (refs);
+        }
+    }
+
+    void CellStore::load (RefRecords& refs)
     {
         if (mState!=State_Loaded)
         {
             if (mState==State_Preloaded)
                 mIds.clear();
 
-            loadRefs ();
+            loadRefs (refs);
 
             mState = State_Loaded;
 
             // TODO: the pathgrid graph only needs to be loaded for active cells, so move this somewhere else.
             // In a simple test, loading the graph for all cells in MW + expansions took 200 ms
-            mPathgridGraph.load(this);
+            mPathgridGraph.load(MWBase::Environment::get().getWorld()->getStore().get<ESM::Pathgrid>().search(*mCell));
         }
     }
 
@@ -464,111 +474,113 @@ namespace MWWorld
 
     void CellStore::listRefs()
     {
-        std::vector<ESM::ESMReader>& esm = mReader;
-
         assert (mCell);
 
-        if (mCell->mContextList.empty())
+        listRefs (mCell, mReader, mIds);
+
+        std::sort (mIds.begin(), mIds.end());
+    }
+
+    void CellStore::listRefs (const ESM::Cell *cell, std::vector<ESM::ESMReader>& esm, std::vector<std::string>& ids)
+    {
+        if (cell->mContextList.empty())
             return; // this is a dynamically generated cell -> skipping.
 
         // Load references from all plugins that do something with this cell.
-        for (size_t i = 0; i < mCell->mContextList.size(); i++)
+        for (size_t i = 0; i < cell->mContextList.size(); i++)
         {
             try
             {
                 // Reopen the ESM reader and seek to the right position.
-                int index = mCell->mContextList.at(i).index;
-                mCell->restore (esm[index], i);
+                int index = cell->mContextList.at(i).index;
+                cell->restore (esm[index], i);
 
                 ESM::CellRef ref;
 
                 // Get each reference in turn
                 bool deleted = false;
-                while (mCell->getNextRef (esm[index], ref, deleted))
+                while (cell->getNextRef (esm[index], ref, deleted))
                 {
                     if (deleted)
                         continue;
 
                     // Don't list reference if it was moved to a different cell.
                     ESM::MovedCellRefTracker::const_iterator iter =
-                        std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
-                    if (iter != mCell->mMovedRefs.end()) {
+                        std::find(cell->mMovedRefs.begin(), cell->mMovedRefs.end(), ref.mRefNum);
+                    if (iter != cell->mMovedRefs.end()) {
                         continue;
                     }
 
-                    mIds.push_back (Misc::StringUtils::lowerCase (ref.mRefID));
+                    ids.push_back (Misc::StringUtils::lowerCase (ref.mRefID));
                 }
             }
             catch (std::exception& e)
             {
-                std::cerr << "An error occurred listing references for cell " << getCell()->getDescription() << ": " << e.what() << std::endl;
+                std::cerr << "An error occurred listing references for cell " << cell->getDescription() << ": " << e.what() << std::endl;
             }
         }
 
         // List moved references, from separately tracked list.
-        for (ESM::CellRefTracker::const_iterator it = mCell->mLeasedRefs.begin(); it != mCell->mLeasedRefs.end(); ++it)
+        for (ESM::CellRefTracker::const_iterator it = cell->mLeasedRefs.begin(); it != cell->mLeasedRefs.end(); ++it)
         {
             const ESM::CellRef &ref = it->first;
             bool deleted = it->second;
 
             if (!deleted)
-                mIds.push_back(Misc::StringUtils::lowerCase(ref.mRefID));
+                ids.push_back(Misc::StringUtils::lowerCase(ref.mRefID));
         }
-
-        std::sort (mIds.begin(), mIds.end());
     }
 
-    void CellStore::loadRefs()
+    void CellStore::readRefs (const ESM::Cell *cell, std::vector<ESM::ESMReader>& esm, RefRecords& refs)
     {
-        std::vector<ESM::ESMReader>& esm = mReader;
-
-        assert (mCell);
-
-        if (mCell->mContextList.empty())
+        if (cell->mContextList.empty())
             return; // this is a dynamically generated cell -> skipping.
 
-        std::map<ESM::RefNum, std::string> refNumToID; // used to detect refID modifications
-
         // Load references from all plugins that do something with this cell.
-        for (size_t i = 0; i < mCell->mContextList.size(); i++)
+        for (size_t i = 0; i < cell->mContextList.size(); i++)
         {
             try
             {
                 // Reopen the ESM reader and seek to the right position.
-                int index = mCell->mContextList.at(i).index;
-                mCell->restore (esm[index], i);
+                int index = cell->mContextList.at(i).index;
+                cell->restore (esm[index], i);
 
                 ESM::CellRef ref;
                 ref.mRefNum.mContentFile = ESM::RefNum::RefNum_NoContentFile;
 
                 // Get each reference in turn
                 bool deleted = false;
-                while(mCell->getNextRef(esm[index], ref, deleted))
+                while(cell->getNextRef(esm[index], ref, deleted))
                 {
                     // Don't load reference if it was moved to a different cell.
                     ESM::MovedCellRefTracker::const_iterator iter =
-                        std::find(mCell->mMovedRefs.begin(), mCell->mMovedRefs.end(), ref.mRefNum);
-                    if (iter != mCell->mMovedRefs.end()) {
+                        std::find(cell->mMovedRefs.begin(), cell->mMovedRefs.end(), ref.mRefNum);
+                    if (iter != cell->mMovedRefs.end()) {
                         continue;
                     }
 
-                    loadRef (ref, deleted, refNumToID);
+                    refs.push_back (std::make_pair (ref, deleted));
                 }
             }
             catch (std::exception& e)
             {
-                std::cerr << "An error occurred loading references for cell " << getCell()->getDescription() << ": " << e.what() << std::endl;
+                std::cerr << "An error occurred loading references for cell " << cell->getDescription() << ": " << e.what() << std::endl;
             }
         }
 
         // Load moved references, from separately tracked list.
-        for (ESM::CellRefTracker::const_iterator it = mCell->mLeasedRefs.begin(); it != mCell->mLeasedRefs.end(); ++it)
-        {
-            ESM::CellRef &ref = const_cast<ESM::CellRef&>(it->first);
-            bool deleted = it->second;
+        for (ESM::CellRefTracker::const_iterator it = cell->mLeasedRefs.begin(); it != cell->mLeasedRefs.end(); ++it)
+            refs.push_back (*it);
+    }
 
-            loadRef (ref, deleted, refNumToID);
-        }
+    void CellStore::loadRefs (RefRecords& refs)
+    {
+        assert (mCell);
+
+        std::map<ESM::RefNum, std::string> refNumToID; // used to detect refID modifications
+
+        for (RefRecords::iterator it = refs.begin(); it != refs.end(); ++it)
+            loadRef (it->first, it->second, refNumToID);
 
         updateMergedRefs();
     }
@@ -942,9 +954,9 @@ namespace MWWorld
         return mPathgridGraph.isPointConnected(start, end);
     }
 
-    std::list<ESM::Pathgrid::Point> CellStore::aStarSearch(const int start, const int end) const
+    bool CellStore::aStarSearch(const int start, const int end, std::vector<int>& path) const
     {
-        return mPathgridGraph.aStarSearch(start, end);
+        return mPathgridGraph.aStarSearch(start, end, path);
     }
 
     void CellStore::setFog(ESM::FogState *fog)
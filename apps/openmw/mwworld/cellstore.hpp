@@ -242,9 +242,15 @@ namespace MWWorld
             int count() const;
             ///< Return total number of references, including deleted ones.
 
+            /// References as read from the content files, with their deleted flag, in the order they are loaded in.
+            typedef std::vector<std::pair<ESM::CellRef, bool> > RefRecords;
+
             void load ();
             ///< Load references from content file.
 
+            void load (RefRecords& refs);
+            ///< Load the references that readRefs() has read for this cell, e.g. on another thread.
+
             void preload ();
             ///< Build ID list from content file.
 
@@ -378,14 +384,23 @@ namespace MWWorld
 
             bool isPointConnected(const int start, const int end) const;
 
-            std::list<ESM::Pathgrid::Point> aStarSearch(const int start, const int end) const;
+            /// Find a path between two pathgrid points of this cell, see MWMechanics::PathgridGraph::aStarSearch.
+            bool aStarSearch(const int start, const int end, std::vector<int>& path) const;
+
+            /// Append the lower case IDs of all references that the content files place in \a cell to \a ids.
+            /// These are the IDs a CellStore for \a cell lists in State_Preloaded, unsorted.
+            static void listRefs (const ESM::Cell *cell, std::vector<ESM::ESMReader>& esm, std::vector<std::string>& ids);
+
+            /// Append the references that the content files place in \a cell to \a refs, for load().
+            /// Only uses \a cell and \a esm, so it can run on another thread with its own readers.
+            static void readRefs (const ESM::Cell *cell, std::vector<ESM::ESMReader>& esm, RefRecords& refs);
 
         private:
 
             /// Run through references and store IDs
             void listRefs();
 
-            void loadRefs();
+            void loadRefs (RefRecords& refs);
 
             void loadRef (ESM::CellRef& ref, bool deleted, std::map<ESM::RefNum, std::string>& refNumToID);
             ///< Make case-adjustments to \a ref and insert it into the respective container.
@@ -28,6 +28,12 @@ struct ContentLoader
       mListener.setLabel(MyGUI::TextIterator::toTagsString(filepath.string()));
     }
 
+    /// Called after load() has been called for every content file.
+    /// Loaders that defer part of their work must complete it here.
+    virtual void finish()
+    {
+    }
+
     protected:
         Loading::Listener& mListener;
 };
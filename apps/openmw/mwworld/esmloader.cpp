@@ -1,17 +1,93 @@
 #include "esmloader.hpp"
 #include "esmstore.hpp"
 
+#include <algorithm>
+#include <exception>
+#include <memory>
+
+#include <osg/Timer>
+
+#include <OpenThreads/Thread>
+
 #include <components/esm/esmreader.hpp>
 
+#include <components/sceneutil/workqueue.hpp>
+
+namespace
+{
+
+  /// Reads the records of one content file on a worker thread.
+  class StageFileWorkItem : public SceneUtil::WorkItem
+  {
+  public:
+      StageFileWorkItem(MWWorld::ESMStore& store, ESM::ESMReader& reader, ToUTF8::Utf8Encoder* encoder)
+        : mStore(store)
+        , mReader(reader)
+        , mEncoder(encoder)
+        , mTime(0.0)
+      {
+      }
+
+      virtual const char* getName() const { return "Content file loading"; }
+
+      virtual void doWork()
+      {
+          osg::Timer timer;
+
+          // The encoder keeps a conversion buffer, so every thread needs its own
+          std::unique_ptr<ToUTF8::Utf8Encoder> encoder;
+          if (mEncoder)
+              encoder.reset(new ToUTF8::Utf8Encoder(*mEncoder));
+          mReader.setEncoder(encoder.get());
+
+          try
+          {
+              mStore.stage(mReader, mFile);
+          }
+          catch (...)
+          {
+              mError = std::current_exception();
+          }
+
+          mReader.setEncoder(mEncoder);
+          mTime = timer.time_m();
+      }
+
+      /// Rethrow the exception that occurred while reading the file, if any.
+      void checkError() const
+      {
+          if (mError)
+              std::rethrow_exception(mError);
+      }
+
+      MWWorld::ESMStore::StagedFile& getFile() { return mFile; }
+
+      /// Time taken to read the file, in milliseconds
+      double getTime() const { return mTime; }
+
+  private:
+      MWWorld::ESMStore& mStore;
+      ESM::ESMReader& mReader;
+      ToUTF8::Utf8Encoder* mEncoder;
+
+      MWWorld::ESMStore::StagedFile mFile;
+      std::exception_ptr mError;
+      double mTime;
+  };
+
+}
+
 namespace MWWorld
 {
 
 EsmLoader::EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener)
+  ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, bool parallel, bool memoryMapped)
   : ContentLoader(listener)
   , mEsm(readers)
   , mStore(store)
   , mEncoder(encoder)
+  , mParallel(parallel)
+  , mMemoryMapped(memoryMapped)
 {
 }
 
@@ -23,9 +99,55 @@ void EsmLoader::load(const boost::filesystem::path& filepath, int& index)
   lEsm.setEncoder(mEncoder);
   lEsm.setIndex(index);
   lEsm.setGlobalReaderList(&mEsm);
+  lEsm.setMemoryMapped(mMemoryMapped);
   lEsm.open(filepath.string());
   mEsm[index] = lEsm;
-  mStore.load(mEsm[index], &mListener);
+
+  if (mParallel)
+    mPending.push_back(index);
+  else
+    mStore.load(mEsm[index], &mListener);
+}
+
+void EsmLoader::finish()
+{
+  if (mPending.empty())
+    return;
+
+  std::vector<osg::ref_ptr<StageFileWorkItem> > items;
+  {
+    int numThreads = std::min(static_cast<int>(mPending.size()), std::max(1, OpenThreads::GetNumberOfProcessors()));
+    osg::ref_ptr<SceneUtil::WorkQueue> workQueue = new SceneUtil::WorkQueue(numThreads);
+
+    for (std::vector<int>::const_iterator it = mPending.begin(); it != mPending.end(); ++it)
+    {
+      osg::ref_ptr<StageFileWorkItem> item = new StageFileWorkItem(mStore, mEsm[*it], mEncoder);
+      workQueue->addWorkItem(item);
+      items.push_back(item);
+    }
+
+    for (std::vector<osg::ref_ptr<StageFileWorkItem> >::const_iterator it = items.begin(); it != items.end(); ++it)
+      (*it)->waitTillDone();
+  }
+
+  // Records overwrite each other, so they have to be added in load order
+  for (std::size_t i = 0; i < mPending.size(); ++i)
+  {
+    ESM::ESMReader& esm = mEsm[mPending[i]];
+    StageFileWorkItem& item = *items[i];
+    item.checkError();
+
+    std::string filename = boost::filesystem::path(esm.getName()).filename().string();
+    mListener.setLabel(MyGUI::TextIterator::toTagsString(filename));
+
+    osg::Timer timer;
+    mStore.merge(esm, item.getFile(), &mListener);
+
+    mListener.reportTime("Reading " + filename, item.getTime());
+    mListener.reportTime("Merging " + filename, timer.time_m());
+  }
+
+  mPending.clear();
 }
 
 } /* namespace MWWorld */
@@ -22,15 +22,24 @@ class ESMStore;
 
 struct EsmLoader : public ContentLoader
 {
+    /// @param parallel Read all content files on worker threads in finish(), instead of one by one in load().
+    /// @param memoryMapped Map content files into memory instead of reading them through file streams.
     EsmLoader(MWWorld::ESMStore& store, std::vector<ESM::ESMReader>& readers,
-      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener);
+      ToUTF8::Utf8Encoder* encoder, Loading::Listener& listener, bool parallel = false, bool memoryMapped = false);
 
     void load(const boost::filesystem::path& filepath, int& index);
 
+    void finish();
+
     private:
       std::vector<ESM::ESMReader>& mEsm;
       MWWorld::ESMStore& mStore;
       ToUTF8::Utf8Encoder* mEncoder;
+      bool mParallel;
+      bool mMemoryMapped;
+
+      /// Indices of files that have been opened, but not read yet
+      std::vector<int> mPending;
 };
 
 } /* namespace MWWorld */
@@ -27,12 +27,8 @@ static bool isCacheableRecord(int id)
     return false;
 }
 
-void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+void ESMStore::setUpPlugin(ESM::ESMReader &esm)
 {
-    listener->setProgressRange(1000);
-
-    ESM::Dialogue *dialogue = 0;
-
     // Land texture loading needs to use a separate internal store for each plugin.
     // We set the number of plugins here to avoid continual resizes during loading,
     // and so we can properly verify if valid plugin indices are being passed to the
@@ -50,7 +46,7 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         std::string fname = mast.name;
         int index = ~0;
         for (int i = 0; i < esm.getIndex(); i++) {
-            const std::string &candidate = allPlugins->at(i).getContext().filename;
+            const std::string &candidate = allPlugins->at(i).getName();
             std::string fnamecandidate = boost::filesystem::path(candidate).filename().string();
             if (Misc::StringUtils::ciEqual(fname, fnamecandidate)) {
                 index = i;
@@ -66,6 +62,64 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         }
         mast.index = index;
     }
+}
+
+void ESMStore::loadRecord(ESM::ESMReader &esm, int type, ESM::Dialogue *&dialogue)
+{
+    // Look up the record type.
+    std::map<int, StoreBase *>::iterator it = mStores.find(type);
+
+    if (it == mStores.end()) {
+        if (type == ESM::REC_INFO) {
+            if (dialogue)
+            {
+                dialogue->readInfo(esm, esm.getIndex() != 0);
+            }
+            else
+            {
+                std::cerr << "error: info record without dialog" << std::endl;
+                esm.skipRecord();
+            }
+        } else if (type == ESM::REC_MGEF) {
+            mMagicEffects.load (esm);
+        } else if (type == ESM::REC_SKIL) {
+            mSkills.load (esm);
+        }
+        else if (type==ESM::REC_FILT || type == ESM::REC_DBGP)
+        {
+            // ignore project file only records
+            esm.skipRecord();
+        }
+        else {
+            ESM::NAME name;
+            name.intval = type;
+            std::stringstream error;
+            error << "Unknown record: " << name.toString();
+            throw std::runtime_error(error.str());
+        }
+    } else {
+        RecordId id = it->second->load(esm);
+        if (id.mIsDeleted)
+        {
+            it->second->eraseStatic(id.mId);
+            return;
+        }
+
+        if (type==ESM::REC_DIAL) {
+            dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
+        } else {
+            dialogue = 0;
+        }
+    }
+}
+
+void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
+{
+    listener->setProgressRange(1000);
+
+    setUpPlugin(esm);
+
+    ESM::Dialogue *dialogue = 0;
 
     // Loop through all records
     while(esm.hasMoreRecs())
@@ -73,51 +127,82 @@ void ESMStore::load(ESM::ESMReader &esm, Loading::Listener* listener)
         ESM::NAME n = esm.getRecName();
         esm.getRecHeader();
 
-        // Look up the record type.
-        std::map<int, StoreBase *>::iterator it = mStores.find(n.intval);
+        loadRecord(esm, n.intval, dialogue);
 
-        if (it == mStores.end()) {
-            if (n.intval == ESM::REC_INFO) {
-                if (dialogue)
-                {
-                    dialogue->readInfo(esm, esm.getIndex() != 0);
-                }
-                else
-                {
-                    std::cerr << "error: info record without dialog" << std::endl;
-                    esm.skipRecord();
-                }
-            } else if (n.intval == ESM::REC_MGEF) {
-                mMagicEffects.load (esm);
-            } else if (n.intval == ESM::REC_SKIL) {
-                mSkills.load (esm);
-            }
-            else if (n.intval==ESM::REC_FILT || n.intval == ESM::REC_DBGP)
-            {
-                // ignore project file only records
-                esm.skipRecord();
-            }
-            else {
-                std::stringstream error;
-                error << "Unknown record: " << n.toString();
-                throw std::runtime_error(error.str());
-            }
-        } else {
-            RecordId id = it->second->load(esm);
-            if (id.mIsDeleted)
-            {
-                it->second->eraseStatic(id.mId);
-                continue;
-            }
+        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+    }
+}
 
-            if (n.intval==ESM::REC_DIAL) {
-                dialogue = const_cast<ESM::Dialogue*>(mDialogs.find(id.mId));
-            } else {
+void ESMStore::stage(ESM::ESMReader &esm, StagedFile &file)
+{
+    file.mRecords.clear();
+
+    while(esm.hasMoreRecs())
+    {
+        ESM::NAME n = esm.getRecName();
+        esm.getRecHeader();
+
+        if (n.intval==ESM::REC_FILT || n.intval == ESM::REC_DBGP)
+        {
+            // ignore project file only records
+            esm.skipRecord();
+            continue;
+        }
+
+        StagedFile::Record record;
+        record.mType = n.intval;
+
+        // Only reads the store map, stage() implementations must not touch the stores themselves
+        std::map<int, StoreBase *>::const_iterator it = mStores.find(n.intval);
+        if (it != mStores.end())
+            record.mStaged.reset(it->second->stage(esm));
+        else if (n.intval != ESM::REC_INFO && n.intval != ESM::REC_MGEF && n.intval != ESM::REC_SKIL)
+        {
+            std::stringstream error;
+            error << "Unknown record: " << n.toString();
+            throw std::runtime_error(error.str());
+        }
+
+        if (!record.mStaged)
+        {
+            record.mContext = esm.getContext();
+            esm.skipRecord();
+        }
+
+        file.mRecords.push_back(std::move(record));
+    }
+}
+
+void ESMStore::merge(ESM::ESMReader &esm, StagedFile &file, Loading::Listener* listener)
+{
+    listener->setProgressRange(1000);
+
+    setUpPlugin(esm);
+
+    ESM::Dialogue *dialogue = 0;
+
+    for (size_t i = 0; i < file.mRecords.size(); ++i)
+    {
+        StagedFile::Record &record = file.mRecords[i];
+        if (record.mStaged)
+        {
+            RecordId id = record.mStaged->apply();
+            record.mStaged.reset();
+            if (id.mIsDeleted)
+                mStores[record.mType]->eraseStatic(id.mId);
+            else
                 dialogue = 0;
-            }
         }
-        listener->setProgress(static_cast<size_t>(esm.getFileOffset() / (float)esm.getFileSize() * 1000));
+        else
+        {
+            esm.restoreContext(record.mContext);
+            loadRecord(esm, record.mType, dialogue);
+        }
+
+        listener->setProgress(static_cast<size_t>((i + 1) / (float)file.mRecords.size() * 1000));
     }
+
+    file.mRecords.clear();
 }
 
 void ESMStore::setUp()
@@ -1,9 +1,11 @@
 #ifndef OPENMW_MWWORLD_ESMSTORE_H
 #define OPENMW_MWWORLD_ESMSTORE_H
 
+#include <memory>
 #include <sstream>
 #include <stdexcept>
 
+#include <components/esm/esmcommon.hpp>
 #include <components/esm/records.hpp>
 #include "store.hpp"
 
@@ -67,14 +69,37 @@ namespace MWWorld
 
         // Lookup of all IDs. Makes looking up references faster. Just
         // maps the id name to the record type.
-        std::map<std::string, int> mIds;
+        RecordMap<int> mIds;
         std::map<int, StoreBase *> mStores;
 
         ESM::NPC mPlayerTemplate;
 
         unsigned int mDynamicCount;
 
+        /// Resolve the masters of the file being loaded and prepare the per-plugin stores.
+        void setUpPlugin(ESM::ESMReader &esm);
+
+        /// Load the record whose header has just been read from \a esm.
+        void loadRecord(ESM::ESMReader &esm, int type, ESM::Dialogue *&dialogue);
+
     public:
+        /// The records of a content file, read by stage() and not yet added to the stores.
+        struct StagedFile
+        {
+            struct Record
+            {
+                int mType;
+
+                /// The parsed record, or empty if the record is read by merge().
+                std::unique_ptr<StagedRecord> mStaged;
+
+                /// Position of the record in the file, used if \a mStaged is empty.
+                ESM::ESM_Context mContext;
+            };
+
+            std::vector<Record> mRecords;
+        };
+
         /// \todo replace with SharedIterator<StoreBase>
         typedef std::map<int, StoreBase *>::const_iterator iterator;
 
@@ -87,14 +112,13 @@ namespace MWWorld
         }
 
         /// Look up the given ID in 'all'. Returns 0 if not found.
-        /// \note id must be in lower case.
         int find(const std::string &id) const
         {
-            std::map<std::string, int>::const_iterator it = mIds.find(id);
-            if (it == mIds.end()) {
+            const int *type = mIds.search(id);
+            if (!type) {
                 return 0;
             }
-            return it->second;
+            return *type;
         }
 
         ESMStore()
@@ -160,6 +184,15 @@ namespace MWWorld
 
         void load(ESM::ESMReader &esm, Loading::Listener* listener);
 
+        /// Read the records of \a esm into \a file without modifying the store. Records that depend on
+        /// previously loaded content (cells, dialogue, land, ...) are only located, to be read by merge().
+        /// \note Safe to call for several files at the same time, as long as each uses its own reader.
+        void stage(ESM::ESMReader &esm, StagedFile &file);
+
+        /// Add the records of \a file, which must have been staged from \a esm, to the store.
+        /// Has the same effect as load(), provided that files are merged in load order.
+        void merge(ESM::ESMReader &esm, StagedFile &file, Loading::Listener* listener);
+
         template <class T>
         const Store<T> &get() const {
             throw std::runtime_error("Storage for this type not exist");
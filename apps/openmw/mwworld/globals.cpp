@@ -11,28 +11,19 @@
 
 namespace MWWorld
 {
-    Globals::Collection::const_iterator Globals::find (const std::string& name) const
+    int Globals::find (const std::string& name) const
     {
-        Collection::const_iterator iter = mVariables.find (Misc::StringUtils::lowerCase (name));
+        Collection::const_iterator iter = mSlots.find (Misc::StringUtils::lowerCase (name));
 
-        if (iter==mVariables.end())
+        if (iter==mSlots.end())
             throw std::runtime_error ("unknown global variable: " + name);
 
-        return iter;
-    }
-
-    Globals::Collection::iterator Globals::find (const std::string& name)
-    {
-        Collection::iterator iter = mVariables.find (Misc::StringUtils::lowerCase (name));
-
-        if (iter==mVariables.end())
-            throw std::runtime_error ("unknown global variable: " + name);
-
-        return iter;
+        return iter->second;
     }
 
     void Globals::fill (const MWWorld::ESMStore& store)
     {
+        mSlots.clear();
         mVariables.clear();
 
         const MWWorld::Store<ESM::Global>& globals = store.get<ESM::Global>();
@@ -40,28 +31,46 @@ namespace MWWorld
         for (MWWorld::Store<ESM::Global>::iterator iter = globals.begin(); iter!=globals.end();
             ++iter)
         {
-            mVariables.insert (std::make_pair (Misc::StringUtils::lowerCase (iter->mId), *iter));
+            std::string name = Misc::StringUtils::lowerCase (iter->mId);
+
+            if (mSlots.insert (std::make_pair (name, static_cast<int> (mVariables.size()))).second)
+                mVariables.push_back (*iter);
         }
     }
 
     const ESM::Variant& Globals::operator[] (const std::string& name) const
     {
-        return find (Misc::StringUtils::lowerCase (name))->second.mValue;
+        return mVariables[find (name)].mValue;
     }
 
     ESM::Variant& Globals::operator[] (const std::string& name)
     {
-        return find (Misc::StringUtils::lowerCase (name))->second.mValue;
+        return mVariables[find (name)].mValue;
+    }
+
+    int Globals::getSlot (const std::string& name) const
+    {
+        return find (name);
+    }
+
+    const ESM::Variant& Globals::operator[] (int slot) const
+    {
+        return mVariables.at (slot).mValue;
+    }
+
+    ESM::Variant& Globals::operator[] (int slot)
+    {
+        return mVariables.at (slot).mValue;
     }
 
     char Globals::getType (const std::string& name) const
     {
-        Collection::const_iterator iter = mVariables.find (Misc::StringUtils::lowerCase (name));
+        Collection::const_iterator iter = mSlots.find (Misc::StringUtils::lowerCase (name));
 
-        if (iter==mVariables.end())
+        if (iter==mSlots.end())
             return ' ';
 
-        switch (iter->second.mValue.getType())
+        switch (mVariables[iter->second].mValue.getType())
         {
             case ESM::VT_Short: return 's';
             case ESM::VT_Long: return 'l';
@@ -78,10 +87,10 @@ namespace MWWorld
 
     void Globals::write (ESM::ESMWriter& writer, Loading::Listener& progress) const
     {
-        for (Collection::const_iterator iter (mVariables.begin()); iter!=mVariables.end(); ++iter)
+        for (Collection::const_iterator iter (mSlots.begin()); iter!=mSlots.end(); ++iter)
         {
             writer.startRecord (ESM::REC_GLOB);
-            iter->second.save (writer);
+            mVariables[iter->second].save (writer);
             writer.endRecord (ESM::REC_GLOB);
         }
     }
@@ -98,9 +107,9 @@ namespace MWWorld
             global.load(reader, isDeleted);
             Misc::StringUtils::lowerCaseInPlace(global.mId);
 
-            Collection::iterator iter = mVariables.find (global.mId);
-            if (iter!=mVariables.end())
-                iter->second = global;
+            Collection::iterator iter = mSlots.find (global.mId);
+            if (iter!=mSlots.end())
+                mVariables[iter->second] = global;
 
             return true;
         }
@@ -29,13 +29,13 @@ namespace MWWorld
     {
         private:
 
-            typedef std::map<std::string, ESM::Global> Collection;
+            typedef std::map<std::string, int> Collection;
 
-            Collection mVariables; // type, value
+            Collection mSlots; // name, slot in mVariables
 
-            Collection::const_iterator find (const std::string& name) const;
+            std::vector<ESM::Global> mVariables; // type, value
 
-            Collection::iterator find (const std::string& name);
+            int find (const std::string& name) const;
 
         public:
 
@@ -43,6 +43,15 @@ namespace MWWorld
 
             ESM::Variant& operator[] (const std::string& name);
 
+            int getSlot (const std::string& name) const;
+            ///< Return the slot of the variable with this name, to access it without a lookup by name.
+            /// Slots only change when the variables are filled from other content files.
+            /// Throws, if there is no global variable with this name.
+
+            const ESM::Variant& operator[] (int slot) const;
+
+            ESM::Variant& operator[] (int slot);
+
             char getType (const std::string& name) const;
             ///< If there is no global variable with this name, ' ' is returned.
 
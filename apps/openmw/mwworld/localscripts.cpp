@@ -2,6 +2,9 @@
 
 #include <iostream>
 
+#include "../mwbase/environment.hpp"
+#include "../mwbase/scriptmanager.hpp"
+
 #include "esmstore.hpp"
 #include "cellstore.hpp"
 
@@ -71,11 +74,11 @@ void MWWorld::LocalScripts::startIteration()
     mIter = mScripts.begin();
 }
 
-bool MWWorld::LocalScripts::getNext(std::pair<std::string, Ptr>& script)
+bool MWWorld::LocalScripts::getNext(Script& script)
 {
     while (mIter!=mScripts.end())
     {
-        std::list<std::pair<std::string, Ptr> >::iterator iter = mIter++;
+        std::list<Script>::iterator iter = mIter++;
         script = *iter;
         return true;
     }
@@ -90,15 +93,19 @@ void MWWorld::LocalScripts::add (const std::string& scriptName, const Ptr& ptr)
         {
             ptr.getRefData().setLocals (*script);
 
-            for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin(); iter!=mScripts.end(); ++iter)
-                if (iter->second==ptr)
+            for (std::list<Script>::iterator iter = mScripts.begin(); iter!=mScripts.end(); ++iter)
+                if (iter->mPtr==ptr)
                 {
                     std::cerr << "Error: tried to add local script twice for " << ptr.getCellRef().getRefId() << std::endl;
                     remove(ptr);
                     break;
                 }
 
-            mScripts.push_back (std::make_pair (scriptName, ptr));
+            Script entry;
+            entry.mName = scriptName;
+            entry.mHandle = MWBase::Environment::get().getScriptManager()->getScriptHandle (scriptName);
+            entry.mPtr = ptr;
+            mScripts.push_back (entry);
         }
         catch (const std::exception& exception)
         {
@@ -131,11 +138,11 @@ void MWWorld::LocalScripts::clear()
 
 void MWWorld::LocalScripts::clearCell (CellStore *cell)
 {
-    std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
+    std::list<Script>::iterator iter = mScripts.begin();
 
     while (iter!=mScripts.end())
     {
-        if (iter->second.mCell==cell)
+        if (iter->mPtr.mCell==cell)
         {
             if (iter==mIter)
                ++mIter;
@@ -149,9 +156,9 @@ void MWWorld::LocalScripts::clearCell (CellStore *cell)
 
 void MWWorld::LocalScripts::remove (RefData *ref)
 {
-    for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
+    for (std::list<Script>::iterator iter = mScripts.begin();
         iter!=mScripts.end(); ++iter)
-        if (&(iter->second.getRefData()) == ref)
+        if (&(iter->mPtr.getRefData()) == ref)
         {
             if (iter==mIter)
                 ++mIter;
@@ -163,9 +170,9 @@ void MWWorld::LocalScripts::remove (RefData *ref)
 
 void MWWorld::LocalScripts::remove (const Ptr& ptr)
 {
-    for (std::list<std::pair<std::string, Ptr> >::iterator iter = mScripts.begin();
+    for (std::list<Script>::iterator iter = mScripts.begin();
         iter!=mScripts.end(); ++iter)
-        if (iter->second==ptr)
+        if (iter->mPtr==ptr)
         {
             if (iter==mIter)
                 ++mIter;
@@ -15,8 +15,19 @@ namespace MWWorld
     /// \brief List of active local scripts
     class LocalScripts
     {
-            std::list<std::pair<std::string, Ptr> > mScripts;
-            std::list<std::pair<std::string, Ptr> >::iterator mIter;
+        public:
+
+            struct Script
+            {
+                std::string mName;
+                int mHandle; ///< Handle from the script manager, to run the script without looking it up
+                Ptr mPtr;
+            };
+
+        private:
+
+            std::list<Script> mScripts;
+            std::list<Script>::iterator mIter;
             const MWWorld::ESMStore& mStore;
 
         public:
@@ -26,7 +37,7 @@ namespace MWWorld
             void startIteration();
             ///< Set the iterator to the begin of the script list.
 
-            bool getNext(std::pair<std::string, Ptr>& script);
+            bool getNext(Script& script);
             ///< Get next local script
             /// @return Did we get a script?
 
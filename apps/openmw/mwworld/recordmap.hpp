@@ -0,0 +1,259 @@
+#ifndef OPENMW_MWWORLD_RECORDMAP_H
+#define OPENMW_MWWORLD_RECORDMAP_H
+
+#include <deque>
+#include <iterator>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <components/misc/stringops.hpp>
+
+namespace MWWorld
+{
+    /// @brief Hash map from record IDs to values, with case insensitive lookups that do not allocate.
+    /// @par IDs are folded to lower case and hashed once, when they are inserted. Lookups fold and hash the
+    /// requested ID on the fly and search a flat open-addressing table of entry indices.
+    /// @par Entries are never moved, so pointers to values stay valid until the entry is erased or the map is cleared.
+    template <class T>
+    class RecordMap
+    {
+    public:
+        struct Entry
+        {
+            /// The ID in lower case
+            std::string mId;
+            std::size_t mHash;
+            T mValue;
+            bool mUsed;
+        };
+
+        /// Iterates over the entries in an unspecified order.
+        template <class EntryType, class BaseIterator>
+        class Iterator : public std::iterator<std::forward_iterator_tag, EntryType>
+        {
+            BaseIterator mIter;
+            BaseIterator mEnd;
+
+            void skipUnused()
+            {
+                while (mIter != mEnd && !mIter->mUsed)
+                    ++mIter;
+            }
+
+        public:
+            Iterator(BaseIterator iter, BaseIterator end)
+              : mIter(iter), mEnd(end)
+            {
+                skipUnused();
+            }
+
+            EntryType& operator*() const { return *mIter; }
+            EntryType* operator->() const { return &*mIter; }
+
+            Iterator& operator++()
+            {
+                ++mIter;
+                skipUnused();
+                return *this;
+            }
+
+            Iterator operator++(int)
+            {
+                Iterator iter = *this;
+                ++(*this);
+                return iter;
+            }
+
+            bool operator==(const Iterator& other) const { return mIter == other.mIter; }
+            bool operator!=(const Iterator& other) const { return mIter != other.mIter; }
+        };
+
+        typedef Iterator<Entry, typename std::deque<Entry>::iterator> iterator;
+        typedef Iterator<const Entry, typename std::deque<Entry>::const_iterator> const_iterator;
+
+        RecordMap()
+          : mSize(0)
+        {
+        }
+
+        /// Hash an ID as it would be after folding it to lower case.
+        static std::size_t hash(const char* id, std::size_t length)
+        {
+            // 32-bit FNV-1a
+            unsigned int result = 2166136261u;
+            for (std::size_t i = 0; i < length; ++i)
+            {
+                result ^= static_cast<unsigned char>(Misc::StringUtils::toLower(id[i]));
+                result *= 16777619u;
+            }
+            return result;
+        }
+
+        /// Look up an ID using a hash previously obtained from hash().
+        /// @return The value, or NULL if there is no such ID.
+        T* search(const char* id, std::size_t length, std::size_t hash) const
+        {
+            std::size_t slot = findSlot(id, length, hash);
+            if (slot == sNoSlot)
+                return NULL;
+            return const_cast<T*>(&mEntries[mSlots[slot] - 1].mValue);
+        }
+
+        T* search(const char* id, std::size_t length) const
+        {
+            return search(id, length, hash(id, length));
+        }
+
+        T* search(const std::string& id) const
+        {
+            return search(id.data(), id.size());
+        }
+
+        /// Insert a value, unless there already is a value for the given ID.
+        /// @return The value with that ID, and whether it has been inserted.
+        std::pair<T*, bool> insert(const std::string& id, const T& value)
+        {
+            const std::size_t idHash = hash(id.data(), id.size());
+            std::size_t slot = findSlot(id.data(), id.size(), idHash);
+            if (slot != sNoSlot)
+                return std::make_pair(&mEntries[mSlots[slot] - 1].mValue, false);
+
+            if ((mSize + 1) * 2 > mSlots.size())
+                rehash(mSlots.empty() ? 16 : mSlots.size() * 2);
+
+            std::size_t index;
+            if (!mFree.empty())
+            {
+                index = mFree.back();
+                mFree.pop_back();
+            }
+            else
+            {
+                index = mEntries.size();
+                mEntries.push_back(Entry());
+            }
+
+            Entry& entry = mEntries[index];
+            entry.mId = Misc::StringUtils::lowerCase(id);
+            entry.mHash = idHash;
+            entry.mValue = value;
+            entry.mUsed = true;
+
+            const std::size_t mask = mSlots.size() - 1;
+            for (slot = idHash & mask; mSlots[slot] != 0; slot = (slot + 1) & mask) {}
+            mSlots[slot] = static_cast<unsigned int>(index + 1);
+            ++mSize;
+
+            return std::make_pair(&entry.mValue, true);
+        }
+
+        /// Get the value for the given ID, inserting a default constructed value if there is none yet.
+        T& operator[](const std::string& id)
+        {
+            return *insert(id, T()).first;
+        }
+
+        /// @return Was there a value with that ID?
+        bool erase(const std::string& id)
+        {
+            std::size_t slot = findSlot(id.data(), id.size(), hash(id.data(), id.size()));
+            if (slot == sNoSlot)
+                return false;
+
+            const std::size_t index = mSlots[slot] - 1;
+            mEntries[index] = Entry();
+            mEntries[index].mUsed = false;
+            mFree.push_back(index);
+            --mSize;
+
+            // Backward shift deletion: move following entries of the probe sequence into the gap,
+            // unless that would put them before their home slot
+            const std::size_t mask = mSlots.size() - 1;
+            mSlots[slot] = 0;
+            for (std::size_t next = (slot + 1) & mask; mSlots[next] != 0; next = (next + 1) & mask)
+            {
+                const std::size_t home = mEntries[mSlots[next] - 1].mHash & mask;
+                const bool inPlace = (slot <= next) ? (slot < home && home <= next) : (slot < home || home <= next);
+                if (inPlace)
+                    continue;
+                mSlots[slot] = mSlots[next];
+                mSlots[next] = 0;
+                slot = next;
+            }
+            return true;
+        }
+
+        void clear()
+        {
+            mEntries.clear();
+            mFree.clear();
+            mSlots.clear();
+            mSize = 0;
+        }
+
+        void swap(RecordMap& other)
+        {
+            mEntries.swap(other.mEntries);
+            mFree.swap(other.mFree);
+            mSlots.swap(other.mSlots);
+            std::swap(mSize, other.mSize);
+        }
+
+        std::size_t size() const { return mSize; }
+        bool empty() const { return mSize == 0; }
+
+        iterator begin() { return iterator(mEntries.begin(), mEntries.end()); }
+        iterator end() { return iterator(mEntries.end(), mEntries.end()); }
+        const_iterator begin() const { return const_iterator(mEntries.begin(), mEntries.end()); }
+        const_iterator end() const { return const_iterator(mEntries.end(), mEntries.end()); }
+
+    private:
+        static const std::size_t sNoSlot = static_cast<std::size_t>(-1);
+
+        std::size_t findSlot(const char* id, std::size_t length, std::size_t hash) const
+        {
+            if (mSlots.empty())
+                return sNoSlot;
+
+            const std::size_t mask = mSlots.size() - 1;
+            for (std::size_t slot = hash & mask; mSlots[slot] != 0; slot = (slot + 1) & mask)
+            {
+                const Entry& entry = mEntries[mSlots[slot] - 1];
+                if (entry.mHash != hash || entry.mId.size() != length)
+                    continue;
+
+                std::size_t i = 0;
+                while (i < length && Misc::StringUtils::toLower(id[i]) == entry.mId[i])
+                    ++i;
+                if (i == length)
+                    return slot;
+            }
+            return sNoSlot;
+        }
+
+        void rehash(std::size_t capacity)
+        {
+            mSlots.assign(capacity, 0);
+            const std::size_t mask = capacity - 1;
+            for (std::size_t i = 0; i < mEntries.size(); ++i)
+            {
+                if (!mEntries[i].mUsed)
+                    continue;
+                std::size_t slot = mEntries[i].mHash & mask;
+                while (mSlots[slot] != 0)
+                    slot = (slot + 1) & mask;
+                mSlots[slot] = static_cast<unsigned int>(i + 1);
+            }
+        }
+
+        std::deque<Entry> mEntries;
+        /// Indices of erased entries, to be reused
+        std::vector<std::size_t> mFree;
+        /// Open-addressing table with linear probing. Holds (index into mEntries) + 1, or 0 for an empty slot.
+        std::vector<unsigned int> mSlots;
+        std::size_t mSize;
+    };
+}
+
+#endif
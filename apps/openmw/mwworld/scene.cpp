@@ -1,10 +1,13 @@
 #include "scene.hpp"
 
 #include <limits>
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 
 #include <components/loadinglistener/loadinglistener.hpp>
 #include <components/misc/resourcehelpers.hpp>
+#include <components/sceneutil/profiler.hpp>
 #include <components/settings/settings.hpp>
 #include <components/resource/resourcesystem.hpp>
 #include <components/resource/scenemanager.hpp>
@@ -70,6 +73,7 @@ namespace
             model = ""; // marker objects that have a hardcoded function in the game logic, should be hidden from the player
 
         ptr.getClass().insertObjectRendering(ptr, model, rendering);
+        rendering.pagingHideObject(ptr);
         setNodeRotation(ptr, rendering, false);
 
         ptr.getClass().insertObject (ptr, model, physics);
@@ -102,6 +106,31 @@ namespace
         }
     }
 
+    void insertObject(const MWWorld::Ptr& ptr, bool rescale, MWPhysics::PhysicsSystem& physics,
+                      MWRender::RenderingManager& rendering)
+    {
+        if (rescale)
+        {
+            if (ptr.getCellRef().getScale()<0.5)
+                ptr.getCellRef().setScale(0.5);
+            else if (ptr.getCellRef().getScale()>2)
+                ptr.getCellRef().setScale(2);
+        }
+
+        if (!ptr.getRefData().isDeleted() && ptr.getRefData().isEnabled())
+        {
+            try
+            {
+                addObject(ptr, physics, rendering);
+            }
+            catch (const std::exception& e)
+            {
+                std::string error ("failed to render '" + ptr.getCellRef().getRefId() + "': ");
+                std::cerr << error + e.what() << std::endl;
+            }
+        }
+    }
+
     struct InsertVisitor
     {
         MWWorld::CellStore& mCell;
@@ -139,27 +168,7 @@ namespace
     {
         for (std::vector<MWWorld::Ptr>::iterator it = mToInsert.begin(); it != mToInsert.end(); ++it)
         {
-            MWWorld::Ptr ptr = *it;
-            if (mRescale)
-            {
-                if (ptr.getCellRef().getScale()<0.5)
-                    ptr.getCellRef().setScale(0.5);
-                else if (ptr.getCellRef().getScale()>2)
-                    ptr.getCellRef().setScale(2);
-            }
-
-            if (!ptr.getRefData().isDeleted() && ptr.getRefData().isEnabled())
-            {
-                try
-                {
-                    addObject(ptr, mPhysics, mRendering);
-                }
-                catch (const std::exception& e)
-                {
-                    std::string error ("failed to render '" + ptr.getCellRef().getRefId() + "': ");
-                    std::cerr << error + e.what() << std::endl;
-                }
-            }
+            insertObject(*it, mRescale, mPhysics, mRendering);
 
             mLoadingListener.increaseProgress (1);
         }
@@ -175,6 +184,43 @@ namespace
         }
     };
 
+    bool isNotActor(const MWWorld::Ptr& ptr)
+    {
+        return !ptr.getClass().isActor();
+    }
+
+    /// Inserts the objects of a cell that is streamed in, see MWWorld::CellAttacher
+    struct AttachScene
+    {
+        MWWorld::Scene& mScene;
+        MWPhysics::PhysicsSystem& mPhysics;
+        MWRender::RenderingManager& mRendering;
+
+        AttachScene (MWWorld::Scene& scene, MWPhysics::PhysicsSystem& physics, MWRender::RenderingManager& rendering)
+        : mScene (scene), mPhysics (physics), mRendering (rendering)
+        {}
+
+        bool isInScene (const MWWorld::Ptr& ptr) const
+        {
+            return ptr.getRefData().getBaseNode() != NULL;
+        }
+
+        bool shouldBeInScene (const MWWorld::Ptr& ptr) const
+        {
+            return !ptr.getRefData().isDeleted() && ptr.getRefData().isEnabled();
+        }
+
+        void insert (const MWWorld::Ptr& ptr)
+        {
+            insertObject(ptr, true, mPhysics, mRendering);
+        }
+
+        void remove (const MWWorld::Ptr& ptr)
+        {
+            mScene.removeObjectFromScene(ptr);
+        }
+    };
+
 }
 
 
@@ -193,28 +239,15 @@ namespace MWWorld
 
     void Scene::getGridCenter(int &cellX, int &cellY)
     {
-        int maxX = std::numeric_limits<int>::min();
-        int maxY = std::numeric_limits<int>::min();
-        int minX = std::numeric_limits<int>::max();
-        int minY = std::numeric_limits<int>::max();
-        CellStoreCollection::iterator iter = mActiveCells.begin();
-        while (iter!=mActiveCells.end())
-        {
-            assert ((*iter)->getCell()->isExterior());
-            int x = (*iter)->getCell()->getGridX();
-            int y = (*iter)->getCell()->getGridY();
-            maxX = std::max(x, maxX);
-            maxY = std::max(y, maxY);
-            minX = std::min(x, minX);
-            minY = std::min(y, minY);
-            ++iter;
-        }
-        cellX = (minX + maxX) / 2;
-        cellY = (minY + maxY) / 2;
+        // Remembered rather than computed from the active cells, which lag behind while cells are streamed in
+        cellX = mGridCenterX;
+        cellY = mGridCenterY;
     }
 
     void Scene::update (float duration, bool paused)
     {
+        OPENMW_PROFILE_ZONE("Scene");
+
         mPreloadTimer += duration;
         if (mPreloadTimer > 0.1f)
         {
@@ -222,6 +255,8 @@ namespace MWWorld
             mPreloadTimer = 0.f;
         }
 
+        updatePendingCells();
+
         mRendering.update (duration, paused);
 
         mPreloader->updateCache(mRendering.getReferenceTime());
@@ -258,67 +293,97 @@ namespace MWWorld
         MWBase::Environment::get().getWorld()->getLocalScripts().clearCell (*iter);
 
         MWBase::Environment::get().getSoundManager()->stopSound (*iter);
+
+        for (std::map<int, CellStore*>::iterator it = mActorIdCells.begin(); it != mActorIdCells.end();)
+        {
+            if (it->second == *iter)
+                mActorIdCells.erase(it++);
+            else
+                ++it;
+        }
+
+        for (std::vector<PendingCell>::iterator it = mPendingCells.begin(); it != mPendingCells.end(); ++it)
+        {
+            if (it->mCell == *iter)
+            {
+                mPendingCells.erase(it);
+                break;
+            }
+        }
+
         mActiveCells.erase(*iter);
     }
 
     void Scene::loadCell (CellStore *cell, Loading::Listener* loadingListener, bool respawn)
     {
+        OPENMW_PROFILE_ZONE("Scene: load cell");
+
         std::pair<CellStoreCollection::iterator, bool> result = mActiveCells.insert(cell);
 
         if(result.second)
         {
             std::cout << "Loading cell " << cell->getCell()->getDescription() << std::endl;
 
-            float verts = ESM::Land::LAND_SIZE;
-            float worldsize = ESM::Land::REAL_SIZE;
-
-            // Load terrain physics first...
-            if (cell->getCell()->isExterior())
-            {
-                int cellX = cell->getCell()->getGridX();
-                int cellY = cell->getCell()->getGridY();
-                osg::ref_ptr<const ESMTerrain::LandObject> land = mRendering.getLandManager()->getLand(cellX, cellY);
-                const ESM::Land::LandData* data = land ? land->getData(ESM::Land::DATA_VHGT) : 0;
-                if (data)
-                {
-                    mPhysics->addHeightField (data->mHeights, cellX, cell->getCell()->getGridY(), worldsize / (verts-1), verts, data->mMinHeight, data->mMaxHeight, land.get());
-                }
-                else
-                {
-                    static std::vector<float> defaultHeight;
-                    defaultHeight.resize(verts*verts, ESM::Land::DEFAULT_HEIGHT);
-                    mPhysics->addHeightField (&defaultHeight[0], cell->getCell()->getGridX(), cell->getCell()->getGridY(), worldsize / (verts-1), verts, ESM::Land::DEFAULT_HEIGHT, ESM::Land::DEFAULT_HEIGHT, land.get());
-                }
-            }
+            beginCellLoad(cell, respawn);
 
             // register local scripts
             // do this before insertCell, to make sure we don't add scripts from levelled creature spawning twice
             MWBase::Environment::get().getWorld()->getLocalScripts().addCell (cell);
 
-            if (respawn)
-                cell->respawn();
-
             // ... then references. This is important for adjustPosition to work correctly.
             /// \todo rescale depending on the state of a new GMST
             insertCell (*cell, true, loadingListener);
 
-            mRendering.addCell(cell);
-            bool waterEnabled = cell->getCell()->hasWater() || cell->isExterior();
-            float waterLevel = cell->getWaterLevel();
-            mRendering.setWaterEnabled(waterEnabled);
-            if (waterEnabled)
+            endCellLoad(cell);
+        }
+
+        mPreloader->notifyLoaded(cell);
+    }
+
+    void Scene::beginCellLoad (CellStore* cell, bool respawn)
+    {
+        float verts = ESM::Land::LAND_SIZE;
+        float worldsize = ESM::Land::REAL_SIZE;
+
+        // Load terrain physics first...
+        if (cell->getCell()->isExterior())
+        {
+            int cellX = cell->getCell()->getGridX();
+            int cellY = cell->getCell()->getGridY();
+            osg::ref_ptr<const ESMTerrain::LandObject> land = mRendering.getLandManager()->getLand(cellX, cellY);
+            const ESM::Land::LandData* data = land ? land->getData(ESM::Land::DATA_VHGT) : 0;
+            if (data)
             {
-                mPhysics->enableWater(waterLevel);
-                mRendering.setWaterHeight(waterLevel);
+                mPhysics->addHeightField (data->mHeights, cellX, cell->getCell()->getGridY(), worldsize / (verts-1), verts, data->mMinHeight, data->mMaxHeight, land.get());
             }
             else
-                mPhysics->disableWater();
+            {
+                static std::vector<float> defaultHeight;
+                defaultHeight.resize(verts*verts, ESM::Land::DEFAULT_HEIGHT);
+                mPhysics->addHeightField (&defaultHeight[0], cell->getCell()->getGridX(), cell->getCell()->getGridY(), worldsize / (verts-1), verts, ESM::Land::DEFAULT_HEIGHT, ESM::Land::DEFAULT_HEIGHT, land.get());
+            }
+        }
 
-            if (!cell->isExterior() && !(cell->getCell()->mData.mFlags & ESM::Cell::QuasiEx))
-                mRendering.configureAmbient(cell->getCell());
+        if (respawn)
+            cell->respawn();
+    }
+
+    void Scene::endCellLoad (CellStore* cell)
+    {
+        mRendering.addCell(cell);
+        bool waterEnabled = cell->getCell()->hasWater() || cell->isExterior();
+        float waterLevel = cell->getWaterLevel();
+        mRendering.setWaterEnabled(waterEnabled);
+        if (waterEnabled)
+        {
+            mPhysics->enableWater(waterLevel);
+            mRendering.setWaterHeight(waterLevel);
         }
+        else
+            mPhysics->disableWater();
 
-        mPreloader->notifyLoaded(cell);
+        if (!cell->isExterior() && !(cell->getCell()->mData.mFlags & ESM::Cell::QuasiEx))
+            mRendering.configureAmbient(cell->getCell());
     }
 
     void Scene::clear()
@@ -327,6 +392,7 @@ namespace MWWorld
         while (active!=mActiveCells.end())
             unloadCell (active++);
         assert(mActiveCells.empty());
+        finishPendingCells();
         mCurrentCell = NULL;
 
         mPreloader->clear();
@@ -348,12 +414,268 @@ namespace MWWorld
         {
             int newX, newY;
             MWBase::Environment::get().getWorld()->positionToIndex(pos.x(), pos.y(), newX, newY);
-            changeCellGrid(newX, newY);
+            if (mStreamingEnabled)
+                requestCellGrid(newX, newY);
+            else
+                changeCellGrid(newX, newY);
+        }
+    }
+
+    Scene::PendingCell::PendingCell(CellStore* cell, float distance)
+        : mCell(cell)
+        , mDistance(distance)
+        , mRequestTick(osg::Timer::instance()->tick())
+        , mLoaded(false)
+        , mAttaching(false)
+        , mBuildTime(0.0)
+        , mWaitTime(0.0)
+        , mAttachTime(0.0)
+        , mLongestObjectTime(0.0)
+        , mNumFrames(0)
+    {
+    }
+
+    void Scene::requestCellGrid (int X, int Y)
+    {
+        OPENMW_PROFILE_ZONE("Scene: request cell grid");
+
+        mGridCenterX = X;
+        mGridCenterY = Y;
+
+        CellStoreCollection::iterator active = mActiveCells.begin();
+        while (active!=mActiveCells.end())
+        {
+            if ((*active)->getCell()->isExterior() &&
+                std::abs (X-(*active)->getCell()->getGridX())<=mHalfGridSize &&
+                std::abs (Y-(*active)->getCell()->getGridY())<=mHalfGridSize)
+            {
+                ++active;
+                continue;
+            }
+            unloadCell (active++);
+        }
+
+        // The cells that are still part of the grid continue attaching. Cells that did not start attaching yet are
+        // queued again below, if they are still part of the grid.
+        std::vector<PendingCell> pendingCells;
+        pendingCells.swap(mPendingCells);
+        for (std::vector<PendingCell>::iterator it = pendingCells.begin(); it != pendingCells.end(); ++it)
+        {
+            if (it->mAttaching)
+                mPendingCells.push_back(*it);
+        }
+
+        // Queue the missing cells, closest to the center first
+        for (int distance=0; distance<=mHalfGridSize; ++distance)
+        {
+            for (int x=X-distance; x<=X+distance; ++x)
+            {
+                for (int y=Y-distance; y<=Y+distance; ++y)
+                {
+                    if (std::max(std::abs(x-X), std::abs(y-Y)) != distance)
+                        continue;
+
+                    // The references are read on the work queue, then the preloader builds the objects
+                    const float cellDistance = static_cast<float>(distance) * 8192.f;
+                    CellStore* cell = MWBase::Environment::get().getWorld()->getExteriorInBackground(x, y, -cellDistance);
+                    if (mActiveCells.find(cell) != mActiveCells.end())
+                        continue;
+
+                    PendingCell pending (cell, cellDistance);
+                    for (std::vector<PendingCell>::const_iterator it = pendingCells.begin(); it != pendingCells.end(); ++it)
+                    {
+                        if (it->mCell == cell)
+                        {
+                            pending.mRequestTick = it->mRequestTick;
+                            break;
+                        }
+                    }
+                    mPendingCells.push_back(pending);
+                }
+            }
         }
+
+        CellStore* current = MWBase::Environment::get().getWorld()->getExteriorInBackground(X, Y, 0.f);
+        MWBase::Environment::get().getWindowManager()->changeCell(current);
+
+        mCellChanged = true;
+    }
+
+    void Scene::updatePendingCells()
+    {
+        if (mPendingCells.empty())
+            return;
+
+        OPENMW_PROFILE_ZONE("Scene: attach cells");
+
+        const osg::Timer* timer = osg::Timer::instance();
+        const osg::Timer_t start = timer->tick();
+        const osg::Timer_t end = start + static_cast<osg::Timer_t>(mStreamingBudget / 1000.0 / timer->getSecondsPerTick());
+
+        // Hand the cells whose references have been read over to the preloader, which builds their objects
+        for (std::vector<PendingCell>::iterator it = mPendingCells.begin(); it != mPendingCells.end() && timer->tick() < end; ++it)
+        {
+            if (it->mLoaded || !MWBase::Environment::get().getWorld()->finishBackgroundLoad(it->mCell))
+                continue;
+
+            it->mLoaded = true;
+            mPreloader->preload(it->mCell, mRendering.getReferenceTime(), it->mDistance);
+        }
+
+        while (timer->tick() < end)
+        {
+            // Continue with the cell that is being attached, or start with the first one that has been built
+            std::vector<PendingCell>::iterator pending = mPendingCells.begin();
+            for (; pending != mPendingCells.end(); ++pending)
+            {
+                if (pending->mAttaching)
+                    break;
+            }
+            if (pending == mPendingCells.end())
+            {
+                for (pending = mPendingCells.begin(); pending != mPendingCells.end(); ++pending)
+                {
+                    if (!pending->mLoaded)
+                        continue;
+
+                    // No work item means that the preloader did not take the cell, so there is nothing to wait for
+                    const SceneUtil::WorkItem* item = mPreloader->getWorkItem(pending->mCell);
+                    if (!item || item->isDone())
+                        break;
+                }
+            }
+            if (pending == mPendingCells.end())
+                return;
+
+            if (!attachPendingCell(*pending, end))
+                return;
+
+            mPendingCells.erase(pending);
+        }
+    }
+
+    bool Scene::attachPendingCell (PendingCell& pending, osg::Timer_t end)
+    {
+        const osg::Timer* timer = osg::Timer::instance();
+        const osg::Timer_t start = timer->tick();
+        CellStore* cell = pending.mCell;
+
+        if (!pending.mAttaching)
+        {
+            std::cout << "Streaming cell " << cell->getCell()->getDescription() << std::endl;
+
+            pending.mAttaching = true;
+            pending.mWaitTime = timer->delta_m(pending.mRequestTick, start);
+            if (const SceneUtil::WorkItem* item = mPreloader->getWorkItem(cell))
+                pending.mBuildTime = item->getWorkTime() * 1000.0;
+
+            // The cell is active from now on, so that objects that are inserted already are moved and removed like
+            // those of other active cells. Its own scripts only start once all objects are inserted, see CellAttacher.
+            mActiveCells.insert(cell);
+            beginCellLoad(cell, true);
+
+            Loading::Listener noLoadingScreen;
+            InsertVisitor insertVisitor (*cell, true, noLoadingScreen, *mPhysics, mRendering);
+            cell->forEach (insertVisitor);
+            // Actors go last, so that they find the ground they are standing on
+            std::stable_partition(insertVisitor.mToInsert.begin(), insertVisitor.mToInsert.end(), isNotActor);
+            pending.mAttacher = CellAttacher<Ptr>(insertVisitor.mToInsert);
+        }
+
+        ++pending.mNumFrames;
+
+        AttachScene attachScene (*this, *mPhysics, mRendering);
+        osg::Timer_t objectStart = timer->tick();
+        while (!pending.mAttacher.isDone())
+        {
+            const Ptr& ptr = pending.mAttacher.attachNext(attachScene);
+
+            const osg::Timer_t objectEnd = timer->tick();
+            const double objectTime = timer->delta_m(objectStart, objectEnd);
+            if (objectTime > pending.mLongestObjectTime)
+            {
+                pending.mLongestObjectTime = objectTime;
+                pending.mLongestObject = ptr.getCellRef().getRefId();
+            }
+            objectStart = objectEnd;
+
+            if (objectEnd >= end)
+            {
+                pending.mAttachTime += timer->delta_m(start, objectEnd);
+                return false;
+            }
+        }
+
+        Loading::Listener noLoadingScreen;
+        InsertVisitor cellObjects (*cell, true, noLoadingScreen, *mPhysics, mRendering);
+        cell->forEach (cellObjects);
+        pending.mAttacher.finish(attachScene, cellObjects.mToInsert);
+
+        // register local scripts once all objects are in place, including levelled creatures spawned and objects moved
+        // into the cell while attaching, which may have registered their scripts already
+        MWBase::Environment::get().getWorld()->getLocalScripts().clearCell (cell);
+        MWBase::Environment::get().getWorld()->getLocalScripts().addCell (cell);
+
+        AdjustPositionVisitor adjustPosVisitor;
+        cell->forEach (adjustPosVisitor);
+
+        endCellLoad(cell);
+        mPreloader->notifyLoaded(cell);
+
+        pending.mAttachTime += timer->delta_m(start, timer->tick());
+
+        std::cout << "Streamed cell " << cell->getCell()->getDescription() << ": built in " << pending.mBuildTime
+                  << " ms, attached after " << pending.mWaitTime << " ms in " << pending.mAttachTime << " ms over "
+                  << pending.mNumFrames << " frames";
+        if (pending.mLongestObjectTime > mStreamingBudget)
+            std::cout << ", '" << pending.mLongestObject << "' alone took " << pending.mLongestObjectTime
+                      << " ms, more than the budget of " << mStreamingBudget << " ms";
+        std::cout << std::endl;
+
+        return true;
+    }
+
+    bool Scene::detachPendingObject (const Ptr& ptr)
+    {
+        for (std::vector<PendingCell>::iterator it = mPendingCells.begin(); it != mPendingCells.end(); ++it)
+        {
+            if (it->mCell == ptr.getCell() && it->mAttaching)
+                return it->mAttacher.forget(ptr);
+        }
+        return false;
+    }
+
+    bool Scene::finishAttaching (CellStore* cell)
+    {
+        for (std::vector<PendingCell>::iterator it = mPendingCells.begin(); it != mPendingCells.end(); ++it)
+        {
+            if (it->mCell == cell && it->mAttaching)
+            {
+                attachPendingCell(*it, std::numeric_limits<osg::Timer_t>::max());
+                mPendingCells.erase(it);
+                break;
+            }
+        }
+        return mActiveCells.find(cell) != mActiveCells.end();
+    }
+
+    void Scene::finishPendingCells()
+    {
+        for (std::vector<PendingCell>::iterator it = mPendingCells.begin(); it != mPendingCells.end(); ++it)
+        {
+            if (it->mAttaching)
+                attachPendingCell(*it, std::numeric_limits<osg::Timer_t>::max());
+        }
+        mPendingCells.clear();
     }
 
     void Scene::changeCellGrid (int X, int Y, bool changeEvent)
     {
+        OPENMW_PROFILE_ZONE("Scene: change cell grid");
+
+        mGridCenterX = X;
+        mGridCenterY = Y;
+
         Loading::Listener* loadingListener = MWBase::Environment::get().getWindowManager()->getLoadingScreen();
         Loading::ScopedLoad load(loadingListener);
 
@@ -376,6 +698,9 @@ namespace MWWorld
             unloadCell (active++);
         }
 
+        // Cells that are still being attached are part of the new grid, so complete them here
+        finishPendingCells();
+
         int refsToLoad = 0;
         // get the number of refs to load
         for (int x=X-mHalfGridSize; x<=X+mHalfGridSize; ++x)
@@ -481,6 +806,10 @@ namespace MWWorld
     , mCellLoadingThreshold(1024.f)
     , mPreloadDistance(Settings::Manager::getInt("preload distance", "Cells"))
     , mPreloadEnabled(Settings::Manager::getBool("preload enabled", "Cells"))
+    , mStreamingEnabled(Settings::Manager::getBool("exterior cell streaming", "Cells"))
+    , mStreamingBudget(Settings::Manager::getFloat("streaming time budget", "Cells"))
+    , mGridCenterX(0)
+    , mGridCenterY(0)
     , mPreloadExteriorGrid(Settings::Manager::getBool("preload exterior grid", "Cells"))
     , mPreloadDoors(Settings::Manager::getBool("preload doors", "Cells"))
     , mPreloadFastTravel(Settings::Manager::getBool("preload fast travel", "Cells"))
@@ -493,6 +822,8 @@ namespace MWWorld
         mPhysics->setUnrefQueue(rendering.getUnrefQueue());
 
         rendering.getResourceSystem()->setExpiryDelay(Settings::Manager::getFloat("cache expiry delay", "Cells"));
+        rendering.getResourceSystem()->setMemoryBudget(
+                    static_cast<std::size_t>(std::max(0, Settings::Manager::getInt("cache memory budget", "Cells"))) * 1024 * 1024);
 
         mPreloader->setExpiryDelay(Settings::Manager::getFloat("preload cell expiry delay", "Cells"));
         mPreloader->setMinCacheSize(Settings::Manager::getInt("preload cell cache min", "Cells"));
@@ -550,6 +881,7 @@ namespace MWWorld
         CellStoreCollection::iterator active = mActiveCells.begin();
         while (active!=mActiveCells.end())
             unloadCell (active++);
+        finishPendingCells();
 
         int refsToLoad = cell->count();
         loadingListener->setProgressRange(refsToLoad);
@@ -650,10 +982,23 @@ namespace MWWorld
 
     Ptr Scene::searchPtrViaActorId (int actorId)
     {
+        std::map<int, CellStore*>::iterator cached = mActorIdCells.find (actorId);
+        if (cached != mActorIdCells.end())
+        {
+            if (Ptr ptr = cached->second->searchViaActorId (actorId))
+                return ptr;
+
+            // The actor has moved to another cell, or is gone
+            mActorIdCells.erase (cached);
+        }
+
         for (CellStoreCollection::const_iterator iter (mActiveCells.begin());
             iter!=mActiveCells.end(); ++iter)
             if (Ptr ptr = (*iter)->searchViaActorId (actorId))
+            {
+                mActorIdCells[actorId] = *iter;
                 return ptr;
+            }
 
         return Ptr();
     }
@@ -666,6 +1011,8 @@ namespace MWWorld
         {
         }
 
+        virtual const char* getName() const { return "Mesh preload"; }
+
         virtual void doWork()
         {
             try
@@ -746,14 +1093,15 @@ namespace MWWorld
             {
                 try
                 {
+                    const float distance = std::sqrt(sqrDistToPlayer);
                     if (!door.getCellRef().getDestCell().empty())
-                        preloadCell(MWBase::Environment::get().getWorld()->getInterior(door.getCellRef().getDestCell()));
+                        preloadCell(MWBase::Environment::get().getWorld()->getInterior(door.getCellRef().getDestCell()), false, distance);
                     else
                     {
                         osg::Vec3f pos = door.getCellRef().getDoorDest().asVec3();
                         int x,y;
                         MWBase::Environment::get().getWorld()->positionToIndex (pos.x(), pos.y(), x, y);
-                        preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true);
+                        preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true, distance);
                         exteriorPositions.push_back(pos);
                     }
                 }
@@ -793,13 +1141,23 @@ namespace MWWorld
                 dist = std::min(dist,std::max(std::abs(thisCellCenterX - predictedPos.x()), std::abs(thisCellCenterY - predictedPos.y())));
                 float loadDist = 8192/2 + 8192 - mCellLoadingThreshold + mPreloadDistance;
 
-                if (dist < loadDist)
-                    preloadCell(MWBase::Environment::get().getWorld()->getExterior(cellX+dx, cellY+dy));
+                if (dist >= loadDist)
+                    continue;
+
+                if (mStreamingEnabled)
+                {
+                    // Read the references in the background first, and preload once they are loaded
+                    CellStore* cell = MWBase::Environment::get().getWorld()->getExteriorInBackground(cellX+dx, cellY+dy, -dist);
+                    if (MWBase::Environment::get().getWorld()->finishBackgroundLoad(cell))
+                        preloadCell(cell, false, dist);
+                }
+                else
+                    preloadCell(MWBase::Environment::get().getWorld()->getExterior(cellX+dx, cellY+dy), false, dist);
             }
         }
     }
 
-    void Scene::preloadCell(CellStore *cell, bool preloadSurrounding)
+    void Scene::preloadCell(CellStore *cell, bool preloadSurrounding, float distance)
     {
         if (preloadSurrounding && cell->isExterior())
         {
@@ -810,14 +1168,14 @@ namespace MWWorld
             {
                 for (int dy = -mHalfGridSize; dy <= mHalfGridSize; ++dy)
                 {
-                    mPreloader->preload(MWBase::Environment::get().getWorld()->getExterior(x+dx, y+dy), mRendering.getReferenceTime());
+                    mPreloader->preload(MWBase::Environment::get().getWorld()->getExterior(x+dx, y+dy), mRendering.getReferenceTime(), distance);
                     if (++numpreloaded >= mPreloader->getMaxCacheSize())
                         break;
                 }
             }
         }
         else
-            mPreloader->preload(cell, mRendering.getReferenceTime());
+            mPreloader->preload(cell, mRendering.getReferenceTime(), distance);
     }
 
     void Scene::preloadTerrain(const osg::Vec3f &pos)
@@ -869,16 +1227,17 @@ namespace MWWorld
             cellStore->forEachType<ESM::Creature>(listVisitor);
         }
 
+        // the player has to talk to the travel service first, so these are less urgent than anything in reach
         for (std::vector<ESM::Transport::Dest>::const_iterator it = listVisitor.mList.begin(); it != listVisitor.mList.end(); ++it)
         {
             if (!it->mCellName.empty())
-                preloadCell(MWBase::Environment::get().getWorld()->getInterior(it->mCellName));
+                preloadCell(MWBase::Environment::get().getWorld()->getInterior(it->mCellName), false, mPreloadDistance);
             else
             {
                 osg::Vec3f pos = it->mPos.asVec3();
                 int x,y;
                 MWBase::Environment::get().getWorld()->positionToIndex( pos.x(), pos.y(), x, y);
-                preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true);
+                preloadCell(MWBase::Environment::get().getWorld()->getExterior(x,y), true, mPreloadDistance);
                 exteriorPositions.push_back(pos);
             }
         }
@@ -3,9 +3,15 @@
 
 #include "ptr.hpp"
 #include "globals.hpp"
+#include "cellattacher.hpp"
 
+#include <map>
 #include <set>
 #include <memory>
+#include <string>
+#include <vector>
+
+#include <osg/Timer>
 
 namespace osg
 {
@@ -52,8 +58,37 @@ namespace MWWorld
 
         private:
 
+            /// An exterior cell that is streamed in: its references are read and the resources of its objects loaded in
+            /// the background, then its objects are inserted into the scene on the main thread over as many frames as it
+            /// takes to stay within the time budget. The cell is active from the first inserted object on, but its
+            /// scripts only start once all of its objects are inserted.
+            struct PendingCell
+            {
+                PendingCell(CellStore* cell, float distance);
+
+                CellStore* mCell;
+                /// Distance from the grid center, to prioritize the closest cells
+                float mDistance;
+                osg::Timer_t mRequestTick;
+                /// Has the cell been loaded from the references read in the background, and handed to the preloader?
+                bool mLoaded;
+                bool mAttaching;
+                /// Objects to insert once attaching started
+                CellAttacher<Ptr> mAttacher;
+
+                /// Timings in milliseconds, for the report once the cell is attached
+                double mBuildTime;
+                double mWaitTime;
+                double mAttachTime;
+                double mLongestObjectTime;
+                std::string mLongestObject;
+                unsigned int mNumFrames;
+            };
+
             CellStore* mCurrentCell; // the cell the player is in
             CellStoreCollection mActiveCells;
+            /// The active cell each actor ID was last found in, so searchPtrViaActorId can usually look at one cell only
+            std::map<int, CellStore*> mActorIdCells;
             bool mCellChanged;
             MWPhysics::PhysicsSystem *mPhysics;
             MWRender::RenderingManager& mRendering;
@@ -64,6 +99,12 @@ namespace MWWorld
             float mPreloadDistance;
             bool mPreloadEnabled;
 
+            bool mStreamingEnabled;
+            float mStreamingBudget;
+            std::vector<PendingCell> mPendingCells;
+            int mGridCenterX;
+            int mGridCenterY;
+
             bool mPreloadExteriorGrid;
             bool mPreloadDoors;
             bool mPreloadFastTravel;
@@ -76,6 +117,25 @@ namespace MWWorld
             // Load and unload cells as necessary to create a cell grid with "X" and "Y" in the center
             void changeCellGrid (int X, int Y, bool changeEvent = true);
 
+            // Unload cells outside of the grid with "X" and "Y" in the center, and queue the missing ones for streaming
+            void requestCellGrid (int X, int Y);
+
+            /// Load queued cells whose references have been read, and attach those whose objects have been preloaded,
+            /// until the streaming budget of this frame is used up
+            void updatePendingCells();
+
+            /// Finish attaching the cells that started attaching, and forget the others
+            void finishPendingCells();
+
+            /// Add the terrain physics of a cell before its objects are inserted
+            void beginCellLoad (CellStore* cell, bool respawn);
+            /// Set up water and lighting once the objects of a cell are inserted
+            void endCellLoad (CellStore* cell);
+
+            /// Insert objects of a pending cell until the tick \a end is reached, then start the scripts of the cell.
+            /// @return Has the cell been attached completely?
+            bool attachPendingCell (PendingCell& pending, osg::Timer_t end);
+
             void getGridCenter(int& cellX, int& cellY);
 
             void preloadCells(float dt);
@@ -89,13 +149,21 @@ namespace MWWorld
 
             ~Scene();
 
-            void preloadCell(MWWorld::CellStore* cell, bool preloadSurrounding=false);
+            void preloadCell(MWWorld::CellStore* cell, bool preloadSurrounding=false, float distance=0.f);
             void preloadTerrain(const osg::Vec3f& pos);
 
             void unloadCell (CellStoreCollection::iterator iter);
 
             void loadCell (CellStore *cell, Loading::Listener* loadingListener, bool respawn);
 
+            /// Finish attaching \a cell if it is being streamed in.
+            /// @return Is the cell active now?
+            bool finishAttaching (CellStore* cell);
+
+            /// Do not insert \a ptr with the cell it is being attached with, as it moves to another cell.
+            /// @return Was it still to be inserted?
+            bool detachPendingObject (const Ptr& ptr);
+
             void playerMoved (const osg::Vec3f& pos);
 
             void changePlayerCell (CellStore* newCell, const ESM::Position& position, bool adjustPlayerPos);
@@ -6,6 +6,8 @@
 #include <components/loadinglistener/loadinglistener.hpp>
 #include <components/misc/rng.hpp>
 
+#include <algorithm>
+#include <cassert>
 #include <stdexcept>
 #include <sstream>
 #include <iostream>
@@ -30,6 +32,16 @@ namespace
         }
     };
 
+    /// Orders RecordMap entries by their lower case ID, like the std::map the stores used to be
+    struct EntryIdLess
+    {
+        template <typename Entry>
+        bool operator()(const Entry *x, const Entry *y) const
+        {
+            return x->mId < y->mId;
+        }
+    };
+
     struct Compare
     {
         bool operator()(const ESM::Land *x, const ESM::Land *y) {
@@ -136,26 +148,21 @@ namespace MWWorld
     template<typename T>
     const T *Store<T>::search(const std::string &id) const
     {
-        std::string idLower = Misc::StringUtils::lowerCase(id);
+        const std::size_t hash = Static::hash(id.data(), id.size());
 
-        typename Dynamic::const_iterator dit = mDynamic.find(idLower);
-        if (dit != mDynamic.end()) {
-            return &dit->second;
-        }
-
-        typename std::map<std::string, T>::const_iterator it = mStatic.find(idLower);
-
-        if (it != mStatic.end() && Misc::StringUtils::ciEqual(it->second.mId, id)) {
-            return &(it->second);
+        if (!mDynamic.empty()) {
+            const T *ptr = mDynamic.search(id.data(), id.size(), hash);
+            if (ptr) {
+                return ptr;
+            }
         }
 
-        return 0;
+        return mStatic.search(id.data(), id.size(), hash);
     }
     template<typename T>
     bool Store<T>::isDynamic(const std::string &id) const
     {
-        typename Dynamic::const_iterator dit = mDynamic.find(id);
-        return (dit != mDynamic.end());
+        return mDynamic.search(id) != NULL;
     }
     template<typename T>
     const T *Store<T>::searchRandom(const std::string &id) const
@@ -189,6 +196,27 @@ namespace MWWorld
         }
         return ptr;
     }
+    template<typename T>
+    class Store<T>::Staged : public StagedRecord
+    {
+        Store<T>& mStore;
+        T mRecord;
+        bool mIsDeleted;
+
+    public:
+        Staged(Store<T>& store, ESM::ESMReader& esm)
+            : mStore(store), mIsDeleted(false)
+        {
+            mRecord.load(esm, mIsDeleted);
+            Misc::StringUtils::lowerCaseInPlace(mRecord.mId);
+        }
+
+        virtual RecordId apply()
+        {
+            return mStore.insertLoaded(mRecord, mIsDeleted);
+        }
+    };
+
     template<typename T>
     RecordId Store<T>::load(ESM::ESMReader &esm) 
     {
@@ -198,11 +226,21 @@ namespace MWWorld
         record.load(esm, isDeleted);
         Misc::StringUtils::lowerCaseInPlace(record.mId);
 
-        std::pair<typename Static::iterator, bool> inserted = mStatic.insert(std::make_pair(record.mId, record));
+        return insertLoaded(record, isDeleted);
+    }
+    template<typename T>
+    StagedRecord *Store<T>::stage(ESM::ESMReader &esm)
+    {
+        return new Staged(*this, esm);
+    }
+    template<typename T>
+    RecordId Store<T>::insertLoaded(T &record, bool isDeleted)
+    {
+        std::pair<T*, bool> inserted = mStatic.insert(record.mId, record);
         if (inserted.second)
-            mShared.push_back(&inserted.first->second);
+            mShared.push_back(inserted.first);
         else
-            inserted.first->second = record;
+            *inserted.first = record;
 
         return RecordId(record.mId, isDeleted);
     }
@@ -245,10 +283,8 @@ namespace MWWorld
     template<typename T>
     T *Store<T>::insert(const T &item)
     {
-        std::string id = Misc::StringUtils::lowerCase(item.mId);
-        std::pair<typename Dynamic::iterator, bool> result =
-            mDynamic.insert(std::pair<std::string, T>(id, item));
-        T *ptr = &result.first->second;
+        std::pair<T*, bool> result = mDynamic.insert(item.mId, item);
+        T *ptr = result.first;
         if (result.second) {
             mShared.push_back(ptr);
         } else {
@@ -259,10 +295,8 @@ namespace MWWorld
     template<typename T>
     T *Store<T>::insertStatic(const T &item)
     {
-        std::string id = Misc::StringUtils::lowerCase(item.mId);
-        std::pair<typename Static::iterator, bool> result =
-            mStatic.insert(std::pair<std::string, T>(id, item));
-        T *ptr = &result.first->second;
+        std::pair<T*, bool> result = mStatic.insert(item.mId, item);
+        T *ptr = result.first;
         if (result.second) {
             mShared.push_back(ptr);
         } else {
@@ -273,23 +307,17 @@ namespace MWWorld
     template<typename T>
     bool Store<T>::eraseStatic(const std::string &id)
     {
-        std::string idLower = Misc::StringUtils::lowerCase(id);
-
-        typename std::map<std::string, T>::iterator it = mStatic.find(idLower);
+        T *ptr = mStatic.search(id);
 
-        if (it != mStatic.end() && Misc::StringUtils::ciEqual(it->second.mId, id)) {
+        if (ptr) {
             // delete from the static part of mShared
-            typename std::vector<T *>::iterator sharedIter = mShared.begin();
-            typename std::vector<T *>::iterator end = sharedIter + mStatic.size();
+            assert(mShared.size() >= mStatic.size());
+            typename std::vector<T *>::iterator end = mShared.begin() + mStatic.size();
+            typename std::vector<T *>::iterator sharedIter = std::find(mShared.begin(), end, ptr);
+            if (sharedIter != end)
+                mShared.erase(sharedIter);
 
-            while (sharedIter != mShared.end() && sharedIter != end) {
-                if((*sharedIter)->mId == idLower) {
-                    mShared.erase(sharedIter);
-                    break;
-                }
-                ++sharedIter;
-            }
-            mStatic.erase(it);
+            mStatic.erase(id);
         }
 
         return true;
@@ -298,19 +326,18 @@ namespace MWWorld
     template<typename T>
     bool Store<T>::erase(const std::string &id)
     {
-        std::string key = Misc::StringUtils::lowerCase(id);
-        typename Dynamic::iterator it = mDynamic.find(key);
-        if (it == mDynamic.end()) {
+        T *ptr = mDynamic.search(id);
+        if (!ptr) {
             return false;
         }
-        mDynamic.erase(it);
 
-        // have to reinit the whole shared part
+        // delete from the dynamic part of mShared, keeping the order of the remaining records
         assert(mShared.size() >= mStatic.size());
-        mShared.erase(mShared.begin() + mStatic.size(), mShared.end());
-        for (it = mDynamic.begin(); it != mDynamic.end(); ++it) {
-            mShared.push_back(&it->second);
-        }
+        typename std::vector<T *>::iterator sharedIter = std::find(mShared.begin() + mStatic.size(), mShared.end(), ptr);
+        if (sharedIter != mShared.end())
+            mShared.erase(sharedIter);
+
+        mDynamic.erase(id);
         return true;
     }
     template<typename T>
@@ -321,11 +348,20 @@ namespace MWWorld
     template<typename T>
     void Store<T>::write (ESM::ESMWriter& writer, Loading::Listener& progress) const
     {
+        // Write the records sorted by ID rather than in the order of the hash map, so that saving the same game
+        // always gives the same file
+        std::vector<const typename Dynamic::Entry*> entries;
+        entries.reserve(mDynamic.size());
         for (typename Dynamic::const_iterator iter (mDynamic.begin()); iter!=mDynamic.end();
              ++iter)
+            entries.push_back(&*iter);
+        std::sort(entries.begin(), entries.end(), EntryIdLess());
+
+        for (typename std::vector<const typename Dynamic::Entry*>::const_iterator iter (entries.begin());
+             iter!=entries.end(); ++iter)
         {
             writer.startRecord (T::sRecordId);
-            iter->second.save (writer);
+            (*iter)->mValue.save (writer);
             writer.endRecord (T::sRecordId);
         }
     }
@@ -1034,20 +1070,32 @@ namespace MWWorld
     {
         // DialInfos marked as deleted are kept during the loading phase, so that the linked list
         // structure is kept intact for inserting further INFOs. Delete them now that loading is done.
+        std::vector<Static::Entry*> entries;
+        entries.reserve(mStatic.size());
         for (Static::iterator it = mStatic.begin(); it != mStatic.end(); ++it)
         {
-            ESM::Dialogue& dial = it->second;
+            ESM::Dialogue& dial = it->mValue;
             dial.clearDeletedInfos();
+            entries.push_back(&*it);
         }
 
+        // Dialogues are listed in alphabetical order
+        std::sort(entries.begin(), entries.end(), EntryIdLess());
+
         mShared.clear();
-        mShared.reserve(mStatic.size());
-        std::map<std::string, ESM::Dialogue>::iterator it = mStatic.begin();
-        for (; it != mStatic.end(); ++it) {
-            mShared.push_back(&(it->second));
+        mShared.reserve(entries.size());
+        for (std::vector<Static::Entry*>::const_iterator it = entries.begin(); it != entries.end(); ++it) {
+            mShared.push_back(&(*it)->mValue);
         }
     }
 
+    template <>
+    StagedRecord *Store<ESM::Dialogue>::stage(ESM::ESMReader &esm)
+    {
+        // Dialogues are merged with previously loaded ones, and the INFOs following them must be read into the merged record
+        return NULL;
+    }
+
     template <>
     inline RecordId Store<ESM::Dialogue>::load(ESM::ESMReader &esm) {
         // The original letter case of a dialogue ID is saved, because it's printed
@@ -1056,17 +1104,16 @@ namespace MWWorld
 
         dialogue.loadId(esm);
 
-        std::string idLower = Misc::StringUtils::lowerCase(dialogue.mId);
-        std::map<std::string, ESM::Dialogue>::iterator found = mStatic.find(idLower);
-        if (found == mStatic.end())
+        ESM::Dialogue *found = mStatic.search(dialogue.mId);
+        if (!found)
         {
             dialogue.loadData(esm, isDeleted);
-            mStatic.insert(std::make_pair(idLower, dialogue));
+            mStatic.insert(dialogue.mId, dialogue);
         }
         else
         {
-            found->second.loadData(esm, isDeleted);
-            dialogue = found->second;
+            found->loadData(esm, isDeleted);
+            dialogue = *found;
         }
 
         return RecordId(dialogue.mId, isDeleted);
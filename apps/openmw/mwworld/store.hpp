@@ -6,10 +6,12 @@
 #include <map>
 
 #include "recordcmp.hpp"
+#include "recordmap.hpp"
 
 namespace ESM
 {
     struct Land;
+    struct Dialogue;
 }
 
 namespace Loading
@@ -27,6 +29,17 @@ namespace MWWorld
         RecordId(const std::string &id = "", bool isDeleted = false);
     };
 
+    /// A record that has been read from a content file, but not yet added to its store.
+    /// @see StoreBase::stage
+    class StagedRecord
+    {
+    public:
+        virtual ~StagedRecord() {}
+
+        /// Add the record to the store it was read for, with the same effect as StoreBase::load.
+        virtual RecordId apply() = 0;
+    };
+
     class StoreBase
     {
     public:
@@ -41,6 +54,12 @@ namespace MWWorld
         virtual int getDynamicSize() const { return 0; }
         virtual RecordId load(ESM::ESMReader &esm) = 0;
 
+        /// Read a record without modifying the store, so that content files can be read in parallel.
+        /// @return The record, to be applied in load order later on, or NULL if records of this store
+        /// depend on previously loaded records and have to be read through load().
+        /// @note Must not access the store's contents, is called from worker threads.
+        virtual StagedRecord* stage(ESM::ESMReader &esm) { return NULL; }
+
         virtual bool eraseStatic(const std::string &id) {return false;}
         virtual void clearDynamic() {}
 
@@ -138,17 +157,23 @@ namespace MWWorld
     template <class T>
     class Store : public StoreBase
     {
-        std::map<std::string, T>      mStatic;
+        RecordMap<T>        mStatic;
         std::vector<T *>    mShared; // Preserves the record order as it came from the content files (this
                                      // is relevant for the spell autocalc code and selection order
                                      // for heads/hairs in the character creation)
-        std::map<std::string, T> mDynamic;
+        RecordMap<T>        mDynamic;
 
-        typedef std::map<std::string, T> Dynamic;
-        typedef std::map<std::string, T> Static;
+        typedef RecordMap<T> Dynamic;
+        typedef RecordMap<T> Static;
 
         friend class ESMStore;
 
+        class Staged;
+
+        /// Insert a record read from a content file, overwriting an existing record with the same ID.
+        /// @note Expects the record ID to be lower case already.
+        RecordId insertLoaded(T &record, bool isDeleted);
+
     public:
         Store();
         Store(const Store<T> &orig);
@@ -159,6 +184,7 @@ namespace MWWorld
         virtual void clearDynamic();
         void setUp();
 
+        /// @note Does not allocate, the ID is folded to lower case on the fly.
         const T *search(const std::string &id) const;
 
         /**
@@ -192,10 +218,14 @@ namespace MWWorld
         bool erase(const T &item);
 
         RecordId load(ESM::ESMReader &esm);
+        StagedRecord* stage(ESM::ESMReader &esm);
         void write(ESM::ESMWriter& writer, Loading::Listener& progress) const;
         RecordId read(ESM::ESMReader& reader);
     };
 
+    template <>
+    StagedRecord* Store<ESM::Dialogue>::stage(ESM::ESMReader &esm);
+
     template <>
     class Store<ESM::LandTexture> : public StoreBase
     {
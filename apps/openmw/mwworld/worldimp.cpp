@@ -1,5 +1,7 @@
 #include "worldimp.hpp"
 
+#include <set>
+
 #include <osg/Group>
 #include <osg/ComputeBoundsVisitor>
 
@@ -10,6 +12,8 @@
 #include <components/misc/resourcehelpers.hpp>
 #include <components/misc/rng.hpp>
 
+#include <components/settings/settings.hpp>
+
 #include <components/files/collections.hpp>
 
 #include <components/resource/resourcesystem.hpp>
@@ -101,6 +105,17 @@ namespace MWWorld
             }
         }
 
+        void finish()
+        {
+            // The same loader is registered for several extensions
+            std::set<ContentLoader*> finished;
+            for (LoadersContainer::iterator it = mLoaders.begin(); it != mLoaders.end(); ++it)
+            {
+                if (finished.insert(it->second).second)
+                    it->second->finish();
+            }
+        }
+
         private:
           typedef std::map<std::string, ContentLoader*> LoadersContainer;
           LoadersContainer mLoaders;
@@ -166,7 +181,9 @@ namespace MWWorld
         listener->loadingOn();
 
         GameContentLoader gameContentLoader(*listener);
-        EsmLoader esmLoader(mStore, mEsm, encoder, *listener);
+        EsmLoader esmLoader(mStore, mEsm, encoder, *listener,
+                            Settings::Manager::getBool("parallel content loading", "General"),
+                            Settings::Manager::getBool("memory mapped content files", "General"));
 
         gameContentLoader.addLoader(".esm", &esmLoader);
         gameContentLoader.addLoader(".esp", &esmLoader);
@@ -187,6 +204,11 @@ namespace MWWorld
         mStore.setUp();
         mStore.movePlayerRecord();
 
+        mRendering->setObjectPagingContent(mStore, mEsm);
+
+        mCells.setWorkQueue (workQueue, encoder);
+        mCells.buildRefIndex();
+
         mSwimHeightScale = mStore.get<ESM::GameSetting>().find("fSwimHeightScale")->getFloat();
 
         mWeatherManager = new MWWorld::WeatherManager(*mRendering, mFallback, mStore);
@@ -531,6 +553,16 @@ namespace MWWorld
         return mCells.getExterior (x, y);
     }
 
+    CellStore *World::getExteriorInBackground (int x, int y, float priority)
+    {
+        return mCells.getExteriorInBackground (x, y, priority);
+    }
+
+    bool World::finishBackgroundLoad (CellStore *cell)
+    {
+        return mCells.finishBackgroundLoad (cell);
+    }
+
     CellStore *World::getInterior (const std::string& name)
     {
         return mCells.getInterior (name);
@@ -619,6 +651,49 @@ namespace MWWorld
         return mGlobalVariables.getType (name);
     }
 
+    int World::getGlobalSlot (const std::string& name) const
+    {
+        return mGlobalVariables.getSlot (name);
+    }
+
+    void World::setGlobalInt (int slot, int value)
+    {
+        ESM::Variant& variable = mGlobalVariables[slot];
+
+        if (&variable==mGameHour)
+            setHour (value);
+        else if (&variable==mDay)
+            setDay (value);
+        else if (&variable==mMonth)
+            setMonth (value);
+        else
+            variable.setInteger (value);
+    }
+
+    void World::setGlobalFloat (int slot, float value)
+    {
+        ESM::Variant& variable = mGlobalVariables[slot];
+
+        if (&variable==mGameHour)
+            setHour (value);
+        else if (&variable==mDay)
+            setDay(static_cast<int>(value));
+        else if (&variable==mMonth)
+            setMonth(static_cast<int>(value));
+        else
+            variable.setFloat (value);
+    }
+
+    int World::getGlobalInt (int slot) const
+    {
+        return mGlobalVariables[slot].getInteger();
+    }
+
+    float World::getGlobalFloat (int slot) const
+    {
+        return mGlobalVariables[slot].getFloat();
+    }
+
     std::string World::getCellName (const MWWorld::CellStore *cell) const
     {
         if (!cell)
@@ -773,6 +848,7 @@ namespace MWWorld
         if (!reference.getRefData().isEnabled())
         {
             reference.getRefData().enable();
+            mRendering->pagingBlacklistObject(reference);
 
             if(mWorldScene->getActiveCells().find (reference.getCell()) != mWorldScene->getActiveCells().end() && reference.getRefData().getCount())
                 mWorldScene->addObjectToScene (reference);
@@ -810,6 +886,7 @@ namespace MWWorld
                 throw std::runtime_error("can not disable player object");
 
             reference.getRefData().disable();
+            mRendering->pagingBlacklistObject(reference);
 
             if(mWorldScene->getActiveCells().find (reference.getCell())!=mWorldScene->getActiveCells().end() && reference.getRefData().getCount())
                 mWorldScene->removeObjectFromScene (reference);
@@ -1109,6 +1186,7 @@ namespace MWWorld
                 throw std::runtime_error("can not delete player object");
 
             ptr.getRefData().setCount(0);
+            mRendering->pagingBlacklistObject(ptr);
 
             if (ptr.isInCell()
                 && mWorldScene->getActiveCells().find(ptr.getCell()) != mWorldScene->getActiveCells().end()
@@ -1140,6 +1218,11 @@ namespace MWWorld
         }
     }
 
+    void World::pagingBlacklistChangedObjects (const CellStore& cell)
+    {
+        mRendering->pagingBlacklistChangedObjects (cell);
+    }
+
     MWWorld::Ptr World::moveObject(const Ptr &ptr, CellStore* newCell, float x, float y, float z, bool movePhysics)
     {
         ESM::Position pos = ptr.getRefData().getPosition();
@@ -1149,6 +1232,7 @@ namespace MWWorld
         pos.pos[2] = z;
 
         ptr.getRefData().setPosition(pos);
+        mRendering->pagingBlacklistObject(ptr);
 
         osg::Vec3f vec(x, y, z);
 
@@ -1167,7 +1251,7 @@ namespace MWWorld
                     changeToInteriorCell(Misc::StringUtils::lowerCase(newCell->getCell()->mName), pos, false);
                 else
                 {
-                    if (mWorldScene->isCellActive(*newCell))
+                    if (mWorldScene->finishAttaching(newCell))
                         mWorldScene->changePlayerCell(newCell, pos, false);
                     else
                         mWorldScene->changeToExteriorCell(pos, false);
@@ -1179,6 +1263,9 @@ namespace MWWorld
             {
                 bool currCellActive = mWorldScene->isCellActive(*currCell);
                 bool newCellActive = mWorldScene->isCellActive(*newCell);
+                // An object of a cell that is still being attached may not be in the scene yet. It is then inserted with
+                // its new cell, if that is active, rather than with its old one.
+                bool notAttachedYet = mWorldScene->detachPendingObject(ptr);
                 if (!currCellActive && newCellActive)
                 {
                     newPtr = currCell->moveTo(ptr, newCell);
@@ -1206,12 +1293,20 @@ namespace MWWorld
                 {
                     newPtr = currCell->moveTo(ptr, newCell);
 
-                    mRendering->updatePtr(ptr, newPtr);
-                    MWBase::Environment::get().getSoundManager()->updatePtr (ptr, newPtr);
-                    mPhysics->updatePtr(ptr, newPtr);
+                    if (notAttachedYet)
+                    {
+                        if (newPtr.getRefData().isEnabled() && !newPtr.getRefData().isDeleted())
+                            mWorldScene->addObjectToScene(newPtr);
+                    }
+                    else
+                    {
+                        mRendering->updatePtr(ptr, newPtr);
+                        MWBase::Environment::get().getSoundManager()->updatePtr (ptr, newPtr);
+                        mPhysics->updatePtr(ptr, newPtr);
 
-                    MWBase::MechanicsManager *mechMgr = MWBase::Environment::get().getMechanicsManager();
-                    mechMgr->updateCell(ptr, newPtr);
+                        MWBase::MechanicsManager *mechMgr = MWBase::Environment::get().getMechanicsManager();
+                        mechMgr->updateCell(ptr, newPtr);
+                    }
 
                     std::string script =
                         ptr.getClass().getScript(ptr);
@@ -1223,6 +1318,8 @@ namespace MWWorld
                         addContainerScripts (newPtr, newCell);
                     }
                 }
+
+                mCells.addRef (newPtr.getCellRef().getRefId(), *newCell);
             }
         }
         if (haveToMove && newPtr.getRefData().getBaseNode())
@@ -1260,6 +1357,7 @@ namespace MWWorld
     void World::scaleObject (const Ptr& ptr, float scale)
     {
         ptr.getCellRef().setScale(scale);
+        mRendering->pagingBlacklistObject(ptr);
 
         mWorldScene->updateObjectScale(ptr);
     }
@@ -1299,6 +1397,7 @@ namespace MWWorld
         }
 
         ptr.getRefData().setPosition(pos);
+        mRendering->pagingBlacklistObject(ptr);
 
         if(ptr.getRefData().getBaseNode() != 0)
             mWorldScene->updateObjectRotation(ptr, true);
@@ -1990,6 +2089,8 @@ namespace MWWorld
         dropped.getCellRef().setPosition(pos);
         dropped.getCellRef().unsetRefNum();
 
+        mCells.addRef(dropped.getCellRef().getRefId(), *cell);
+
         if (mWorldScene->isCellActive(*cell)) {
             if (dropped.getRefData().isEnabled()) {
                 mWorldScene->addObjectToScene(dropped);
@@ -2276,9 +2377,9 @@ namespace MWWorld
         return mRendering->getAnimation(ptr);
     }
 
-    void World::screenshot(osg::Image* image, int w, int h)
+    bool World::screenshot(osg::Image* image, int w, int h)
     {
-        mRendering->screenshot(image, w, h);
+        return mRendering->screenshot(image, w, h);
     }
 
     void World::activateDoor(const MWWorld::Ptr& door)
@@ -2687,6 +2788,7 @@ namespace MWWorld
                 throw std::runtime_error(msg.str());
             }
         }
+        contentLoader.finish();
     }
 
     bool World::startSpellCast(const Ptr &actor)
@@ -206,6 +206,10 @@ namespace MWWorld
 
             CellStore *getExterior (int x, int y) override;
 
+            CellStore *getExteriorInBackground (int x, int y, float priority) override;
+
+            bool finishBackgroundLoad (CellStore *cell) override;
+
             CellStore *getInterior (const std::string& name) override;
 
             CellStore *getCell (const ESM::CellId& id) override;
@@ -259,6 +263,23 @@ namespace MWWorld
             char getGlobalVariableType (const std::string& name) const override;
             ///< Return ' ', if there is no global variable with this name.
 
+            int getGlobalSlot (const std::string& name) const override;
+            ///< Return the slot of a global variable, to access it with the functions below.
+            /// Slots stay the same while the content files do not change.
+            /// Throws, if there is no global variable with this name.
+
+            void setGlobalInt (int slot, int value) override;
+            ///< Set value independently from real type.
+
+            void setGlobalFloat (int slot, float value) override;
+            ///< Set value independently from real type.
+
+            int getGlobalInt (int slot) const override;
+            ///< Get value independently from real type.
+
+            float getGlobalFloat (int slot) const override;
+            ///< Get value independently from real type.
+
             std::string getCellName (const MWWorld::CellStore *cell = 0) const override;
             ///< Return name of the cell.
             ///
@@ -364,6 +385,10 @@ namespace MWWorld
 
             void undeleteObject (const Ptr& ptr) override;
 
+            void pagingBlacklistChangedObjects (const CellStore& cell) override;
+            ///< Stop drawing the objects of \a cell that were changed from their state in the content
+            /// files as distant objects, e.g. after the state of the cell was loaded from a saved game.
+
             MWWorld::Ptr moveObject (const Ptr& ptr, float x, float y, float z) override;
             ///< @return an updated Ptr in case the Ptr's cell changes
 
@@ -559,7 +584,7 @@ namespace MWWorld
             void reattachPlayerCamera() override;
 
             /// \todo this does not belong here
-            void screenshot (osg::Image* image, int w, int h) override;
+            bool screenshot (osg::Image* image, int w, int h) override;
 
             /// Find center of exterior cell above land surface
             /// \return false if exterior with given name not exists, true otherwise
@@ -0,0 +1,39 @@
+#ifndef OPENMW_TEST_SUITE_BENCHMARK_H
+#define OPENMW_TEST_SUITE_BENCHMARK_H
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+/// Benchmarks are named DISABLED_*_benchmark, so that they only run, and only print their results, when asked for with
+/// --gtest_also_run_disabled_tests, e.g. --gtest_filter=*benchmark --gtest_also_run_disabled_tests
+namespace Benchmark
+{
+
+    /// Measures the wall clock time since it was created or restarted
+    class Timer
+    {
+    public:
+        Timer() : mStart(Clock::now()) {}
+
+        void restart() { mStart = Clock::now(); }
+
+        double getMilliseconds() const { return std::chrono::duration<double, std::milli>(Clock::now() - mStart).count(); }
+
+        double getSeconds() const { return std::chrono::duration<double>(Clock::now() - mStart).count(); }
+
+    private:
+        typedef std::chrono::steady_clock Clock;
+
+        Clock::time_point mStart;
+    };
+
+    /// Print the result of a benchmark, e.g. "VFS lookup of 180000 names: 12.5 ms"
+    inline void report(const std::string& what, double milliseconds)
+    {
+        std::cout << what << ": " << milliseconds << " ms" << std::endl;
+    }
+
+}
+
+#endif
@@ -0,0 +1,160 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <components/bsa/bsa_file.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    /// Writes a TES3 archive with a few thousand files, each holding its index as content.
+    struct BSAFileTest : public ::testing::Test
+    {
+        std::string mPath;
+        std::vector<std::string> mNames;
+
+        virtual void SetUp()
+        {
+            static const char* directories[] = { "meshes\\", "meshes\\x\\", "meshes\\r\\", "meshes\\i\\", "textures\\",
+                                                 "textures\\tx_", "icons\\m\\", "sound\\fx\\", "sound\\vo\\d\\m\\" };
+            static const char* extensions[] = { ".nif", ".nif", ".nif", ".nif", ".dds", ".dds", ".dds", ".wav", ".mp3" };
+            const std::size_t count = sizeof(directories) / sizeof(directories[0]);
+
+            for (int i = 0; i < 8500; ++i)
+            {
+                std::ostringstream stream;
+                stream << directories[i % count] << "object_" << i << extensions[i % count];
+                mNames.push_back(stream.str());
+            }
+
+            std::string nameBuffer;
+            std::vector<uint32_t> directory;
+            for (std::size_t i = 0; i < mNames.size(); ++i)
+            {
+                directory.push_back(4); // size
+                directory.push_back(static_cast<uint32_t>(4 * i)); // offset
+            }
+            for (std::size_t i = 0; i < mNames.size(); ++i)
+            {
+                directory.push_back(static_cast<uint32_t>(nameBuffer.size()));
+                nameBuffer += mNames[i];
+                nameBuffer.push_back('\0');
+            }
+
+            const uint32_t numFiles = static_cast<uint32_t>(mNames.size());
+            const uint32_t header[3] = { 0x100, static_cast<uint32_t>(12 * numFiles + nameBuffer.size()), numFiles };
+
+            mPath = "openmw_test_suite_archive.bsa";
+            std::ofstream stream(mPath.c_str(), std::ios::binary);
+            stream.write(reinterpret_cast<const char*>(header), sizeof(header));
+            stream.write(reinterpret_cast<const char*>(&directory[0]), directory.size() * sizeof(uint32_t));
+            stream.write(nameBuffer.data(), nameBuffer.size());
+            for (std::size_t i = 0; i < mNames.size(); ++i)
+            {
+                const uint64_t hash = Bsa::BSAFile::getHash(mNames[i].data(), mNames[i].size());
+                stream.write(reinterpret_cast<const char*>(&hash), sizeof(hash));
+            }
+            for (std::size_t i = 0; i < mNames.size(); ++i)
+                stream.write(reinterpret_cast<const char*>(&i), 4);
+        }
+
+        virtual void TearDown()
+        {
+            std::remove(mPath.c_str());
+        }
+    };
+
+}
+
+TEST_F(BSAFileTest, hash_is_case_insensitive)
+{
+    const std::string name = "meshes\\r\\xbase_anim.nif";
+    const std::string other = "Meshes\\R\\XBase_Anim.NIF";
+    EXPECT_EQ(Bsa::BSAFile::getHash(name.data(), name.size()), Bsa::BSAFile::getHash(other.data(), other.size()));
+}
+
+TEST_F(BSAFileTest, lookup_finds_every_file)
+{
+    Bsa::BSAFile bsa;
+    bsa.open(mPath);
+
+    for (std::size_t i = 0; i < mNames.size(); ++i)
+    {
+        std::string name = mNames[i];
+        ASSERT_TRUE(bsa.exists(name.c_str())) << name;
+
+        std::transform(name.begin(), name.end(), name.begin(), ::toupper);
+        ASSERT_TRUE(bsa.exists(name.c_str())) << name;
+    }
+
+    EXPECT_FALSE(bsa.exists("meshes\\doesnotexist.nif"));
+    EXPECT_FALSE(bsa.exists("meshes\\object_0.ni"));
+    EXPECT_FALSE(bsa.exists(""));
+    // like the old ciLess lookup, separators are not normalized; the VFS and bsatool pass names with backslashes
+    EXPECT_FALSE(bsa.exists("meshes/object_0.nif"));
+
+    Files::IStreamPtr stream = bsa.getFile("TEXTURES\\object_4.dds");
+    uint32_t content = 0;
+    stream->read(reinterpret_cast<char*>(&content), sizeof(content));
+    EXPECT_EQ(content, 4u);
+}
+
+TEST_F(BSAFileTest, memory_mapped_archive_gives_direct_access_to_file_data)
+{
+    Bsa::BSAFile bsa;
+    bsa.open(mPath, true);
+    ASSERT_TRUE(bsa.isMemoryMapped());
+
+    const Bsa::BSAFile::FileList& files = bsa.getList();
+    for (std::size_t i = 0; i < files.size(); i += 97)
+    {
+        const char* data = NULL;
+        size_t size = 0;
+        ASSERT_TRUE(bsa.getFileData(&files[i], data, size)) << files[i].name;
+        ASSERT_EQ(size, 4u);
+
+        uint32_t content = 0;
+        memcpy(&content, data, sizeof(content));
+        EXPECT_EQ(content, i);
+
+        Files::IStreamPtr stream = bsa.getFile(&files[i]);
+        uint32_t streamed = 0;
+        stream->read(reinterpret_cast<char*>(&streamed), sizeof(streamed));
+        EXPECT_EQ(streamed, content);
+    }
+
+    Bsa::BSAFile unmapped;
+    unmapped.open(mPath);
+    EXPECT_FALSE(unmapped.isMemoryMapped());
+    const char* data = NULL;
+    size_t size = 0;
+    EXPECT_FALSE(unmapped.getFileData(&unmapped.getList()[0], data, size));
+}
+
+/// Look up every file of the archive by name
+TEST_F(BSAFileTest, DISABLED_lookup_benchmark)
+{
+    const int iterations = 20;
+
+    Bsa::BSAFile bsa;
+    bsa.open(mPath);
+
+    std::size_t found = 0;
+    Benchmark::Timer timer;
+    for (int n = 0; n < iterations; ++n)
+    {
+        for (std::size_t i = 0; i < mNames.size(); ++i)
+            found += bsa.exists(mNames[i].c_str());
+    }
+    const double time = timer.getMilliseconds();
+
+    EXPECT_EQ(found, mNames.size() * iterations);
+
+    Benchmark::report("BSA lookup of " + std::to_string(mNames.size() * iterations) + " names", time);
+}
@@ -0,0 +1,188 @@
+#include <gtest/gtest.h>
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+
+#include <components/esm/defs.hpp>
+#include <components/esm/esmreader.hpp>
+#include <components/esm/esmwriter.hpp>
+#include <components/esm/loadbook.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    /// Writes a content file with a large number of book records.
+    struct ESMReaderTest : public ::testing::Test
+    {
+        std::string mPath;
+        std::vector<ESM::Book> mRecords;
+
+        virtual void SetUp()
+        {
+            for (int i = 0; i < 20000; ++i)
+            {
+                ESM::Book book;
+                book.blank();
+
+                std::ostringstream id;
+                id << "bookskill_" << i;
+                book.mId = id.str();
+                book.mName = "The Book of " + id.str();
+                book.mModel = "m\\text_octavo_" + id.str() + ".nif";
+                book.mIcon = "m\\tx_octavo_" + id.str() + ".tga";
+                book.mText = std::string(100 + i % 1000, 'x');
+                book.mData.mValue = i;
+                mRecords.push_back(book);
+            }
+
+            mPath = "openmw_test_suite_content.esm";
+            std::ofstream stream(mPath.c_str(), std::ios::binary);
+
+            ESM::ESMWriter writer;
+            writer.setFormat(0);
+            writer.save(stream);
+            for (std::size_t i = 0; i < mRecords.size(); ++i)
+            {
+                writer.startRecord(ESM::Book::sRecordId);
+                mRecords[i].save(writer, false);
+                writer.endRecord(ESM::Book::sRecordId);
+            }
+            writer.close();
+        }
+
+        virtual void TearDown()
+        {
+            std::remove(mPath.c_str());
+        }
+
+        /// Load all records from the test file.
+        /// @return Number of records loaded
+        std::size_t loadRecords(bool memoryMapped, std::vector<ESM::Book>* records)
+        {
+            ESM::ESMReader reader;
+            reader.setMemoryMapped(memoryMapped);
+            reader.open(mPath);
+            EXPECT_EQ(reader.isMemoryMapped(), memoryMapped);
+
+            std::size_t count = 0;
+            while (reader.hasMoreRecs())
+            {
+                ESM::NAME name = reader.getRecName();
+                reader.getRecHeader();
+                EXPECT_TRUE(name == ESM::REC_BOOK);
+
+                ESM::Book book;
+                bool isDeleted = false;
+                book.load(reader, isDeleted);
+                if (records)
+                    records->push_back(book);
+                ++count;
+            }
+            return count;
+        }
+    };
+
+}
+
+TEST_F(ESMReaderTest, memory_mapped_reader_matches_stream_reader)
+{
+    std::vector<ESM::Book> streamed;
+    std::vector<ESM::Book> mapped;
+    loadRecords(false, &streamed);
+    loadRecords(true, &mapped);
+
+    ASSERT_EQ(streamed.size(), mRecords.size());
+    ASSERT_EQ(mapped.size(), mRecords.size());
+    for (std::size_t i = 0; i < mRecords.size(); ++i)
+    {
+        EXPECT_EQ(mapped[i].mId, mRecords[i].mId);
+        EXPECT_EQ(mapped[i].mId, streamed[i].mId);
+        EXPECT_EQ(mapped[i].mModel, streamed[i].mModel);
+        EXPECT_EQ(mapped[i].mText, streamed[i].mText);
+        EXPECT_EQ(mapped[i].mData.mValue, streamed[i].mData.mValue);
+    }
+}
+
+TEST_F(ESMReaderTest, memory_mapped_reader_skips_records_and_restores_contexts)
+{
+    ESM::ESMReader reader;
+    reader.setMemoryMapped(true);
+    reader.open(mPath);
+
+    std::vector<ESM::ESM_Context> contexts;
+    while (reader.hasMoreRecs())
+    {
+        reader.getRecName();
+        reader.getRecHeader();
+        contexts.push_back(reader.getContext());
+        reader.skipRecord();
+    }
+    ASSERT_EQ(contexts.size(), mRecords.size());
+    EXPECT_EQ(reader.getFileOffset(), reader.getFileSize());
+
+    // Jump back to records in reverse order
+    for (int i = static_cast<int>(contexts.size()) - 1; i >= 0; i -= 997)
+    {
+        reader.restoreContext(contexts[i]);
+        ESM::Book book;
+        bool isDeleted = false;
+        book.load(reader, isDeleted);
+        EXPECT_EQ(book.mId, mRecords[i].mId);
+    }
+}
+
+TEST_F(ESMReaderTest, memory_mapped_reader_fails_on_truncated_file)
+{
+    std::string contents;
+    {
+        std::ifstream stream(mPath.c_str(), std::ios::binary);
+        std::ostringstream buffer;
+        buffer << stream.rdbuf();
+        contents = buffer.str();
+    }
+    {
+        // Drop the end of the last record, but keep the header claiming the full size
+        std::ofstream stream(mPath.c_str(), std::ios::binary | std::ios::trunc);
+        stream.write(contents.data(), contents.size() - 10);
+    }
+
+    ESM::ESMReader reader;
+    reader.setMemoryMapped(true);
+    reader.open(mPath);
+    EXPECT_THROW(
+        while (reader.hasMoreRecs())
+        {
+            reader.getRecName();
+            reader.getRecHeader();
+            reader.skipRecord();
+        },
+        std::runtime_error);
+}
+
+TEST_F(ESMReaderTest, DISABLED_load_benchmark)
+{
+    const int iterations = 3;
+
+    std::ifstream file(mPath.c_str(), std::ios::binary | std::ios::ate);
+    const std::string size = std::to_string(file.tellg() * iterations / (1024 * 1024)) + " MB";
+
+    Benchmark::Timer timer;
+    std::size_t streamCount = 0;
+    for (int n = 0; n < iterations; ++n)
+        streamCount += loadRecords(false, NULL);
+    const double streamTime = timer.getMilliseconds();
+
+    timer.restart();
+    std::size_t mappedCount = 0;
+    for (int n = 0; n < iterations; ++n)
+        mappedCount += loadRecords(true, NULL);
+    const double mappedTime = timer.getMilliseconds();
+
+    EXPECT_EQ(streamCount, mappedCount);
+
+    Benchmark::report("Stream loading of " + size, streamTime);
+    Benchmark::report("Memory mapped loading of " + size, mappedTime);
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include <components/esm/esmwriter.hpp>
+#include <components/esm/defs.hpp>
+
+namespace
+{
+
+    void setupHeader(ESM::ESMWriter& writer, int recordCount)
+    {
+        writer.addMaster("Morrowind.esm", 0);
+        writer.setFormat(1);
+        writer.setVersion(0);
+        writer.setType(0);
+        writer.setAuthor("");
+        writer.setDescription("");
+        writer.setRecordCount(recordCount);
+    }
+
+    void writeRecord(ESM::ESMWriter& writer, const std::string& id, int value)
+    {
+        writer.startRecord(ESM::REC_GLOB);
+        writer.writeHNString("NAME", id);
+        writer.writeHNT("FLTV", value);
+        writer.endRecord(ESM::REC_GLOB);
+    }
+
+}
+
+TEST(ESMWriterTest, records_saved_without_header_can_be_appended_to_a_file)
+{
+    std::stringstream expected;
+    ESM::ESMWriter writer;
+    setupHeader(writer, 3);
+    writer.save(expected);
+    writeRecord(writer, "first", 1);
+    writeRecord(writer, "second", 2);
+    writeRecord(writer, "third", 3);
+    writer.close();
+
+    // Write the first record with the header, and the others separately
+    std::stringstream records;
+    ESM::ESMWriter recordWriter;
+    recordWriter.saveRecords(records);
+    writeRecord(recordWriter, "second", 2);
+    writeRecord(recordWriter, "third", 3);
+    recordWriter.close();
+    EXPECT_EQ(recordWriter.getRecordCount(), 2);
+
+    std::stringstream result;
+    ESM::ESMWriter fileWriter;
+    setupHeader(fileWriter, 3);
+    fileWriter.save(result);
+    writeRecord(fileWriter, "first", 1);
+    const std::string data = records.str();
+    fileWriter.write(data.data(), data.size());
+    fileWriter.close();
+
+    EXPECT_EQ(result.str(), expected.str());
+}
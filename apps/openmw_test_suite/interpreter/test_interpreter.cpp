@@ -0,0 +1,426 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <list>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+
+#include <components/compiler/context.hpp>
+#include <components/compiler/extensions.hpp>
+#include <components/compiler/fileparser.hpp>
+#include <components/compiler/scanner.hpp>
+#include <components/compiler/streamerrorhandler.hpp>
+
+#include <components/interpreter/context.hpp>
+#include <components/interpreter/installopcodes.hpp>
+#include <components/interpreter/interpreter.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    /// Knows the globals gamehour (float), doorcount (long) and questflag (short), and the reference door,
+    /// which has a float member variable angle
+    class TestCompilerContext : public Compiler::Context
+    {
+        public:
+
+            virtual bool canDeclareLocals() const { return true; }
+            virtual char getGlobalType (const std::string& name) const
+            {
+                if (name=="gamehour")
+                    return 'f';
+                if (name=="doorcount")
+                    return 'l';
+                if (name=="questflag")
+                    return 's';
+                return ' ';
+            }
+            virtual std::pair<char, bool> getMemberType (const std::string& name, const std::string& id) const
+            {
+                return std::make_pair (id=="door" && name=="angle" ? 'f' : ' ', true);
+            }
+            virtual bool isId (const std::string& name) const { return name=="door"; }
+            virtual bool isJournalId (const std::string& name) const { return false; }
+    };
+
+    /// A reference with a local script, that holds float locals only
+    struct TestObject
+    {
+        std::string mId;
+        std::vector<std::string> mNames;
+        std::vector<float> mFloats;
+        bool mDeleted;
+    };
+
+    /// Global variables and references, with variables kept in slots like MWWorld::Globals and MWScript::Locals do.
+    /// Like references in cells, objects stay in place and are only flagged when they are deleted.
+    struct TestWorld
+    {
+        std::map<std::string, int> mGlobalSlots;
+        std::vector<float> mGlobals;
+        std::list<TestObject> mObjects;
+        int mLookups; ///< Number of variables that were looked up by name
+
+        TestWorld() : mLookups (0)
+        {
+            const char *globals[] = { "doorcount", "gamehour", "questflag" };
+            for (int i=0; i<3; ++i)
+            {
+                mGlobalSlots[globals[i]] = i;
+                mGlobals.push_back (0);
+            }
+
+            addObject ("door", "open", "angle");
+        }
+
+        /// Replace the object with the ID \a id, if there is one
+        TestObject& addObject (const std::string& id, const std::string& first, const std::string& second)
+        {
+            if (TestObject *object = findObject (id))
+                object->mDeleted = true;
+
+            TestObject object;
+            object.mId = id;
+            object.mNames.push_back (first);
+            object.mNames.push_back (second);
+            object.mFloats.assign (2, 0);
+            object.mDeleted = false;
+            mObjects.push_back (object);
+            return mObjects.back();
+        }
+
+        TestObject *findObject (const std::string& id)
+        {
+            for (std::list<TestObject>::iterator iter (mObjects.begin()); iter!=mObjects.end(); ++iter)
+                if (iter->mId==id && !iter->mDeleted)
+                    return &*iter;
+
+            return 0;
+        }
+
+        int getGlobalSlot (const std::string& name)
+        {
+            ++mLookups;
+            return mGlobalSlots.at (name);
+        }
+
+        float& getMember (Interpreter::MemberSlot& slot)
+        {
+            TestObject *object = static_cast<TestObject *> (slot.mObject);
+
+            if (!object || object->mDeleted)
+            {
+                ++mLookups;
+                object = findObject (slot.mId);
+                if (!object)
+                    throw std::runtime_error ("unknown ID " + slot.mId);
+                std::vector<std::string>::const_iterator iter =
+                    std::find (object->mNames.begin(), object->mNames.end(), slot.mName);
+                if (iter==object->mNames.end())
+                    throw std::runtime_error ("unknown member variable " + slot.mName);
+                slot.mObject = object;
+                slot.mIndex = static_cast<int> (iter-object->mNames.begin());
+            }
+
+            return object->mFloats.at (slot.mIndex);
+        }
+    };
+
+    /// Provides local variables, and globals and member variables of a TestWorld. Everything else is unused by
+    /// the test scripts.
+    class TestInterpreterContext : public Interpreter::Context
+    {
+            std::vector<int> mShorts;
+            std::vector<int> mLongs;
+            std::vector<float> mFloats;
+            TestWorld *mWorld;
+
+        public:
+
+            TestInterpreterContext (const Compiler::Locals& locals, TestWorld *world = 0)
+            : mShorts (locals.get ('s').size()), mLongs (locals.get ('l').size()), mFloats (locals.get ('f').size()),
+              mWorld (world)
+            {}
+
+            virtual int getLocalShort (int index) const { return mShorts.at (index); }
+            virtual int getLocalLong (int index) const { return mLongs.at (index); }
+            virtual float getLocalFloat (int index) const { return mFloats.at (index); }
+            virtual void setLocalShort (int index, int value) { mShorts.at (index) = value; }
+            virtual void setLocalLong (int index, int value) { mLongs.at (index) = value; }
+            virtual void setLocalFloat (int index, float value) { mFloats.at (index) = value; }
+
+            virtual void messageBox (const std::string& message, const std::vector<std::string>& buttons) {}
+            virtual void report (const std::string& message) {}
+            virtual bool menuMode() { return false; }
+            virtual int getGlobalShort (const std::string& name) const { return getGlobalShort (getGlobalSlot (name)); }
+            virtual int getGlobalLong (const std::string& name) const { return getGlobalLong (getGlobalSlot (name)); }
+            virtual float getGlobalFloat (const std::string& name) const { return getGlobalFloat (getGlobalSlot (name)); }
+            virtual void setGlobalShort (const std::string& name, int value) { setGlobalShort (getGlobalSlot (name), value); }
+            virtual void setGlobalLong (const std::string& name, int value) { setGlobalLong (getGlobalSlot (name), value); }
+            virtual void setGlobalFloat (const std::string& name, float value) { setGlobalFloat (getGlobalSlot (name), value); }
+            virtual int getGlobalSlot (const std::string& name) const { return mWorld->getGlobalSlot (name); }
+            virtual int getGlobalShort (int slot) const { return static_cast<int> (mWorld->mGlobals.at (slot)); }
+            virtual int getGlobalLong (int slot) const { return static_cast<int> (mWorld->mGlobals.at (slot)); }
+            virtual float getGlobalFloat (int slot) const { return mWorld->mGlobals.at (slot); }
+            virtual void setGlobalShort (int slot, int value) { mWorld->mGlobals.at (slot) = static_cast<float> (value); }
+            virtual void setGlobalLong (int slot, int value) { mWorld->mGlobals.at (slot) = static_cast<float> (value); }
+            virtual void setGlobalFloat (int slot, float value) { mWorld->mGlobals.at (slot) = value; }
+            virtual std::vector<std::string> getGlobals () const { return std::vector<std::string>(); }
+            virtual char getGlobalType (const std::string& name) const { return ' '; }
+            virtual std::string getActionBinding (const std::string& action) const { return ""; }
+            virtual std::string getNPCName() const { return ""; }
+            virtual std::string getNPCRace() const { return ""; }
+            virtual std::string getNPCClass() const { return ""; }
+            virtual std::string getNPCFaction() const { return ""; }
+            virtual std::string getNPCRank() const { return ""; }
+            virtual std::string getPCName() const { return ""; }
+            virtual std::string getPCRace() const { return ""; }
+            virtual std::string getPCClass() const { return ""; }
+            virtual std::string getPCRank() const { return ""; }
+            virtual std::string getPCNextRank() const { return ""; }
+            virtual int getPCBounty() const { return 0; }
+            virtual std::string getCurrentCellName() const { return ""; }
+            virtual bool isScriptRunning (const std::string& name) const { return false; }
+            virtual void startScript (const std::string& name, const std::string& targetId = "") {}
+            virtual void stopScript (const std::string& name) {}
+            virtual float getDistance (const std::string& name, const std::string& id = "") const { return 0; }
+            virtual float getSecondsPassed() const { return 0; }
+            virtual bool isDisabled (const std::string& id = "") const { return false; }
+            virtual void enable (const std::string& id = "") {}
+            virtual void disable (const std::string& id = "") {}
+            virtual int getMemberShort (Interpreter::MemberSlot& slot, bool global) const { return 0; }
+            virtual int getMemberLong (Interpreter::MemberSlot& slot, bool global) const { return 0; }
+            virtual float getMemberFloat (Interpreter::MemberSlot& slot, bool global) const
+            {
+                return mWorld->getMember (slot);
+            }
+            virtual void setMemberShort (Interpreter::MemberSlot& slot, int value, bool global) {}
+            virtual void setMemberLong (Interpreter::MemberSlot& slot, int value, bool global) {}
+            virtual void setMemberFloat (Interpreter::MemberSlot& slot, float value, bool global)
+            {
+                mWorld->getMember (slot) = value;
+            }
+            virtual std::string getTargetId() const { return ""; }
+    };
+
+    const char *benchmarkScript =
+        "begin benchmark\n"
+        "short count\n"
+        "long sum\n"
+        "float value\n"
+        "while ( count < 10000 )\n"
+        "    set count to count + 1\n"
+        "    set sum to sum + count * 2\n"
+        "    set value to value + 0.5\n"
+        "    if ( sum > 1000000 )\n"
+        "        set sum to sum - 1000000\n"
+        "    endif\n"
+        "endwhile\n"
+        "end\n";
+
+    /// A local script, as it runs every frame
+    const char *localScript =
+        "begin localscript\n"
+        "short state\n"
+        "float timer\n"
+        "set timer to timer + GameHour * 0.5\n"
+        "if ( DoorCount > state )\n"
+        "    set state to state + 1\n"
+        "endif\n"
+        "set QuestFlag to state\n"
+        "set door.angle to door.angle + 1\n"
+        "end\n";
+
+    struct InterpreterTest : public ::testing::Test
+    {
+        InterpreterTest()
+        : mErrorHandler (std::cerr), mParser (mErrorHandler, mCompilerContext)
+        {}
+
+        virtual void SetUp()
+        {
+            mCompilerContext.setExtensions (&mExtensions);
+
+            std::istringstream input (benchmarkScript);
+            Compiler::Scanner scanner (mErrorHandler, input, &mExtensions);
+            scanner.scan (mParser);
+            ASSERT_TRUE (mErrorHandler.isGood());
+
+            mParser.getCode (mCode);
+
+            Interpreter::installOpcodes (mInterpreter);
+        }
+
+        void compile (const char *text, std::vector<Interpreter::Type_Code>& code, Compiler::Locals& locals)
+        {
+            Compiler::FileParser parser (mErrorHandler, mCompilerContext);
+            std::istringstream input (text);
+            Compiler::Scanner scanner (mErrorHandler, input, &mExtensions);
+            scanner.scan (parser);
+            ASSERT_TRUE (mErrorHandler.isGood());
+
+            parser.getCode (code);
+            locals = parser.getLocals();
+        }
+
+        Compiler::Extensions mExtensions;
+        TestCompilerContext mCompilerContext;
+        Compiler::StreamErrorHandler mErrorHandler;
+        Compiler::FileParser mParser;
+        std::vector<Interpreter::Type_Code> mCode;
+        Interpreter::Interpreter mInterpreter;
+    };
+
+}
+
+TEST_F (InterpreterTest, runs_compiled_script)
+{
+    TestInterpreterContext context (mParser.getLocals());
+    mInterpreter.run (&mCode[0], static_cast<int> (mCode.size()), context);
+
+    long long sum = 0;
+    for (int count = 1; count <= 10000; ++count)
+    {
+        sum += count * 2;
+        if (sum > 1000000)
+            sum -= 1000000;
+    }
+
+    EXPECT_EQ (context.getLocalShort (0), 10000);
+    EXPECT_EQ (context.getLocalLong (0), sum);
+    EXPECT_FLOAT_EQ (context.getLocalFloat (0), 5000.f);
+}
+
+TEST_F (InterpreterTest, rejects_unknown_opcodes)
+{
+    Interpreter::Interpreter interpreter; // nothing installed
+    TestInterpreterContext context (mParser.getLocals());
+    EXPECT_THROW (interpreter.run (&mCode[0], static_cast<int> (mCode.size()), context), std::runtime_error);
+}
+
+/// Time the instruction dispatch of Interpreter::run on a loop of arithmetic, comparisons and jumps
+TEST_F (InterpreterTest, DISABLED_run_benchmark)
+{
+    const int runs = 50;
+
+    Benchmark::Timer timer;
+    for (int i = 0; i < runs; ++i)
+    {
+        TestInterpreterContext context (mParser.getLocals());
+        mInterpreter.run (&mCode[0], static_cast<int> (mCode.size()), context);
+    }
+
+    Benchmark::report ("Interpreter: " + std::to_string (runs) + " runs of a 10000 iteration script loop",
+        timer.getMilliseconds());
+}
+
+TEST_F (InterpreterTest, linked_script_looks_up_variables_once)
+{
+    std::vector<Interpreter::Type_Code> code;
+    Compiler::Locals locals;
+    compile (localScript, code, locals);
+
+    TestWorld unlinkedWorld;
+    TestWorld linkedWorld;
+    unlinkedWorld.mGlobals[linkedWorld.mGlobalSlots["doorcount"]] = 2;
+    linkedWorld.mGlobals[linkedWorld.mGlobalSlots["doorcount"]] = 2;
+    unlinkedWorld.mGlobals[linkedWorld.mGlobalSlots["gamehour"]] = 9;
+    linkedWorld.mGlobals[linkedWorld.mGlobalSlots["gamehour"]] = 9;
+
+    TestInterpreterContext unlinkedContext (locals, &unlinkedWorld);
+    TestInterpreterContext linkedContext (locals, &linkedWorld);
+    Interpreter::LinkTable links;
+
+    for (int frame=0; frame<3; ++frame)
+    {
+        mInterpreter.run (&code[0], static_cast<int> (code.size()), unlinkedContext);
+        mInterpreter.run (&code[0], static_cast<int> (code.size()), linkedContext, &links);
+    }
+
+    EXPECT_EQ (linkedWorld.mGlobals, unlinkedWorld.mGlobals);
+    EXPECT_EQ (linkedWorld.findObject ("door")->mFloats, unlinkedWorld.findObject ("door")->mFloats);
+    EXPECT_EQ (linkedContext.getLocalShort (0), unlinkedContext.getLocalShort (0));
+    EXPECT_FLOAT_EQ (linkedContext.getLocalFloat (0), unlinkedContext.getLocalFloat (0));
+
+    EXPECT_EQ (linkedWorld.mGlobals[linkedWorld.mGlobalSlots["questflag"]], 2);
+    EXPECT_EQ (linkedWorld.findObject ("door")->mFloats[1], 3);
+
+    // 3 global and 2 member accesses per run
+    EXPECT_EQ (unlinkedWorld.mLookups, 3*5);
+    EXPECT_EQ (linkedWorld.mLookups, 5);
+}
+
+TEST_F (InterpreterTest, linked_member_is_resolved_again_for_another_object)
+{
+    std::vector<Interpreter::Type_Code> code;
+    Compiler::Locals locals;
+    compile (localScript, code, locals);
+
+    TestWorld world;
+    TestInterpreterContext context (locals, &world);
+    Interpreter::LinkTable links;
+
+    mInterpreter.run (&code[0], static_cast<int> (code.size()), context, &links);
+    EXPECT_EQ (world.findObject ("door")->mFloats[1], 1);
+
+    TestObject& door = world.addObject ("door", "angle", "open");
+    const int lookups = world.mLookups;
+    mInterpreter.run (&code[0], static_cast<int> (code.size()), context, &links);
+
+    // once for reading and once for writing door.angle
+    EXPECT_EQ (world.mLookups, lookups+2);
+    EXPECT_EQ (door.mFloats[0], 1);
+    EXPECT_EQ (door.mFloats[1], 0);
+}
+
+TEST_F (InterpreterTest, linked_member_is_resolved_again_after_clearing_members)
+{
+    std::vector<Interpreter::Type_Code> code;
+    Compiler::Locals locals;
+    compile (localScript, code, locals);
+
+    TestWorld world;
+    TestInterpreterContext context (locals, &world);
+    Interpreter::LinkTable links;
+
+    mInterpreter.run (&code[0], static_cast<int> (code.size()), context, &links);
+    links.clearMembers();
+    const int lookups = world.mLookups;
+    mInterpreter.run (&code[0], static_cast<int> (code.size()), context, &links);
+
+    // globals stay resolved
+    EXPECT_EQ (world.mLookups, lookups+2);
+    EXPECT_EQ (world.findObject ("door")->mFloats[1], 2);
+}
+
+/// Time one frame of local scripts, with each variable looked up by name on every access or through a link table
+TEST_F (InterpreterTest, DISABLED_local_scripts_benchmark)
+{
+    const int scripts = 500;
+    const int frames = 100;
+
+    std::vector<Interpreter::Type_Code> code;
+    Compiler::Locals locals;
+    compile (localScript, code, locals);
+
+    for (int linked=0; linked<2; ++linked)
+    {
+        TestWorld world;
+        std::vector<TestInterpreterContext> contexts (scripts, TestInterpreterContext (locals, &world));
+        Interpreter::LinkTable links;
+
+        Benchmark::Timer timer;
+        for (int frame=0; frame<frames; ++frame)
+            for (int i=0; i<scripts; ++i)
+                mInterpreter.run (&code[0], static_cast<int> (code.size()), contexts[i], linked ? &links : 0);
+        const double time = timer.getMilliseconds();
+
+        EXPECT_EQ (world.findObject ("door")->mFloats[1], scripts*frames);
+
+        Benchmark::report ("Interpreter: frame of " + std::to_string (scripts) + " local scripts "
+            + (linked ? "with" : "without") + " link table", time/frames);
+    }
+}
@@ -0,0 +1,107 @@
+#include <gtest/gtest.h>
+
+#include <components/esm/loaddial.hpp>
+
+#include "apps/openmw/mwdialogue/filterindex.hpp"
+
+namespace
+{
+
+    ESM::DialInfo makeInfo(const std::string& id, const std::string& actor, const std::string& race,
+                           const std::string& cls, const std::string& faction)
+    {
+        ESM::DialInfo info;
+        info.blank();
+        info.mId = id;
+        info.mActor = actor;
+        info.mRace = race;
+        info.mClass = cls;
+        info.mFaction = faction;
+        return info;
+    }
+
+    struct FilterIndexTest : public ::testing::Test
+    {
+        virtual void SetUp()
+        {
+            mDialogue.blank();
+            mDialogue.mId = "topic";
+            mDialogue.mInfo.push_back(makeInfo("actor", "Fargoth", "", "", ""));
+            mDialogue.mInfo.push_back(makeInfo("race", "", "Wood Elf", "", ""));
+            mDialogue.mInfo.push_back(makeInfo("generic", "", "", "", ""));
+            mDialogue.mInfo.push_back(makeInfo("class", "", "", "Commoner", ""));
+            mDialogue.mInfo.push_back(makeInfo("faction", "", "", "", "Temple"));
+            mDialogue.mInfo.push_back(makeInfo("other actor", "mudcrab", "", "", ""));
+            mDialogue.mInfo.push_back(makeInfo("other race", "", "Dark Elf", "Commoner", ""));
+
+            ESM::DialInfo factionLess = makeInfo("factionless", "", "", "", "");
+            factionLess.mFactionLess = true;
+            mDialogue.mInfo.push_back(factionLess);
+
+            ESM::DialInfo::SelectStruct select;
+            select.mSelectRule = "02000Global";
+            mDialogue.mInfo.front().mSelects.push_back(select);
+
+            MWDialogue::FilterIndex::compile(mDialogue, mTopic);
+        }
+
+        std::vector<std::string> getCandidateIds(const MWDialogue::FilterIndex::Speaker& speaker) const
+        {
+            std::vector<const MWDialogue::FilterIndex::Info*> candidates;
+            mTopic.getCandidates(speaker, candidates);
+
+            std::vector<std::string> ids;
+            for (std::vector<const MWDialogue::FilterIndex::Info*>::const_iterator it = candidates.begin();
+                 it != candidates.end(); ++it)
+                ids.push_back((*it)->mInfo->mId);
+            return ids;
+        }
+
+        ESM::Dialogue mDialogue;
+        MWDialogue::FilterIndex::Topic mTopic;
+    };
+
+}
+
+TEST_F(FilterIndexTest, npc_candidates_keep_dialogue_order)
+{
+    MWDialogue::FilterIndex::Speaker speaker;
+    speaker.mId = "fargoth";
+    speaker.mRace = "wood elf";
+    speaker.mClass = "commoner";
+    speaker.mFaction = "temple";
+
+    const char* expected[] = { "actor", "race", "generic", "class", "faction", "factionless" };
+    EXPECT_EQ(getCandidateIds(speaker), std::vector<std::string>(expected, expected + 6));
+}
+
+TEST_F(FilterIndexTest, npc_candidates_skip_other_speakers)
+{
+    MWDialogue::FilterIndex::Speaker speaker;
+    speaker.mId = "someone";
+    speaker.mRace = "dark elf";
+    speaker.mClass = "commoner";
+
+    // "other race" is bucketed by race only, so it's found even though it also requires a class
+    const char* expected[] = { "generic", "class", "other race", "factionless" };
+    EXPECT_EQ(getCandidateIds(speaker), std::vector<std::string>(expected, expected + 4));
+}
+
+TEST_F(FilterIndexTest, creatures_only_get_infos_for_their_id)
+{
+    MWDialogue::FilterIndex::Speaker speaker;
+    speaker.mId = "mudcrab";
+    speaker.mIsCreature = true;
+
+    const char* expected[] = { "other actor" };
+    EXPECT_EQ(getCandidateIds(speaker), std::vector<std::string>(expected, expected + 1));
+}
+
+TEST_F(FilterIndexTest, select_structs_are_decoded_once)
+{
+    const MWDialogue::FilterIndex::Info& info = mTopic.mInfos.front();
+    ASSERT_EQ(info.mSelects.size(), 1u);
+    EXPECT_EQ(info.mSelects[0].getFunction(), MWDialogue::SelectWrapper::Function_Global);
+    EXPECT_EQ(info.mSelects[0].getName(), "global");
+    EXPECT_EQ(&info.mSelects[0].getName(), &info.mSelects[0].getName());
+}
@@ -0,0 +1,155 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+
+#include "apps/openmw/mwmechanics/pathgrid.hpp"
+
+namespace
+{
+
+    void addEdge(ESM::Pathgrid& pathgrid, int from, int to)
+    {
+        // Pathgrids list each direction as a separate edge
+        ESM::Pathgrid::Edge edge;
+        edge.mV0 = from;
+        edge.mV1 = to;
+        pathgrid.mEdges.push_back(edge);
+        edge.mV0 = to;
+        edge.mV1 = from;
+        pathgrid.mEdges.push_back(edge);
+    }
+
+    /// A grid of size x size points, 256 units apart, connected to their horizontal and vertical neighbours,
+    /// with a wall along column size/2 that only has a gap in the last row. The last point is disconnected.
+    ESM::Pathgrid makePathgrid(int size)
+    {
+        ESM::Pathgrid pathgrid;
+        pathgrid.blank();
+        for (int y = 0; y < size; ++y)
+            for (int x = 0; x < size; ++x)
+                pathgrid.mPoints.push_back(ESM::Pathgrid::Point(x * 256, y * 256, 0));
+
+        const int wall = size / 2;
+        for (int y = 0; y < size; ++y)
+        {
+            for (int x = 0; x < size; ++x)
+            {
+                const int point = y * size + x;
+                if (point == size * size - 1)
+                    continue;
+                if (x + 1 < size && (x + 1 != wall || y == size - 1) && point + 1 != size * size - 1)
+                    addEdge(pathgrid, point, point + 1);
+                if (y + 1 < size && point + size != size * size - 1)
+                    addEdge(pathgrid, point, point + size);
+            }
+        }
+        return pathgrid;
+    }
+
+    bool hasEdge(const ESM::Pathgrid& pathgrid, int from, int to)
+    {
+        for (ESM::Pathgrid::EdgeList::const_iterator it = pathgrid.mEdges.begin(); it != pathgrid.mEdges.end(); ++it)
+        {
+            if (it->mV0 == from && it->mV1 == to)
+                return true;
+        }
+        return false;
+    }
+
+    struct PathgridGraphTest : public ::testing::Test
+    {
+        PathgridGraphTest()
+            : mSize(12)
+            , mPathgrid(makePathgrid(mSize))
+        {
+        }
+
+        virtual void SetUp()
+        {
+            ASSERT_TRUE(mGraph.load(&mPathgrid));
+        }
+
+        int mSize;
+        ESM::Pathgrid mPathgrid;
+        MWMechanics::PathgridGraph mGraph;
+    };
+
+}
+
+TEST_F(PathgridGraphTest, finds_connected_paths_around_the_wall)
+{
+    const int start = 0;
+    const int goal = mSize - 1; // top right, on the other side of the wall
+
+    std::vector<int> path;
+    ASSERT_TRUE(mGraph.aStarSearch(start, goal, path));
+    ASSERT_FALSE(path.empty());
+    EXPECT_EQ(path.front(), start);
+    EXPECT_EQ(path.back(), goal);
+    for (std::size_t i = 0; i + 1 < path.size(); ++i)
+        EXPECT_TRUE(hasEdge(mPathgrid, path[i], path[i + 1])) << path[i] << " -> " << path[i + 1];
+
+    // The path has to go through the gap in the last row
+    const int gap = (mSize - 1) * mSize + mSize / 2;
+    EXPECT_NE(std::find(path.begin(), path.end(), gap), path.end());
+}
+
+TEST_F(PathgridGraphTest, start_equals_goal)
+{
+    std::vector<int> path(3, 7);
+    ASSERT_TRUE(mGraph.aStarSearch(5, 5, path));
+    ASSERT_EQ(path.size(), 1u);
+    EXPECT_EQ(path[0], 5);
+}
+
+TEST_F(PathgridGraphTest, no_path_to_disconnected_point)
+{
+    const int isolated = mSize * mSize - 1;
+    EXPECT_FALSE(mGraph.isPointConnected(0, isolated));
+
+    std::vector<int> path(3, 7);
+    EXPECT_FALSE(mGraph.aStarSearch(0, isolated, path));
+    EXPECT_TRUE(path.empty());
+}
+
+TEST_F(PathgridGraphTest, cached_paths_match_computed_paths)
+{
+    const int count = mSize * mSize - 1;
+    std::vector<std::vector<int> > first(count);
+    for (int goal = 0; goal < count; ++goal)
+        ASSERT_TRUE(mGraph.aStarSearch(0, goal, first[goal]));
+
+    // Ask again in reverse order, so some of the paths come from the cache and others have been evicted
+    for (int goal = count - 1; goal >= 0; --goal)
+    {
+        std::vector<int> path;
+        ASSERT_TRUE(mGraph.aStarSearch(0, goal, path));
+        EXPECT_EQ(first[goal], path) << "goal " << goal;
+    }
+}
+
+TEST_F(PathgridGraphTest, copies_search_independently_of_the_original)
+{
+    std::vector<int> path;
+    ASSERT_TRUE(mGraph.aStarSearch(0, mSize - 1, path));
+
+    MWMechanics::PathgridGraph copy(mGraph);
+    MWMechanics::PathgridGraph assigned;
+    assigned = mGraph;
+
+    // Evict the cached path from the original, then search with the copies
+    for (int goal = 0; goal < mSize * mSize - 1; ++goal)
+    {
+        std::vector<int> other;
+        ASSERT_TRUE(mGraph.aStarSearch(goal, 0, other));
+    }
+
+    std::vector<int> copiedPath;
+    ASSERT_TRUE(copy.aStarSearch(0, mSize - 1, copiedPath));
+    EXPECT_EQ(path, copiedPath);
+
+    std::vector<int> assignedPath;
+    ASSERT_TRUE(assigned.aStarSearch(0, mSize - 1, assignedPath));
+    EXPECT_EQ(path, assignedPath);
+    EXPECT_FALSE(assigned.isPointConnected(0, mSize * mSize - 1));
+}
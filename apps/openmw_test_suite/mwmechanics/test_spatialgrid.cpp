@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "apps/openmw/mwmechanics/spatialgrid.hpp"
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    /// Actors spread over one exterior cell, a few of them on a second floor
+    std::vector<osg::Vec3f> makeActorPositions(std::size_t count)
+    {
+        std::srand(42);
+        std::vector<osg::Vec3f> positions;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            const float x = static_cast<float>(std::rand() % 8192) - 4096.f;
+            const float y = static_cast<float>(std::rand() % 8192) + 8192.f;
+            const float z = (i % 5 == 0) ? 512.f : 0.f;
+            positions.push_back(osg::Vec3f(x, y, z));
+        }
+        return positions;
+    }
+
+    void bruteForceQuery(const std::vector<osg::Vec3f>& positions, const osg::Vec3f& position, float radius,
+                         std::vector<std::size_t>& out)
+    {
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            if ((positions[i] - position).length2() <= radius * radius)
+                out.push_back(i);
+        }
+    }
+
+    MWMechanics::SpatialGrid makeGrid(const std::vector<osg::Vec3f>& positions)
+    {
+        MWMechanics::SpatialGrid grid(1024);
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            grid.add(i, positions[i]);
+        grid.build();
+        return grid;
+    }
+
+}
+
+TEST(SpatialGridTest, query_matches_brute_force)
+{
+    const std::vector<osg::Vec3f> positions = makeActorPositions(1000);
+    const MWMechanics::SpatialGrid grid = makeGrid(positions);
+    ASSERT_EQ(grid.size(), positions.size());
+
+    const float radii[] = { 0.f, 100.f, 400.f, 1024.f, 2000.f, 7168.f };
+    for (std::size_t r = 0; r < sizeof(radii) / sizeof(radii[0]); ++r)
+    {
+        for (std::size_t i = 0; i < positions.size(); i += 7)
+        {
+            std::vector<std::size_t> expected;
+            bruteForceQuery(positions, positions[i], radii[r], expected);
+
+            std::vector<std::size_t> found;
+            grid.query(positions[i], radii[r], found);
+
+            EXPECT_EQ(expected, found) << "radius " << radii[r] << " around actor " << i;
+        }
+    }
+}
+
+TEST(SpatialGridTest, query_appends_and_handles_negative_coordinates)
+{
+    MWMechanics::SpatialGrid grid(100);
+    grid.add(3, osg::Vec3f(-1.f, -1.f, 0.f));
+    grid.add(1, osg::Vec3f(1.f, 1.f, 0.f));
+    grid.add(2, osg::Vec3f(-150.f, 0.f, 0.f));
+    grid.build();
+
+    std::vector<std::size_t> found(1, 99);
+    grid.query(osg::Vec3f(0.f, 0.f, 0.f), 2.f, found);
+    ASSERT_EQ(found.size(), 3u);
+    EXPECT_EQ(found[0], 99u);
+    EXPECT_EQ(found[1], 1u);
+    EXPECT_EQ(found[2], 3u);
+
+    found.clear();
+    grid.query(osg::Vec3f(-100.f, 0.f, 0.f), 60.f, found);
+    ASSERT_EQ(found.size(), 1u);
+    EXPECT_EQ(found[0], 2u);
+
+    grid.clear();
+    found.clear();
+    grid.query(osg::Vec3f(0.f, 0.f, 0.f), 1000.f, found);
+    EXPECT_TRUE(found.empty());
+}
+
+/// The pairwise neighbour search done by Actors::update for every AI update: combat engagement
+/// within the AI processing distance and head tracking within fMaxHeadTrackDistance.
+TEST(SpatialGridTest, DISABLED_actors_update_benchmark)
+{
+    const float aiProcessingDistance = 7168.f;
+    const float headTrackDistance = 400.f;
+    const std::size_t counts[] = { 50, 200, 1000 };
+
+    for (std::size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        // Keep all actors within the AI processing distance of each other, like in a crowded cell
+        std::vector<osg::Vec3f> positions = makeActorPositions(counts[c]);
+        for (std::size_t i = 0; i < positions.size(); ++i)
+            positions[i] = osg::Vec3f(positions[i].x() * 0.5f, positions[i].y() * 0.5f, positions[i].z());
+
+        std::size_t pairs = 0;
+        Benchmark::Timer timer;
+        const MWMechanics::SpatialGrid grid = makeGrid(positions);
+        for (std::size_t i = 0; i < positions.size(); ++i)
+        {
+            std::vector<std::size_t> neighbours;
+            grid.query(positions[i], aiProcessingDistance, neighbours);
+            pairs += neighbours.size();
+            neighbours.clear();
+            grid.query(positions[i], headTrackDistance, neighbours);
+            pairs += neighbours.size();
+        }
+        Benchmark::report("Neighbour search for " + std::to_string(counts[c]) + " actors in one cell, including the grid build",
+                          timer.getMilliseconds());
+
+        // every actor finds at least itself in both searches
+        EXPECT_GE(pairs, 2 * positions.size());
+    }
+}
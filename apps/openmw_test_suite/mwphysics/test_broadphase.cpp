@@ -0,0 +1,341 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <BulletCollision/CollisionDispatch/btCollisionWorld.h>
+#include <BulletCollision/CollisionDispatch/btDefaultCollisionConfiguration.h>
+#include <BulletCollision/CollisionShapes/btBoxShape.h>
+#include <BulletCollision/CollisionShapes/btCapsuleShape.h>
+#include <BulletCollision/CollisionShapes/btHeightfieldTerrainShape.h>
+
+#include <components/sceneutil/workqueue.hpp>
+
+#include "apps/openmw/mwphysics/broadphase.hpp"
+#include "apps/openmw/mwphysics/movementsolverbatch.hpp"
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    const int sHeightFieldSize = 65;
+    const float sCellSize = 8192.f;
+
+    /// Ignores the object that is being swept, like the actor tracer does
+    class ClosestNotMeConvexResultCallback : public btCollisionWorld::ClosestConvexResultCallback
+    {
+    public:
+        ClosestNotMeConvexResultCallback(const btCollisionObject* me)
+            : btCollisionWorld::ClosestConvexResultCallback(btVector3(0, 0, 0), btVector3(0, 0, 0))
+            , mMe(me)
+        {
+        }
+
+        virtual btScalar addSingleResult(btCollisionWorld::LocalConvexResult& convexResult, bool normalInWorldSpace)
+        {
+            if (convexResult.m_hitCollisionObject == mMe)
+                return btScalar(1);
+            return btCollisionWorld::ClosestConvexResultCallback::addSingleResult(convexResult, normalInWorldSpace);
+        }
+
+    private:
+        const btCollisionObject* mMe;
+    };
+
+    /// An exterior cell with hilly terrain, some rocks and a crowd of capsule actors
+    class TestWorld
+    {
+    public:
+        TestWorld(btBroadphaseInterface* broadphase, int numActors)
+            : mBroadphase(broadphase)
+            , mDispatcher(&mConfiguration)
+            , mWorld(&mDispatcher, mBroadphase.get(), &mConfiguration)
+            , mActorShape(30.f, 70.f)
+            , mRockShape(btVector3(100.f, 100.f, 60.f))
+        {
+            mWorld.setForceUpdateAllAabbs(false);
+
+            for (int y = 0; y < sHeightFieldSize; ++y)
+                for (int x = 0; x < sHeightFieldSize; ++x)
+                    mHeights.push_back(200.f * std::sin(x * 0.3f) * std::cos(y * 0.2f));
+            mTerrainShape.reset(new btHeightfieldTerrainShape(sHeightFieldSize, sHeightFieldSize, &mHeights[0], 1,
+                                                              -200.f, 200.f, 2, PHY_FLOAT, false));
+            mTerrainShape->setUseDiamondSubdivision(true);
+            const float triSize = sCellSize / (sHeightFieldSize - 1);
+            mTerrainShape->setLocalScaling(btVector3(triSize, triSize, 1));
+            addObject(mTerrainShape.get(), btVector3(0, 0, 0), 1);
+
+            std::mt19937 random(42);
+            std::uniform_real_distribution<float> coordinate(-sCellSize / 2 + 200.f, sCellSize / 2 - 200.f);
+            for (int i = 0; i < 100; ++i)
+                addObject(&mRockShape, btVector3(coordinate(random), coordinate(random), 0), 1);
+
+            for (int i = 0; i < numActors; ++i)
+            {
+                mActors.push_back(addObject(&mActorShape, btVector3(coordinate(random), coordinate(random), 300.f), 2));
+                const float angle = i * 2.39996f;
+                mVelocities.push_back(btVector3(std::cos(angle), std::sin(angle), -0.5f) * 300.f);
+            }
+        }
+
+        ~TestWorld()
+        {
+            for (std::size_t i = 0; i < mObjects.size(); ++i)
+                mWorld.removeCollisionObject(mObjects[i].get());
+        }
+
+        /// Sweep the actor by its velocity, and return where it stops
+        btVector3 sweep(std::size_t actor, float time) const
+        {
+            bool hit = false;
+            return sweep(actor, time, hit);
+        }
+
+        btVector3 sweep(std::size_t actor, float time, bool& hit) const
+        {
+            const btCollisionObject* object = mActors[actor];
+            btTransform from = object->getWorldTransform();
+            btTransform to = from;
+            to.setOrigin(from.getOrigin() + mVelocities[actor] * time);
+
+            ClosestNotMeConvexResultCallback callback(object);
+            mWorld.convexSweepTest(&mActorShape, from, to, callback);
+            hit = callback.hasHit();
+            return from.getOrigin().lerp(to.getOrigin(), callback.m_closestHitFraction);
+        }
+
+        /// Move the actors to their solved positions; serial, like the commit of the movement solver
+        void commit(const std::vector<btVector3>& positions)
+        {
+            for (std::size_t i = 0; i < mActors.size(); ++i)
+            {
+                mActors[i]->getWorldTransform().setOrigin(positions[i]);
+                mWorld.updateSingleAabb(mActors[i]);
+            }
+        }
+
+        std::size_t getNumActors() const { return mActors.size(); }
+
+        const btCollisionWorld& getWorld() const { return mWorld; }
+
+    private:
+        btCollisionObject* addObject(btCollisionShape* shape, const btVector3& position, short group)
+        {
+            std::unique_ptr<btCollisionObject> object(new btCollisionObject);
+            object->setCollisionShape(shape);
+            object->getWorldTransform().setIdentity();
+            object->getWorldTransform().setOrigin(position);
+            mWorld.addCollisionObject(object.get(), group, 3);
+            mObjects.push_back(std::move(object));
+            return mObjects.back().get();
+        }
+
+        std::unique_ptr<btBroadphaseInterface> mBroadphase;
+        btDefaultCollisionConfiguration mConfiguration;
+        btCollisionDispatcher mDispatcher;
+        btCollisionWorld mWorld;
+
+        std::vector<float> mHeights;
+        std::unique_ptr<btHeightfieldTerrainShape> mTerrainShape;
+        btCapsuleShapeZ mActorShape;
+        btBoxShape mRockShape;
+
+        std::vector<std::unique_ptr<btCollisionObject> > mObjects;
+        std::vector<btCollisionObject*> mActors;
+        std::vector<btVector3> mVelocities;
+    };
+
+    /// Sweeps the actors of a TestWorld, for MWPhysics::solveMovement
+    class SweepSolver
+    {
+    public:
+        /// The actors that hit something
+        typedef std::vector<std::size_t> Result;
+
+        SweepSolver(TestWorld& world)
+            : mWorld(world)
+            , mPositions(world.getNumActors())
+        {
+        }
+
+        void solve(std::size_t actor, Result& hits)
+        {
+            bool hit = false;
+            mPositions[actor] = mWorld.sweep(actor, 1.f / 60.f, hit);
+            if (hit)
+                hits.push_back(actor);
+        }
+
+        void merge(const Result& hits)
+        {
+            mHits.insert(mHits.end(), hits.begin(), hits.end());
+        }
+
+        void commit()
+        {
+            mWorld.commit(mPositions);
+        }
+
+        TestWorld& mWorld;
+        std::vector<btVector3> mPositions;
+        Result mHits;
+    };
+
+    /// Walk all actors for the given number of physics steps; in parallel batches if a queue is given
+    SweepSolver simulate(TestWorld& world, int steps, SceneUtil::WorkQueue* queue)
+    {
+        SweepSolver solver(world);
+        MWPhysics::solveMovement(solver, world.getNumActors(), steps, queue);
+        return solver;
+    }
+
+    /// Records the order of the calls made by solveMovement
+    class RecordingSolver
+    {
+    public:
+        typedef std::vector<std::size_t> Result;
+
+        RecordingSolver(std::size_t numActors, std::size_t failingActor)
+            : mSolved(numActors, 0)
+            , mFailingActor(failingActor)
+            , mStep(0)
+        {
+        }
+
+        void solve(std::size_t actor, Result& solved)
+        {
+            if (actor == mFailingActor)
+                throw std::runtime_error("actor is stuck");
+            // every actor is solved once per step, and only after the previous step was committed
+            if (mSolved[actor] != mStep)
+                throw std::runtime_error("actor solved out of step");
+            ++mSolved[actor];
+            solved.push_back(actor);
+        }
+
+        void merge(const Result& solved)
+        {
+            mMerged.insert(mMerged.end(), solved.begin(), solved.end());
+        }
+
+        void commit()
+        {
+            for (std::size_t i = 0; i < mSolved.size(); ++i)
+                EXPECT_EQ(mSolved[i], mStep + 1) << "actor " << i;
+            ++mStep;
+        }
+
+        std::vector<int> mSolved;
+        std::size_t mFailingActor;
+        int mStep;
+        Result mMerged;
+    };
+
+}
+
+TEST(MWPhysicsThreadSafeBroadphaseTest, finds_the_same_hits_as_dbvt_broadphase)
+{
+    TestWorld reference(new btDbvtBroadphase, 200);
+    TestWorld world(new MWPhysics::ThreadSafeBroadphase, 200);
+
+    for (std::size_t i = 0; i < world.getNumActors(); ++i)
+    {
+        const btVector3 expected = reference.sweep(i, 0.5f);
+        const btVector3 result = world.sweep(i, 0.5f);
+        EXPECT_FLOAT_EQ(result.x(), expected.x()) << "actor " << i;
+        EXPECT_FLOAT_EQ(result.y(), expected.y()) << "actor " << i;
+        EXPECT_FLOAT_EQ(result.z(), expected.z()) << "actor " << i;
+    }
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coordinate(-sCellSize / 2, sCellSize / 2);
+    for (int i = 0; i < 200; ++i)
+    {
+        const btVector3 from(coordinate(random), coordinate(random), 1000.f);
+        const btVector3 to(coordinate(random), coordinate(random), -1000.f);
+        btCollisionWorld::ClosestRayResultCallback expected(from, to);
+        reference.getWorld().rayTest(from, to, expected);
+        btCollisionWorld::ClosestRayResultCallback result(from, to);
+        world.getWorld().rayTest(from, to, result);
+        ASSERT_EQ(result.hasHit(), expected.hasHit()) << "ray " << i;
+        EXPECT_FLOAT_EQ(result.m_closestHitFraction, expected.m_closestHitFraction) << "ray " << i;
+    }
+}
+
+TEST(MWPhysicsMovementSolverTest, solves_each_step_for_all_actors_before_the_next)
+{
+    const std::size_t actors = 10;
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(3);
+
+    RecordingSolver serial(actors, actors);
+    MWPhysics::solveMovement(serial, actors, 3, NULL);
+    EXPECT_EQ(serial.mStep, 3);
+
+    RecordingSolver parallel(actors, actors);
+    MWPhysics::solveMovement(parallel, actors, 3, queue.get());
+    EXPECT_EQ(parallel.mStep, 3);
+
+    // the results of the batches are merged in actor order
+    EXPECT_EQ(parallel.mMerged, serial.mMerged);
+    ASSERT_EQ(serial.mMerged.size(), 3 * actors);
+    for (std::size_t i = 0; i < serial.mMerged.size(); ++i)
+        EXPECT_EQ(serial.mMerged[i], i % actors);
+}
+
+TEST(MWPhysicsMovementSolverTest, reports_errors_of_other_threads)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(3);
+    RecordingSolver solver(10, 0); // the first actor is in a batch for the queue
+    EXPECT_THROW(MWPhysics::solveMovement(solver, 10, 2, queue.get()), std::runtime_error);
+    EXPECT_EQ(solver.mStep, 0);
+}
+
+TEST(MWPhysicsMovementSolverTest, moves_actors_in_parallel_like_on_the_main_thread)
+{
+    const int actors = 100;
+    const int steps = 20;
+
+    // Without thread safe queries, the broadphase is only used from the main thread
+    if (!MWPhysics::isBulletThreadSafe())
+        return;
+
+    TestWorld serialWorld(new MWPhysics::ThreadSafeBroadphase, actors);
+    const SweepSolver expected = simulate(serialWorld, steps, NULL);
+
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(3);
+    TestWorld parallelWorld(new MWPhysics::ThreadSafeBroadphase, actors);
+    const SweepSolver result = simulate(parallelWorld, steps, queue.get());
+
+    for (std::size_t i = 0; i < expected.mPositions.size(); ++i)
+        EXPECT_EQ(result.mPositions[i], expected.mPositions[i]) << "actor " << i;
+    EXPECT_FALSE(expected.mHits.empty());
+    EXPECT_EQ(result.mHits, expected.mHits);
+}
+
+/// Walk a crowd of actors over an exterior cell for two seconds, in parallel batches
+TEST(MWPhysicsMovementSolverTest, DISABLED_actor_movement_benchmark)
+{
+    const int actors = 400;
+    const int steps = 120;
+
+    if (!MWPhysics::isBulletThreadSafe())
+    {
+        std::cout << "Skipping the parallel movement benchmark, Bullet does not support queries from several threads" << std::endl;
+        return;
+    }
+
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(0);
+    TestWorld world(new MWPhysics::ThreadSafeBroadphase, actors);
+    Benchmark::Timer timer;
+    simulate(world, steps, queue.get());
+
+    Benchmark::report("Actor movement: " + std::to_string(actors) + " actors over " + std::to_string(steps) + " steps on "
+                      + std::to_string(queue->getNumThreads() + 1) + " threads", timer.getMilliseconds());
+}
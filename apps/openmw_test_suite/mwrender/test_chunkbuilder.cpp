@@ -0,0 +1,229 @@
+#include <gtest/gtest.h>
+
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+#include <osg/NodeVisitor>
+
+#include <osgParticle/ParticleSystem>
+
+#include "apps/openmw/mwrender/chunkbuilder.hpp"
+
+namespace
+{
+
+    osg::ref_ptr<osg::Geometry> createQuad(osg::StateSet* stateset)
+    {
+        osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+        vertices->push_back(osg::Vec3f(-1, -1, 0));
+        vertices->push_back(osg::Vec3f(1, -1, 0));
+        vertices->push_back(osg::Vec3f(1, 1, 0));
+        vertices->push_back(osg::Vec3f(-1, 1, 0));
+
+        osg::ref_ptr<osg::DrawElementsUShort> indices = new osg::DrawElementsUShort(GL_TRIANGLES);
+        const unsigned short quad[] = { 0, 1, 2, 2, 3, 0 };
+        indices->insert(indices->end(), quad, quad + 6);
+
+        osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+        geometry->setVertexArray(vertices);
+        geometry->addPrimitiveSet(indices);
+        geometry->setStateSet(stateset);
+        return geometry;
+    }
+
+    /// A quad below a transform, like the meshes loaded from NIF files
+    osg::ref_ptr<osg::Group> createTemplate(osg::StateSet* stateset)
+    {
+        osg::ref_ptr<osg::MatrixTransform> transform = new osg::MatrixTransform(osg::Matrix::translate(0, 0, 10));
+        transform->addChild(createQuad(stateset));
+        osg::ref_ptr<osg::Group> root = new osg::Group;
+        root->addChild(transform);
+        return root;
+    }
+
+    MWRender::ChunkBuilder::Reference makeReference(const osg::Node* templateNode, const osg::Vec3f& position, float scale = 1.f,
+                                                    const osg::Quat& attitude = osg::Quat())
+    {
+        MWRender::ChunkBuilder::Reference reference;
+        reference.mTemplate = templateNode;
+        reference.mPosition = position;
+        reference.mAttitude = attitude;
+        reference.mScale = scale;
+        return reference;
+    }
+
+    struct GeometryCollector : public osg::NodeVisitor
+    {
+        GeometryCollector()
+            : osg::NodeVisitor(osg::NodeVisitor::TRAVERSE_ALL_CHILDREN)
+            , mNumDrawables(0)
+            , mNumTransforms(0)
+        {
+            // also count hidden nodes, which should not have been copied
+            setNodeMaskOverride(~0u);
+        }
+
+        virtual void apply(osg::Drawable& drawable)
+        {
+            ++mNumDrawables;
+            if (osg::Geometry* geometry = drawable.asGeometry())
+                mGeometries.push_back(geometry);
+        }
+
+        virtual void apply(osg::Transform& transform)
+        {
+            ++mNumTransforms;
+            traverse(transform);
+        }
+
+        unsigned int getNumVertices() const
+        {
+            unsigned int numVertices = 0;
+            for (std::vector<osg::Geometry*>::const_iterator it = mGeometries.begin(); it != mGeometries.end(); ++it)
+                numVertices += (*it)->getVertexArray()->getNumElements();
+            return numVertices;
+        }
+
+        unsigned int mNumDrawables;
+        unsigned int mNumTransforms;
+        std::vector<osg::Geometry*> mGeometries;
+    };
+
+}
+
+TEST(MWRenderChunkBuilderTest, merges_objects_with_the_same_state)
+{
+    osg::ref_ptr<osg::StateSet> stateset = new osg::StateSet;
+    osg::ref_ptr<osg::Group> templateNode = createTemplate(stateset);
+
+    MWRender::ChunkBuilder builder(osg::Vec3f(4096, 4096, 0));
+    for (int i = 0; i < 20; ++i)
+        builder.add(makeReference(templateNode, osg::Vec3f(i * 100.f, 8192 - i * 200.f, i * 5.f), 1.f + i * 0.1f));
+    EXPECT_EQ(builder.getNumReferences(), 20u);
+
+    osg::ref_ptr<osg::Node> chunk = builder.build();
+    ASSERT_TRUE(chunk != NULL);
+    EXPECT_EQ(builder.getNumReferences(), 0u);
+
+    GeometryCollector collector;
+    chunk->accept(collector);
+    EXPECT_EQ(collector.mNumDrawables, 1u);
+    EXPECT_EQ(collector.getNumVertices(), 20u * 4u);
+    // only the chunk's own transform is left
+    EXPECT_EQ(collector.mNumTransforms, 1u);
+}
+
+TEST(MWRenderChunkBuilderTest, moves_vertices_to_the_object_positions)
+{
+    osg::ref_ptr<osg::Group> templateNode = createTemplate(new osg::StateSet);
+
+    const osg::Vec3f origin(4096, 4096, 0);
+    const osg::Vec3f position(5000, 3000, 200);
+    const osg::Quat attitude(osg::PI_2, osg::Vec3f(0, 0, 1));
+    MWRender::ChunkBuilder builder(origin);
+    builder.add(makeReference(templateNode, position, 2.f, attitude));
+    osg::ref_ptr<osg::Node> chunk = builder.build();
+    ASSERT_TRUE(chunk != NULL);
+
+    GeometryCollector collector;
+    chunk->accept(collector);
+    ASSERT_EQ(collector.mGeometries.size(), 1u);
+    const osg::Vec3Array* vertices = static_cast<const osg::Vec3Array*>(collector.mGeometries[0]->getVertexArray());
+    ASSERT_EQ(vertices->size(), 4u);
+
+    // (-1, -1, 10) in the template: scaled by 2, rotated by 90 degrees around z, relative to the origin of the chunk
+    const osg::Vec3f expected = position - origin + osg::Vec3f(2, -2, 20);
+    EXPECT_NEAR((*vertices)[0].x(), expected.x(), 1e-3f);
+    EXPECT_NEAR((*vertices)[0].y(), expected.y(), 1e-3f);
+    EXPECT_NEAR((*vertices)[0].z(), expected.z(), 1e-3f);
+
+    EXPECT_NEAR(chunk->getBound().center().x(), position.x(), 1e-2f);
+    EXPECT_NEAR(chunk->getBound().center().y(), position.y(), 1e-2f);
+    EXPECT_NEAR(chunk->getBound().center().z(), position.z() + 20, 1e-2f);
+}
+
+TEST(MWRenderChunkBuilderTest, keeps_objects_with_different_state_apart)
+{
+    osg::ref_ptr<osg::Group> first = createTemplate(new osg::StateSet);
+    osg::ref_ptr<osg::Group> second = createTemplate(new osg::StateSet);
+
+    MWRender::ChunkBuilder builder(osg::Vec3f());
+    for (int i = 0; i < 5; ++i)
+    {
+        builder.add(makeReference(first, osg::Vec3f(i * 100.f, 0, 0)));
+        builder.add(makeReference(second, osg::Vec3f(0, i * 100.f, 0)));
+    }
+    osg::ref_ptr<osg::Node> chunk = builder.build();
+    ASSERT_TRUE(chunk != NULL);
+
+    GeometryCollector collector;
+    chunk->accept(collector);
+    EXPECT_EQ(collector.mNumDrawables, 2u);
+    EXPECT_EQ(collector.getNumVertices(), 10u * 4u);
+}
+
+TEST(MWRenderChunkBuilderTest, leaves_out_what_can_not_be_merged)
+{
+    osg::ref_ptr<osg::Group> templateNode = createTemplate(new osg::StateSet);
+
+    osg::ref_ptr<osg::Group> hidden = new osg::Group;
+    hidden->setNodeMask(0);
+    hidden->addChild(createQuad(new osg::StateSet));
+    templateNode->addChild(hidden);
+    templateNode->addChild(new osgParticle::ParticleSystem);
+
+    MWRender::ChunkBuilder builder(osg::Vec3f());
+    builder.add(makeReference(templateNode, osg::Vec3f()));
+    osg::ref_ptr<osg::Node> chunk = builder.build();
+    ASSERT_TRUE(chunk != NULL);
+
+    GeometryCollector collector;
+    chunk->accept(collector);
+    EXPECT_EQ(collector.mNumDrawables, 1u);
+    EXPECT_EQ(collector.getNumVertices(), 4u);
+}
+
+TEST(MWRenderChunkBuilderTest, does_not_change_the_template)
+{
+    osg::ref_ptr<osg::StateSet> stateset = new osg::StateSet;
+    osg::ref_ptr<osg::Group> templateNode = createTemplate(stateset);
+    osg::ref_ptr<osg::Node> transform = templateNode->getChild(0);
+    osg::ref_ptr<osg::Geometry> geometry = transform->asGroup()->getChild(0)->asGeometry();
+
+    MWRender::ChunkBuilder builder(osg::Vec3f());
+    for (int i = 0; i < 5; ++i)
+        builder.add(makeReference(templateNode, osg::Vec3f(i * 100.f, 0, 0), 2.f));
+    osg::ref_ptr<osg::Node> chunk = builder.build();
+    ASSERT_TRUE(chunk != NULL);
+
+    ASSERT_EQ(templateNode->getNumChildren(), 1u);
+    EXPECT_EQ(templateNode->getChild(0), transform.get());
+    ASSERT_EQ(transform->asGroup()->getNumChildren(), 1u);
+    EXPECT_EQ(transform->asGroup()->getChild(0), geometry.get());
+    EXPECT_EQ(geometry->getNumParents(), 1u);
+    EXPECT_EQ(geometry->getStateSet(), stateset.get());
+
+    const osg::Vec3Array* vertices = static_cast<const osg::Vec3Array*>(geometry->getVertexArray());
+    ASSERT_EQ(vertices->size(), 4u);
+    EXPECT_EQ((*vertices)[0], osg::Vec3f(-1, -1, 0));
+    EXPECT_EQ((*vertices)[2], osg::Vec3f(1, 1, 0));
+    EXPECT_EQ(geometry->getPrimitiveSet(0)->getNumIndices(), 6u);
+}
+
+TEST(MWRenderChunkBuilderTest, builds_nothing_without_references)
+{
+    MWRender::ChunkBuilder builder(osg::Vec3f());
+    EXPECT_TRUE(builder.build() == NULL);
+
+    osg::ref_ptr<osg::Group> hidden = createTemplate(new osg::StateSet);
+    hidden->setNodeMask(0);
+    builder.add(makeReference(hidden, osg::Vec3f()));
+    EXPECT_TRUE(builder.build() == NULL);
+}
+
+TEST(MWRenderChunkBuilderTest, is_large_enough)
+{
+    EXPECT_TRUE(MWRender::ChunkBuilder::isLargeEnough(100.f, 8192.f, 0.01f));
+    EXPECT_FALSE(MWRender::ChunkBuilder::isLargeEnough(30.f, 8192.f, 0.01f));
+    EXPECT_TRUE(MWRender::ChunkBuilder::isLargeEnough(30.f, 4096.f, 0.01f));
+    EXPECT_TRUE(MWRender::ChunkBuilder::isLargeEnough(1.f, 8192.f, 0.f));
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "apps/openmw/mwscript/scriptcache.hpp"
+
+namespace
+{
+
+    MWScript::ScriptCache::CompiledScript makeScript(Interpreter::Type_Code firstCode, std::size_t size)
+    {
+        MWScript::ScriptCache::CompiledScript script;
+        for (std::size_t i = 0; i < size; ++i)
+            script.first.push_back(firstCode + static_cast<Interpreter::Type_Code>(i));
+        script.second.declare('s', "state");
+        script.second.declare('l', "counter");
+        script.second.declare('f', "timer");
+        script.second.declare('f', "Distance");
+        return script;
+    }
+
+    std::string writeCache(const MWScript::ScriptCache& cache)
+    {
+        std::ostringstream stream;
+        cache.write(stream);
+        return stream.str();
+    }
+
+}
+
+TEST(MWScriptScriptCacheTest, returns_added_scripts_only_for_the_same_text)
+{
+    MWScript::ScriptCache cache("scripts.cache", "signature");
+    cache.add("doorscript", "begin doorscript\nend", makeScript(1, 10));
+
+    const MWScript::ScriptCache::CompiledScript* script = cache.get("doorscript", "begin doorscript\nend");
+    ASSERT_TRUE(script != NULL);
+    EXPECT_EQ(script->first, makeScript(1, 10).first);
+
+    EXPECT_TRUE(cache.get("doorscript", "begin doorscript\nshort state\nend") == NULL);
+    EXPECT_TRUE(cache.get("otherscript", "begin doorscript\nend") == NULL);
+}
+
+TEST(MWScriptScriptCacheTest, reads_what_it_wrote)
+{
+    MWScript::ScriptCache cache("scripts.cache", "Morrowind.esm 79837557 1024920000\n");
+    cache.add("doorscript", "begin doorscript\nend", makeScript(1, 10));
+    cache.add("emptyscript", "begin emptyscript\nend", MWScript::ScriptCache::CompiledScript());
+    cache.add("longscript", "begin longscript\nend", makeScript(0x80000000u, 5000));
+
+    std::istringstream stream(writeCache(cache));
+    MWScript::ScriptCache result("scripts.cache", "Morrowind.esm 79837557 1024920000\n");
+    ASSERT_TRUE(result.read(stream));
+    ASSERT_EQ(result.getSize(), 3u);
+
+    const MWScript::ScriptCache::CompiledScript* script = result.get("longscript", "begin longscript\nend");
+    ASSERT_TRUE(script != NULL);
+    EXPECT_EQ(script->first, makeScript(0x80000000u, 5000).first);
+    EXPECT_EQ(script->second.get('s'), std::vector<std::string>(1, "state"));
+    EXPECT_EQ(script->second.get('l'), std::vector<std::string>(1, "counter"));
+    ASSERT_EQ(script->second.get('f').size(), 2u);
+    EXPECT_EQ(script->second.getIndex("distance"), 1);
+
+    script = result.get("emptyscript", "begin emptyscript\nend");
+    ASSERT_TRUE(script != NULL);
+    EXPECT_TRUE(script->first.empty());
+}
+
+TEST(MWScriptScriptCacheTest, discards_cache_with_other_signature)
+{
+    MWScript::ScriptCache cache("scripts.cache", "Morrowind.esm\n");
+    cache.add("doorscript", "begin doorscript\nend", makeScript(1, 10));
+
+    std::istringstream stream(writeCache(cache));
+    MWScript::ScriptCache result("scripts.cache", "Morrowind.esm\nTribunal.esm\n");
+    EXPECT_FALSE(result.read(stream));
+    EXPECT_EQ(result.getSize(), 0u);
+}
+
+TEST(MWScriptScriptCacheTest, discards_truncated_cache)
+{
+    MWScript::ScriptCache cache("scripts.cache", "signature");
+    cache.add("doorscript", "begin doorscript\nend", makeScript(1, 10));
+    cache.add("otherscript", "begin otherscript\nend", makeScript(1, 10));
+    const std::string data = writeCache(cache);
+
+    for (std::size_t size = 0; size < data.size(); size += 7)
+    {
+        std::istringstream stream(data.substr(0, size));
+        MWScript::ScriptCache result("scripts.cache", "signature");
+        EXPECT_FALSE(result.read(stream)) << "size " << size;
+        EXPECT_EQ(result.getSize(), 0u) << "size " << size;
+    }
+}
+
+TEST(MWScriptScriptCacheTest, hash_does_not_change)
+{
+    EXPECT_EQ(MWScript::ScriptCache::hash(""), 14695981039346656037ULL);
+    EXPECT_EQ(MWScript::ScriptCache::hash("a"), 0xaf63dc4c8601ec8cULL);
+    EXPECT_NE(MWScript::ScriptCache::hash("begin a\nend"), MWScript::ScriptCache::hash("begin b\nend"));
+}
@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "apps/openmw/mwsound/null_output.hpp"
+#include "apps/openmw/mwsound/sound.hpp"
+
+namespace
+{
+
+    struct MWSoundNullOutputTest : public ::testing::Test
+    {
+        MWSound::Null_Output mOutput;
+        MWSound::Sound_Handle mBuffer;
+
+        virtual void SetUp()
+        {
+            ASSERT_TRUE(mOutput.init("", "", MWSound::HrtfMode::Disable));
+            ASSERT_TRUE(mOutput.isInitialized());
+            mBuffer = mOutput.loadSound("Sound/Fx/item/bookpag1.wav").first;
+            ASSERT_TRUE(mBuffer != nullptr);
+        }
+    };
+
+    int flags(MWSound::PlayMode mode, MWSound::Type type)
+    {
+        return static_cast<int>(mode) | static_cast<int>(type);
+    }
+
+}
+
+TEST_F(MWSoundNullOutputTest, ends_sounds_at_once)
+{
+    MWSound::Sound sound;
+    sound.init(1.f, 1.f, 1.f, flags(MWSound::PlayMode::Normal, MWSound::Type::Sfx));
+    ASSERT_TRUE(mOutput.playSound(&sound, mBuffer, 0.f));
+    EXPECT_FALSE(mOutput.isSoundPlaying(&sound));
+
+    MWSound::Stream voice;
+    voice.init(osg::Vec3f(0, 0, 0), 1.f, 1.f, 1.f, 1.f, 1000.f, flags(MWSound::PlayMode::Normal, MWSound::Type::Voice));
+    ASSERT_TRUE(mOutput.streamSound3D(MWSound::DecoderPtr(), &voice, true));
+    EXPECT_FALSE(mOutput.isStreamPlaying(&voice));
+    EXPECT_EQ(mOutput.getStreamLoudness(&voice), 0.f);
+}
+
+TEST_F(MWSoundNullOutputTest, plays_looping_sounds_until_they_are_finished)
+{
+    MWSound::Sound sound;
+    sound.init(osg::Vec3f(0, 0, 0), 1.f, 1.f, 1.f, 1.f, 1000.f, flags(MWSound::PlayMode::Loop, MWSound::Type::Sfx));
+    ASSERT_TRUE(mOutput.playSound3D(&sound, mBuffer, 0.f));
+    mOutput.startUpdate();
+    mOutput.updateSound(&sound);
+    mOutput.finishUpdate();
+    EXPECT_TRUE(mOutput.isSoundPlaying(&sound));
+
+    mOutput.finishSound(&sound);
+    EXPECT_FALSE(mOutput.isSoundPlaying(&sound));
+}
+
+TEST_F(MWSoundNullOutputTest, plays_music_until_it_is_finished)
+{
+    MWSound::Stream music;
+    music.init(1.f, 1.f, 1.f, flags(MWSound::PlayMode::NoEnv, MWSound::Type::Music));
+    ASSERT_TRUE(mOutput.streamSound(MWSound::DecoderPtr(), &music));
+    EXPECT_TRUE(mOutput.isStreamPlaying(&music));
+
+    mOutput.finishStream(&music);
+    EXPECT_FALSE(mOutput.isStreamPlaying(&music));
+}
+
+TEST_F(MWSoundNullOutputTest, stops_all_sounds_when_deinitialized)
+{
+    MWSound::Sound sound;
+    sound.init(1.f, 1.f, 1.f, flags(MWSound::PlayMode::Loop, MWSound::Type::Sfx));
+    ASSERT_TRUE(mOutput.playSound(&sound, mBuffer, 0.f));
+
+    mOutput.deinit();
+
+    EXPECT_FALSE(mOutput.isInitialized());
+    EXPECT_FALSE(mOutput.isSoundPlaying(&sound));
+}
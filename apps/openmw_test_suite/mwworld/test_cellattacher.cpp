@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "apps/openmw/mwworld/cellattacher.hpp"
+
+namespace
+{
+
+    /// Objects are numbers, their state is set by the test like scripts of other cells would while a cell is attached
+    struct FakeScene
+    {
+        std::set<int> mInScene;
+        std::set<int> mDisabled;
+        std::multiset<int> mInserted;
+        std::multiset<int> mRemoved;
+
+        bool isInScene(int object) const
+        {
+            return mInScene.count(object) != 0;
+        }
+
+        bool shouldBeInScene(int object) const
+        {
+            return mDisabled.count(object) == 0;
+        }
+
+        void insert(int object)
+        {
+            EXPECT_FALSE(isInScene(object)) << object;
+            mInScene.insert(object);
+            mInserted.insert(object);
+        }
+
+        void remove(int object)
+        {
+            EXPECT_TRUE(isInScene(object)) << object;
+            mInScene.erase(object);
+            mRemoved.insert(object);
+        }
+    };
+
+    std::vector<int> makeObjects(int count)
+    {
+        std::vector<int> objects;
+        for (int i = 0; i < count; ++i)
+            objects.push_back(i);
+        return objects;
+    }
+
+}
+
+TEST(MWWorldCellAttacherTest, inserts_the_objects_in_order)
+{
+    FakeScene scene;
+    MWWorld::CellAttacher<int> attacher(makeObjects(3));
+
+    EXPECT_EQ(attacher.attachNext(scene), 0);
+    EXPECT_EQ(scene.mInScene, std::set<int>({0}));
+    EXPECT_EQ(attacher.attachNext(scene), 1);
+    EXPECT_FALSE(attacher.isDone());
+    EXPECT_EQ(attacher.attachNext(scene), 2);
+    EXPECT_TRUE(attacher.isDone());
+
+    attacher.finish(scene, makeObjects(3));
+    EXPECT_EQ(scene.mInserted, std::multiset<int>({0, 1, 2}));
+    EXPECT_TRUE(scene.mRemoved.empty());
+}
+
+TEST(MWWorldCellAttacherTest, does_not_insert_an_object_enabled_while_attaching_twice)
+{
+    FakeScene scene;
+    scene.mDisabled.insert(1);
+    scene.mDisabled.insert(2);
+    MWWorld::CellAttacher<int> attacher(makeObjects(3));
+
+    attacher.attachNext(scene);
+    attacher.attachNext(scene);
+    EXPECT_EQ(scene.mInScene, std::set<int>({0}));
+
+    // enabled by a script, which inserts it as the enable of an object of an active cell would
+    scene.mDisabled.erase(2);
+    scene.insert(2);
+    attacher.attachNext(scene);
+    EXPECT_TRUE(attacher.isDone());
+
+    // enabled by a script, which only changes its state
+    scene.mDisabled.erase(1);
+    attacher.finish(scene, makeObjects(3));
+
+    EXPECT_EQ(scene.mInScene, std::set<int>({0, 1, 2}));
+    EXPECT_EQ(scene.mInserted, std::multiset<int>({0, 1, 2}));
+}
+
+TEST(MWWorldCellAttacherTest, removes_objects_disabled_or_deleted_while_attaching)
+{
+    FakeScene scene;
+    MWWorld::CellAttacher<int> attacher(makeObjects(4));
+    while (!attacher.isDone())
+        attacher.attachNext(scene);
+
+    scene.mDisabled.insert(1);
+    // deleted objects are disabled for the scene and no longer listed in the cell
+    scene.mDisabled.insert(3);
+    attacher.finish(scene, makeObjects(3));
+
+    EXPECT_EQ(scene.mInScene, std::set<int>({0, 2}));
+    EXPECT_EQ(scene.mRemoved, std::multiset<int>({1, 3}));
+}
+
+TEST(MWWorldCellAttacherTest, inserts_objects_placed_while_attaching)
+{
+    FakeScene scene;
+    MWWorld::CellAttacher<int> attacher(makeObjects(2));
+    attacher.attachNext(scene);
+
+    // e.g. a creature spawned by a levelled list, and a disabled object placed by a script
+    scene.mDisabled.insert(3);
+    attacher.attachNext(scene);
+    attacher.finish(scene, makeObjects(4));
+
+    EXPECT_EQ(scene.mInScene, std::set<int>({0, 1, 2}));
+    EXPECT_EQ(scene.mInserted, std::multiset<int>({0, 1, 2}));
+    EXPECT_TRUE(attacher.isDone());
+}
+
+TEST(MWWorldCellAttacherTest, forgets_objects_that_move_to_another_cell)
+{
+    FakeScene scene;
+    MWWorld::CellAttacher<int> attacher(makeObjects(4));
+    attacher.attachNext(scene);
+
+    // moved away by scripts of other cells, before and after they were attached
+    EXPECT_TRUE(attacher.forget(2));
+    EXPECT_FALSE(attacher.forget(0));
+    EXPECT_FALSE(attacher.forget(5));
+    scene.mInScene.erase(0);
+
+    EXPECT_EQ(attacher.attachNext(scene), 1);
+    EXPECT_EQ(attacher.attachNext(scene), 3);
+    EXPECT_TRUE(attacher.isDone());
+
+    attacher.finish(scene, std::vector<int>({1, 3}));
+    EXPECT_EQ(scene.mInScene, std::set<int>({1, 3}));
+    EXPECT_EQ(scene.mInserted, std::multiset<int>({0, 1, 3}));
+    EXPECT_TRUE(scene.mRemoved.empty());
+}
@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+
+#include "apps/openmw/mwworld/cellrefindex.hpp"
+
+namespace
+{
+
+    struct TestCell
+    {
+    };
+
+    typedef MWWorld::CellRefIndex<TestCell> Index;
+
+    struct CellRefIndexTest : public ::testing::Test
+    {
+        TestCell mBalmora;
+        TestCell mCaldera;
+        TestCell mVivec;
+        Index mIndex;
+
+        virtual void SetUp()
+        {
+            // the content files place a chair in Balmora and Caldera, and a door in Vivec
+            Index::Map contentRefs;
+            contentRefs["chair"].push_back(&mBalmora);
+            contentRefs["chair"].push_back(&mCaldera);
+            contentRefs["door"].push_back(&mVivec);
+            mIndex.swapContentRefs(contentRefs);
+        }
+
+        Index::CellList getCells(const std::string& id) const
+        {
+            Index::CellList cells;
+            mIndex.getCells(id, cells);
+            return cells;
+        }
+    };
+
+}
+
+TEST_F(CellRefIndexTest, finds_content_file_references_regardless_of_case)
+{
+    Index::CellList expected;
+    expected.push_back(&mBalmora);
+    expected.push_back(&mCaldera);
+    EXPECT_EQ(getCells("Chair"), expected);
+    EXPECT_TRUE(mIndex.mayHaveRef("CHAIR", &mCaldera));
+    EXPECT_FALSE(mIndex.mayHaveRef("chair", &mVivec));
+    EXPECT_TRUE(getCells("table").empty());
+}
+
+TEST_F(CellRefIndexTest, finds_a_reference_in_the_cell_it_was_moved_to)
+{
+    mIndex.addRuntimeRef("door", &mBalmora);
+
+    Index::CellList expected;
+    expected.push_back(&mVivec);
+    expected.push_back(&mBalmora);
+    EXPECT_EQ(getCells("door"), expected);
+    EXPECT_TRUE(mIndex.mayHaveRef("door", &mBalmora));
+
+    // moving it on, or moving another one to the same cell, lists every cell once
+    mIndex.addRuntimeRef("door", &mCaldera);
+    mIndex.addRuntimeRef("Door", &mBalmora);
+    mIndex.addRuntimeRef("door", &mVivec);
+    expected.push_back(&mCaldera);
+    EXPECT_EQ(getCells("door"), expected);
+}
+
+TEST_F(CellRefIndexTest, finds_a_reference_created_at_runtime)
+{
+    EXPECT_FALSE(mIndex.mayHaveRef("gold_001", &mCaldera));
+
+    mIndex.addRuntimeRef("gold_001", &mCaldera);
+
+    EXPECT_EQ(getCells("gold_001"), Index::CellList(1, &mCaldera));
+    EXPECT_TRUE(mIndex.mayHaveRef("Gold_001", &mCaldera));
+}
+
+TEST_F(CellRefIndexTest, clearing_runtime_references_keeps_content_file_references)
+{
+    mIndex.addRuntimeRef("door", &mBalmora);
+    mIndex.addRuntimeRef("gold_001", &mCaldera);
+
+    mIndex.clearRuntimeRefs();
+
+    EXPECT_EQ(getCells("door"), Index::CellList(1, &mVivec));
+    EXPECT_TRUE(getCells("gold_001").empty());
+    EXPECT_FALSE(mIndex.mayHaveRef("door", &mBalmora));
+}
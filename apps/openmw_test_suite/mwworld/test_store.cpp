@@ -6,8 +6,13 @@
 #include <components/esm/esmreader.hpp>
 #include <components/esm/esmwriter.hpp>
 #include <components/loadinglistener/loadinglistener.hpp>
+#include <components/misc/stringops.hpp>
 
 #include "apps/openmw/mwworld/esmstore.hpp"
+#include "apps/openmw/mwmechanics/pathgrid.hpp"
+#include "apps/openmw/mwdialogue/filterindex.hpp"
+
+#include "../benchmark.hpp"
 
 static Loading::Listener dummyListener;
 
@@ -193,6 +198,133 @@ TEST_F(ContentFileTest, content_diagnostics_test)
     std::cout << "diagnostics_test successful, results printed to " << file << std::endl;
 }
 
+/// Compare the throughput of loading the content files of the test data directory
+/// through file streams and through memory mapped readers
+TEST_F(ContentFileTest, DISABLED_load_benchmark)
+{
+    if (mContentFiles.empty())
+    {
+        std::cout << "No content files found, skipping test" << std::endl;
+        return;
+    }
+
+    boost::uintmax_t bytes = 0;
+    for (std::vector<boost::filesystem::path>::const_iterator it = mContentFiles.begin(); it != mContentFiles.end(); ++it)
+        bytes += boost::filesystem::file_size(*it);
+    const std::string size = std::to_string(bytes / (1024 * 1024)) + " MB";
+
+    for (int memoryMapped = 0; memoryMapped < 2; ++memoryMapped)
+    {
+        MWWorld::ESMStore store;
+        std::vector<ESM::ESMReader> readerList(mContentFiles.size());
+
+        Benchmark::Timer timer;
+        for (std::size_t i = 0; i < mContentFiles.size(); ++i)
+        {
+            ESM::ESMReader& reader = readerList[i];
+            reader.setEncoder(NULL);
+            reader.setIndex(static_cast<int>(i));
+            reader.setGlobalReaderList(&readerList);
+            reader.setMemoryMapped(memoryMapped != 0);
+            reader.open(mContentFiles[i].string());
+            store.load(reader, &dummyListener);
+        }
+
+        Benchmark::report((memoryMapped ? "Memory mapped loading of " : "Stream loading of ") + size, timer.getMilliseconds());
+    }
+}
+
+/// Time path searches on every pathgrid of the content files, from each point to a spread of goal points
+TEST_F(ContentFileTest, DISABLED_pathgrid_benchmark)
+{
+    if (mContentFiles.empty())
+    {
+        std::cout << "No content files found, skipping test" << std::endl;
+        return;
+    }
+
+    const MWWorld::Store<ESM::Cell>& cells = mEsmStore.get<ESM::Cell>();
+    std::vector<const ESM::Pathgrid*> pathgrids;
+    for (MWWorld::Store<ESM::Cell>::iterator it = cells.intBegin(); it != cells.intEnd(); ++it)
+        if (const ESM::Pathgrid* pathgrid = mEsmStore.get<ESM::Pathgrid>().search(*it))
+            pathgrids.push_back(pathgrid);
+    for (MWWorld::Store<ESM::Cell>::iterator it = cells.extBegin(); it != cells.extEnd(); ++it)
+        if (const ESM::Pathgrid* pathgrid = mEsmStore.get<ESM::Pathgrid>().search(*it))
+            pathgrids.push_back(pathgrid);
+
+    std::size_t searches = 0;
+    std::size_t pathPoints = 0;
+    Benchmark::Timer timer;
+    for (std::vector<const ESM::Pathgrid*>::const_iterator it = pathgrids.begin(); it != pathgrids.end(); ++it)
+    {
+        MWMechanics::PathgridGraph graph;
+        graph.load(*it);
+
+        const int points = static_cast<int>((*it)->mPoints.size());
+        const int step = std::max(1, points / 8);
+        std::vector<int> path;
+        for (int from = 0; from < points; ++from)
+        {
+            for (int to = 0; to < points; to += step)
+            {
+                graph.aStarSearch(from, to, path);
+                pathPoints += path.size();
+                ++searches;
+            }
+        }
+    }
+
+    Benchmark::report("Pathgrid search on " + std::to_string(pathgrids.size()) + " pathgrids, "
+                      + std::to_string(searches) + " searches, " + std::to_string(pathPoints) + " path points",
+                      timer.getMilliseconds());
+}
+
+/// Count the dialogue infos that have to be tested when talking to every NPC of the content files,
+/// with and without the dialogue filter index
+TEST_F(ContentFileTest, DISABLED_dialogue_filter_index_benchmark)
+{
+    if (mContentFiles.empty())
+    {
+        std::cout << "No content files found, skipping test" << std::endl;
+        return;
+    }
+
+    const MWWorld::Store<ESM::Dialogue>& dialogues = mEsmStore.get<ESM::Dialogue>();
+    const MWWorld::Store<ESM::NPC>& npcs = mEsmStore.get<ESM::NPC>();
+
+    Benchmark::Timer timer;
+    MWDialogue::FilterIndex index;
+    index.build(dialogues);
+    const double buildTime = timer.getMilliseconds();
+    ASSERT_EQ(index.size(), dialogues.getSize());
+
+    std::size_t allInfos = 0;
+    std::size_t candidateInfos = 0;
+    std::vector<const MWDialogue::FilterIndex::Info*> candidates;
+    timer.restart();
+    for (MWWorld::Store<ESM::NPC>::iterator npc = npcs.begin(); npc != npcs.end(); ++npc)
+    {
+        MWDialogue::FilterIndex::Speaker speaker;
+        speaker.mId = Misc::StringUtils::lowerCase(npc->mId);
+        speaker.mRace = Misc::StringUtils::lowerCase(npc->mRace);
+        speaker.mClass = Misc::StringUtils::lowerCase(npc->mClass);
+        speaker.mFaction = Misc::StringUtils::lowerCase(npc->mFaction);
+
+        for (MWWorld::Store<ESM::Dialogue>::iterator dialogue = dialogues.begin(); dialogue != dialogues.end(); ++dialogue)
+        {
+            const MWDialogue::FilterIndex::Topic* topic = index.search(*dialogue);
+            ASSERT_TRUE(topic != NULL);
+            topic->getCandidates(speaker, candidates);
+            candidateInfos += candidates.size();
+            allInfos += dialogue->mInfo.size();
+        }
+    }
+
+    Benchmark::report("Dialogue filter index build for " + std::to_string(dialogues.getSize()) + " dialogues", buildTime);
+    Benchmark::report("Talking to " + std::to_string(npcs.getSize()) + " NPCs, testing " + std::to_string(candidateInfos)
+                      + " of " + std::to_string(allInfos) + " infos", timer.getMilliseconds());
+}
+
 // TODO:
 /// Print results of autocalculated NPC spell lists. Also serves as test for attribute/skill autocalculation which the spell autocalculation heavily relies on
 /// - even incorrect rounding modes can completely change the resulting spell lists.
@@ -313,3 +445,197 @@ TEST_F(StoreTest, overwrite_test)
 
     ASSERT_TRUE (overwrittenRec && overwrittenRec->mModel == "the_new_model");
 }
+
+/// Tests that staging several files up front and merging them in load order has the same result as loading them one by one.
+TEST_F(StoreTest, staged_merge_test)
+{
+    typedef ESM::Apparatus RecordType;
+
+    RecordType record;
+    record.blank();
+    record.mId = "foobar";
+
+    std::vector<ESM::ESMReader> readerList(3);
+    for (std::size_t i = 0; i < readerList.size(); ++i)
+    {
+        readerList[i].setIndex(static_cast<int>(i));
+        readerList[i].setGlobalReaderList(&readerList);
+    }
+
+    // master file inserts a record, a plugin deletes it, another plugin inserts it again with changed data
+    readerList[0].open(getEsmFile(record, false), "master");
+    readerList[1].open(getEsmFile(record, true), "plugin1");
+    record.mId = "Foobar";
+    record.mModel = "the_new_model";
+    readerList[2].open(getEsmFile(record, false), "plugin2");
+
+    // all files are read before any of them is added to the store
+    std::vector<MWWorld::ESMStore::StagedFile> files(readerList.size());
+    for (std::size_t i = 0; i < readerList.size(); ++i)
+        mEsmStore.stage(readerList[i], files[i]);
+
+    ASSERT_TRUE (mEsmStore.get<RecordType>().getSize() == 0);
+
+    mEsmStore.merge(readerList[0], files[0], &dummyListener);
+    mEsmStore.setUp();
+    ASSERT_TRUE (mEsmStore.get<RecordType>().getSize() == 1);
+
+    mEsmStore.merge(readerList[1], files[1], &dummyListener);
+    mEsmStore.setUp();
+    ASSERT_TRUE (mEsmStore.get<RecordType>().getSize() == 0);
+
+    mEsmStore.merge(readerList[2], files[2], &dummyListener);
+    mEsmStore.setUp();
+
+    const RecordType* mergedRec = mEsmStore.get<RecordType>().search("foobar");
+    ASSERT_TRUE (mergedRec != NULL);
+    ASSERT_TRUE (mergedRec && mergedRec->mModel == "the_new_model");
+}
+
+/// Tests that dynamic records are saved in ID order, no matter in which order they were created.
+TEST(StoreWriteTest, writes_dynamic_records_sorted_by_id)
+{
+    typedef ESM::Apparatus RecordType;
+
+    MWWorld::Store<RecordType> store;
+    const char* ids[] = { "Zeta", "alpha", "gamma", "Mid", "beta" };
+    for (std::size_t i = 0; i < sizeof(ids) / sizeof(ids[0]); ++i)
+    {
+        RecordType record;
+        record.blank();
+        record.mId = ids[i];
+        store.insert(record);
+    }
+    // reuse the slot of an erased record
+    store.erase("gamma");
+    RecordType record;
+    record.blank();
+    record.mId = "delta";
+    store.insert(record);
+
+    ESM::ESMWriter writer;
+    std::stringstream* stream = new std::stringstream;
+    writer.setFormat(0);
+    writer.save(*stream);
+    store.write(writer, dummyListener);
+
+    ESM::ESMReader reader;
+    reader.open(Files::IStreamPtr(stream), "savegame");
+    std::vector<std::string> written;
+    while (reader.hasMoreRecs())
+    {
+        ASSERT_EQ(reader.getRecName().intval, static_cast<unsigned int>(RecordType::sRecordId));
+        reader.getRecHeader();
+        bool isDeleted = false;
+        record.load(reader, isDeleted);
+        written.push_back(record.mId);
+    }
+
+    const char* expected[] = { "alpha", "beta", "delta", "Mid", "Zeta" };
+    EXPECT_EQ(written, std::vector<std::string>(expected, expected + sizeof(expected) / sizeof(expected[0])));
+}
+
+/// Tests case insensitive lookups in RecordMap while entries are inserted and erased.
+TEST(RecordMapTest, insert_search_erase)
+{
+    MWWorld::RecordMap<int> map;
+    std::map<std::string, int> reference;
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::ostringstream id;
+        id << "Record_" << i;
+        ASSERT_TRUE (map.insert(id.str(), i).second);
+        reference[Misc::StringUtils::lowerCase(id.str())] = i;
+    }
+    ASSERT_FALSE (map.insert("RECORD_42", 0).second);
+
+    // Erase every third record, so that probe sequences are broken up all over the table
+    for (int i = 0; i < 5000; i += 3)
+    {
+        std::ostringstream id;
+        id << "rEcOrD_" << i;
+        ASSERT_TRUE (map.erase(id.str()));
+        reference.erase(Misc::StringUtils::lowerCase(id.str()));
+    }
+    ASSERT_FALSE (map.erase("record_0"));
+    ASSERT_EQ (map.size(), reference.size());
+
+    for (int i = 0; i < 5000; ++i)
+    {
+        std::ostringstream id;
+        id << "RECORD_" << i;
+        const int* value = map.search(id.str());
+        if (i % 3 == 0)
+            ASSERT_TRUE (value == NULL) << id.str();
+        else
+            ASSERT_TRUE (value && *value == i) << id.str();
+    }
+
+    std::map<std::string, int> iterated;
+    for (MWWorld::RecordMap<int>::iterator it = map.begin(); it != map.end(); ++it)
+        iterated[it->mId] = it->mValue;
+    ASSERT_TRUE (iterated == reference);
+}
+
+/// Tests that swapping RecordMaps keeps their entries searchable.
+TEST(RecordMapTest, swap)
+{
+    MWWorld::RecordMap<int> first;
+    first.insert("Foo", 1);
+    first.insert("bar", 2);
+    first.erase("bar");
+
+    MWWorld::RecordMap<int> second;
+    second.insert("Baz", 3);
+
+    first.swap(second);
+
+    ASSERT_EQ (first.size(), 1u);
+    ASSERT_TRUE (first.search("BAZ") != NULL);
+    EXPECT_EQ (*first.search("baz"), 3);
+    EXPECT_TRUE (first.search("foo") == NULL);
+
+    ASSERT_EQ (second.size(), 1u);
+    ASSERT_TRUE (second.search("foo") != NULL);
+    EXPECT_EQ (*second.search("FOO"), 1);
+    EXPECT_TRUE (second.search("bar") == NULL);
+
+    // the erased entry's slot is reused after the swap
+    second.insert("qux", 4);
+    EXPECT_EQ (second.size(), 2u);
+    EXPECT_EQ (*second.search("Qux"), 4);
+}
+
+/// Search a store of statics by ID, in a different case than they were inserted with
+TEST(RecordMapTest, DISABLED_search_benchmark)
+{
+    const int iterations = 20;
+
+    MWWorld::Store<ESM::Static> store;
+    std::vector<std::string> ids;
+    for (int i = 0; i < 8000; ++i)
+    {
+        std::ostringstream id;
+        id << "Ex_Common_Building_" << i;
+
+        ESM::Static record;
+        record.blank();
+        record.mId = id.str();
+        store.insertStatic(record);
+        ids.push_back(Misc::StringUtils::lowerCase(record.mId));
+    }
+
+    std::size_t found = 0;
+    Benchmark::Timer timer;
+    for (int n = 0; n < iterations; ++n)
+    {
+        for (std::size_t i = 0; i < ids.size(); ++i)
+            found += store.search(ids[i]) != NULL;
+    }
+    const double time = timer.getMilliseconds();
+
+    ASSERT_EQ (found, ids.size() * iterations);
+
+    Benchmark::report("Record search of " + std::to_string(ids.size() * iterations) + " IDs", time);
+}
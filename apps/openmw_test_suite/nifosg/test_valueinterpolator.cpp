@@ -0,0 +1,143 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <components/nifosg/controller.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    const float sKeySpacing = 0.25f;
+
+    /// The value of key i is i squared, so each pair of keys has a different slope
+    float getKeyValue(int key)
+    {
+        return static_cast<float>(key * key);
+    }
+
+    std::shared_ptr<Nif::FloatKeyMap> makeTrack(int count)
+    {
+        std::shared_ptr<Nif::FloatKeyMap> keys(new Nif::FloatKeyMap);
+        for (int i = 0; i < count; ++i)
+            keys->addKey(i * sKeySpacing, getKeyValue(i));
+        return keys;
+    }
+
+    float getExpectedValue(int count, float time)
+    {
+        if (time <= 0.f)
+            return getKeyValue(0);
+        const int key = static_cast<int>(std::floor(time / sKeySpacing));
+        if (key >= count - 1)
+            return getKeyValue(count - 1);
+        const float a = time / sKeySpacing - key;
+        return getKeyValue(key) + a * (getKeyValue(key + 1) - getKeyValue(key));
+    }
+
+    void expectValue(const NifOsg::FloatInterpolator& interpolator, int count, float time)
+    {
+        EXPECT_NEAR(interpolator.interpKey(time), getExpectedValue(count, time), 1e-2f) << "time " << time;
+    }
+
+}
+
+TEST(NifOsgValueInterpolatorTest, interpolates_between_the_surrounding_keys_in_any_order)
+{
+    const int count = 50;
+    NifOsg::FloatInterpolator interpolator(makeTrack(count));
+
+    // forward sweep, with steps smaller and larger than the key spacing
+    for (float time = -1.f; time < 14.f; time += 0.1f)
+        expectValue(interpolator, count, time);
+    for (float time = -1.f; time < 14.f; time += 0.7f)
+        expectValue(interpolator, count, time);
+    // backward sweep
+    for (float time = 14.f; time > -1.f; time -= 0.1f)
+        expectValue(interpolator, count, time);
+    // exactly on the keys
+    for (int i = 0; i < count; ++i)
+        EXPECT_EQ(interpolator.interpKey(i * sKeySpacing), getKeyValue(i));
+    // random access
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> times(-1.f, 14.f);
+    for (int i = 0; i < 200; ++i)
+        expectValue(interpolator, count, times(random));
+}
+
+TEST(NifOsgValueInterpolatorTest, clamps_to_first_and_last_key)
+{
+    std::shared_ptr<Nif::Vector3KeyMap> keys(new Nif::Vector3KeyMap);
+    keys->addKey(1.f, osg::Vec3f(1, 2, 3));
+    keys->addKey(2.f, osg::Vec3f(3, 4, 5));
+    NifOsg::Vec3Interpolator interpolator(keys);
+
+    EXPECT_EQ(interpolator.interpKey(0.f), osg::Vec3f(1, 2, 3));
+    EXPECT_EQ(interpolator.interpKey(1.5f), osg::Vec3f(2, 3, 4));
+    EXPECT_EQ(interpolator.interpKey(5.f), osg::Vec3f(3, 4, 5));
+}
+
+TEST(NifOsgValueInterpolatorTest, empty_track_returns_default_value)
+{
+    NifOsg::FloatInterpolator interpolator(std::shared_ptr<Nif::FloatKeyMap>(new Nif::FloatKeyMap), 7.f);
+    EXPECT_TRUE(interpolator.empty());
+    EXPECT_EQ(interpolator.interpKey(1.f), 7.f);
+
+    NifOsg::FloatInterpolator noKeys;
+    EXPECT_TRUE(noKeys.empty());
+    EXPECT_EQ(noKeys.interpKey(1.f), 0.f);
+}
+
+TEST(NifKeyMapTest, sort_keeps_the_last_of_duplicate_keys)
+{
+    // Same as inserting into a map with operator[]
+    Nif::FloatKeyMap keys;
+    keys.addKey(2.f, 20.f);
+    keys.addKey(1.f, 10.f);
+    keys.addKey(2.f, 21.f);
+    keys.addKey(0.f, 0.f);
+    keys.sort();
+
+    ASSERT_EQ(keys.size(), 3u);
+    EXPECT_EQ(keys.mTimes[0], 0.f);
+    EXPECT_EQ(keys.mTimes[1], 1.f);
+    EXPECT_EQ(keys.mTimes[2], 2.f);
+    EXPECT_EQ(keys.mValues[0], 0.f);
+    EXPECT_EQ(keys.mValues[1], 10.f);
+    EXPECT_EQ(keys.mValues[2], 21.f);
+}
+
+/// Evaluate as many key tracks as an actor animation file has (three per bone, keyed at 15 fps) over a time sweep
+TEST(NifOsgValueInterpolatorTest, DISABLED_animation_sweep_benchmark)
+{
+    const int bones = 60;
+    const int tracksPerBone = 3;
+    const int keys = 15 * 120;
+    const float frameTime = 1 / 60.f;
+    const int frames = 60 * 120;
+
+    std::mt19937 random(42);
+    std::uniform_real_distribution<float> values(0.f, 100.f);
+    std::vector<NifOsg::FloatInterpolator> interpolators;
+    for (int i = 0; i < bones * tracksPerBone; ++i)
+    {
+        std::shared_ptr<Nif::FloatKeyMap> track(new Nif::FloatKeyMap);
+        for (int key = 0; key < keys; ++key)
+            track->addKey(key / 15.f, values(random));
+        interpolators.push_back(NifOsg::FloatInterpolator(track));
+    }
+
+    float sum = 0;
+    Benchmark::Timer timer;
+    for (int frame = 0; frame < frames; ++frame)
+        for (std::size_t i = 0; i < interpolators.size(); ++i)
+            sum += interpolators[i].interpKey(frame * frameTime);
+
+    Benchmark::report("Key tracks: " + std::to_string(interpolators.size()) + " tracks over " + std::to_string(frames)
+                      + " frames", timer.getMilliseconds());
+    EXPECT_GT(sum, 0.f);
+}
@@ -0,0 +1,138 @@
+#include <gtest/gtest.h>
+
+#include <osg/Node>
+#include <osg/Image>
+
+#include <components/resource/objectcache.hpp>
+
+namespace
+{
+
+    struct ObjectCacheTest : public ::testing::Test
+    {
+        ObjectCacheTest()
+            : mCache(new Resource::ObjectCache)
+            , mOtherCache(new Resource::ObjectCache)
+        {
+        }
+
+        osg::ref_ptr<Resource::ObjectCache> mCache;
+        osg::ref_ptr<Resource::ObjectCache> mOtherCache;
+    };
+
+}
+
+TEST_F(ObjectCacheTest, counts_hits_and_misses)
+{
+    mCache->addEntryToObjectCache("a", new osg::Node);
+
+    EXPECT_TRUE(mCache->getRefFromObjectCache("a").valid());
+    EXPECT_FALSE(mCache->getRefFromObjectCache("b").valid());
+    EXPECT_TRUE(mCache->checkInObjectCache("a", 1.0));
+
+    Resource::ObjectCache::Stats stats = mCache->getStats();
+    EXPECT_EQ(stats._numObjects, 1u);
+    EXPECT_EQ(stats._numHits, 2u);
+    EXPECT_EQ(stats._numMisses, 1u);
+    EXPECT_EQ(stats._numEvictions, 0u);
+}
+
+TEST_F(ObjectCacheTest, tracks_memory_usage)
+{
+    mCache->addEntryToObjectCache("a", new osg::Node, 0.0, 1000);
+    mCache->addEntryToObjectCache("b", new osg::Node, 0.0, 2000);
+    const std::size_t both = mCache->getStats()._memoryUsage;
+    EXPECT_GE(both, 3000u);
+
+    // Replacing an entry replaces its size
+    mCache->addEntryToObjectCache("b", new osg::Node, 0.0, 500);
+    EXPECT_EQ(mCache->getStats()._memoryUsage, both - 1500);
+
+    mCache->removeFromObjectCache("a");
+    mCache->removeFromObjectCache("b");
+    EXPECT_EQ(mCache->getStats()._memoryUsage, 0u);
+}
+
+TEST_F(ObjectCacheTest, estimates_image_size)
+{
+    osg::ref_ptr<osg::Image> image = new osg::Image;
+    image->allocateImage(64, 64, 1, GL_RGBA, GL_UNSIGNED_BYTE);
+    EXPECT_GE(Resource::ObjectCache::estimateSize(image), 64u * 64u * 4u);
+}
+
+TEST_F(ObjectCacheTest, removes_least_recently_used_objects_over_budget)
+{
+    mCache->addEntryToObjectCache("a", new osg::Node, 0.0, 1000);
+    mOtherCache->addEntryToObjectCache("b", new osg::Node, 0.0, 1000);
+    mCache->addEntryToObjectCache("c", new osg::Node, 0.0, 1000);
+    mOtherCache->addEntryToObjectCache("d", new osg::Node, 0.0, 1000);
+
+    // "a" is used again, and "b" is still referenced elsewhere, so "c" and "d" go first
+    EXPECT_TRUE(mCache->getRefFromObjectCache("a").valid());
+    osg::ref_ptr<osg::Object> b = mOtherCache->getRefFromObjectCache("b");
+
+    std::vector<Resource::ObjectCache*> caches;
+    caches.push_back(mCache.get());
+    caches.push_back(mOtherCache.get());
+    Resource::ObjectCache::removeLeastRecentlyUsedObjects(caches, 2500);
+
+    EXPECT_TRUE(mCache->checkInObjectCache("a", 0.0));
+    EXPECT_TRUE(mOtherCache->checkInObjectCache("b", 0.0));
+    EXPECT_FALSE(mCache->checkInObjectCache("c", 0.0));
+    EXPECT_FALSE(mOtherCache->checkInObjectCache("d", 0.0));
+    EXPECT_EQ(mCache->getStats()._numEvictions, 1u);
+    EXPECT_EQ(mOtherCache->getStats()._numEvictions, 1u);
+
+    // Referenced objects are kept even if that exceeds the budget
+    Resource::ObjectCache::removeLeastRecentlyUsedObjects(caches, 0);
+    EXPECT_FALSE(mCache->checkInObjectCache("a", 0.0));
+    EXPECT_TRUE(mOtherCache->checkInObjectCache("b", 0.0));
+}
+
+TEST_F(ObjectCacheTest, expired_objects_count_as_evictions)
+{
+    mCache->addEntryToObjectCache("a", new osg::Node, 1.0);
+    mCache->addEntryToObjectCache("b", new osg::Node, 3.0);
+    mCache->removeExpiredObjectsInCache(2.0);
+
+    EXPECT_FALSE(mCache->checkInObjectCache("a", 0.0));
+    EXPECT_TRUE(mCache->checkInObjectCache("b", 0.0));
+    EXPECT_EQ(mCache->getStats()._numEvictions, 1u);
+}
+
+namespace
+{
+
+    struct StartsWith
+    {
+        StartsWith(const std::string& prefix) : mPrefix(prefix) {}
+
+        bool operator() (const std::string& fileName) const
+        {
+            return fileName.compare(0, mPrefix.size(), mPrefix) == 0;
+        }
+
+        std::string mPrefix;
+    };
+
+}
+
+TEST_F(ObjectCacheTest, removes_objects_by_file_name)
+{
+    mCache->addEntryToObjectCache("a1", new osg::Node, 0.0, 1000);
+    mCache->addEntryToObjectCache("a2", new osg::Node, 0.0, 1000);
+    mCache->addEntryToObjectCache("b", new osg::Node, 0.0, 1000);
+    const std::size_t all = mCache->getStats()._memoryUsage;
+
+    // also objects that are still referenced elsewhere
+    osg::ref_ptr<osg::Object> a1 = mCache->getRefFromObjectCache("a1");
+
+    StartsWith predicate("a");
+    mCache->removeIf(predicate);
+
+    EXPECT_FALSE(mCache->checkInObjectCache("a1", 0.0));
+    EXPECT_FALSE(mCache->checkInObjectCache("a2", 0.0));
+    EXPECT_TRUE(mCache->checkInObjectCache("b", 0.0));
+    EXPECT_EQ(mCache->getStats()._memoryUsage, all - 2000);
+    EXPECT_EQ(a1->referenceCount(), 1);
+}
@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+
+#include <ctime>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <osg/Array>
+#include <osg/Geometry>
+#include <osg/Group>
+
+#include <osgDB/Registry>
+
+#include <components/resource/scenefilecache.hpp>
+#include <components/sceneutil/serialize.hpp>
+#include <components/vfs/filesystemarchive.hpp>
+
+namespace
+{
+
+    struct SceneFileCacheTest : public ::testing::Test
+    {
+        SceneFileCacheTest()
+            : mDirectory(boost::filesystem::temp_directory_path() / boost::filesystem::unique_path("openmw-scenefilecache-%%%%%%%%"))
+            , mSourcePath(mDirectory / "mesh.nif")
+            , mSource(mSourcePath.string())
+        {
+        }
+
+        virtual void SetUp()
+        {
+            ASSERT_TRUE(osgDB::Registry::instance()->getReaderWriterForExtension("osgb") != NULL);
+
+            // The debug serializers skip the vertex data, which must not matter to the cache
+            SceneUtil::registerSerializers();
+
+            boost::filesystem::create_directories(mDirectory);
+            writeSource("NetImmerse File Format");
+
+            osg::ref_ptr<osg::Vec3Array> vertices (new osg::Vec3Array);
+            vertices->push_back(osg::Vec3f(0, 0, 0));
+            vertices->push_back(osg::Vec3f(128, 0, 0));
+            vertices->push_back(osg::Vec3f(0, 128, 64));
+
+            osg::ref_ptr<osg::Geometry> geometry (new osg::Geometry);
+            geometry->setVertexArray(vertices.get());
+            geometry->addPrimitiveSet(new osg::DrawArrays(GL_TRIANGLES, 0, 3));
+
+            mScene = new osg::Group;
+            mScene->setName("mesh");
+            mScene->addChild(geometry.get());
+        }
+
+        virtual void TearDown()
+        {
+            boost::filesystem::remove_all(mDirectory);
+        }
+
+        void writeSource(const std::string& contents)
+        {
+            boost::filesystem::ofstream file (mSourcePath, std::ios::binary);
+            file << contents;
+        }
+
+        boost::filesystem::path mDirectory;
+        boost::filesystem::path mSourcePath;
+        VFS::FileSystemArchiveFile mSource;
+        osg::ref_ptr<osg::Group> mScene;
+    };
+
+}
+
+TEST_F(SceneFileCacheTest, reads_back_written_scene_with_its_vertex_data)
+{
+    Resource::SceneFileCache cache ((mDirectory / "cache").string(), "settings");
+    ASSERT_TRUE(cache.write("meshes/mesh.nif", mSource, *mScene));
+
+    osg::ref_ptr<osg::Node> node = cache.read("meshes/mesh.nif", mSource, NULL);
+    ASSERT_TRUE(node.valid());
+    EXPECT_EQ(node->getName(), "mesh");
+
+    osg::Group* group = node->asGroup();
+    ASSERT_TRUE(group != NULL);
+    ASSERT_EQ(group->getNumChildren(), 1u);
+    osg::Geometry* geometry = group->getChild(0)->asGeometry();
+    ASSERT_TRUE(geometry != NULL);
+    const osg::Vec3Array* vertices = dynamic_cast<const osg::Vec3Array*>(geometry->getVertexArray());
+    ASSERT_TRUE(vertices != NULL);
+    ASSERT_EQ(vertices->size(), 3u);
+    EXPECT_EQ((*vertices)[2], osg::Vec3f(0, 128, 64));
+
+    EXPECT_FALSE(cache.read("meshes/other.nif", mSource, NULL).valid());
+}
+
+TEST_F(SceneFileCacheTest, ignores_scene_when_source_size_changes)
+{
+    Resource::SceneFileCache cache ((mDirectory / "cache").string(), "settings");
+    ASSERT_TRUE(cache.write("meshes/mesh.nif", mSource, *mScene));
+    ASSERT_TRUE(cache.read("meshes/mesh.nif", mSource, NULL).valid());
+    const std::time_t modified = boost::filesystem::last_write_time(mSourcePath);
+
+    writeSource("NetImmerse File Format, Version 4.0.0.2");
+    boost::filesystem::last_write_time(mSourcePath, modified);
+
+    EXPECT_FALSE(cache.read("meshes/mesh.nif", mSource, NULL).valid());
+}
+
+TEST_F(SceneFileCacheTest, ignores_scene_when_source_modification_time_changes)
+{
+    Resource::SceneFileCache cache ((mDirectory / "cache").string(), "settings");
+    ASSERT_TRUE(cache.write("meshes/mesh.nif", mSource, *mScene));
+    ASSERT_TRUE(cache.read("meshes/mesh.nif", mSource, NULL).valid());
+
+    boost::filesystem::last_write_time(mSourcePath, boost::filesystem::last_write_time(mSourcePath) - 60);
+
+    EXPECT_FALSE(cache.read("meshes/mesh.nif", mSource, NULL).valid());
+}
+
+TEST_F(SceneFileCacheTest, ignores_scene_converted_with_other_settings)
+{
+    ASSERT_TRUE(Resource::SceneFileCache((mDirectory / "cache").string(), "settings").write("meshes/mesh.nif", mSource, *mScene));
+
+    Resource::SceneFileCache cache ((mDirectory / "cache").string(), "other settings");
+    EXPECT_FALSE(cache.read("meshes/mesh.nif", mSource, NULL).valid());
+}
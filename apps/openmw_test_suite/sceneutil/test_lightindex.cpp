@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+
+#include <components/sceneutil/lightindex.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    float random(float min, float max)
+    {
+        return min + (max - min) * (std::rand() / static_cast<float>(RAND_MAX));
+    }
+
+    /// Light bounds in view space, like the lights of the exterior cells around the player
+    std::vector<osg::BoundingSphere> makeLights(std::size_t count)
+    {
+        std::srand(42);
+        std::vector<osg::BoundingSphere> lights;
+        for (std::size_t i = 0; i < count; ++i)
+            lights.push_back(osg::BoundingSphere(osg::Vec3f(random(-12288, 12288), random(-2000, 2000), random(-24576, 0)),
+                                                 random(100, 600)));
+        return lights;
+    }
+
+    /// Object bounds in view space
+    std::vector<osg::BoundingSphere> makeObjects(std::size_t count)
+    {
+        std::vector<osg::BoundingSphere> objects;
+        for (std::size_t i = 0; i < count; ++i)
+            objects.push_back(osg::BoundingSphere(osg::Vec3f(random(-12288, 12288), random(-2000, 2000), random(-24576, 0)),
+                                                  random(10, 300)));
+        return objects;
+    }
+
+    void bruteForceQuery(const std::vector<osg::BoundingSphere>& lights, const osg::BoundingSphere& bound, std::vector<unsigned int>& out)
+    {
+        for (std::size_t i = 0; i < lights.size(); ++i)
+        {
+            if (lights[i].intersects(bound))
+                out.push_back(static_cast<unsigned int>(i));
+        }
+    }
+
+    SceneUtil::LightIndex makeIndex(const std::vector<osg::BoundingSphere>& lights)
+    {
+        SceneUtil::LightIndex index;
+        for (std::size_t i = 0; i < lights.size(); ++i)
+            index.add(lights[i]);
+        index.build();
+        return index;
+    }
+
+}
+
+TEST(SceneUtilLightIndexTest, finds_the_same_lights_as_brute_force)
+{
+    const std::size_t counts[] = { 1, 4, 5, 37, 500 };
+
+    for (std::size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        const std::vector<osg::BoundingSphere> lights = makeLights(counts[c]);
+        const std::vector<osg::BoundingSphere> objects = makeObjects(200);
+        const SceneUtil::LightIndex index = makeIndex(lights);
+        EXPECT_EQ(index.size(), counts[c]);
+
+        std::size_t found = 0;
+        for (std::size_t i = 0; i < objects.size(); ++i)
+        {
+            std::vector<unsigned int> expected;
+            bruteForceQuery(lights, objects[i], expected);
+            std::vector<unsigned int> result;
+            index.query(objects[i], result);
+            ASSERT_EQ(result, expected) << counts[c] << " lights, object " << i;
+            found += result.size();
+        }
+
+        if (counts[c] > 100)
+        {
+            EXPECT_GT(found, 0u);
+        }
+    }
+}
+
+TEST(SceneUtilLightIndexTest, appends_to_the_result)
+{
+    std::vector<osg::BoundingSphere> lights;
+    for (int i = 0; i < 10; ++i)
+        lights.push_back(osg::BoundingSphere(osg::Vec3f(i * 100.f, 0, 0), 60.f));
+    const SceneUtil::LightIndex index = makeIndex(lights);
+
+    std::vector<unsigned int> result(1, 42);
+    index.query(osg::BoundingSphere(osg::Vec3f(450, 0, 0), 100.f), result);
+    ASSERT_EQ(result.size(), 5u);
+    EXPECT_EQ(result[0], 42u);
+    EXPECT_EQ(result[1], 3u);
+    EXPECT_EQ(result[2], 4u);
+    EXPECT_EQ(result[3], 5u);
+    EXPECT_EQ(result[4], 6u);
+}
+
+TEST(SceneUtilLightIndexTest, never_finds_invalid_bounds)
+{
+    SceneUtil::LightIndex index;
+    index.add(osg::BoundingSphere(osg::Vec3f(0, 0, 0), 100.f));
+    index.add(osg::BoundingSphere());
+    index.add(osg::BoundingSphere(osg::Vec3f(50, 0, 0), 0.f));
+    index.build();
+    EXPECT_EQ(index.size(), 3u);
+
+    std::vector<unsigned int> result;
+    index.query(osg::BoundingSphere(osg::Vec3f(0, 0, 0), 60.f), result);
+    ASSERT_EQ(result.size(), 2u);
+    EXPECT_EQ(result[0], 0u);
+    EXPECT_EQ(result[1], 2u);
+
+    result.clear();
+    index.query(osg::BoundingSphere(), result);
+    EXPECT_TRUE(result.empty());
+}
+
+TEST(SceneUtilLightIndexTest, is_empty_after_clear)
+{
+    SceneUtil::LightIndex index = makeIndex(makeLights(20));
+    index.clear();
+    index.build();
+    EXPECT_EQ(index.size(), 0u);
+
+    std::vector<unsigned int> result;
+    index.query(osg::BoundingSphere(osg::Vec3f(0, 0, 0), 100000.f), result);
+    EXPECT_TRUE(result.empty());
+}
+
+/// The light lookup done by every LightListCallback during the cull traversal
+TEST(SceneUtilLightIndexTest, DISABLED_light_lookup_benchmark)
+{
+    const std::size_t counts[] = { 8, 64, 512 };
+    const std::vector<osg::BoundingSphere> objects = makeObjects(5000);
+
+    for (std::size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        const std::vector<osg::BoundingSphere> lights = makeLights(counts[c]);
+
+        std::size_t bruteForceFound = 0;
+        std::vector<unsigned int> result;
+        Benchmark::Timer timer;
+        for (std::size_t i = 0; i < objects.size(); ++i)
+        {
+            result.clear();
+            bruteForceQuery(lights, objects[i], result);
+            bruteForceFound += result.size();
+        }
+        const double bruteForceTime = timer.getMilliseconds();
+
+        std::size_t indexFound = 0;
+        timer.restart();
+        const SceneUtil::LightIndex index = makeIndex(lights);
+        for (std::size_t i = 0; i < objects.size(); ++i)
+        {
+            result.clear();
+            index.query(objects[i], result);
+            indexFound += result.size();
+        }
+        const double indexTime = timer.getMilliseconds();
+
+        EXPECT_EQ(bruteForceFound, indexFound);
+
+        const std::string what = "Light lookup for " + std::to_string(objects.size()) + " objects and " + std::to_string(counts[c]) + " lights";
+        Benchmark::report(what + ", brute force", bruteForceTime);
+        Benchmark::report(what + ", index (including build)", indexTime);
+    }
+}
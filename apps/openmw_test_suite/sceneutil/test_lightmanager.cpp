@@ -0,0 +1,287 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <vector>
+
+#include <osg/Camera>
+#include <osg/Geode>
+#include <osg/Geometry>
+#include <osg/MatrixTransform>
+
+#include <osgUtil/CullVisitor>
+#include <osgUtil/RenderStage>
+#include <osgUtil/StateGraph>
+#include <osgUtil/UpdateVisitor>
+
+#include <components/sceneutil/lightmanager.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    float random(float min, float max)
+    {
+        return min + (max - min) * (std::rand() / static_cast<float>(RAND_MAX));
+    }
+
+    osg::ref_ptr<osg::Geode> createBox(float size)
+    {
+        osg::ref_ptr<osg::Vec3Array> vertices = new osg::Vec3Array;
+        vertices->push_back(osg::Vec3f(-size, -size, -size));
+        vertices->push_back(osg::Vec3f(size, -size, -size));
+        vertices->push_back(osg::Vec3f(size, size, size));
+        vertices->push_back(osg::Vec3f(-size, size, size));
+
+        osg::ref_ptr<osg::Geometry> geometry = new osg::Geometry;
+        geometry->setVertexArray(vertices);
+        geometry->addPrimitiveSet(new osg::DrawArrays(osg::PrimitiveSet::QUADS, 0, 4));
+
+        osg::ref_ptr<osg::Geode> geode = new osg::Geode;
+        geode->addDrawable(geometry);
+        return geode;
+    }
+
+    osg::ref_ptr<SceneUtil::LightSource> createLight(float radius)
+    {
+        osg::ref_ptr<SceneUtil::LightSource> lightSource = new SceneUtil::LightSource;
+        lightSource->setLight(new osg::Light);
+        lightSource->setRadius(radius);
+        return lightSource;
+    }
+
+    /// Runs the update and cull traversals over a scene like the exterior cells around the player, without a graphics context
+    struct LightManagerTest : public ::testing::Test
+    {
+        LightManagerTest()
+            : mLightManager(new SceneUtil::LightManager)
+            , mCamera(new osg::Camera)
+            , mCullVisitor(new osgUtil::CullVisitor)
+            , mStateGraph(new osgUtil::StateGraph)
+            , mRenderStage(new osgUtil::RenderStage)
+            , mFrameNumber(0)
+        {
+            mLightManager->setStartLight(1);
+
+            mCamera->setViewport(0, 0, 1920, 1080);
+            mCamera->setProjectionMatrixAsPerspective(55.f, 1920.f / 1080.f, 1.f, 24576.f);
+            mCamera->setViewMatrixAsLookAt(osg::Vec3f(0, -12288, 500), osg::Vec3f(0, 0, 500), osg::Vec3f(0, 0, 1));
+
+            mRenderStage->setCamera(mCamera);
+            mRenderStage->setViewport(mCamera->getViewport());
+        }
+
+        void addLights(std::size_t count)
+        {
+            addLights(count, 100, 600);
+        }
+
+        void addLights(std::size_t count, float minRadius, float maxRadius)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                osg::ref_ptr<osg::MatrixTransform> transform = new osg::MatrixTransform(
+                            osg::Matrix::translate(random(-12288, 12288), random(-12288, 12288), random(0, 1000)));
+                transform->addChild(createLight(random(minRadius, maxRadius)));
+                mLightManager->addChild(transform);
+            }
+        }
+
+        void addObjects(std::size_t count)
+        {
+            for (std::size_t i = 0; i < count; ++i)
+            {
+                osg::ref_ptr<osg::MatrixTransform> transform = new osg::MatrixTransform(
+                            osg::Matrix::translate(random(-12288, 12288), random(-12288, 12288), random(0, 1000)));
+                transform->addChild(createBox(random(10, 200)));
+                transform->addCullCallback(new SceneUtil::LightListCallback);
+                mLightManager->addChild(transform);
+            }
+        }
+
+        void frame()
+        {
+            ++mFrameNumber;
+
+            osgUtil::UpdateVisitor updateVisitor;
+            updateVisitor.setTraversalNumber(mFrameNumber);
+            mLightManager->accept(updateVisitor);
+
+            mCullVisitor->reset();
+            mStateGraph->clean();
+            mRenderStage->reset();
+            mRenderStage->setInitialViewMatrix(new osg::RefMatrix(mCamera->getViewMatrix()));
+
+            mCullVisitor->setTraversalNumber(mFrameNumber);
+            mCullVisitor->setStateGraph(mStateGraph);
+            mCullVisitor->setRenderStage(mRenderStage);
+            mCullVisitor->pushViewport(mCamera->getViewport());
+            mCullVisitor->pushProjectionMatrix(new osg::RefMatrix(mCamera->getProjectionMatrix()));
+            mCullVisitor->pushModelViewMatrix(new osg::RefMatrix(mCamera->getViewMatrix()), osg::Transform::ABSOLUTE_RF);
+
+            mLightManager->accept(*mCullVisitor);
+
+            mCullVisitor->popModelViewMatrix();
+            mCullVisitor->popProjectionMatrix();
+            mCullVisitor->popViewport();
+        }
+
+        /// The lights that the LightListCallback of the object drawing @a drawable is expected to find
+        SceneUtil::LightManager::LightList getExpectedLights(const osg::Drawable& drawable)
+        {
+            const osg::MatrixTransform* transform = drawable.getParent(0)->getParent(0)->asTransform()->asMatrixTransform();
+            osg::BoundingSphere bound = transform->getChild(0)->getBound();
+            bound.center() = bound.center() * transform->getMatrix() * mCamera->getViewMatrix();
+
+            osg::ref_ptr<osg::RefMatrix> viewMatrix = new osg::RefMatrix(mCamera->getViewMatrix());
+            const std::vector<SceneUtil::LightManager::LightSourceViewBound>& lights = mLightManager->getLightsInViewSpace(mCamera, viewMatrix);
+            SceneUtil::LightManager::LightList expected;
+            for (std::size_t i = 0; i < lights.size(); ++i)
+            {
+                if (lights[i].mViewBound.intersects(bound))
+                    expected.push_back(&lights[i]);
+            }
+            return expected;
+        }
+
+        /// Check that each drawable that was culled is drawn with the state of its expected lights, or without any state
+        /// if no light reaches it.
+        void checkLightStates(const osgUtil::StateGraph& stateGraph, std::size_t& lit, std::size_t& unlit)
+        {
+            for (std::vector<osg::ref_ptr<osgUtil::RenderLeaf> >::const_iterator it = stateGraph._leaves.begin(); it != stateGraph._leaves.end(); ++it)
+            {
+                std::vector<const osg::StateSet*> states;
+                for (const osgUtil::StateGraph* parent = &stateGraph; parent; parent = parent->_parent)
+                {
+                    if (parent->getStateSet())
+                        states.push_back(parent->getStateSet());
+                }
+
+                const SceneUtil::LightManager::LightList expected = getExpectedLights(*(*it)->getDrawable());
+                if (expected.empty())
+                {
+                    EXPECT_TRUE(states.empty());
+                    ++unlit;
+                }
+                else
+                {
+                    ASSERT_EQ(states.size(), 1u);
+                    EXPECT_EQ(states[0], mLightManager->getLightListStateSet(expected, mFrameNumber).get());
+                    ++lit;
+                }
+            }
+
+            for (osgUtil::StateGraph::ChildList::const_iterator it = stateGraph._children.begin(); it != stateGraph._children.end(); ++it)
+                checkLightStates(*it->second, lit, unlit);
+        }
+
+        virtual void SetUp()
+        {
+            std::srand(42);
+        }
+
+        osg::ref_ptr<SceneUtil::LightManager> mLightManager;
+        osg::ref_ptr<osg::Camera> mCamera;
+        osg::ref_ptr<osgUtil::CullVisitor> mCullVisitor;
+        osg::ref_ptr<osgUtil::StateGraph> mStateGraph;
+        osg::ref_ptr<osgUtil::RenderStage> mRenderStage;
+        unsigned int mFrameNumber;
+    };
+
+}
+
+TEST_F(LightManagerTest, finds_the_lights_intersecting_a_bound)
+{
+    addLights(300);
+    frame();
+
+    osg::ref_ptr<osg::RefMatrix> viewMatrix = new osg::RefMatrix(mCamera->getViewMatrix());
+    const std::vector<SceneUtil::LightManager::LightSourceViewBound>& lights = mLightManager->getLightsInViewSpace(mCamera, viewMatrix);
+    ASSERT_EQ(lights.size(), 300u);
+
+    std::size_t found = 0;
+    for (int i = 0; i < 100; ++i)
+    {
+        const osg::BoundingSphere bound(osg::Vec3f(random(-12288, 12288), random(-1000, 1000), random(-24576, 0)), random(10, 500));
+
+        SceneUtil::LightManager::LightList expected;
+        for (std::size_t j = 0; j < lights.size(); ++j)
+        {
+            if (lights[j].mViewBound.intersects(bound))
+                expected.push_back(&lights[j]);
+        }
+
+        SceneUtil::LightManager::LightList lightList;
+        std::vector<unsigned int> foundLights;
+        mLightManager->getLightsInViewSpace(mCamera, viewMatrix, bound, lightList, foundLights);
+        ASSERT_EQ(lightList, expected) << i;
+        found += lightList.size();
+    }
+    EXPECT_GT(found, 0u);
+}
+
+TEST_F(LightManagerTest, shares_light_state_between_equal_light_lists)
+{
+    addLights(3);
+    frame();
+
+    osg::ref_ptr<osg::RefMatrix> viewMatrix = new osg::RefMatrix(mCamera->getViewMatrix());
+    const std::vector<SceneUtil::LightManager::LightSourceViewBound>& lights = mLightManager->getLightsInViewSpace(mCamera, viewMatrix);
+    ASSERT_EQ(lights.size(), 3u);
+
+    SceneUtil::LightManager::LightList first;
+    first.push_back(&lights[0]);
+    first.push_back(&lights[1]);
+    SceneUtil::LightManager::LightList second(first);
+    SceneUtil::LightManager::LightList reversed;
+    reversed.push_back(&lights[1]);
+    reversed.push_back(&lights[0]);
+
+    EXPECT_EQ(mLightManager->getLightListStateSet(first, mFrameNumber).get(), mLightManager->getLightListStateSet(second, mFrameNumber).get());
+    EXPECT_NE(mLightManager->getLightListStateSet(first, mFrameNumber).get(), mLightManager->getLightListStateSet(reversed, mFrameNumber).get());
+
+    second.pop_back();
+    EXPECT_NE(mLightManager->getLightListStateSet(first, mFrameNumber).get(), mLightManager->getLightListStateSet(second, mFrameNumber).get());
+}
+
+TEST_F(LightManagerTest, culls_objects_with_light_lists)
+{
+    addObjects(500);
+    // fewer lights than an object can receive, so that none are dropped
+    addLights(6, 2000, 4000);
+    frame();
+
+    std::size_t lit = 0;
+    std::size_t unlit = 0;
+    checkLightStates(*mStateGraph, lit, unlit);
+    EXPECT_GT(lit, 0u);
+    EXPECT_GT(unlit, 0u);
+}
+
+/// The cull traversal of the objects in view, each with its own light list
+TEST_F(LightManagerTest, DISABLED_cull_benchmark)
+{
+    const std::size_t counts[] = { 8, 64, 512 };
+    const int numFrames = 20;
+
+    addObjects(2000);
+    std::size_t numLights = 0;
+    for (std::size_t c = 0; c < sizeof(counts) / sizeof(counts[0]); ++c)
+    {
+        addLights(counts[c] - numLights);
+        numLights = counts[c];
+
+        // warm up the light state caches
+        frame();
+
+        const Benchmark::Timer timer;
+        for (int i = 0; i < numFrames; ++i)
+            frame();
+        const double time = timer.getMilliseconds() / numFrames;
+
+        // objects that receive light are sorted by their light state
+        EXPECT_FALSE(mStateGraph->_children.empty());
+
+        Benchmark::report("Update and cull of 2000 objects with " + std::to_string(numLights) + " lights, per frame", time);
+    }
+}
@@ -0,0 +1,98 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include <components/sceneutil/profiler.hpp>
+
+namespace
+{
+
+    std::size_t count(const std::string& string, const std::string& part)
+    {
+        std::size_t result = 0;
+        for (std::size_t pos = string.find(part); pos != std::string::npos; pos = string.find(part, pos + 1))
+            ++result;
+        return result;
+    }
+
+    std::string writeTrace()
+    {
+        std::ostringstream stream;
+        SceneUtil::Profiler::instance().writeTrace(stream);
+        return stream.str();
+    }
+
+}
+
+TEST(SceneUtilProfilerTest, records_zones_only_while_capturing)
+{
+    SceneUtil::Profiler& profiler = SceneUtil::Profiler::instance();
+    {
+        SceneUtil::ProfileZone zone("before");
+    }
+
+    profiler.startCapture();
+    {
+        SceneUtil::ProfileZone outer("outer");
+        SceneUtil::ProfileZone inner(std::string("inner \"quoted\""));
+    }
+    std::thread thread([&profiler] ()
+    {
+        profiler.setThreadName("worker");
+        SceneUtil::ProfileZone zone("on worker");
+    });
+    thread.join();
+    const std::string trace = writeTrace();
+    profiler.stopCapture();
+
+    {
+        SceneUtil::ProfileZone zone("after");
+    }
+
+    EXPECT_EQ(count(trace, "\"name\":\"outer\""), 1u);
+    EXPECT_EQ(count(trace, "\"name\":\"inner \\\"quoted\\\"\""), 1u);
+    EXPECT_EQ(count(trace, "\"name\":\"on worker\""), 1u);
+    EXPECT_EQ(count(trace, "\"args\":{\"name\":\"worker\"}"), 1u);
+    EXPECT_EQ(count(trace, "\"before\""), 0u);
+    EXPECT_EQ(count(writeTrace(), "\"after\""), 0u);
+    EXPECT_EQ(trace.find("{\"displayTimeUnit\""), 0u);
+}
+
+TEST(SceneUtilProfilerTest, starting_a_capture_discards_previous_events)
+{
+    SceneUtil::Profiler& profiler = SceneUtil::Profiler::instance();
+    profiler.startCapture();
+    {
+        SceneUtil::ProfileZone zone("first capture");
+    }
+    profiler.startCapture();
+    {
+        SceneUtil::ProfileZone zone("second capture");
+    }
+    const std::string trace = writeTrace();
+    profiler.stopCapture();
+
+    EXPECT_EQ(count(trace, "first capture"), 0u);
+    EXPECT_EQ(count(trace, "second capture"), 1u);
+}
+
+TEST(SceneUtilProfilerTest, keeps_the_latest_events_when_the_buffer_is_full)
+{
+    SceneUtil::Profiler& profiler = SceneUtil::Profiler::instance();
+    profiler.startCapture();
+    for (std::size_t i = 0; i < SceneUtil::Profiler::sBufferSize; ++i)
+    {
+        SceneUtil::ProfileZone zone("old");
+    }
+    for (std::size_t i = 0; i < 10; ++i)
+    {
+        SceneUtil::ProfileZone zone("new");
+    }
+    const std::string trace = writeTrace();
+    profiler.stopCapture();
+
+    EXPECT_EQ(count(trace, "\"new\""), 10u);
+    EXPECT_EQ(count(trace, "\"old\""), SceneUtil::Profiler::sBufferSize - 10);
+}
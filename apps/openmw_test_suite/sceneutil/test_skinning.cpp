@@ -0,0 +1,142 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <cstdlib>
+#include <string>
+
+#include <components/sceneutil/skinning.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    float random(float min, float max)
+    {
+        return min + (max - min) * (std::rand() / static_cast<float>(RAND_MAX));
+    }
+
+    /// Vertex count and influence groups in the range of an NPC body part
+    struct SkinningTest : public ::testing::Test
+    {
+        SkinningTest()
+            : mNumVertices(1500)
+        {
+        }
+
+        virtual void SetUp()
+        {
+            std::srand(42);
+
+            // Groups of 1 to 30 vertices, with the vertices scattered over the destination arrays like in a real mesh
+            std::vector<unsigned short> order;
+            for (int i = 0; i < mNumVertices; ++i)
+                order.push_back(static_cast<unsigned short>(i));
+            for (int i = mNumVertices - 1; i > 0; --i)
+                std::swap(order[i], order[std::rand() % (i + 1)]);
+
+            std::size_t next = 0;
+            while (next < order.size())
+            {
+                mStreams.beginGroup();
+                std::size_t size = std::min(order.size() - next, static_cast<std::size_t>(1 + std::rand() % 30));
+                for (std::size_t i = 0; i < size; ++i, ++next)
+                {
+                    float position[3] = { random(-50, 50), random(-50, 50), random(0, 120) };
+                    float normal[3] = { random(-1, 1), random(-1, 1), random(-1, 1) };
+                    float tangent[3] = { random(-1, 1), random(-1, 1), random(-1, 1) };
+                    mStreams.addVertex(order[next], position, normal, tangent);
+                }
+
+                // Affine matrices, row vector convention
+                for (int row = 0; row < 4; ++row)
+                    for (int column = 0; column < 4; ++column)
+                        mMatrices.push_back(column == 3 ? (row == 3 ? 1.f : 0.f) : random(-2, 2));
+            }
+        }
+
+        int mNumVertices;
+        SceneUtil::SkinningStreams mStreams;
+        std::vector<float> mMatrices;
+    };
+
+}
+
+TEST_F(SkinningTest, vectorized_matches_scalar)
+{
+    std::vector<float> positions(mNumVertices * 3), normals(mNumVertices * 3), tangents(mNumVertices * 4, 0.5f);
+    std::vector<float> expectedPositions(positions), expectedNormals(normals), expectedTangents(tangents);
+
+    SceneUtil::skin(mStreams, &mMatrices[0], &positions[0], &normals[0], &tangents[0]);
+    SceneUtil::skinScalar(mStreams, &mMatrices[0], &expectedPositions[0], &expectedNormals[0], &expectedTangents[0]);
+
+    for (std::size_t i = 0; i < positions.size(); ++i)
+        ASSERT_NEAR(positions[i], expectedPositions[i], 1e-3f) << i;
+    for (std::size_t i = 0; i < normals.size(); ++i)
+        ASSERT_NEAR(normals[i], expectedNormals[i], 1e-5f) << i;
+    for (std::size_t i = 0; i < tangents.size(); ++i)
+        ASSERT_NEAR(tangents[i], expectedTangents[i], 1e-5f) << i;
+}
+
+TEST_F(SkinningTest, transforms_points_and_directions)
+{
+    SceneUtil::SkinningStreams streams;
+    streams.beginGroup();
+    for (unsigned short i = 0; i < 5; ++i)
+    {
+        float position[3] = { 1.f + i, 2.f, 3.f };
+        float normal[3] = { 0.f, 0.f, 1.f };
+        // the destination index is reversed to check the scatter
+        streams.addVertex(static_cast<unsigned short>(4 - i), position, normal, NULL);
+    }
+
+    // Rotate 90 degrees around z (x -> y, y -> -x), then translate by (10, 20, 30)
+    const float matrix[16] = {
+        0, 1, 0, 0,
+        -1, 0, 0, 0,
+        0, 0, 1, 0,
+        10, 20, 30, 1
+    };
+
+    std::vector<float> positions(15), normals(15);
+    std::vector<float> tangents(20, -1.f);
+    SceneUtil::skin(streams, matrix, &positions[0], &normals[0], &tangents[0]);
+
+    for (int i = 0; i < 5; ++i)
+    {
+        const int vertex = 4 - i;
+        EXPECT_FLOAT_EQ(positions[vertex * 3], 10.f - 2.f);
+        EXPECT_FLOAT_EQ(positions[vertex * 3 + 1], 20.f + 1.f + i);
+        EXPECT_FLOAT_EQ(positions[vertex * 3 + 2], 30.f + 3.f);
+        EXPECT_FLOAT_EQ(normals[vertex * 3], 0.f);
+        EXPECT_FLOAT_EQ(normals[vertex * 3 + 1], 0.f);
+        EXPECT_FLOAT_EQ(normals[vertex * 3 + 2], 1.f);
+    }
+
+    // The mesh has no tangents, so they must not be touched
+    for (std::size_t i = 0; i < tangents.size(); ++i)
+        EXPECT_EQ(tangents[i], -1.f);
+}
+
+TEST_F(SkinningTest, keeps_tangent_w)
+{
+    std::vector<float> positions(mNumVertices * 3), normals(mNumVertices * 3), tangents(mNumVertices * 4, 0.25f);
+    SceneUtil::skin(mStreams, &mMatrices[0], &positions[0], &normals[0], &tangents[0]);
+    for (int i = 0; i < mNumVertices; ++i)
+        EXPECT_EQ(tangents[i * 4 + 3], 0.25f);
+}
+
+/// Skin a mesh the size of an NPC body part many times
+TEST_F(SkinningTest, DISABLED_skinning_benchmark)
+{
+    const int runs = 2000;
+
+    std::vector<float> positions(mNumVertices * 3), normals(mNumVertices * 3), tangents(mNumVertices * 4);
+
+    Benchmark::Timer timer;
+    for (int i = 0; i < runs; ++i)
+        SceneUtil::skin(mStreams, &mMatrices[0], &positions[0], &normals[0], &tangents[0]);
+
+    Benchmark::report("Skinning " + std::to_string(runs) + " times " + std::to_string(mNumVertices) + " vertices in "
+                      + std::to_string(mStreams.getNumGroups()) + " groups", timer.getMilliseconds());
+}
@@ -0,0 +1,279 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <OpenThreads/ScopedLock>
+
+#include <components/sceneutil/profiler.hpp>
+#include <components/sceneutil/workqueue.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    /// Counts how often it was run, and optionally records its id in a shared list
+    class CountingWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        CountingWorkItem(int id, std::vector<int>* order = NULL, OpenThreads::Mutex* orderMutex = NULL)
+            : mId(id), mOrder(order), mOrderMutex(orderMutex)
+        {
+        }
+
+        virtual void doWork()
+        {
+            ++mRuns;
+            if (mOrder)
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(*mOrderMutex);
+                mOrder->push_back(mId);
+            }
+        }
+
+        int mId;
+        OpenThreads::Atomic mRuns;
+        std::vector<int>* mOrder;
+        OpenThreads::Mutex* mOrderMutex;
+    };
+
+    /// Keeps its thread busy until released, so that other items pile up in the queue
+    class GateWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        virtual void doWork()
+        {
+            ++mStarted;
+            while (mOpen == 0)
+                std::this_thread::yield();
+        }
+
+        void waitTillStarted()
+        {
+            while (mStarted == 0)
+                std::this_thread::yield();
+        }
+
+        void open() { mOpen.exchange(1); }
+
+        OpenThreads::Atomic mStarted;
+        OpenThreads::Atomic mOpen;
+    };
+
+    class NamedWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        virtual const char* getName() const { return "Named work item"; }
+    };
+
+    void waitTillDone(const std::vector<osg::ref_ptr<CountingWorkItem> >& items)
+    {
+        for (std::vector<osg::ref_ptr<CountingWorkItem> >::const_iterator it = items.begin(); it != items.end(); ++it)
+            (*it)->waitTillDone();
+    }
+
+    /// Add many small items from several threads at once, and check that each of them is processed exactly once
+    void addFromSeveralThreads(SceneUtil::WorkQueue& queue, int producers, int itemsPerProducer)
+    {
+        std::vector<std::vector<osg::ref_ptr<CountingWorkItem> > > items(producers);
+
+        std::vector<std::thread> threads;
+        for (int producer = 0; producer < producers; ++producer)
+        {
+            threads.push_back(std::thread([&, producer] ()
+            {
+                for (int i = 0; i < itemsPerProducer; ++i)
+                {
+                    osg::ref_ptr<CountingWorkItem> item = new CountingWorkItem(i);
+                    item->setPriority(static_cast<float>(i % 7));
+                    items[producer].push_back(item);
+                    queue.addWorkItem(item, i % 100 == 0);
+                    if (i % 10 == 3)
+                        item->cancel();
+                }
+            }));
+        }
+        for (std::size_t i = 0; i < threads.size(); ++i)
+            threads[i].join();
+        for (int producer = 0; producer < producers; ++producer)
+            waitTillDone(items[producer]);
+
+        unsigned int runs = 0;
+        for (int producer = 0; producer < producers; ++producer)
+        {
+            for (std::size_t i = 0; i < items[producer].size(); ++i)
+            {
+                ASSERT_TRUE(items[producer][i]->isDone());
+                ASSERT_LE(static_cast<int>(items[producer][i]->mRuns), 1);
+                if (i % 10 != 3)
+                {
+                    ASSERT_EQ(static_cast<int>(items[producer][i]->mRuns), 1);
+                }
+                runs += items[producer][i]->mRuns;
+            }
+        }
+
+        SceneUtil::WorkQueue::Stats stats = queue.getStats();
+        EXPECT_EQ(stats.mNumCompleted, runs);
+        EXPECT_EQ(stats.mNumCompleted + stats.mNumCancelled, static_cast<unsigned int>(producers * itemsPerProducer));
+        EXPECT_EQ(queue.getNumItems(), 0u);
+    }
+
+}
+
+TEST(SceneUtilWorkQueueTest, processes_items_in_order_of_priority)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(1);
+    osg::ref_ptr<GateWorkItem> gate = new GateWorkItem;
+    queue->addWorkItem(gate);
+    gate->waitTillStarted();
+
+    std::vector<int> order;
+    OpenThreads::Mutex orderMutex;
+    std::vector<osg::ref_ptr<CountingWorkItem> > items;
+    const float priorities[] = { 1.f, 5.f, -2.f, 3.f, 5.f };
+    for (int i = 0; i < 5; ++i)
+    {
+        items.push_back(new CountingWorkItem(i, &order, &orderMutex));
+        items.back()->setPriority(priorities[i]);
+        queue->addWorkItem(items.back());
+    }
+    items.push_back(new CountingWorkItem(5, &order, &orderMutex));
+    queue->addWorkItem(items.back(), true);
+
+    gate->open();
+    waitTillDone(items);
+
+    const int expected[] = { 5, 1, 4, 3, 0, 2 };
+    EXPECT_EQ(order, std::vector<int>(expected, expected + 6));
+}
+
+TEST(SceneUtilWorkQueueTest, processes_front_items_last_in_first_out)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(1);
+    osg::ref_ptr<GateWorkItem> gate = new GateWorkItem;
+    queue->addWorkItem(gate);
+    gate->waitTillStarted();
+
+    std::vector<int> order;
+    OpenThreads::Mutex orderMutex;
+    std::vector<osg::ref_ptr<CountingWorkItem> > items;
+    for (int i = 0; i < 4; ++i)
+    {
+        items.push_back(new CountingWorkItem(i, &order, &orderMutex));
+        items.back()->setPriority(static_cast<float>(i));
+        queue->addWorkItem(items.back(), i % 2 == 0);
+    }
+
+    gate->open();
+    waitTillDone(items);
+
+    const int expected[] = { 2, 0, 3, 1 };
+    EXPECT_EQ(order, std::vector<int>(expected, expected + 4));
+}
+
+TEST(SceneUtilWorkQueueTest, idle_thread_steals_items_of_a_busy_thread)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(2);
+    osg::ref_ptr<GateWorkItem> gate = new GateWorkItem;
+    queue->addWorkItem(gate);
+    gate->waitTillStarted();
+
+    // half of these go to the queue of the thread that is stuck on the gate
+    std::vector<osg::ref_ptr<CountingWorkItem> > items;
+    for (int i = 0; i < 10; ++i)
+    {
+        items.push_back(new CountingWorkItem(i));
+        queue->addWorkItem(items.back());
+    }
+    waitTillDone(items);
+
+    EXPECT_FALSE(gate->isDone());
+    EXPECT_GE(queue->getStats().mNumStolen, 5u);
+
+    gate->open();
+    gate->waitTillDone();
+}
+
+TEST(SceneUtilWorkQueueTest, drops_cancelled_items)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(1);
+    osg::ref_ptr<GateWorkItem> gate = new GateWorkItem;
+    queue->addWorkItem(gate);
+    gate->waitTillStarted();
+
+    std::vector<osg::ref_ptr<CountingWorkItem> > items;
+    for (int i = 0; i < 10; ++i)
+    {
+        items.push_back(new CountingWorkItem(i));
+        queue->addWorkItem(items.back());
+    }
+    for (int i = 0; i < 10; i += 2)
+        items[i]->cancel();
+
+    gate->open();
+    waitTillDone(items);
+
+    for (int i = 0; i < 10; ++i)
+    {
+        EXPECT_TRUE(items[i]->isDone());
+        EXPECT_EQ(static_cast<int>(items[i]->mRuns), i % 2) << "item " << i;
+    }
+
+    SceneUtil::WorkQueue::Stats stats = queue->getStats();
+    EXPECT_EQ(stats.mNumCancelled, 5u);
+    EXPECT_EQ(stats.mNumCompleted, 6u); // including the gate
+    EXPECT_EQ(queue->getNumItems(), 0u);
+}
+
+TEST(SceneUtilWorkQueueTest, uses_hardware_concurrency_by_default)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(0);
+    EXPECT_EQ(static_cast<int>(queue->getNumThreads()), SceneUtil::WorkQueue::getDefaultNumThreads());
+    EXPECT_GE(queue->getNumThreads(), 1u);
+}
+
+TEST(SceneUtilWorkQueueTest, processes_items_added_from_several_threads_exactly_once)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(4);
+    addFromSeveralThreads(*queue, 4, 2000);
+}
+
+#ifdef OPENMW_ENABLE_PROFILER
+TEST(SceneUtilWorkQueueTest, names_work_items_in_profiler_traces)
+{
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(1);
+    SceneUtil::Profiler& profiler = SceneUtil::Profiler::instance();
+
+    profiler.startCapture();
+    osg::ref_ptr<NamedWorkItem> item = new NamedWorkItem;
+    queue->addWorkItem(item);
+    item->waitTillDone();
+    profiler.stopCapture();
+
+    std::ostringstream trace;
+    profiler.writeTrace(trace);
+    EXPECT_NE(trace.str().find("\"Named work item\""), std::string::npos);
+}
+#endif
+
+TEST(SceneUtilWorkQueueTest, DISABLED_stress_benchmark)
+{
+    const int producers = 4;
+    const int itemsPerProducer = 20000;
+
+    osg::ref_ptr<SceneUtil::WorkQueue> queue = new SceneUtil::WorkQueue(4);
+    Benchmark::Timer timer;
+    addFromSeveralThreads(*queue, producers, itemsPerProducer);
+    const double time = timer.getMilliseconds();
+
+    SceneUtil::WorkQueue::Stats stats = queue->getStats();
+    Benchmark::report("WorkQueue: " + std::to_string(producers * itemsPerProducer) + " items from "
+                      + std::to_string(producers) + " threads on " + std::to_string(queue->getNumThreads()) + " threads, "
+                      + std::to_string(stats.mNumCancelled) + " cancelled, " + std::to_string(stats.mNumStolen) + " stolen",
+                      time);
+    Benchmark::report("WorkQueue: average wait", stats.mWaitTime / (producers * itemsPerProducer) * 1000);
+}
@@ -0,0 +1,163 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <sstream>
+
+#include <components/vfs/archive.hpp>
+#include <components/vfs/manager.hpp>
+
+#include <components/misc/stringops.hpp>
+
+#include "../benchmark.hpp"
+
+namespace
+{
+
+    class TestFile : public VFS::File
+    {
+    public:
+        virtual Files::IStreamPtr open()
+        {
+            return Files::IStreamPtr();
+        }
+
+        virtual std::string getStamp() const
+        {
+            return std::string();
+        }
+    };
+
+    class TestArchive : public VFS::Archive
+    {
+    public:
+        TestArchive(const std::vector<std::string>& names)
+            : mNames(names)
+            , mFiles(names.size())
+        {
+        }
+
+        virtual void listResources(std::map<std::string, VFS::File*>& out, char (*normalize_function) (char))
+        {
+            for (std::size_t i = 0; i < mNames.size(); ++i)
+            {
+                std::string name = mNames[i];
+                std::transform(name.begin(), name.end(), name.begin(), normalize_function);
+                out[name] = &mFiles[i];
+            }
+        }
+
+    private:
+        std::vector<std::string> mNames;
+        std::vector<TestFile> mFiles;
+    };
+
+    /// Mixed case names with backslashes, spread over the usual data directories
+    std::vector<std::string> makeFileList()
+    {
+        static const char* directories[] = { "Meshes\\", "Meshes\\x\\", "Meshes\\r\\", "Meshes\\i\\", "Meshes\\f\\",
+                                             "Textures\\", "Textures\\Tx_", "Icons\\m\\", "Icons\\a\\",
+                                             "Sound\\Fx\\", "Sound\\Vo\\d\\m\\", "BookArt\\", "Music\\Explore\\" };
+        static const char* extensions[] = { ".nif", ".nif", ".nif", ".nif", ".nif", ".dds", ".dds", ".dds", ".tga",
+                                            ".wav", ".mp3", ".tga", ".mp3" };
+        const std::size_t count = sizeof(directories) / sizeof(directories[0]);
+
+        std::vector<std::string> names;
+        for (int i = 0; i < 9000; ++i)
+        {
+            std::ostringstream stream;
+            stream << directories[i % count] << "Object_" << i << "_Name" << extensions[i % count];
+            names.push_back(stream.str());
+        }
+        return names;
+    }
+
+    struct VFSFileIndexTest : public ::testing::Test
+    {
+        VFSFileIndexTest()
+            : mNames(makeFileList())
+            , mManager(false)
+        {
+        }
+
+        virtual void SetUp()
+        {
+            mManager.addArchive(new TestArchive(mNames));
+            mManager.buildIndex();
+        }
+
+        std::vector<std::string> mNames;
+        VFS::Manager mManager;
+    };
+
+}
+
+TEST_F(VFSFileIndexTest, finds_every_file_regardless_of_case_and_separator)
+{
+    ASSERT_EQ(mManager.getIndex().size(), mNames.size());
+
+    for (std::size_t i = 0; i < mNames.size(); ++i)
+    {
+        std::string name = mNames[i];
+        EXPECT_TRUE(mManager.exists(name));
+
+        Misc::StringUtils::lowerCaseInPlace(name);
+        std::replace(name.begin(), name.end(), '\\', '/');
+        EXPECT_TRUE(mManager.exists(name.data(), name.size()));
+        EXPECT_TRUE(mManager.find(name.data(), name.size(), mManager.getHash(name.data(), name.size())) != nullptr);
+    }
+
+    EXPECT_FALSE(mManager.exists("meshes\\doesnotexist.nif"));
+    EXPECT_FALSE(mManager.exists(""));
+    EXPECT_FALSE(mManager.exists("meshes"));
+}
+
+TEST_F(VFSFileIndexTest, index_is_sorted)
+{
+    const VFS::FileIndex& index = mManager.getIndex();
+    for (VFS::FileIndex::const_iterator it = index.begin(); it + 1 < index.end(); ++it)
+        EXPECT_LT(it->getName(), (it + 1)->getName());
+}
+
+TEST_F(VFSFileIndexTest, prefix_search_matches_map_lower_bound)
+{
+    std::map<std::string, VFS::File*> reference;
+    for (VFS::FileIndex::const_iterator it = mManager.getIndex().begin(); it != mManager.getIndex().end(); ++it)
+        reference[it->getName()] = it->mFile;
+
+    const char* prefixes[] = { "Music\\Explore\\", "Meshes/X/", "sound\\", "Icons", "nothing/", "" };
+    for (std::size_t i = 0; i < sizeof(prefixes) / sizeof(prefixes[0]); ++i)
+    {
+        std::string pattern = prefixes[i];
+        mManager.normalizeFilename(pattern);
+
+        std::vector<std::string> expected;
+        for (std::map<std::string, VFS::File*>::const_iterator it = reference.lower_bound(pattern);
+             it != reference.end() && it->first.compare(0, pattern.size(), pattern) == 0; ++it)
+            expected.push_back(it->first);
+
+        std::vector<std::string> found;
+        for (const VFS::FileIndex::Entry& entry : mManager.getFilesWithPrefix(prefixes[i]))
+            found.push_back(entry.getName());
+
+        EXPECT_EQ(expected, found) << "prefix " << prefixes[i];
+    }
+}
+
+/// Look up every file by the name the game passes in, i.e. with mixed case and backslashes
+TEST_F(VFSFileIndexTest, DISABLED_lookup_benchmark)
+{
+    const int iterations = 20;
+
+    std::size_t found = 0;
+    Benchmark::Timer timer;
+    for (int n = 0; n < iterations; ++n)
+    {
+        for (std::size_t i = 0; i < mNames.size(); ++i)
+            found += mManager.exists(mNames[i]);
+    }
+    const double time = timer.getMilliseconds();
+
+    EXPECT_EQ(found, mNames.size() * iterations);
+
+    Benchmark::report("VFS lookup of " + std::to_string(mNames.size() * iterations) + " names", time);
+}
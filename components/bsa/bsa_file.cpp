@@ -24,6 +24,7 @@
 #include "bsa_file.hpp"
 
 #include <cassert>
+#include <cstring>
 
 #include <boost/filesystem/path.hpp>
 #include <boost/filesystem/fstream.hpp>
@@ -31,9 +32,27 @@
 using namespace std;
 using namespace Bsa;
 
+namespace
+{
+    bool namesEqual(const char *name, const char *query, size_t length)
+    {
+        for (size_t i = 0; i < length; ++i)
+        {
+            if (Misc::StringUtils::toLower(name[i]) != Misc::StringUtils::toLower(query[i]))
+                return false;
+        }
+        return name[length] == '\0';
+    }
+
+    /// The archive hash mixes poorly in its low bits, so scramble it before picking a table slot
+    size_t getSlot(uint64_t hash, size_t mask)
+    {
+        return static_cast<size_t>((hash * 0x9E3779B97F4A7C15ull) >> 32) & mask;
+    }
+}
 
 /// Error handling
-void BSAFile::fail(const string &msg)
+void BSAFile::fail(const string &msg) const
 {
     throw std::runtime_error("BSA Error: " + msg + "\nArchive: " + filename);
 }
@@ -62,7 +81,8 @@ void BSAFile::readHeader()
      *
      * ---------- end of directory block -------------
      *
-     * - 8*filenum - hash table block, we currently ignore this
+     * - 8*filenum - hash table block, we currently ignore this and
+     *   compute the same hashes from the file names (see getHash())
      *
      * ----------- start of data buffer --------------
      *
@@ -128,8 +148,16 @@ void BSAFile::readHeader()
     // (skipped)
     size_t fileDataOffset = 12 + dirsize + 8*filenum;
 
+    // Size the lookup table for a load factor of at most 0.5
+    size_t tableSize = 16;
+    while (tableSize < filenum*2)
+        tableSize *= 2;
+    lookup.assign(tableSize, 0);
+    const size_t mask = tableSize - 1;
+
     // Set up the the FileStruct table
     files.resize(filenum);
+    hashes.resize(filenum);
     for(size_t i=0;i<filenum;i++)
     {
         FileStruct &fs = files[i];
@@ -140,30 +168,85 @@ void BSAFile::readHeader()
         if(fs.offset + fs.fileSize > fsize)
             fail("Archive contains offsets outside itself");
 
-        // Add the file name to the lookup
-        lookup[fs.name] = i;
+        if(offsets[2*filenum+i] >= stringBuf.size() ||
+           memchr(fs.name, '\0', stringBuf.size() - offsets[2*filenum+i]) == nullptr)
+            fail("Archive contains file names outside of the name table");
+
+        // Add the file name to the lookup. If there are duplicate names,
+        // the last one wins, as it did with the old std::map lookup.
+        const size_t nameLength = strlen(fs.name);
+        hashes[i] = getHash(fs.name, nameLength);
+
+        size_t slot = getSlot(hashes[i], mask);
+        for (; lookup[slot] != 0; slot = (slot + 1) & mask)
+        {
+            const size_t other = lookup[slot] - 1;
+            if (hashes[other] == hashes[i] && namesEqual(files[other].name, fs.name, nameLength))
+                break;
+        }
+        lookup[slot] = static_cast<uint32_t>(i + 1);
     }
 
     isLoaded = true;
 }
 
+uint64_t BSAFile::getHash(const char *name, size_t length)
+{
+    const size_t half = length / 2;
+
+    uint32_t low = 0;
+    unsigned int shift = 0;
+    size_t i = 0;
+    for (; i < half; ++i)
+    {
+        low ^= static_cast<uint32_t>(static_cast<unsigned char>(Misc::StringUtils::toLower(name[i]))) << (shift & 0x1F);
+        shift += 8;
+    }
+
+    uint32_t high = 0;
+    shift = 0;
+    for (; i < length; ++i)
+    {
+        const uint32_t temp = static_cast<uint32_t>(static_cast<unsigned char>(Misc::StringUtils::toLower(name[i]))) << (shift & 0x1F);
+        high ^= temp;
+        // Rotate right by the low five bits of what was just mixed in
+        const unsigned int rotate = temp & 0x1F;
+        if (rotate != 0)
+            high = (high >> rotate) | (high << (32 - rotate));
+        shift += 8;
+    }
+
+    return (static_cast<uint64_t>(high) << 32) | low;
+}
+
 /// Get the index of a given file name, or -1 if not found
 int BSAFile::getIndex(const char *str) const
 {
-    Lookup::const_iterator it = lookup.find(str);
-    if(it == lookup.end())
+    if (lookup.empty())
         return -1;
 
-    int res = it->second;
-    assert(res >= 0 && (size_t)res < files.size());
-    return res;
+    const size_t length = strlen(str);
+    const uint64_t hash = getHash(str, length);
+
+    const size_t mask = lookup.size() - 1;
+    for (size_t slot = getSlot(hash, mask); lookup[slot] != 0; slot = (slot + 1) & mask)
+    {
+        const int res = lookup[slot] - 1;
+        assert(res >= 0 && (size_t)res < files.size());
+        if (hashes[res] == hash && namesEqual(files[res].name, str, length))
+            return res;
+    }
+    return -1;
 }
 
 /// Open an archive file.
-void BSAFile::open(const string &file)
+void BSAFile::open(const string &file, bool memoryMapped)
 {
     filename = file;
     readHeader();
+
+    if (memoryMapped)
+        mappedFile.reset(new Files::MemoryMappedFile(filename));
 }
 
 Files::IStreamPtr BSAFile::getFile(const char *file)
@@ -173,12 +256,25 @@ Files::IStreamPtr BSAFile::getFile(const char *file)
     if(i == -1)
         fail("File not found: " + string(file));
 
-    const FileStruct &fs = files[i];
-
-    return Files::openConstrainedFileStream (filename.c_str (), fs.offset, fs.fileSize);
+    return getFile(&files[i]);
 }
 
 Files::IStreamPtr BSAFile::getFile(const FileStruct *file)
 {
+    if (mappedFile)
+        return Files::openMemoryMappedStream (mappedFile, file->offset, file->fileSize);
     return Files::openConstrainedFileStream (filename.c_str (), file->offset, file->fileSize);
 }
+
+bool BSAFile::getFileData(const FileStruct *file, const char *&data, size_t &size) const
+{
+    if (!mappedFile)
+        return false;
+
+    if (file->offset > mappedFile->size() || file->fileSize > mappedFile->size() - file->offset)
+        fail("File " + string(file->name) + " is outside of the mapped archive");
+
+    data = mappedFile->data() + file->offset;
+    size = file->fileSize;
+    return true;
+}
@@ -27,11 +27,11 @@
 #include <stdint.h>
 #include <string>
 #include <vector>
-#include <map>
 
 #include <components/misc/stringops.hpp>
 
 #include <components/files/constrainedfilestream.hpp>
+#include <components/files/memorymappedfile.hpp>
 
 
 namespace Bsa
@@ -69,22 +69,21 @@ private:
     /// Used for error messages
     std::string filename;
 
-    /// Case insensitive string comparison
-    struct iltstr
-    {
-        bool operator()(const char *s1, const char *s2) const
-        { return Misc::StringUtils::ciLess(s1, s2); }
-    };
+    /// The whole archive mapped into memory, if it was opened as memory mapped
+    Files::MemoryMappedFilePtr mappedFile;
+
+    /// Hash of each file name, indexed like files[]
+    std::vector<uint64_t> hashes;
 
-    /** A map used for fast file name lookup. The value is the index into
-        the files[] vector above. The iltstr ensures that file name
-        checks are case insensitive.
+    /** An open addressing hash table used for fast file name lookup,
+        with linear probing. Each slot holds the index into the files[]
+        vector above plus one, or zero if the slot is empty. File names
+        are hashed case insensitively, see getHash().
     */
-    typedef std::map<const char*, int, iltstr> Lookup;
-    Lookup lookup;
+    std::vector<uint32_t> lookup;
 
     /// Error handling
-    void fail(const std::string &msg);
+    void fail(const std::string &msg) const;
 
     /// Read header information from the input source
     void readHeader();
@@ -103,8 +102,21 @@ public:
       : isLoaded(false)
     { }
 
+    /** Compute the hash of a file name, case insensitively. This is the
+        hash function used by the hash table stored in TES3 archives: the
+        low 32 bits cover the first half of the name, the high 32 bits the
+        second half.
+    */
+    static uint64_t getHash(const char *name, size_t length);
+
     /// Open an archive file.
-    void open(const std::string &file);
+    /// @param memoryMapped Map the whole archive into memory, so that files can be read from it
+    /// without any system calls or per-file handles.
+    void open(const std::string &file, bool memoryMapped = false);
+
+    /// Is the archive mapped into memory?
+    bool isMemoryMapped() const
+    { return mappedFile.get() != nullptr; }
 
     /* -----------------------------------
      * Archive file routines
@@ -126,6 +138,14 @@ public:
     */
     Files::IStreamPtr getFile(const FileStruct* file);
 
+    /** Get direct read-only access to the contents of a file in the archive, without copying.
+     * Throws an exception if the file lies outside of the mapped archive, e.g. because it was truncated.
+     * @return false if the archive is not memory mapped.
+     * @note The data stays valid for as long as the archive is open.
+     * @note Thread safe.
+    */
+    bool getFileData(const FileStruct* file, const char*& data, size_t& size) const;
+
     /// Get a list of all files
     /// @note Thread safe.
     const FileList &getList() const
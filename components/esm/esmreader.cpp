@@ -2,6 +2,8 @@
 
 #include <stdexcept>
 
+#include <components/files/memorymappedfile.hpp>
+
 namespace ESM
 {
 
@@ -15,7 +17,7 @@ using namespace Misc;
 ESM_Context ESMReader::getContext()
 {
     // Update the file position before returning
-    mCtx.filePos = mEsm->tellg();
+    mCtx.filePos = getFileOffset();
     return mCtx;
 }
 
@@ -26,6 +28,9 @@ ESMReader::ESMReader()
     , mGlobalReaderList(NULL)
     , mEncoder(NULL)
     , mFileSize(0)
+    , mData(NULL)
+    , mPosition(0)
+    , mMemoryMapped(false)
 {
 }
 
@@ -44,12 +49,18 @@ void ESMReader::restoreContext(const ESM_Context &rc)
     mCtx = rc;
 
     // Make sure we seek to the right place
-    mEsm->seekg(mCtx.filePos);
+    if (mData)
+        mPosition = mCtx.filePos;
+    else
+        mEsm->seekg(mCtx.filePos);
 }
 
 void ESMReader::close()
 {
     mEsm.reset();
+    mMappedFile.reset();
+    mData = NULL;
+    mPosition = 0;
     mCtx.filename.clear();
     mCtx.leftFile = 0;
     mCtx.leftRec = 0;
@@ -69,15 +80,37 @@ void ESMReader::openRaw(Files::IStreamPtr _esm, const std::string& name)
     mEsm->seekg(0, mEsm->beg);
 }
 
+void ESMReader::openRaw(const Files::MemoryMappedFilePtr& file, const std::string& name)
+{
+    close();
+    mMappedFile = file;
+    mData = file->data();
+    mCtx.filename = name;
+    mCtx.leftFile = mFileSize = file->size();
+}
+
 void ESMReader::openRaw(const std::string& filename)
 {
-    openRaw(Files::openConstrainedFileStream(filename.c_str()), filename);
+    if (mMemoryMapped)
+        openRaw(std::make_shared<Files::MemoryMappedFile>(filename), filename);
+    else
+        openRaw(Files::openConstrainedFileStream(filename.c_str()), filename);
 }
 
 void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
 {
     openRaw(_esm, name);
+    readHeader();
+}
+
+void ESMReader::open(const std::string &file)
+{
+    openRaw(file);
+    readHeader();
+}
 
+void ESMReader::readHeader()
+{
     if (getRecName() != "TES3")
         fail("Not a valid Morrowind file");
 
@@ -86,11 +119,6 @@ void ESMReader::open(Files::IStreamPtr _esm, const std::string &name)
     mHeader.load (*this);
 }
 
-void ESMReader::open(const std::string &file)
-{
-    open (Files::openConstrainedFileStream (file.c_str ()), file);
-}
-
 int64_t ESMReader::getHNLong(const char *name)
 {
     int64_t val;
@@ -313,8 +341,28 @@ void ESMReader::getRecHeader(uint32_t &flags)
  *
  *************************************************************************/
 
+const char* ESMReader::getMappedData(int size)
+{
+    if (size < 0 || static_cast<size_t>(size) > mFileSize - mPosition)
+    {
+        std::stringstream error;
+        error << "Read error: tried to read " << size << " bytes, but only " << mFileSize - mPosition << " are left";
+        fail(error.str());
+    }
+
+    const char* data = mData + mPosition;
+    mPosition += size;
+    return data;
+}
+
 void ESMReader::getExact(void*x, int size)
 {
+    if (mData)
+    {
+        memcpy(x, getMappedData(size), size);
+        return;
+    }
+
     try
     {
         mEsm->read((char*)x, size);
@@ -327,6 +375,13 @@ void ESMReader::getExact(void*x, int size)
 
 std::string ESMReader::getString(int size)
 {
+    if (mData && !mEncoder)
+    {
+        // Nothing to convert, so the string can be created straight from the mapped file
+        const char *ptr = getMappedData(size);
+        return std::string (ptr, strnlen(ptr, size));
+    }
+
     size_t s = size;
     if (mBuffer.size() <= s)
         // Add some extra padding to reduce the chance of having to resize
@@ -359,7 +414,9 @@ void ESMReader::fail(const std::string &msg)
     ss << "\n  File: " << mCtx.filename;
     ss << "\n  Record: " << mCtx.recName.toString();
     ss << "\n  Subrecord: " << mCtx.subName.toString();
-    if (mEsm.get())
+    if (mData)
+        ss << "\n  Offset: 0x" << hex << mPosition;
+    else if (mEsm.get())
         ss << "\n  Offset: 0x" << hex << mEsm->tellg();
     throw std::runtime_error(ss.str());
 }
@@ -371,12 +428,17 @@ void ESMReader::setEncoder(ToUTF8::Utf8Encoder* encoder)
 
 size_t ESMReader::getFileOffset()
 {
+    if (mData)
+        return mPosition;
     return mEsm->tellg();
 }
 
 void ESMReader::skip(int bytes)
 {
-    mEsm->seekg(getFileOffset()+bytes);
+    if (mData)
+        getMappedData(bytes);
+    else
+        mEsm->seekg(getFileOffset()+bytes);
 }
 
 }
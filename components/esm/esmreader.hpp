@@ -4,6 +4,7 @@
 #include <stdint.h>
 #include <string.h>
 #include <cassert>
+#include <memory>
 #include <vector>
 #include <sstream>
 
@@ -16,6 +17,12 @@
 #include "esmcommon.hpp"
 #include "loadtes3.hpp"
 
+namespace Files
+{
+  class MemoryMappedFile;
+  typedef std::shared_ptr<MemoryMappedFile> MemoryMappedFilePtr;
+}
+
 namespace ESM {
 
 class ESMReader
@@ -73,6 +80,17 @@ public:
 
   void openRaw(const std::string &filename);
 
+  /// Raw opening of a file that has been mapped into memory. Records are decoded straight
+  /// from the mapping, and skipping a record does not touch its contents at all.
+  void openRaw(const Files::MemoryMappedFilePtr& file, const std::string &name);
+
+  /// Map files opened by name into memory as a whole, instead of reading them through a file stream.
+  /// Takes effect the next time a file is opened by name.
+  void setMemoryMapped(bool mapped) { mMemoryMapped = mapped; }
+
+  /// Is the currently open file read from memory?
+  bool isMemoryMapped() const { return mData != NULL; }
+
   /// Get the current position in the file. Make sure that the file has been opened!
   size_t getFileOffset();
 
@@ -269,6 +287,12 @@ public:
   size_t getFileSize() const { return mFileSize; }
 
 private:
+  /// Parse the TES3 header record at the start of the file
+  void readHeader();
+
+  /// Get a pointer to the next \a size bytes of a memory mapped file and advance past them.
+  const char* getMappedData(int size);
+
   Files::IStreamPtr mEsm;
 
   ESM_Context mCtx;
@@ -287,6 +311,14 @@ private:
 
   size_t mFileSize;
 
+  /// Keeps the file mapped while it is open. Copies of this reader share the mapping.
+  Files::MemoryMappedFilePtr mMappedFile;
+  /// Start of the mapped file contents, or NULL if the file is read through \a mEsm
+  const char* mData;
+  /// Current read position in the mapped file
+  size_t mPosition;
+  bool mMemoryMapped;
+
 };
 }
 #endif
@@ -80,6 +80,14 @@ namespace ESM
         endRecord("TES3");
     }
 
+    void ESMWriter::saveRecords(std::ostream& file)
+    {
+        mRecordCount = 0;
+        mRecords.clear();
+        mCounting = true;
+        mStream = &file;
+    }
+
     void ESMWriter::close()
     {
         if (!mRecords.empty())
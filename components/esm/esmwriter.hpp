@@ -52,6 +52,9 @@ class ESMWriter
         void save(std::ostream& file);
         ///< Start saving a file by writing the TES3 header.
 
+        void saveRecords(std::ostream& file);
+        ///< Start saving records without a TES3 header, e.g. to copy them into a file with a header later on.
+
         void close();
         ///< \note Does not close the stream.
 
@@ -0,0 +1,182 @@
+#include "memorymappedfile.hpp"
+
+#include <stdexcept>
+#include <sstream>
+
+#include "memorystream.hpp"
+
+#if FILE_API == FILE_API_POSIX
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <string.h>
+#elif FILE_API == FILE_API_STDIO
+#include <cstdio>
+#endif
+
+namespace
+{
+
+    class MemoryMappedStream : public Files::IMemStream
+    {
+    public:
+        MemoryMappedStream(const Files::MemoryMappedFilePtr& file, size_t start, size_t length)
+            : Files::MemBuf(file->data() + start, length)
+            , Files::IMemStream(file->data() + start, length)
+            , mFile(file)
+        {
+        }
+
+    private:
+        Files::MemoryMappedFilePtr mFile;
+    };
+
+    void fail(const std::string& filename, const std::string& reason)
+    {
+        std::ostringstream os;
+        os << "Failed to map '" << filename << "' into memory: " << reason;
+        throw std::runtime_error(os.str());
+    }
+
+}
+
+namespace Files
+{
+
+#if FILE_API == FILE_API_POSIX
+
+    MemoryMappedFile::MemoryMappedFile(const std::string &filename)
+        : mData(nullptr)
+        , mSize(0)
+    {
+#ifdef O_BINARY
+        static const int openFlags = O_RDONLY | O_BINARY;
+#else
+        static const int openFlags = O_RDONLY;
+#endif
+
+        int handle = ::open(filename.c_str(), openFlags, 0);
+        if (handle == -1)
+            fail(filename, strerror(errno));
+
+        struct stat info;
+        if (::fstat(handle, &info) == -1)
+        {
+            const int error = errno;
+            ::close(handle);
+            fail(filename, strerror(error));
+        }
+
+        mSize = info.st_size;
+        if (mSize != 0)
+        {
+            void* data = ::mmap(nullptr, mSize, PROT_READ, MAP_PRIVATE, handle, 0);
+            if (data == MAP_FAILED)
+            {
+                const int error = errno;
+                ::close(handle);
+                fail(filename, strerror(error));
+            }
+            mData = static_cast<const char*>(data);
+        }
+
+        // The mapping stays valid after the descriptor is closed
+        ::close(handle);
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (mData)
+            ::munmap(const_cast<char*>(mData), mSize);
+    }
+
+#elif FILE_API == FILE_API_WIN32
+
+    MemoryMappedFile::MemoryMappedFile(const std::string &filename)
+        : mData(nullptr)
+        , mSize(0)
+        , mFile(INVALID_HANDLE_VALUE)
+        , mMapping(NULL)
+    {
+        mFile = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, 0, OPEN_EXISTING, 0, 0);
+        if (mFile == INVALID_HANDLE_VALUE)
+            fail(filename, "CreateFile failed");
+
+        LARGE_INTEGER size;
+        if (!::GetFileSizeEx(mFile, &size))
+        {
+            ::CloseHandle(mFile);
+            fail(filename, "GetFileSizeEx failed");
+        }
+        mSize = static_cast<size_t>(size.QuadPart);
+
+        if (mSize != 0)
+        {
+            mMapping = ::CreateFileMappingA(mFile, 0, PAGE_READONLY, 0, 0, 0);
+            if (mMapping == NULL)
+            {
+                ::CloseHandle(mFile);
+                fail(filename, "CreateFileMapping failed");
+            }
+
+            mData = static_cast<const char*>(::MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+            if (!mData)
+            {
+                ::CloseHandle(mMapping);
+                ::CloseHandle(mFile);
+                fail(filename, "MapViewOfFile failed");
+            }
+        }
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+        if (mData)
+            ::UnmapViewOfFile(mData);
+        if (mMapping != NULL)
+            ::CloseHandle(mMapping);
+        ::CloseHandle(mFile);
+    }
+
+#elif FILE_API == FILE_API_STDIO
+
+    MemoryMappedFile::MemoryMappedFile(const std::string &filename)
+        : mData(nullptr)
+        , mSize(0)
+    {
+        FILE* handle = fopen(filename.c_str(), "rb");
+        if (handle == NULL)
+            fail(filename, "fopen failed");
+
+        fseek(handle, 0, SEEK_END);
+        mBuffer.resize(ftell(handle));
+        fseek(handle, 0, SEEK_SET);
+
+        if (!mBuffer.empty() && fread(&mBuffer[0], 1, mBuffer.size(), handle) != mBuffer.size())
+        {
+            fclose(handle);
+            fail(filename, "fread failed");
+        }
+        fclose(handle);
+
+        mSize = mBuffer.size();
+        mData = mBuffer.empty() ? nullptr : &mBuffer[0];
+    }
+
+    MemoryMappedFile::~MemoryMappedFile()
+    {
+    }
+
+#endif
+
+    IStreamPtr openMemoryMappedStream(const MemoryMappedFilePtr &file, size_t start, size_t length)
+    {
+        if (start > file->size() || length > file->size() - start)
+            throw std::runtime_error("Memory mapped stream region is outside of the file");
+        return IStreamPtr(new MemoryMappedStream(file, start, length));
+    }
+
+}
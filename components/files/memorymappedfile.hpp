@@ -0,0 +1,50 @@
+#ifndef OPENMW_COMPONENTS_FILES_MEMORYMAPPEDFILE_H
+#define OPENMW_COMPONENTS_FILES_MEMORYMAPPEDFILE_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "constrainedfilestream.hpp"
+#include "lowlevelfile.hpp"
+
+namespace Files
+{
+
+    /// @brief A read-only view of a whole file mapped into memory.
+    /// @par On platforms without a supported mapping API the file is read into memory in one block instead.
+    /// @note Thread safe once constructed, the mapped contents are never modified.
+    class MemoryMappedFile
+    {
+    public:
+        /// @note Throws an exception if the file can not be opened or mapped.
+        MemoryMappedFile(const std::string& filename);
+        ~MemoryMappedFile();
+
+        const char* data() const { return mData; }
+        size_t size() const { return mSize; }
+
+    private:
+        MemoryMappedFile(const MemoryMappedFile&);
+        MemoryMappedFile& operator=(const MemoryMappedFile&);
+
+        const char* mData;
+        size_t mSize;
+
+#if FILE_API == FILE_API_WIN32
+        HANDLE mFile;
+        HANDLE mMapping;
+#elif FILE_API == FILE_API_STDIO
+        std::vector<char> mBuffer;
+#endif
+    };
+
+    typedef std::shared_ptr<MemoryMappedFile> MemoryMappedFilePtr;
+
+    /// Open a stream over the given region of a memory mapped file. Reading from the stream does not
+    /// involve any system calls, and the file stays mapped for as long as the stream exists.
+    IStreamPtr openMemoryMappedStream(const MemoryMappedFilePtr& file, size_t start, size_t length);
+
+}
+
+#endif
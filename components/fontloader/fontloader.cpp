@@ -138,6 +138,14 @@ namespace
         throw std::runtime_error(error.str());
     }
 
+    void fail (const std::string& fileName, const std::string& message)
+    {
+        std::stringstream error;
+        error << "Font loading error: " << message;
+        error << "\n  File: " << fileName;
+        throw std::runtime_error(error.str());
+    }
+
 }
 
 namespace Gui
@@ -165,24 +173,13 @@ namespace Gui
 
     void FontLoader::loadAllFonts(bool exportToFile)
     {
-        const std::map<std::string, VFS::File*>& index = mVFS->getIndex();
-
-        std::string pattern = "Fonts/";
-        mVFS->normalizeFilename(pattern);
-
-        std::map<std::string, VFS::File*>::const_iterator found = index.lower_bound(pattern);
-        while (found != index.end())
+        const VFS::FileIndex::Range fonts = mVFS->getFilesWithPrefix("Fonts/");
+        for (VFS::FileIndex::const_iterator it = fonts.begin(); it != fonts.end(); ++it)
         {
-            const std::string& name = found->first;
-            if (name.size() >= pattern.size() && name.substr(0, pattern.size()) == pattern)
-            {
-                size_t pos = name.find_last_of('.');
-                if (pos != std::string::npos && name.compare(pos, name.size()-pos, ".fnt") == 0)
-                    loadFont(name, exportToFile);
-            }
-            else
-                break;
-            ++found;
+            const std::string name = it->getName();
+            size_t pos = name.find_last_of('.');
+            if (pos != std::string::npos && name.compare(pos, name.size()-pos, ".fnt") == 0)
+                loadFont(name, exportToFile);
         }
     }
 
@@ -247,24 +244,49 @@ namespace Gui
         // Create the font texture
         std::string bitmapFilename = "Fonts/" + std::string(name) + ".tex";
 
-        Files::IStreamPtr bitmapFile = mVFS->get(bitmapFilename);
-
         int width, height;
-        bitmapFile->read((char*)&width, sizeof(int));
-        bitmapFile->read((char*)&height, sizeof(int));
+        const char* textureData = NULL;
+        std::size_t textureSize = 0;
+        std::vector<char> textureBuffer;
+
+        // From a memory mapped archive, the pixels are copied straight into the texture
+        const char* bitmap = NULL;
+        std::size_t bitmapSize = 0;
+        if (mVFS->getData(bitmapFilename, bitmap, bitmapSize))
+        {
+            if (bitmapSize < 2 * sizeof(int))
+                fail(bitmapFilename, "File too small to be a valid bitmap");
+
+            memcpy(&width, bitmap, sizeof(int));
+            memcpy(&height, bitmap + sizeof(int), sizeof(int));
+            if (width <= 0 || height <= 0)
+                fail(bitmapFilename, "Width and height must be positive");
+
+            textureSize = static_cast<std::size_t>(width) * height * 4;
+            if (bitmapSize - 2 * sizeof(int) < textureSize)
+                fail(bitmapFilename, "File too small to be a valid bitmap");
+            textureData = bitmap + 2 * sizeof(int);
+        }
+        else
+        {
+            Files::IStreamPtr bitmapFile = mVFS->get(bitmapFilename);
 
-        if (!bitmapFile->good())
-            fail(bitmapFile, bitmapFilename, "File too small to be a valid bitmap");
+            bitmapFile->read((char*)&width, sizeof(int));
+            bitmapFile->read((char*)&height, sizeof(int));
 
-        if (width <= 0 || height <= 0)
-            fail(bitmapFile, bitmapFilename, "Width and height must be positive");
+            if (!bitmapFile->good())
+                fail(bitmapFile, bitmapFilename, "File too small to be a valid bitmap");
 
-        std::vector<char> textureData;
-        textureData.resize(width*height*4);
-        bitmapFile->read(&textureData[0], width*height*4);
-        if (!bitmapFile->good())
-            fail(bitmapFile, bitmapFilename, "File too small to be a valid bitmap");
-        bitmapFile.reset();
+            if (width <= 0 || height <= 0)
+                fail(bitmapFile, bitmapFilename, "Width and height must be positive");
+
+            textureSize = static_cast<std::size_t>(width) * height * 4;
+            textureBuffer.resize(textureSize);
+            bitmapFile->read(&textureBuffer[0], textureSize);
+            if (!bitmapFile->good())
+                fail(bitmapFile, bitmapFilename, "File too small to be a valid bitmap");
+            textureData = &textureBuffer[0];
+        }
 
         std::string resourceName;
         if (name.size() >= 5 && Misc::StringUtils::ciEqual(name.substr(0, 5), "magic"))
@@ -279,7 +301,7 @@ namespace Gui
             osg::ref_ptr<osg::Image> image = new osg::Image;
             image->allocateImage(width, height, 1, GL_RGBA, GL_UNSIGNED_BYTE);
             assert (image->isDataContiguous());
-            memcpy(image->data(), &textureData[0], textureData.size());
+            memcpy(image->data(), textureData, textureSize);
 
             std::cout << "Writing " << resourceName + ".png" << std::endl;
             osgDB::writeImageFile(*image, resourceName + ".png");
@@ -293,7 +315,7 @@ namespace Gui
         MyGUI::ITexture* tex = MyGUI::RenderManager::getInstance().createTexture(bitmapFilename);
         tex->createManual(width, height, MyGUI::TextureUsage::Write, MyGUI::PixelFormat::R8G8B8A8);
         unsigned char* texData = reinterpret_cast<unsigned char*>(tex->lock(MyGUI::TextureUsage::Write));
-        memcpy(texData, &textureData[0], textureData.size());
+        memcpy(texData, textureData, textureSize);
         tex->unlock();
 
         // Using ResourceManualFont::setTexture, enable for MyGUI 3.2.3
@@ -4,6 +4,8 @@
 #include <string>
 #include <vector>
 
+#include "linktable.hpp"
+
 namespace Interpreter
 {
     class Context
@@ -49,6 +51,22 @@ namespace Interpreter
 
             virtual void setGlobalFloat (const std::string& name, float value) = 0;
 
+            virtual int getGlobalSlot (const std::string& name) const = 0;
+            ///< Return the slot of global variable \a name, to access it with the functions below.
+            /// Slots stay the same while the content files do not change.
+
+            virtual int getGlobalShort (int slot) const = 0;
+
+            virtual int getGlobalLong (int slot) const = 0;
+
+            virtual float getGlobalFloat (int slot) const = 0;
+
+            virtual void setGlobalShort (int slot, int value) = 0;
+
+            virtual void setGlobalLong (int slot, int value) = 0;
+
+            virtual void setGlobalFloat (int slot, float value) = 0;
+
             virtual std::vector<std::string> getGlobals () const = 0;
 
             virtual char getGlobalType (const std::string& name) const = 0;
@@ -96,18 +114,20 @@ namespace Interpreter
 
             virtual void disable (const std::string& id = "") = 0;
 
-            virtual int getMemberShort (const std::string& id, const std::string& name, bool global) const = 0;
+            /// \param slot Names the variable and the reference or global script that it belongs to. The
+            /// object and the index of the variable are resolved on first access and kept in \a slot, later
+            /// accesses only check that the object is still valid.
+            virtual int getMemberShort (MemberSlot& slot, bool global) const = 0;
 
-            virtual int getMemberLong (const std::string& id, const std::string& name, bool global) const = 0;
+            virtual int getMemberLong (MemberSlot& slot, bool global) const = 0;
 
-            virtual float getMemberFloat (const std::string& id, const std::string& name, bool global) const = 0;
+            virtual float getMemberFloat (MemberSlot& slot, bool global) const = 0;
 
-            virtual void setMemberShort (const std::string& id, const std::string& name, int value, bool global) = 0;
+            virtual void setMemberShort (MemberSlot& slot, int value, bool global) = 0;
 
-            virtual void setMemberLong (const std::string& id, const std::string& name, int value, bool global) = 0;
+            virtual void setMemberLong (MemberSlot& slot, int value, bool global) = 0;
 
-            virtual void setMemberFloat (const std::string& id, const std::string& name, float value, bool global)
-                = 0;
+            virtual void setMemberFloat (MemberSlot& slot, float value, bool global) = 0;
 
             virtual std::string getTargetId() const = 0;
     };
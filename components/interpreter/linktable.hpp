@@ -0,0 +1,72 @@
+#ifndef INTERPRETER_LINKTABLE_H_INCLUDED
+#define INTERPRETER_LINKTABLE_H_INCLUDED
+
+#include <string>
+#include <vector>
+
+namespace Interpreter
+{
+    /// \brief Member variable of a reference or global script, as resolved by the context
+    struct MemberSlot
+    {
+        /// ID of the reference or global script, and name of the variable, as written in the script
+        std::string mId;
+        std::string mName;
+
+        /// Object the variable was resolved in, as identified by the context (0: not resolved yet).
+        /// The context checks that the object is still valid before it uses the slot again.
+        void *mObject;
+
+        /// Index in the locals of the object
+        int mIndex;
+
+        MemberSlot() : mObject (0), mIndex (-1) {}
+    };
+
+    /// \brief Global and member variables that a compiled script refers to, resolved on first access
+    ///
+    /// Scripts refer to these variables by name, i.e. by the index of a string literal. A link table
+    /// belongs to one compiled script and maps these literals to the slots that the variables were
+    /// found in, so that they are only looked up by name once. Global slots stay the same while the
+    /// content files do not change, so a link table must not outlive the content it was used with.
+    class LinkTable
+    {
+            std::vector<int> mGlobals;
+            std::vector<MemberSlot> mMembers;
+
+        public:
+
+            int& getGlobal (int literal)
+            ///< \return Slot of the global variable named by \a literal (-1: not resolved yet).
+            {
+                if (literal>=static_cast<int> (mGlobals.size()))
+                    mGlobals.resize (literal+1, -1);
+
+                return mGlobals[literal];
+            }
+
+            MemberSlot& getMember (int literal)
+            ///< \return Slot of the member variable named by \a literal. Every member access in a script
+            /// has a name literal of its own, so the slot always belongs to the same ID.
+            {
+                if (literal>=static_cast<int> (mMembers.size()))
+                    mMembers.resize (literal+1);
+
+                return mMembers[literal];
+            }
+
+            void clearMembers()
+            ///< Forget the objects that member variables were resolved in, e.g. when they are destroyed.
+            {
+                mMembers.clear();
+            }
+
+            void clear()
+            {
+                mGlobals.clear();
+                mMembers.clear();
+            }
+    };
+}
+
+#endif
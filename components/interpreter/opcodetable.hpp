@@ -0,0 +1,70 @@
+#ifndef INTERPRETER_OPCODETABLE_H_INCLUDED
+#define INTERPRETER_OPCODETABLE_H_INCLUDED
+
+#include <cassert>
+#include <cstddef>
+#include <vector>
+
+namespace Interpreter
+{
+    /// \brief Opcode lookup table for one code segment
+    ///
+    /// Opcodes are stored in dense pages of 4096 entries, indexed by the high bits of the code, so
+    /// a lookup is two indexed loads. Opcodes of a segment are installed in a few contiguous
+    /// ranges (e.g. 0x2000000 and up for the extensions in segment 5), so only a few pages exist.
+    template<class T>
+    class OpcodeTable
+    {
+            static const int sPageBits = 12;
+            static const int sPageSize = 1 << sPageBits;
+
+            std::vector<std::vector<T *> > mPages;
+
+            // not implemented
+            OpcodeTable (const OpcodeTable&);
+            OpcodeTable& operator= (const OpcodeTable&);
+
+        public:
+
+            OpcodeTable() {}
+
+            ~OpcodeTable()
+            {
+                for (typename std::vector<std::vector<T *> >::iterator page (mPages.begin());
+                    page!=mPages.end(); ++page)
+                    for (typename std::vector<T *>::iterator iter (page->begin()); iter!=page->end(); ++iter)
+                        delete *iter;
+            }
+
+            void install (int code, T *opcode)
+            ///< ownership of \a opcode is transferred to *this.
+            {
+                assert (code>=0);
+
+                std::size_t page = static_cast<std::size_t> (code)>>sPageBits;
+
+                if (page>=mPages.size())
+                    mPages.resize (page+1);
+
+                if (mPages[page].empty())
+                    mPages[page].resize (sPageSize, 0);
+
+                T *& entry = mPages[page][code & (sPageSize-1)];
+                assert (!entry);
+                entry = opcode;
+            }
+
+            T *find (int code) const
+            ///< \return 0, if no opcode is installed for \a code.
+            {
+                std::size_t page = static_cast<std::size_t> (code)>>sPageBits;
+
+                if (page>=mPages.size() || mPages[page].empty())
+                    return 0;
+
+                return mPages[page][code & (sPageSize-1)];
+            }
+    };
+}
+
+#endif
@@ -4,9 +4,11 @@
 #include <cassert>
 #include <cstring>
 
+#include "context.hpp"
+
 namespace Interpreter
 {
-    Runtime::Runtime() : mContext (0), mCode (0), mCodeSize(0), mPC (0) {}
+    Runtime::Runtime() : mContext (0), mCode (0), mCodeSize(0), mPC (0), mLinks (0) {}
 
     int Runtime::getPC() const
     {
@@ -49,7 +51,36 @@ namespace Interpreter
         return literalBlock+offset;
     }
 
-    void Runtime::configure (const Type_Code *code, int codeSize, Context& context)
+    int Runtime::getGlobalSlot (int index)
+    {
+        if (!mLinks)
+            return getContext().getGlobalSlot (getStringLiteral (index));
+
+        int& slot = mLinks->getGlobal (index);
+
+        if (slot==-1)
+            slot = getContext().getGlobalSlot (getStringLiteral (index));
+
+        return slot;
+    }
+
+    MemberSlot& Runtime::getMemberSlot (int id, int name)
+    {
+        if (!mLinks)
+            mUnlinkedMember = MemberSlot();
+
+        MemberSlot& slot = mLinks ? mLinks->getMember (name) : mUnlinkedMember;
+
+        if (slot.mName.empty())
+        {
+            slot.mId = getStringLiteral (id);
+            slot.mName = getStringLiteral (name);
+        }
+
+        return slot;
+    }
+
+    void Runtime::configure (const Type_Code *code, int codeSize, Context& context, LinkTable *links)
     {
         clear();
 
@@ -57,6 +88,7 @@ namespace Interpreter
         mCode = code;
         mCodeSize = codeSize;
         mPC = 0;
+        mLinks = links;
     }
 
     void Runtime::clear()
@@ -65,6 +97,7 @@ namespace Interpreter
         mCode = 0;
         mCodeSize = 0;
         mStack.clear();
+        mLinks = 0;
     }
 
     void Runtime::setPC (int PC)
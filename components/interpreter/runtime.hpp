@@ -5,6 +5,7 @@
 #include <string>
 
 #include "types.hpp"
+#include "linktable.hpp"
 
 namespace Interpreter
 {
@@ -19,6 +20,8 @@ namespace Interpreter
             int mCodeSize;
             int mPC;
             std::vector<Data> mStack;
+            LinkTable *mLinks;
+            MemberSlot mUnlinkedMember;
 
         public:
 
@@ -33,8 +36,16 @@ namespace Interpreter
 
             std::string getStringLiteral (int index) const;
 
-            void configure (const Type_Code *code, int codeSize, Context& context);
-            ///< \a context and \a code must exist as least until either configure, clear or
+            int getGlobalSlot (int index);
+            ///< Return the slot of the global variable named by string literal \a index.
+
+            MemberSlot& getMemberSlot (int id, int name);
+            ///< Return the slot of the member variable named by string literals \a id and \a name. The
+            /// literals are only copied into the slot on first access. Without a link table, this is a slot
+            /// that has to be resolved again on every access.
+
+            void configure (const Type_Code *code, int codeSize, Context& context, LinkTable *links = 0);
+            ///< \a context, \a code and \a links must exist as least until either configure, clear or
             /// the destructor is called. \a codeSize is given in 32-bit words.
 
             void clear();
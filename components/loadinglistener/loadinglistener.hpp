@@ -29,6 +29,11 @@ namespace Loading
         virtual void setProgress (size_t value) {}
         /// Increase current progress, default by 1.
         virtual void increaseProgress (size_t increase = 1) {}
+
+        /// Report how long a step of the loading process took, for diagnostic purposes.
+        /// @param task Description of the step
+        /// @param milliseconds Time taken
+        virtual void reportTime (const std::string& task, double milliseconds) {}
     };
 
     /// @brief Used for stopping a loading sequence when the object goes out of scope
@@ -6,7 +6,8 @@
 #include "nifstream.hpp"
 
 #include <sstream>
-#include <map>
+#include <vector>
+#include <algorithm>
 
 #include "niffile.hpp"
 
@@ -31,9 +32,11 @@ typedef KeyT<osg::Vec3f> Vector3Key;
 typedef KeyT<osg::Vec4f> Vector4Key;
 typedef KeyT<osg::Quat> QuaternionKey;
 
+/// Keys are stored as two parallel arrays of times and values, sorted by strictly increasing time.
 template<typename T, T (NIFStream::*getValue)()>
 struct KeyMapT {
-    typedef std::map< float, KeyT<T> > MapType;
+    typedef std::vector<float> TimeList;
+    typedef std::vector<T> ValueList;
 
     typedef T ValueType;
     typedef KeyT<T> KeyType;
@@ -44,10 +47,59 @@ struct KeyMapT {
     static const unsigned int sXYZInterpolation = 4;
 
     unsigned int mInterpolationType;
-    MapType mKeys;
+    TimeList mTimes;
+    ValueList mValues;
 
     KeyMapT() : mInterpolationType(sLinearInterpolation) {}
 
+    bool empty() const { return mTimes.empty(); }
+    size_t size() const { return mTimes.size(); }
+
+    void clear()
+    {
+        mTimes.clear();
+        mValues.clear();
+    }
+
+    /// Append a key. Call sort() after adding keys out of order.
+    void addKey(float time, const T& value)
+    {
+        mTimes.push_back(time);
+        mValues.push_back(value);
+    }
+
+    /// Sort the keys by time. Of several keys with the same time, only the last one added is kept.
+    void sort()
+    {
+        bool sorted = true;
+        for (size_t i = 1; i < mTimes.size() && sorted; ++i)
+            sorted = mTimes[i-1] < mTimes[i];
+        if (sorted)
+            return;
+
+        std::vector<size_t> order(mTimes.size());
+        for (size_t i = 0; i < order.size(); ++i)
+            order[i] = i;
+        std::stable_sort(order.begin(), order.end(), TimeLess(mTimes));
+
+        TimeList times;
+        ValueList values;
+        times.reserve(order.size());
+        values.reserve(order.size());
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            if (!times.empty() && times.back() == mTimes[order[i]])
+                values.back() = mValues[order[i]];
+            else
+            {
+                times.push_back(mTimes[order[i]]);
+                values.push_back(mValues[order[i]]);
+            }
+        }
+        mTimes.swap(times);
+        mValues.swap(values);
+    }
+
     //Read in a KeyGroup (see http://niftools.sourceforge.net/doc/nif/NiKeyframeData.html)
     void read(NIFStream *nif, bool force=false)
     {
@@ -59,20 +111,26 @@ struct KeyMapT {
         if(count == 0 && !force)
             return;
 
-        mKeys.clear();
+        clear();
 
         mInterpolationType = nif->getUInt();
 
         KeyT<T> key;
         NIFStream &nifReference = *nif;
 
+        if (mInterpolationType != sXYZInterpolation)
+        {
+            mTimes.reserve(count);
+            mValues.reserve(count);
+        }
+
         if(mInterpolationType == sLinearInterpolation)
         {
             for(size_t i = 0;i < count;i++)
             {
                 float time = nif->getFloat();
                 readValue(nifReference, key);
-                mKeys[time] = key;
+                addKey(time, key.mValue);
             }
         }
         else if(mInterpolationType == sQuadraticInterpolation)
@@ -81,7 +139,7 @@ struct KeyMapT {
             {
                 float time = nif->getFloat();
                 readQuadratic(nifReference, key);
-                mKeys[time] = key;
+                addKey(time, key.mValue);
             }
         }
         else if(mInterpolationType == sTBCInterpolation)
@@ -90,7 +148,7 @@ struct KeyMapT {
             {
                 float time = nif->getFloat();
                 readTBC(nifReference, key);
-                mKeys[time] = key;
+                addKey(time, key.mValue);
             }
         }
         //XYZ keys aren't actually read here.
@@ -120,9 +178,18 @@ struct KeyMapT {
             error << "Unhandled interpolation type: " << mInterpolationType;
             nif->file->fail(error.str());
         }
+
+        sort();
     }
 
 private:
+    struct TimeLess
+    {
+        const TimeList& mTimes;
+        TimeLess(const TimeList& times) : mTimes(times) {}
+        bool operator()(size_t left, size_t right) const { return mTimes[left] < mTimes[right]; }
+    };
+
     static void readValue(NIFStream &nif, KeyT<T> &key)
     {
         key.mValue = (nif.*getValue)();
@@ -42,19 +42,16 @@ namespace NifOsg
         typedef typename MapT::ValueType ValueT;
 
         ValueInterpolator()
-            : mDefaultVal(ValueT())
+            : mLastHighKey(0)
+            , mDefaultVal(ValueT())
         {
         }
 
         ValueInterpolator(std::shared_ptr<const MapT> keys, ValueT defaultVal = ValueT())
-            : mKeys(keys)
+            : mLastHighKey(0)
+            , mKeys(keys)
             , mDefaultVal(defaultVal)
         {
-            if (keys)
-            {
-                mLastLowKey = mKeys->mKeys.end();
-                mLastHighKey = mKeys->mKeys.end();
-            }
         }
 
         ValueT interpKey(float time) const
@@ -62,59 +59,39 @@ namespace NifOsg
             if (empty())
                 return mDefaultVal;
 
-            const typename MapT::MapType & keys = mKeys->mKeys;
+            const typename MapT::TimeList& times = mKeys->mTimes;
+            const typename MapT::ValueList& values = mKeys->mValues;
 
-            if(time <= keys.begin()->first)
-                return keys.begin()->second.mValue;
+            if (time <= times.front())
+                return values.front();
+            if (time >= times.back())
+                return values.back();
 
-            // retrieve the current position in the map, optimized for the most common case
-            // where time moves linearly along the keyframe track
-            typename MapT::MapType::const_iterator it = mLastHighKey;
-            if (mLastHighKey != keys.end())
+            // Find the key pair with times[high-1] < time <= times[high]. The cursor from the last call is
+            // checked first, then the key after it, which covers the common case of time moving forward
+            // along the track. Only if both miss do we search the whole track.
+            size_t high = mLastHighKey;
+            if (high == 0 || time > times[high] || time <= times[high-1])
             {
-                if (time > mLastHighKey->first)
-                {
-                    // try if we're there by incrementing one
-                    ++mLastLowKey;
-                    ++mLastHighKey;
-                    it = mLastHighKey;
-                }
-                if (mLastHighKey == keys.end() || (time < mLastLowKey->first || time > mLastHighKey->first))
-                    it = keys.lower_bound(time); // still not there, reorient by performing lower_bound check on the whole map
+                if (high != 0 && time > times[high] && time <= times[high+1])
+                    ++high;
+                else
+                    high = std::lower_bound(times.begin(), times.end(), time) - times.begin();
+                mLastHighKey = high;
             }
-            else
-                it = keys.lower_bound(time);
-
-            // now do the actual interpolation
-            if (it != keys.end())
-            {
-                float aTime = it->first;
-                const typename MapT::KeyType* aKey = &it->second;
 
-                // cache for next time
-                mLastHighKey = it;
-
-                typename MapT::MapType::const_iterator last = --it;
-                mLastLowKey = last;
-                float aLastTime = last->first;
-                const typename MapT::KeyType* aLastKey = &last->second;
-
-                float a = (time - aLastTime) / (aTime - aLastTime);
-
-                return InterpolationFunc()(aLastKey->mValue, aKey->mValue, a);
-            }
-            else
-                return keys.rbegin()->second.mValue;
+            float a = (time - times[high-1]) / (times[high] - times[high-1]);
+            return InterpolationFunc()(values[high-1], values[high], a);
         }
 
         bool empty() const
         {
-            return !mKeys || mKeys->mKeys.empty();
+            return !mKeys || mKeys->empty();
         }
 
     private:
-        mutable typename MapT::MapType::const_iterator mLastLowKey;
-        mutable typename MapT::MapType::const_iterator mLastHighKey;
+        /// Index of the upper key of the last interpolated pair, or 0 if there is none yet
+        mutable size_t mLastHighKey;
 
         std::shared_ptr<const MapT> mKeys;
 
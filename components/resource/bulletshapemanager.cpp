@@ -195,7 +195,7 @@ void BulletShapeManager::clearCache()
 
 void BulletShapeManager::reportStats(unsigned int frameNumber, osg::Stats *stats) const
 {
-    stats->setAttribute(frameNumber, "Shape", mCache->getCacheSize());
+    reportCacheStats(frameNumber, stats, "Shape");
     stats->setAttribute(frameNumber, "Shape Instance", mInstanceCache->getCacheSize());
 }
 
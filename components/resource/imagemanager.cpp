@@ -98,7 +98,7 @@ namespace Resource
             catch (std::exception& e)
             {
                 std::cerr << "Failed to open image: " << e.what() << std::endl;
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
+                addWarningImage(normalized);
                 return mWarningImage;
             }
 
@@ -110,7 +110,7 @@ namespace Resource
             if (!reader)
             {
                 std::cerr << "Error loading " << filename << ": no readerwriter for '" << ext << "' found" << std::endl;
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
+                addWarningImage(normalized);
                 return mWarningImage;
             }
 
@@ -118,7 +118,7 @@ namespace Resource
             if (!result.success())
             {
                 std::cerr << "Error loading " << filename << ": " << result.message() << " code " << result.status() << std::endl;
-                mCache->addEntryToObjectCache(normalized, mWarningImage);
+                addWarningImage(normalized);
                 return mWarningImage;
             }
 
@@ -131,7 +131,7 @@ namespace Resource
                 if (!uncompress)
                 {
                     std::cerr << "Error loading " << filename << ": no S3TC texture compression support installed" << std::endl;
-                    mCache->addEntryToObjectCache(normalized, mWarningImage);
+                    addWarningImage(normalized);
                     return mWarningImage;
                 }
                 else
@@ -154,6 +154,12 @@ namespace Resource
         }
     }
 
+    void ImageManager::addWarningImage(const std::string &name)
+    {
+        // the warning image is shared by all images that failed to load and is never evicted, so only count the entry
+        mCache->addEntryToObjectCache(name, mWarningImage, 0.0, ObjectCache::estimateSize(NULL));
+    }
+
     osg::Image *ImageManager::getWarningImage()
     {
         return mWarningImage;
@@ -161,7 +167,7 @@ namespace Resource
 
     void ImageManager::reportStats(unsigned int frameNumber, osg::Stats *stats) const
     {
-        stats->setAttribute(frameNumber, "Image", mCache->getCacheSize());
+        reportCacheStats(frameNumber, stats, "Image");
     }
 
 }
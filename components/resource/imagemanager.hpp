@@ -35,6 +35,8 @@ namespace Resource
         void reportStats(unsigned int frameNumber, osg::Stats* stats) const;
 
     private:
+        void addWarningImage(const std::string& name);
+
         osg::ref_ptr<osg::Image> mWarningImage;
         osg::ref_ptr<osgDB::Options> mOptions;
 
@@ -49,16 +49,19 @@ namespace Resource
             return static_cast<NifFileHolder*>(obj.get())->mNifFile;
         else
         {
-            Nif::NIFFilePtr file (new Nif::NIFFile(mVFS->get(name), name));
+            Files::IStreamPtr stream = mVFS->get(name);
+            Nif::NIFFilePtr file (new Nif::NIFFile(stream, name));
             obj = new NifFileHolder(file);
-            mCache->addEntryToObjectCache(name, obj);
+            // The records take roughly as much memory as the data they were read from
+            std::streamoff size = stream->tellg();
+            mCache->addEntryToObjectCache(name, obj, 0.0, size > 0 ? static_cast<std::size_t>(size) : 0);
             return file;
         }
     }
 
     void NifFileManager::reportStats(unsigned int frameNumber, osg::Stats *stats) const
     {
-        stats->setAttribute(frameNumber, "Nif", mCache->getCacheSize());
+        reportCacheStats(frameNumber, stats, "Nif");
     }
 
 }
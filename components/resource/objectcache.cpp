@@ -13,12 +13,67 @@
 
 #include "objectcache.hpp"
 
+#include <algorithm>
+#include <functional>
+
 #include <osg/Object>
 #include <osg/Node>
+#include <osg/NodeVisitor>
+#include <osg/Geometry>
+#include <osg/Image>
+
+namespace
+{
+
+    std::size_t getSize(const osg::BufferData* data)
+    {
+        return data ? data->getTotalDataSize() : 0;
+    }
+
+    /// Adds up the vertex and index data of the drawables in a scene graph. Textures are not counted, as their
+    /// images are owned by the image cache.
+    class SizeVisitor : public osg::NodeVisitor
+    {
+    public:
+        SizeVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mSize(0)
+        {
+        }
+
+        virtual void apply(osg::Drawable& drawable)
+        {
+            osg::Geometry* geometry = drawable.asGeometry();
+            if (!geometry)
+                return;
+
+            mSize += getSize(geometry->getVertexArray());
+            mSize += getSize(geometry->getNormalArray());
+            mSize += getSize(geometry->getColorArray());
+            for (unsigned int i = 0; i < geometry->getNumTexCoordArrays(); ++i)
+                mSize += getSize(geometry->getTexCoordArray(i));
+            for (unsigned int i = 0; i < geometry->getNumVertexAttribArrays(); ++i)
+                mSize += getSize(geometry->getVertexAttribArray(i));
+            for (unsigned int i = 0; i < geometry->getNumPrimitiveSets(); ++i)
+                mSize += getSize(geometry->getPrimitiveSet(i));
+        }
+
+        std::size_t mSize;
+    };
+
+    /// Orders a heap with the least recently used candidate on top
+    bool compareLastAccess(const Resource::ObjectCache::EvictionCandidate& left, const Resource::ObjectCache::EvictionCandidate& right)
+    {
+        return left._lastAccess > right._lastAccess;
+    }
+
+}
 
 namespace Resource
 {
 
+OpenThreads::Atomic ObjectCache::_accessCounter;
+
 ////////////////////////////////////////////////////////////////////////////////////////////
 //
 // ObjectCache
@@ -32,54 +87,93 @@ ObjectCache::~ObjectCache()
 {
 }
 
-void ObjectCache::addEntryToObjectCache(const std::string& filename, osg::Object* object, double timestamp)
+ObjectCache::Shard& ObjectCache::getShard(const std::string& fileName)
+{
+    return _shards[std::hash<std::string>()(fileName) % NumShards];
+}
+
+void ObjectCache::addEntryToObjectCache(const std::string& filename, osg::Object* object, double timestamp, std::size_t size)
 {
     if (!object)
     {
         OSG_ALWAYS << " trying to add NULL object to cache for " << filename << std::endl;
         return;
     }
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-    _objectCache[filename]=ObjectTimeStampPair(object,timestamp);
+
+    ObjectCacheEntry entry;
+    entry._object = object;
+    entry._timeStamp = timestamp;
+    entry._size = (size ? size : estimateSize(object)) + filename.size();
+    entry._lastAccess = ++_accessCounter;
+
+    osg::ref_ptr<osg::Object> replaced;
+    {
+        Shard& shard = getShard(filename);
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+        ObjectCacheEntry& cached = shard._objectCache[filename];
+        replaced = cached._object;
+        if (replaced)
+            shard._memoryUsage -= cached._size;
+        cached = entry;
+        shard._memoryUsage += entry._size;
+    }
 }
 
 osg::ref_ptr<osg::Object> ObjectCache::getRefFromObjectCache(const std::string& fileName)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-    ObjectCacheMap::iterator itr = _objectCache.find(fileName);
-    if (itr!=_objectCache.end())
+    Shard& shard = getShard(fileName);
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+    ObjectCacheMap::iterator itr = shard._objectCache.find(fileName);
+    if (itr!=shard._objectCache.end())
     {
-        return itr->second.first;
+        ++shard._numHits;
+        itr->second._lastAccess = ++_accessCounter;
+        return itr->second._object;
+    }
+    else
+    {
+        ++shard._numMisses;
+        return 0;
     }
-    else return 0;
 }
 
 bool ObjectCache::checkInObjectCache(const std::string &fileName, double timeStamp)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-    ObjectCacheMap::iterator itr = _objectCache.find(fileName);
-    if (itr!=_objectCache.end())
+    Shard& shard = getShard(fileName);
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+    ObjectCacheMap::iterator itr = shard._objectCache.find(fileName);
+    if (itr!=shard._objectCache.end())
     {
-        itr->second.second = timeStamp;
+        ++shard._numHits;
+        itr->second._timeStamp = timeStamp;
+        itr->second._lastAccess = ++_accessCounter;
         return true;
     }
-    else return false;
+    else
+    {
+        ++shard._numMisses;
+        return false;
+    }
 }
 
 void ObjectCache::updateTimeStampOfObjectsInCacheWithExternalReferences(double referenceTime)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-
-    // look for objects with external references and update their time stamp.
-    for(ObjectCacheMap::iterator itr=_objectCache.begin();
-        itr!=_objectCache.end();
-        ++itr)
+    for (unsigned int i = 0; i < NumShards; ++i)
     {
-        // if ref count is greater the 1 the object has an external reference.
-        if (itr->second.first->referenceCount()>1)
+        Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+
+        // look for objects with external references and update their time stamp.
+        for(ObjectCacheMap::iterator itr=shard._objectCache.begin();
+            itr!=shard._objectCache.end();
+            ++itr)
         {
-            // so update it time stamp.
-            itr->second.second = referenceTime;
+            // if ref count is greater the 1 the object has an external reference.
+            if (itr->second._object->referenceCount()>1)
+            {
+                // so update it time stamp.
+                itr->second._timeStamp = referenceTime;
+            }
         }
     }
 }
@@ -88,17 +182,21 @@ void ObjectCache::removeExpiredObjectsInCache(double expiryTime)
 {
     std::vector<osg::ref_ptr<osg::Object> > objectsToRemove;
 
+    for (unsigned int i = 0; i < NumShards; ++i)
     {
-        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
+        Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
 
         // Remove expired entries from object cache
-        ObjectCacheMap::iterator oitr = _objectCache.begin();
-        while(oitr != _objectCache.end())
+        ObjectCacheMap::iterator oitr = shard._objectCache.begin();
+        while(oitr != shard._objectCache.end())
         {
-            if (oitr->second.second<=expiryTime)
+            if (oitr->second._timeStamp<=expiryTime)
             {
-                objectsToRemove.push_back(oitr->second.first);
-                _objectCache.erase(oitr++);
+                objectsToRemove.push_back(oitr->second._object);
+                shard._memoryUsage -= oitr->second._size;
+                ++shard._numEvictions;
+                shard._objectCache.erase(oitr++);
             }
             else
             {
@@ -113,52 +211,186 @@ void ObjectCache::removeExpiredObjectsInCache(double expiryTime)
 
 void ObjectCache::removeFromObjectCache(const std::string& fileName)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-    ObjectCacheMap::iterator itr = _objectCache.find(fileName);
-    if (itr!=_objectCache.end()) _objectCache.erase(itr);
+    osg::ref_ptr<osg::Object> removed;
+    {
+        Shard& shard = getShard(fileName);
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+        ObjectCacheMap::iterator itr = shard._objectCache.find(fileName);
+        if (itr!=shard._objectCache.end())
+        {
+            removed = itr->second._object;
+            shard._memoryUsage -= itr->second._size;
+            shard._objectCache.erase(itr);
+        }
+    }
 }
 
 void ObjectCache::clear()
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-    _objectCache.clear();
+    for (unsigned int i = 0; i < NumShards; ++i)
+    {
+        Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+        shard._objectCache.clear();
+        shard._memoryUsage = 0;
+    }
 }
 
 void ObjectCache::releaseGLObjects(osg::State* state)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-
-    for(ObjectCacheMap::iterator itr = _objectCache.begin();
-        itr != _objectCache.end();
-        ++itr)
+    for (unsigned int i = 0; i < NumShards; ++i)
     {
-        osg::Object* object = itr->second.first.get();
-        object->releaseGLObjects(state);
+        Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+
+        for(ObjectCacheMap::iterator itr = shard._objectCache.begin();
+            itr != shard._objectCache.end();
+            ++itr)
+        {
+            osg::Object* object = itr->second._object.get();
+            object->releaseGLObjects(state);
+        }
     }
 }
 
 void ObjectCache::accept(osg::NodeVisitor &nv)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-
-    for(ObjectCacheMap::iterator itr = _objectCache.begin();
-        itr != _objectCache.end();
-        ++itr)
+    for (unsigned int i = 0; i < NumShards; ++i)
     {
-        osg::Object* object = itr->second.first.get();
-        if (object)
+        Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+
+        for(ObjectCacheMap::iterator itr = shard._objectCache.begin();
+            itr != shard._objectCache.end();
+            ++itr)
         {
-            osg::Node* node = dynamic_cast<osg::Node*>(object);
-            if (node)
-                node->accept(nv);
+            osg::Object* object = itr->second._object.get();
+            if (object)
+            {
+                osg::Node* node = dynamic_cast<osg::Node*>(object);
+                if (node)
+                    node->accept(nv);
+            }
         }
     }
 }
 
 unsigned int ObjectCache::getCacheSize() const
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-    return _objectCache.size();
+    unsigned int size = 0;
+    for (unsigned int i = 0; i < NumShards; ++i)
+    {
+        const Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+        size += shard._objectCache.size();
+    }
+    return size;
+}
+
+ObjectCache::Stats ObjectCache::getStats() const
+{
+    Stats stats;
+    stats._numObjects = 0;
+    stats._memoryUsage = 0;
+    stats._numHits = 0;
+    stats._numMisses = 0;
+    stats._numEvictions = 0;
+    for (unsigned int i = 0; i < NumShards; ++i)
+    {
+        const Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+        stats._numObjects += shard._objectCache.size();
+        stats._memoryUsage += shard._memoryUsage;
+        stats._numHits += shard._numHits;
+        stats._numMisses += shard._numMisses;
+        stats._numEvictions += shard._numEvictions;
+    }
+    return stats;
+}
+
+void ObjectCache::getEvictionCandidates(std::vector<EvictionCandidate> &candidates)
+{
+    for (unsigned int i = 0; i < NumShards; ++i)
+    {
+        Shard& shard = _shards[i];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+
+        for(ObjectCacheMap::iterator itr = shard._objectCache.begin();
+            itr != shard._objectCache.end();
+            ++itr)
+        {
+            if (itr->second._object->referenceCount()>1)
+                continue;
+
+            EvictionCandidate candidate;
+            candidate._cache = this;
+            candidate._fileName = itr->first;
+            candidate._size = itr->second._size;
+            candidate._lastAccess = itr->second._lastAccess;
+            candidates.push_back(candidate);
+        }
+    }
+}
+
+std::size_t ObjectCache::evict(const std::string &fileName)
+{
+    osg::ref_ptr<osg::Object> removed;
+    std::size_t size = 0;
+    {
+        Shard& shard = getShard(fileName);
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+        ObjectCacheMap::iterator itr = shard._objectCache.find(fileName);
+        if (itr == shard._objectCache.end() || itr->second._object->referenceCount()>1)
+            return 0;
+
+        removed = itr->second._object;
+        size = itr->second._size;
+        shard._memoryUsage -= size;
+        ++shard._numEvictions;
+        shard._objectCache.erase(itr);
+    }
+
+    // note, actual unref happens outside of the lock
+    return size;
+}
+
+void ObjectCache::removeLeastRecentlyUsedObjects(const std::vector<ObjectCache*>& caches, std::size_t memoryBudget)
+{
+    std::size_t memoryUsage = 0;
+    for (std::vector<ObjectCache*>::const_iterator it = caches.begin(); it != caches.end(); ++it)
+        memoryUsage += (*it)->getStats()._memoryUsage;
+    if (memoryUsage <= memoryBudget)
+        return;
+
+    std::vector<EvictionCandidate> candidates;
+    for (std::vector<ObjectCache*>::const_iterator it = caches.begin(); it != caches.end(); ++it)
+        (*it)->getEvictionCandidates(candidates);
+
+    // usually only a few objects need to go, so only order as many candidates as are evicted
+    std::make_heap(candidates.begin(), candidates.end(), compareLastAccess);
+    std::vector<EvictionCandidate>::iterator end = candidates.end();
+    while (end != candidates.begin() && memoryUsage > memoryBudget)
+    {
+        std::pop_heap(candidates.begin(), end, compareLastAccess);
+        --end;
+        memoryUsage -= std::min(memoryUsage, end->_cache->evict(end->_fileName));
+    }
+}
+
+std::size_t ObjectCache::estimateSize(const osg::Object* object)
+{
+    std::size_t size = sizeof(ObjectCacheEntry);
+
+    if (const osg::Image* image = dynamic_cast<const osg::Image*>(object))
+        size += image->getTotalSizeInBytesIncludingMipmaps();
+    else if (const osg::Node* node = dynamic_cast<const osg::Node*>(object))
+    {
+        SizeVisitor visitor;
+        const_cast<osg::Node*>(node)->accept(visitor);
+        size += visitor.mSize;
+    }
+
+    return size;
 }
 
 }
@@ -1,5 +1,6 @@
 // Resource ObjectCache for OpenMW, forked from osgDB ObjectCache by Robert Osfield, see copyright notice below.
-// The main change from the upstream version is that removeExpiredObjectsInCache no longer keeps a lock while the unref happens.
+// The main changes from the upstream version are that removeExpiredObjectsInCache no longer keeps a lock while the unref happens,
+// that the cache is split into independently locked shards, and that it keeps track of its memory usage for LRU eviction.
 
 /* -*-c++-*- OpenSceneGraph - Copyright (C) 1998-2006 Robert Osfield
  *
@@ -20,8 +21,14 @@
 #include <osg/Referenced>
 #include <osg/ref_ptr>
 
+#include <OpenThreads/Atomic>
+#include <OpenThreads/Mutex>
+#include <OpenThreads/ScopedLock>
+
+#include <cstddef>
 #include <string>
 #include <map>
+#include <vector>
 
 namespace osg
 {
@@ -55,8 +62,9 @@ class ObjectCache : public osg::Referenced
         /** Remove all objects in the cache regardless of having external references or expiry times.*/
         void clear();
 
-        /** Add a filename,object,timestamp triple to the Registry::ObjectCache.*/
-        void addEntryToObjectCache(const std::string& filename, osg::Object* object, double timestamp = 0.0);
+        /** Add a filename,object,timestamp triple to the Registry::ObjectCache.
+          * The size is the approximate memory used by the object in bytes; pass 0 to have it estimated with estimateSize().*/
+        void addEntryToObjectCache(const std::string& filename, osg::Object* object, double timestamp = 0.0, std::size_t size = 0);
 
         /** Remove Object from cache.*/
         void removeFromObjectCache(const std::string& fileName);
@@ -77,23 +85,118 @@ class ObjectCache : public osg::Referenced
         template <class Functor>
         void call(Functor& f)
         {
-            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(_objectCacheMutex);
-            for (ObjectCacheMap::iterator it = _objectCache.begin(); it != _objectCache.end(); ++it)
-                f(it->second.first.get());
+            for (unsigned int i = 0; i < NumShards; ++i)
+            {
+                Shard& shard = _shards[i];
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+                for (ObjectCacheMap::iterator it = shard._objectCache.begin(); it != shard._objectCache.end(); ++it)
+                    f(it->second._object.get());
+            }
+        }
+
+        /** Remove the objects whose file name the predicate returns true for, regardless of having external references. */
+        template <class Predicate>
+        void removeIf(Predicate& predicate)
+        {
+            std::vector<osg::ref_ptr<osg::Object> > removed;
+            for (unsigned int i = 0; i < NumShards; ++i)
+            {
+                Shard& shard = _shards[i];
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(shard._mutex);
+                for (ObjectCacheMap::iterator it = shard._objectCache.begin(); it != shard._objectCache.end();)
+                {
+                    if (predicate(it->first))
+                    {
+                        removed.push_back(it->second._object);
+                        shard._memoryUsage -= it->second._size;
+                        shard._objectCache.erase(it++);
+                    }
+                    else
+                        ++it;
+                }
+            }
+            // the objects are deleted here, outside of the locks
         }
 
         /** Get the number of objects in the cache. */
         unsigned int getCacheSize() const;
 
+        struct Stats
+        {
+            unsigned int _numObjects;
+            /** Approximate memory used by the objects, in bytes. */
+            std::size_t _memoryUsage;
+            /** Number of lookups that found an object, since the cache was created. */
+            unsigned int _numHits;
+            /** Number of lookups that did not find an object, since the cache was created. */
+            unsigned int _numMisses;
+            /** Number of objects removed because they expired or to stay within the memory budget, since the cache was created. */
+            unsigned int _numEvictions;
+        };
+
+        Stats getStats() const;
+
+        /** An object that is not referenced outside of the cache, and could be evicted. */
+        struct EvictionCandidate
+        {
+            ObjectCache* _cache;
+            std::string _fileName;
+            std::size_t _size;
+            /** Value of a counter shared by all caches at the last time the object was looked up. */
+            unsigned int _lastAccess;
+        };
+
+        /** Append all objects that are not referenced outside of the cache to candidates. */
+        void getEvictionCandidates(std::vector<EvictionCandidate>& candidates);
+
+        /** Remove an object from the cache, unless it has gained an external reference in the meantime.
+          * @return The memory used by the removed object, or 0 if nothing was removed.*/
+        std::size_t evict(const std::string& fileName);
+
+        /** Remove objects that are not referenced outside of the caches, least recently used first, until the
+          * caches together use no more than memoryBudget bytes, or there is nothing left to remove.*/
+        static void removeLeastRecentlyUsedObjects(const std::vector<ObjectCache*>& caches, std::size_t memoryBudget);
+
+        /** Estimate the memory used by an object: the data of images and the drawables of a scene graph.
+          * The images of textures and scene graphs are owned by the image cache, so they are counted there only once.
+          * Objects of other types, or NULL, only count the fixed per-entry overhead.*/
+        static std::size_t estimateSize(const osg::Object* object);
+
     protected:
 
         virtual ~ObjectCache();
 
-        typedef std::pair<osg::ref_ptr<osg::Object>, double >           ObjectTimeStampPair;
-        typedef std::map<std::string, ObjectTimeStampPair >             ObjectCacheMap;
+        struct ObjectCacheEntry
+        {
+            osg::ref_ptr<osg::Object> _object;
+            double _timeStamp;
+            std::size_t _size;
+            unsigned int _lastAccess;
+        };
+
+        typedef std::map<std::string, ObjectCacheEntry >                ObjectCacheMap;
+
+        /** A part of the cache with its own lock, selected by the hash of the file name. */
+        struct Shard
+        {
+            Shard() : _memoryUsage(0), _numHits(0), _numMisses(0), _numEvictions(0) {}
+
+            ObjectCacheMap                      _objectCache;
+            mutable OpenThreads::Mutex          _mutex;
+            std::size_t                         _memoryUsage;
+            unsigned int                        _numHits;
+            unsigned int                        _numMisses;
+            unsigned int                        _numEvictions;
+        };
+
+        enum { NumShards = 16 };
+
+        Shard& getShard(const std::string& fileName);
+
+        Shard                                   _shards[NumShards];
 
-        ObjectCacheMap                          _objectCache;
-        mutable OpenThreads::Mutex              _objectCacheMutex;
+        /** Shared by all caches, so that access times of objects in different caches can be compared. */
+        static OpenThreads::Atomic              _accessCounter;
 
 };
 
@@ -1,5 +1,7 @@
 #include "resourcemanager.hpp"
 
+#include <osg/Stats>
+
 #include "objectcache.hpp"
 
 namespace Resource
@@ -43,4 +45,19 @@ namespace Resource
         mCache->releaseGLObjects(state);
     }
 
+    ObjectCache* ResourceManager::getObjectCache()
+    {
+        return mCache.get();
+    }
+
+    void ResourceManager::reportCacheStats(unsigned int frameNumber, osg::Stats *stats, const std::string &name) const
+    {
+        ObjectCache::Stats cacheStats = mCache->getStats();
+        stats->setAttribute(frameNumber, name, cacheStats._numObjects);
+        stats->setAttribute(frameNumber, name + " Memory", cacheStats._memoryUsage / (1024.0 * 1024.0));
+        stats->setAttribute(frameNumber, name + " Hits", cacheStats._numHits);
+        stats->setAttribute(frameNumber, name + " Misses", cacheStats._numMisses);
+        stats->setAttribute(frameNumber, name + " Evictions", cacheStats._numEvictions);
+    }
+
 }
@@ -1,6 +1,8 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_MANAGER_H
 #define OPENMW_COMPONENTS_RESOURCE_MANAGER_H
 
+#include <string>
+
 #include <osg/ref_ptr>
 
 namespace VFS
@@ -41,7 +43,13 @@ namespace Resource
 
         virtual void releaseGLObjects(osg::State* state);
 
+        ObjectCache* getObjectCache();
+
     protected:
+        /// Report the number of cached objects as \a name, and the memory usage, hits, misses and evictions of the cache
+        /// as "<name> Memory" (in megabytes), "<name> Hits", "<name> Misses" and "<name> Evictions".
+        void reportCacheStats(unsigned int frameNumber, osg::Stats* stats, const std::string& name) const;
+
         const VFS::Manager* mVFS;
         osg::ref_ptr<Resource::ObjectCache> mCache;
         double mExpiryDelay;
@@ -6,12 +6,16 @@
 #include "imagemanager.hpp"
 #include "niffilemanager.hpp"
 #include "keyframemanager.hpp"
+#include "objectcache.hpp"
+
+#include <osg/Stats>
 
 namespace Resource
 {
 
     ResourceSystem::ResourceSystem(const VFS::Manager *vfs)
         : mVFS(vfs)
+        , mMemoryBudget(0)
     {
         mNifFileManager.reset(new NifFileManager(vfs));
         mKeyframeManager.reset(new KeyframeManager(vfs));
@@ -62,10 +66,23 @@ namespace Resource
         mNifFileManager->setExpiryDelay(0.0);
     }
 
+    void ResourceSystem::setMemoryBudget(std::size_t memoryBudget)
+    {
+        mMemoryBudget = memoryBudget;
+    }
+
     void ResourceSystem::updateCache(double referenceTime)
     {
         for (std::vector<ResourceManager*>::iterator it = mResourceManagers.begin(); it != mResourceManagers.end(); ++it)
             (*it)->updateCache(referenceTime);
+
+        if (mMemoryBudget != 0)
+        {
+            std::vector<ObjectCache*> caches;
+            for (std::vector<ResourceManager*>::iterator it = mResourceManagers.begin(); it != mResourceManagers.end(); ++it)
+                caches.push_back((*it)->getObjectCache());
+            ObjectCache::removeLeastRecentlyUsedObjects(caches, mMemoryBudget);
+        }
     }
 
     void ResourceSystem::clearCache()
@@ -93,8 +110,26 @@ namespace Resource
 
     void ResourceSystem::reportStats(unsigned int frameNumber, osg::Stats *stats) const
     {
+        ObjectCache::Stats total;
+        total._memoryUsage = 0;
+        total._numHits = 0;
+        total._numMisses = 0;
+        total._numEvictions = 0;
         for (std::vector<ResourceManager*>::const_iterator it = mResourceManagers.begin(); it != mResourceManagers.end(); ++it)
+        {
             (*it)->reportStats(frameNumber, stats);
+
+            ObjectCache::Stats cacheStats = (*it)->getObjectCache()->getStats();
+            total._memoryUsage += cacheStats._memoryUsage;
+            total._numHits += cacheStats._numHits;
+            total._numMisses += cacheStats._numMisses;
+            total._numEvictions += cacheStats._numEvictions;
+        }
+
+        stats->setAttribute(frameNumber, "Cache Memory", total._memoryUsage / (1024.0 * 1024.0));
+        stats->setAttribute(frameNumber, "Cache Hits", total._numHits);
+        stats->setAttribute(frameNumber, "Cache Misses", total._numMisses);
+        stats->setAttribute(frameNumber, "Cache Evictions", total._numEvictions);
     }
 
     void ResourceSystem::releaseGLObjects(osg::State *state)
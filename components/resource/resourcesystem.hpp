@@ -1,6 +1,7 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_RESOURCESYSTEM_H
 #define OPENMW_COMPONENTS_RESOURCE_RESOURCESYSTEM_H
 
+#include <cstddef>
 #include <memory>
 #include <vector>
 
@@ -56,6 +57,11 @@ namespace Resource
         /// How long to keep objects in cache after no longer being referenced.
         void setExpiryDelay(double expiryDelay);
 
+        /// Approximate amount of memory (in bytes) that the caches of all resource managers may use together. When it is
+        /// exceeded, updateCache() also drops the least recently used objects that are no longer referenced, even if they
+        /// have not expired yet. 0 means no limit (default).
+        void setMemoryBudget(std::size_t memoryBudget);
+
         /// @note May be called from any thread.
         const VFS::Manager* getVFS() const;
 
@@ -76,6 +82,8 @@ namespace Resource
 
         const VFS::Manager* mVFS;
 
+        std::size_t mMemoryBudget;
+
         ResourceSystem(const ResourceSystem&);
         void operator = (const ResourceSystem&);
     };
@@ -0,0 +1,331 @@
+#include "scenefilecache.hpp"
+
+#include <iostream>
+#include <sstream>
+#include <iomanip>
+
+#include <boost/filesystem.hpp>
+#include <boost/filesystem/fstream.hpp>
+
+#include <osg/Texture>
+#include <osg/UserDataContainer>
+
+#include <osgDB/ObjectWrapper>
+#include <osgDB/Registry>
+#include <osgDB/Serializer>
+
+#include <components/nifosg/userdata.hpp>
+#include <components/sceneutil/serialize.hpp>
+#include <components/vfs/archive.hpp>
+
+namespace
+{
+
+    /// Bump when the cached data changes in a way the stamps and signatures do not cover
+    const char* const sHeader = "OpenMW scene cache 1\n";
+
+    const char* const sExtension = "osgb";
+
+    bool checkNodeUserData(const NifOsg::NodeUserData&)
+    {
+        return true;
+    }
+
+    bool readNodeUserData(osgDB::InputStream& is, NifOsg::NodeUserData& data)
+    {
+        is >> data.mIndex >> data.mScale;
+        for (int i=0; i<3; ++i)
+            for (int j=0; j<3; ++j)
+                is >> data.mRotationScale.mValues[i][j];
+        return true;
+    }
+
+    bool writeNodeUserData(osgDB::OutputStream& os, const NifOsg::NodeUserData& data)
+    {
+        os << data.mIndex << data.mScale;
+        for (int i=0; i<3; ++i)
+            for (int j=0; j<3; ++j)
+                os << data.mRotationScale.mValues[i][j];
+        os << std::endl;
+        return true;
+    }
+
+    osg::Object* createNodeUserData()
+    {
+        return new NifOsg::NodeUserData;
+    }
+
+    /// NodeUserData is part of almost every NIF scene, so unlike the other NifOsg classes it is serialized for real.
+    class NodeUserDataSerializer : public osgDB::ObjectWrapper
+    {
+    public:
+        NodeUserDataSerializer()
+            : osgDB::ObjectWrapper(createNodeUserData, "NifOsg::NodeUserData", "osg::Object NifOsg::NodeUserData")
+        {
+            addSerializer(new osgDB::UserSerializer<NifOsg::NodeUserData>(
+                "Data", &checkNodeUserData, &readNodeUserData, &writeNodeUserData), osgDB::BaseSerializer::RW_USER);
+        }
+    };
+
+    void registerCacheSerializers()
+    {
+        static bool done = false;
+        if (done)
+            return;
+
+        SceneUtil::registerSerializers();
+        SceneUtil::registerGeometrySerializers();
+
+        osgDB::ObjectWrapperManager* mgr = osgDB::Registry::instance()->getObjectWrapperManager();
+        if (osgDB::ObjectWrapper* dummy = mgr->findWrapper("NifOsg::NodeUserData"))
+            mgr->removeWrapper(dummy);
+        mgr->addWrapper(new NodeUserDataSerializer);
+
+        done = true;
+    }
+
+    /// Objects of these classes are stored completely by their serializers
+    bool isSerializable(const osg::Object& object)
+    {
+        const std::string library = object.libraryName();
+        if (library == "osg")
+            return true;
+        const std::string className = object.className();
+        return (library == "SceneUtil" && className == "PositionAttitudeTransform")
+            || (library == "NifOsg" && className == "NodeUserData");
+    }
+
+    bool canCacheStateSet(const osg::StateSet& stateset)
+    {
+        if (!isSerializable(stateset) || stateset.getUpdateCallback() || stateset.getEventCallback())
+            return false;
+
+        const osg::StateSet::AttributeList& attributes = stateset.getAttributeList();
+        for (osg::StateSet::AttributeList::const_iterator it = attributes.begin(); it != attributes.end(); ++it)
+        {
+            const osg::StateAttribute* attribute = it->second.first.get();
+            // Programs are created by the ShaderVisitor, which runs again on the cached scene instead
+            if (!isSerializable(*attribute) || attribute->getUpdateCallback() || attribute->getEventCallback()
+                    || attribute->getType() == osg::StateAttribute::PROGRAM)
+                return false;
+        }
+
+        const osg::StateSet::TextureAttributeList& textureAttributes = stateset.getTextureAttributeList();
+        for (osg::StateSet::TextureAttributeList::const_iterator unit = textureAttributes.begin(); unit != textureAttributes.end(); ++unit)
+        {
+            for (osg::StateSet::AttributeList::const_iterator it = unit->begin(); it != unit->end(); ++it)
+            {
+                const osg::StateAttribute* attribute = it->second.first.get();
+                if (!isSerializable(*attribute) || attribute->getUpdateCallback() || attribute->getEventCallback())
+                    return false;
+
+                // Textures are loaded through the ImageManager again, so they need to have a file name
+                if (const osg::Texture* texture = attribute->asTexture())
+                {
+                    for (unsigned int i=0; i<texture->getNumImages(); ++i)
+                    {
+                        const osg::Image* image = texture->getImage(i);
+                        if (!image || image->getFileName().empty())
+                            return false;
+                    }
+                }
+            }
+        }
+
+        const osg::StateSet::UniformList& uniforms = stateset.getUniformList();
+        for (osg::StateSet::UniformList::const_iterator it = uniforms.begin(); it != uniforms.end(); ++it)
+        {
+            const osg::Uniform* uniform = it->second.first.get();
+            if (!isSerializable(*uniform) || uniform->getUpdateCallback() || uniform->getEventCallback())
+                return false;
+        }
+        return true;
+    }
+
+    class CanCacheVisitor : public osg::NodeVisitor
+    {
+    public:
+        CanCacheVisitor()
+            : osg::NodeVisitor(TRAVERSE_ALL_CHILDREN)
+            , mCanCache(true)
+        {
+        }
+
+        virtual void apply(osg::Node& node)
+        {
+            if (!mCanCache)
+                return;
+
+            if (!canCacheNode(node))
+            {
+                mCanCache = false;
+                return;
+            }
+
+            traverse(node);
+        }
+
+        bool canCacheNode(const osg::Node& node) const
+        {
+            if (!isSerializable(node))
+                return false;
+
+            if (node.getUpdateCallback() || node.getEventCallback() || node.getCullCallback()
+                    || node.getComputeBoundingSphereCallback())
+                return false;
+
+            if (const osg::Drawable* drawable = node.asDrawable())
+            {
+                if (drawable->getDrawCallback() || drawable->getComputeBoundingBoxCallback())
+                    return false;
+            }
+
+            if (const osg::UserDataContainer* container = node.getUserDataContainer())
+            {
+                if (!isSerializable(*container) || container->getUserData())
+                    return false;
+                for (unsigned int i=0; i<container->getNumUserObjects(); ++i)
+                {
+                    const osg::Object* object = container->getUserObject(i);
+                    if (!object || !isSerializable(*object))
+                        return false;
+                }
+            }
+
+            if (node.getStateSet() && !canCacheStateSet(*node.getStateSet()))
+                return false;
+
+            return true;
+        }
+
+        bool mCanCache;
+    };
+
+    std::string hashName(const std::string& name)
+    {
+        // FNV-1a, so file names stay the same across builds
+        unsigned long long hash = 14695981039346656037ULL;
+        for (std::string::const_iterator it = name.begin(); it != name.end(); ++it)
+        {
+            hash ^= static_cast<unsigned char>(*it);
+            hash *= 1099511628211ULL;
+        }
+
+        std::ostringstream stream;
+        stream << std::hex << std::setw(16) << std::setfill('0') << hash;
+        return stream.str();
+    }
+
+    osgDB::ReaderWriter* getReaderWriter()
+    {
+        osgDB::ReaderWriter* reader = osgDB::Registry::instance()->getReaderWriterForExtension(sExtension);
+        if (!reader)
+            throw std::runtime_error(std::string("no readerwriter for '") + sExtension + "' found");
+        return reader;
+    }
+
+}
+
+namespace Resource
+{
+
+    SceneFileCache::SceneFileCache(const std::string& path, const std::string& signature)
+        : mPath(path)
+        , mSignature(signature)
+    {
+        registerCacheSerializers();
+
+        boost::filesystem::create_directories(mPath);
+    }
+
+    osg::ref_ptr<osg::Node> SceneFileCache::read(const std::string& normalizedName, const VFS::File& source, const osgDB::Options* options) const
+    {
+        std::string contents;
+        try
+        {
+            boost::filesystem::path path (getFileName(normalizedName));
+            if (!boost::filesystem::exists(path))
+                return NULL;
+
+            boost::filesystem::ifstream file (path, std::ios::binary);
+            std::ostringstream buffer;
+            buffer << file.rdbuf();
+            contents = buffer.str();
+
+            const std::string header = getHeader(normalizedName, source);
+            if (contents.compare(0, header.size(), header) != 0)
+                return NULL;
+
+            std::istringstream stream (contents.substr(header.size()));
+            osgDB::ReaderWriter::ReadResult result = getReaderWriter()->readNode(stream, options);
+            if (!result.success())
+            {
+                std::cerr << "Warning: failed to read cached scene for " << normalizedName << ": " << result.message() << std::endl;
+                return NULL;
+            }
+            return result.getNode();
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Warning: failed to read cached scene for " << normalizedName << ": " << e.what() << std::endl;
+            return NULL;
+        }
+    }
+
+    bool SceneFileCache::write(const std::string& normalizedName, const VFS::File& source, const osg::Node& node) const
+    {
+        if (!canCache(node))
+            return false;
+
+        try
+        {
+            const boost::filesystem::path path (getFileName(normalizedName));
+            // Write to a temporary file first, so other threads or processes never see a partially written scene
+            const boost::filesystem::path temporaryPath = path.string() + boost::filesystem::unique_path(".%%%%%%%%.tmp").string();
+            {
+                boost::filesystem::ofstream file (temporaryPath, std::ios::binary);
+                file << getHeader(normalizedName, source);
+
+                osg::ref_ptr<osgDB::Options> options (new osgDB::Options("WriteImageHint=UseExternal"));
+                osgDB::ReaderWriter::WriteResult result = getReaderWriter()->writeNode(node, file, options);
+                if (!result.success() || !file)
+                {
+                    file.close();
+                    boost::filesystem::remove(temporaryPath);
+                    std::cerr << "Warning: failed to cache scene " << normalizedName << ": " << result.message() << std::endl;
+                    return false;
+                }
+            }
+            boost::filesystem::rename(temporaryPath, path);
+            return true;
+        }
+        catch (std::exception& e)
+        {
+            std::cerr << "Warning: failed to cache scene " << normalizedName << ": " << e.what() << std::endl;
+            return false;
+        }
+    }
+
+    bool SceneFileCache::canCache(const osg::Node& node)
+    {
+        CanCacheVisitor visitor;
+        const_cast<osg::Node&>(node).accept(visitor);
+        return visitor.mCanCache;
+    }
+
+    const std::string& SceneFileCache::getPath() const
+    {
+        return mPath;
+    }
+
+    std::string SceneFileCache::getFileName(const std::string& normalizedName) const
+    {
+        return (boost::filesystem::path(mPath) / (hashName(normalizedName) + "." + sExtension)).string();
+    }
+
+    std::string SceneFileCache::getHeader(const std::string& normalizedName, const VFS::File& source) const
+    {
+        return sHeader + normalizedName + "\n" + source.getStamp() + "\n" + mSignature + "\n";
+    }
+
+}
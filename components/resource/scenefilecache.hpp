@@ -0,0 +1,62 @@
+#ifndef OPENMW_COMPONENTS_RESOURCE_SCENEFILECACHE_H
+#define OPENMW_COMPONENTS_RESOURCE_SCENEFILECACHE_H
+
+#include <string>
+
+#include <osg/ref_ptr>
+#include <osg/Node>
+
+namespace osgDB
+{
+    class Options;
+}
+
+namespace VFS
+{
+    class File;
+}
+
+namespace Resource
+{
+
+    /// @brief Persistent cache of converted and optimized scene templates on disk, stored in the osgb format.
+    /// @par Each cached scene is stored along with the stamp of its source file (see VFS::File::getStamp) and the signature
+    /// of the settings it was converted with, and is only used while both still match.
+    /// @par Only scenes made of plain OSG nodes, drawables and state, with textures that are referenced by their file name,
+    /// can be cached. Scenes that rely on custom classes or callbacks (e.g. controllers, particles, skinning) or on shaders
+    /// are always converted from their source file.
+    /// @note Thread safe.
+    class SceneFileCache
+    {
+    public:
+        /// @param path The directory to store the cached scenes in. Created if it does not exist.
+        /// @param signature Describes the settings that affect the converted scenes. Cached scenes that were
+        ///  converted with a different signature are ignored.
+        SceneFileCache(const std::string& path, const std::string& signature);
+
+        /// Read the cached scene converted from \a source.
+        /// @param options Options to read the scene with; these should set a ReadFileCallback to load the textures.
+        /// @return The cached scene, or NULL if there is none, or if it is out of date.
+        osg::ref_ptr<osg::Node> read(const std::string& normalizedName, const VFS::File& source, const osgDB::Options* options) const;
+
+        /// Store the scene converted from \a source, if it can be cached.
+        /// @return Was the scene stored?
+        bool write(const std::string& normalizedName, const VFS::File& source, const osg::Node& node) const;
+
+        /// Can the given scene be stored without losing anything?
+        static bool canCache(const osg::Node& node);
+
+        const std::string& getPath() const;
+
+    private:
+        std::string getFileName(const std::string& normalizedName) const;
+
+        std::string getHeader(const std::string& normalizedName, const VFS::File& source) const;
+
+        std::string mPath;
+        std::string mSignature;
+    };
+
+}
+
+#endif
@@ -1,10 +1,12 @@
 #include "scenemanager.hpp"
 
 #include <iostream>
+#include <sstream>
 #include <cstdlib>
 
 #include <osg/Node>
 #include <osg/UserDataContainer>
+#include <osg/Version>
 
 #include <osgParticle/ParticleSystem>
 
@@ -32,6 +34,7 @@
 #include "niffilemanager.hpp"
 #include "objectcache.hpp"
 #include "multiobjectcache.hpp"
+#include "scenefilecache.hpp"
 
 namespace
 {
@@ -486,30 +489,49 @@ namespace Resource
         else
         {
             osg::ref_ptr<osg::Node> loaded;
-            try
-            {
-                Files::IStreamPtr file = mVFS->get(normalized);
 
-                loaded = load(file, normalized, mImageManager, mNifFileManager);
+            // Scenes read from the file cache have been optimized already
+            const VFS::File* source = NULL;
+            bool cached = false;
+            if (mSceneFileCache)
+            {
+                source = mVFS->find(normalized.c_str(), normalized.size(), mVFS->getHash(normalized.c_str(), normalized.size()));
+                if (source)
+                {
+                    loaded = mSceneFileCache->read(normalized, *source, mSceneFileCacheOptions);
+                    cached = loaded.valid();
+                }
             }
-            catch (std::exception& e)
+
+            if (!loaded)
             {
-                static const char * const sMeshTypes[] = { "nif", "osg", "osgt", "osgb", "osgx", "osg2" };
+                try
+                {
+                    Files::IStreamPtr file = mVFS->get(normalized);
 
-                for (unsigned int i=0; i<sizeof(sMeshTypes)/sizeof(sMeshTypes[0]); ++i)
+                    loaded = load(file, normalized, mImageManager, mNifFileManager);
+                }
+                catch (std::exception& e)
                 {
-                    normalized = "meshes/marker_error." + std::string(sMeshTypes[i]);
-                    if (mVFS->exists(normalized))
+                    source = NULL;
+
+                    static const char * const sMeshTypes[] = { "nif", "osg", "osgt", "osgb", "osgx", "osg2" };
+
+                    for (unsigned int i=0; i<sizeof(sMeshTypes)/sizeof(sMeshTypes[0]); ++i)
                     {
-                        std::cerr << "Failed to load '" << name << "': " << e.what() << ", using marker_error." << sMeshTypes[i] << " instead" << std::endl;
-                        Files::IStreamPtr file = mVFS->get(normalized);
-                        loaded = load(file, normalized, mImageManager, mNifFileManager);
-                        break;
+                        normalized = "meshes/marker_error." + std::string(sMeshTypes[i]);
+                        if (mVFS->exists(normalized))
+                        {
+                            std::cerr << "Failed to load '" << name << "': " << e.what() << ", using marker_error." << sMeshTypes[i] << " instead" << std::endl;
+                            Files::IStreamPtr file = mVFS->get(normalized);
+                            loaded = load(file, normalized, mImageManager, mNifFileManager);
+                            break;
+                        }
                     }
-                }
 
-                if (!loaded)
-                    throw;
+                    if (!loaded)
+                        throw;
+                }
             }
 
             // set filtering settings
@@ -528,7 +550,7 @@ namespace Resource
             mSharedStateManager->share(loaded.get());
             mSharedStateMutex.unlock();
 
-            if (canOptimize(normalized))
+            if (!cached && canOptimize(normalized))
             {
                 SceneUtil::Optimizer optimizer;
                 optimizer.setIsOperationPermissibleForObjectCallback(new CanOptimizeCallback);
@@ -538,6 +560,9 @@ namespace Resource
                 optimizer.optimize(loaded, options);
             }
 
+            if (source && !cached)
+                mSceneFileCache->write(normalized, *source, *loaded);
+
             if (mIncrementalCompileOperation)
                 mIncrementalCompileOperation->add(loaded);
 
@@ -546,6 +571,25 @@ namespace Resource
         }
     }
 
+    void SceneManager::setSceneFileCachePath(const std::string &path)
+    {
+        if (path.empty())
+        {
+            mSceneFileCache.reset();
+            mSceneFileCacheOptions = NULL;
+            return;
+        }
+
+        // Anything that changes the converted scenes without changing their source files
+        std::ostringstream signature;
+        signature << "osg " << osgGetVersion() << " optimize " << getOptimizationOptions();
+
+        mSceneFileCache.reset(new SceneFileCache(path, signature.str()));
+
+        mSceneFileCacheOptions = new osgDB::Options;
+        mSceneFileCacheOptions->setReadFileCallback(new ImageReadCallback(mImageManager));
+    }
+
     osg::ref_ptr<osg::Node> SceneManager::cacheInstance(const std::string &name)
     {
         std::string normalized = name;
@@ -738,7 +782,7 @@ namespace Resource
             stats->setAttribute(frameNumber, "StateSet", mSharedStateManager->getNumSharedStateSets());
         }
 
-        stats->setAttribute(frameNumber, "Node", mCache->getCacheSize());
+        reportCacheStats(frameNumber, stats, "Node");
         stats->setAttribute(frameNumber, "Node Instance", mInstanceCache->getCacheSize());
     }
 
@@ -16,6 +16,7 @@ namespace Resource
     class ImageManager;
     class NifFileManager;
     class SharedStateManager;
+    class SceneFileCache;
 }
 
 namespace osgUtil
@@ -26,6 +27,7 @@ namespace osgUtil
 namespace osgDB
 {
     class SharedStateManager;
+    class Options;
 }
 
 namespace Shader
@@ -79,6 +81,12 @@ namespace Resource
 
         void setShaderPath(const std::string& path);
 
+        /// Keep converted scenes in a cache on disk, and read them from there instead of converting their source files again.
+        /// @param path The directory of the cache. Pass an empty string to disable the cache (default).
+        /// @note Not thread safe; set up the cache before loading any scenes.
+        /// @see SceneFileCache
+        void setSceneFileCachePath(const std::string& path);
+
         /// Check if a given scene is loaded and if so, update its usage timestamp to prevent it from being unloaded
         bool checkLoaded(const std::string& name, double referenceTime);
 
@@ -164,6 +172,9 @@ namespace Resource
 
         osg::ref_ptr<MultiObjectCache> mInstanceCache;
 
+        std::unique_ptr<SceneFileCache> mSceneFileCache;
+        osg::ref_ptr<osgDB::Options> mSceneFileCacheOptions;
+
         osg::ref_ptr<Resource::SharedStateManager> mSharedStateManager;
         mutable OpenThreads::Mutex mSharedStateMutex;
 
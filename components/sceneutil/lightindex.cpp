@@ -0,0 +1,145 @@
+#include "lightindex.hpp"
+
+#include <algorithm>
+
+namespace
+{
+
+    const unsigned int sMaxLeafSize = 4;
+
+    struct CenterLess
+    {
+        CenterLess(int axis) : mAxis(axis) {}
+
+        template <class T>
+        bool operator() (const T& left, const T& right) const
+        {
+            return left.mBound.center()[mAxis] < right.mBound.center()[mAxis];
+        }
+
+        int mAxis;
+    };
+
+    bool intersects(const osg::BoundingBox& box, const osg::BoundingSphere& sphere)
+    {
+        float distance2 = 0.f;
+        for (int i=0; i<3; ++i)
+        {
+            const float coordinate = sphere.center()[i];
+            if (coordinate < box._min[i])
+                distance2 += (box._min[i] - coordinate) * (box._min[i] - coordinate);
+            else if (coordinate > box._max[i])
+                distance2 += (coordinate - box._max[i]) * (coordinate - box._max[i]);
+        }
+        return distance2 <= sphere.radius2();
+    }
+
+}
+
+namespace SceneUtil
+{
+
+    LightIndex::LightIndex()
+        : mNumLights(0)
+    {
+    }
+
+    void LightIndex::clear()
+    {
+        mNumLights = 0;
+        mLights.clear();
+        mNodes.clear();
+    }
+
+    void LightIndex::add(const osg::BoundingSphere& bound)
+    {
+        const unsigned int index = mNumLights++;
+        if (!bound.valid())
+            return;
+
+        Light light;
+        light.mBound = bound;
+        light.mIndex = index;
+        mLights.push_back(light);
+    }
+
+    void LightIndex::build()
+    {
+        mNodes.clear();
+        if (!mLights.empty())
+            buildNode(0, static_cast<unsigned int>(mLights.size()));
+    }
+
+    unsigned int LightIndex::buildNode(unsigned int first, unsigned int count)
+    {
+        const unsigned int index = static_cast<unsigned int>(mNodes.size());
+        mNodes.push_back(Node());
+
+        osg::BoundingBox bounds;
+        osg::BoundingBox centers;
+        for (unsigned int i=first; i<first+count; ++i)
+        {
+            bounds.expandBy(mLights[i].mBound);
+            centers.expandBy(mLights[i].mBound.center());
+        }
+
+        mNodes[index].mBounds = bounds;
+        mNodes[index].mFirst = first;
+        mNodes[index].mCount = count;
+        mNodes[index].mSecondChild = 0;
+
+        if (count <= sMaxLeafSize)
+            return index;
+
+        // split at the median along the axis the centers are spread the most
+        const osg::Vec3f extents = centers._max - centers._min;
+        int axis = 0;
+        if (extents.y() > extents[axis])
+            axis = 1;
+        if (extents.z() > extents[axis])
+            axis = 2;
+
+        const unsigned int half = count / 2;
+        std::nth_element(mLights.begin() + first, mLights.begin() + first + half, mLights.begin() + first + count, CenterLess(axis));
+
+        buildNode(first, half);
+        const unsigned int secondChild = buildNode(first + half, count - half);
+        mNodes[index].mSecondChild = secondChild;
+        return index;
+    }
+
+    void LightIndex::query(const osg::BoundingSphere& bound, std::vector<unsigned int>& out) const
+    {
+        if (!bound.valid() || mNodes.empty())
+            return;
+
+        const std::size_t start = out.size();
+
+        // median splits keep the depth at log2 of the number of lights
+        unsigned int stack[64];
+        unsigned int stackSize = 0;
+        stack[stackSize++] = 0;
+        while (stackSize)
+        {
+            const Node& node = mNodes[stack[--stackSize]];
+            if (!intersects(node.mBounds, bound))
+                continue;
+
+            if (node.mSecondChild)
+            {
+                stack[stackSize++] = node.mSecondChild;
+                stack[stackSize++] = static_cast<unsigned int>(&node - &mNodes[0]) + 1;
+                continue;
+            }
+
+            for (unsigned int i=node.mFirst; i<node.mFirst+node.mCount; ++i)
+            {
+                if (mLights[i].mBound.intersects(bound))
+                    out.push_back(mLights[i].mIndex);
+            }
+        }
+
+        std::sort(out.begin() + start, out.end());
+    }
+
+}
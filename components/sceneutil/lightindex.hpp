@@ -0,0 +1,61 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_LIGHTINDEX_H
+#define OPENMW_COMPONENTS_SCENEUTIL_LIGHTINDEX_H
+
+#include <vector>
+
+#include <osg/BoundingBox>
+#include <osg/BoundingSphere>
+
+namespace SceneUtil
+{
+
+    /// @brief Bounding volume hierarchy over the bounds of a set of lights, to find the lights that may affect an object
+    /// without testing every light against it.
+    /// @par Lights are identified by the index they were added with. The index is meant to be rebuilt from scratch whenever
+    /// the lights move, e.g. once per frame and camera: add() them all, then call build().
+    class LightIndex
+    {
+    public:
+        LightIndex();
+
+        void clear();
+
+        /// Add the bound of the light with the next index, starting at 0. Lights with an invalid bound are never found.
+        void add(const osg::BoundingSphere& bound);
+
+        /// Build the hierarchy over the lights added since the last clear(). Must be called before querying.
+        void build();
+
+        /// Append the indices of all lights whose bounds intersect @a bound to @a out, in ascending order.
+        void query(const osg::BoundingSphere& bound, std::vector<unsigned int>& out) const;
+
+        /// Number of lights added, including those with an invalid bound.
+        unsigned int size() const { return mNumLights; }
+
+    private:
+        struct Light
+        {
+            osg::BoundingSphere mBound;
+            unsigned int mIndex;
+        };
+
+        struct Node
+        {
+            osg::BoundingBox mBounds;
+            /// Range of the node's lights in mLights
+            unsigned int mFirst;
+            unsigned int mCount;
+            /// Index of the second child in mNodes, the first child directly follows its parent. 0 for leaves.
+            unsigned int mSecondChild;
+        };
+
+        unsigned int buildNode(unsigned int first, unsigned int count);
+
+        unsigned int mNumLights;
+        std::vector<Light> mLights;
+        std::vector<Node> mNodes;
+    };
+
+}
+
+#endif
@@ -209,25 +209,19 @@ namespace SceneUtil
         mLights.push_back(l);
     }
 
-    /* similar to the boost::hash_combine */
-    template <class T>
-    inline void hash_combine(std::size_t& seed, const T& v)
-    {
-        std::hash<T> hasher;
-        seed ^= hasher(v) + 0x9e3779b9 + (seed<<6) + (seed>>2);
-    }
-
     osg::ref_ptr<osg::StateSet> LightManager::getLightListStateSet(const LightList &lightList, unsigned int frameNum)
     {
 
         // possible optimization: return a StateSet containing all requested lights plus some extra lights (if a suitable one exists)
-        size_t hash = 0;
-        for (unsigned int i=0; i<lightList.size();++i)
-            hash_combine(hash, lightList[i]->mLightSource->getId());
+        // key by the IDs themselves rather than a hash of them, so that different light lists can never share a StateSet
+        LightIdList ids;
+        ids.fill(-1);
+        for (unsigned int i=0; i<lightList.size() && i<ids.size(); ++i)
+            ids[i] = lightList[i]->mLightSource->getId();
 
         LightStateSetMap& stateSetCache = mStateSetCache[frameNum%2];
 
-        LightStateSetMap::iterator found = stateSetCache.find(hash);
+        LightStateSetMap::iterator found = stateSetCache.find(ids);
         if (found != stateSetCache.end())
             return found->second;
         else
@@ -254,7 +248,7 @@ namespace SceneUtil
                 stateset->setAttribute(dummy, osg::StateAttribute::ON);
             }
 
-            stateSetCache.insert(std::make_pair(hash, stateset));
+            stateSetCache.insert(std::make_pair(ids, stateset));
             return stateset;
         }
     }
@@ -265,14 +259,34 @@ namespace SceneUtil
     }
 
     const std::vector<LightManager::LightSourceViewBound>& LightManager::getLightsInViewSpace(osg::Camera *camera, const osg::RefMatrix* viewMatrix)
+    {
+        return getOrCreateLightsInViewSpace(camera, viewMatrix).mLights;
+    }
+
+    void LightManager::getLightsInViewSpace(osg::Camera *camera, const osg::RefMatrix *viewMatrix, const osg::BoundingSphere &viewBound, LightList &lightList,
+                                            std::vector<unsigned int>& foundLights)
+    {
+        const LightsInViewSpace& lights = getOrCreateLightsInViewSpace(camera, viewMatrix);
+
+        foundLights.clear();
+        lights.mIndex.query(viewBound, foundLights);
+        for (std::vector<unsigned int>::const_iterator it = foundLights.begin(); it != foundLights.end(); ++it)
+            lightList.push_back(&lights.mLights[*it]);
+    }
+
+    LightManager::LightsInViewSpace& LightManager::getOrCreateLightsInViewSpace(osg::Camera *camera, const osg::RefMatrix *viewMatrix)
     {
         osg::observer_ptr<osg::Camera> camPtr (camera);
-        std::map<osg::observer_ptr<osg::Camera>, LightSourceViewBoundCollection>::iterator it = mLightsInViewSpace.find(camPtr);
+        std::map<osg::observer_ptr<osg::Camera>, LightsInViewSpace>::iterator it = mLightsInViewSpace.find(camPtr);
 
         if (it == mLightsInViewSpace.end())
         {
-            it = mLightsInViewSpace.insert(std::make_pair(camPtr, LightSourceViewBoundCollection())).first;
+            it = mLightsInViewSpace.insert(std::make_pair(camPtr, LightsInViewSpace())).first;
 
+            // built on first use rather than in update(), as the lights are only collected later in the update traversal
+            // and the view matrix is only known during the cull traversal
+            LightsInViewSpace& lights = it->second;
+            lights.mLights.reserve(mLights.size());
             for (std::vector<LightSourceTransform>::iterator lightIt = mLights.begin(); lightIt != mLights.end(); ++lightIt)
             {
                 osg::Matrixf worldViewMat = lightIt->mWorldMatrix * (*viewMatrix);
@@ -282,8 +296,10 @@ namespace SceneUtil
                 LightSourceViewBound l;
                 l.mLightSource = lightIt->mLightSource;
                 l.mViewBound = viewBound;
-                it->second.push_back(l);
+                lights.mLights.push_back(l);
+                lights.mIndex.add(viewBound);
             }
+            lights.mIndex.build();
         }
         return it->second;
     }
@@ -404,7 +420,6 @@ namespace SceneUtil
 
         // Possible optimizations:
         // - cull list of lights by the camera frustum
-        // - organize lights in a quad tree
 
 
         // update light list if necessary
@@ -415,7 +430,6 @@ namespace SceneUtil
 
             // Don't use Camera::getViewMatrix, that one might be relative to another camera!
             const osg::RefMatrix* viewMatrix = cv->getCurrentRenderStage()->getInitialViewMatrix();
-            const std::vector<LightManager::LightSourceViewBound>& lights = mLightManager->getLightsInViewSpace(cv->getCurrentCamera(), viewMatrix);
 
             // get the node bounds in view space
             // NB do not node->getBound() * modelView, that would apply the node's transformation twice
@@ -432,15 +446,17 @@ namespace SceneUtil
             transformBoundingSphere(mat, nodeBound);
 
             mLightList.clear();
-            for (unsigned int i=0; i<lights.size(); ++i)
-            {
-                const LightManager::LightSourceViewBound& l = lights[i];
+            mLightManager->getLightsInViewSpace(cv->getCurrentCamera(), viewMatrix, nodeBound, mLightList, mFoundLights);
 
-                if (mIgnoredLightSources.count(l.mLightSource))
-                    continue;
-
-                if (l.mViewBound.intersects(nodeBound))
-                    mLightList.push_back(&l);
+            if (!mIgnoredLightSources.empty())
+            {
+                for (LightManager::LightList::iterator it = mLightList.begin(); it != mLightList.end(); )
+                {
+                    if (mIgnoredLightSources.count((*it)->mLightSource))
+                        it = mLightList.erase(it);
+                    else
+                        ++it;
+                }
             }
         }
         if (!mLightList.empty())
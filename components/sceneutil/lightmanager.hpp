@@ -1,6 +1,7 @@
 #ifndef OPENMW_COMPONENTS_SCENEUTIL_LIGHTMANAGER_H
 #define OPENMW_COMPONENTS_SCENEUTIL_LIGHTMANAGER_H
 
+#include <array>
 #include <set>
 
 #include <osg/Light>
@@ -9,6 +10,8 @@
 #include <osg/NodeVisitor>
 #include <osg/observer_ptr>
 
+#include <components/sceneutil/lightindex.hpp>
+
 namespace osgUtil
 {
     class CullVisitor;
@@ -127,6 +130,14 @@ namespace SceneUtil
 
         typedef std::vector<const LightSourceViewBound*> LightList;
 
+        /// Append the lights whose view space bounds intersect @a viewBound to @a lightList, in the order of getLightsInViewSpace().
+        /// @par Looks the lights up in a LightIndex that is built once per frame and camera.
+        /// @param foundLights Scratch space for the indices of the lights found, kept by the caller so that it is not
+        /// allocated for every query. Not kept in the LightManager, which is shared by the cull threads.
+        void getLightsInViewSpace(osg::Camera* camera, const osg::RefMatrix* viewMatrix, const osg::BoundingSphere& viewBound, LightList& lightList,
+                                  std::vector<unsigned int>& foundLights);
+
+        /// @param lightList At most 8 lights, the OpenGL limit
         osg::ref_ptr<osg::StateSet> getLightListStateSet(const LightList& lightList, unsigned int frameNum);
 
     private:
@@ -134,10 +145,20 @@ namespace SceneUtil
         std::vector<LightSourceTransform> mLights;
 
         typedef std::vector<LightSourceViewBound> LightSourceViewBoundCollection;
-        std::map<osg::observer_ptr<osg::Camera>, LightSourceViewBoundCollection> mLightsInViewSpace;
 
-        // < Light list hash , StateSet >
-        typedef std::map<size_t, osg::ref_ptr<osg::StateSet> > LightStateSetMap;
+        struct LightsInViewSpace
+        {
+            LightSourceViewBoundCollection mLights;
+            LightIndex mIndex;
+        };
+
+        LightsInViewSpace& getOrCreateLightsInViewSpace(osg::Camera* camera, const osg::RefMatrix* viewMatrix);
+
+        std::map<osg::observer_ptr<osg::Camera>, LightsInViewSpace> mLightsInViewSpace;
+
+        // < Light IDs padded with -1 , StateSet >
+        typedef std::array<int, 8> LightIdList;
+        typedef std::map<LightIdList, osg::ref_ptr<osg::StateSet> > LightStateSetMap;
         LightStateSetMap mStateSetCache[2];
 
         int mStartLight;
@@ -180,6 +201,7 @@ namespace SceneUtil
         LightManager* mLightManager;
         unsigned int mLastFrameNumber;
         LightManager::LightList mLightList;
+        std::vector<unsigned int> mFoundLights;
         std::set<SceneUtil::LightSource*> mIgnoredLightSources;
     };
 
@@ -0,0 +1,209 @@
+#include "profiler.hpp"
+
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#include <OpenThreads/ScopedLock>
+
+#include <boost/filesystem/fstream.hpp>
+#include <boost/filesystem/path.hpp>
+
+namespace
+{
+    void writeJsonString(std::ostream& stream, const std::string& string)
+    {
+        stream << '"';
+        for (std::string::const_iterator it = string.begin(); it != string.end(); ++it)
+        {
+            const unsigned char c = *it;
+            if (c == '"' || c == '\\')
+                stream << '\\' << c;
+            else if (c < 0x20)
+                stream << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec << std::setfill(' ');
+            else
+                stream << c;
+        }
+        stream << '"';
+    }
+}
+
+namespace SceneUtil
+{
+
+    Profiler& Profiler::instance()
+    {
+        static Profiler profiler;
+        return profiler;
+    }
+
+    Profiler::Profiler()
+        : mCaptureStart(0)
+        , mFirstFrame(0)
+        , mLastFrame(0)
+        , mFramesScheduled(false)
+    {
+    }
+
+    void Profiler::setTraceDirectory(const std::string& directory)
+    {
+        mTraceDirectory = directory;
+    }
+
+    void Profiler::startCapture()
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        ++mCaptureId;
+        mCaptureStart = osg::Timer::instance()->tick();
+        mCapturing.exchange(1);
+    }
+
+    bool Profiler::stopCapture()
+    {
+        return mCapturing.exchange(0) != 0;
+    }
+
+    std::string Profiler::writeTraceFile()
+    {
+        std::ostringstream name;
+        const std::time_t time = std::time(NULL);
+        char timestamp[32];
+        std::strftime(timestamp, sizeof(timestamp), "%Y%m%d-%H%M%S", std::localtime(&time));
+        name << "openmw-trace-" << timestamp << ".json";
+        const boost::filesystem::path path = boost::filesystem::path(mTraceDirectory) / name.str();
+
+        boost::filesystem::ofstream stream(path);
+        writeTrace(stream);
+        stream.close();
+        if (stream.fail())
+        {
+            std::cerr << "Error: failed to write profiler trace to " << path.string() << std::endl;
+            return std::string();
+        }
+        return path.string();
+    }
+
+    void Profiler::captureFrames(unsigned int first, unsigned int last)
+    {
+        mFirstFrame = first;
+        mLastFrame = std::max(first, last);
+        mFramesScheduled = true;
+    }
+
+    void Profiler::newFrame(unsigned int frameNumber)
+    {
+        if (!mFramesScheduled)
+            return;
+
+        if (frameNumber > mLastFrame)
+        {
+            mFramesScheduled = false;
+            if (!stopCapture())
+                return;
+            const std::string path = writeTraceFile();
+            if (!path.empty())
+                std::cout << "Profiler trace of frames " << mFirstFrame << " to " << mLastFrame << " written to " << path << std::endl;
+        }
+        else if (frameNumber >= mFirstFrame && !isCapturing())
+            startCapture();
+    }
+
+    void Profiler::setThreadName(const std::string& name)
+    {
+        ThreadBuffer& buffer = getThreadBuffer();
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffer.mMutex);
+        buffer.mName = name;
+    }
+
+    const char* Profiler::intern(const std::string& name)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        return mNames.insert(name).first->c_str();
+    }
+
+    Profiler::ThreadBuffer& Profiler::getThreadBuffer()
+    {
+        // The profiler keeps the buffer alive after the thread exits, so that its events can still be written
+        static thread_local std::shared_ptr<ThreadBuffer> buffer;
+        if (!buffer)
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            buffer.reset(new ThreadBuffer(mThreadBuffers.size()));
+            mThreadBuffers.push_back(buffer);
+        }
+        return *buffer;
+    }
+
+    void Profiler::addEvent(const char* name, osg::Timer_t start, osg::Timer_t end)
+    {
+        if (!isCapturing())
+            return;
+
+        ThreadBuffer& buffer = getThreadBuffer();
+        const Event event = { name, start, end };
+        const unsigned int captureId = mCaptureId;
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffer.mMutex);
+        if (buffer.mCaptureId != captureId)
+        {
+            buffer.mCaptureId = captureId;
+            buffer.mEvents.clear();
+            buffer.mNumEvents = 0;
+        }
+        if (buffer.mEvents.size() < sBufferSize)
+            buffer.mEvents.push_back(event);
+        else
+            buffer.mEvents[buffer.mNumEvents % sBufferSize] = event;
+        ++buffer.mNumEvents;
+    }
+
+    void Profiler::writeTrace(std::ostream& stream)
+    {
+        std::vector<std::shared_ptr<ThreadBuffer> > buffers;
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+            buffers = mThreadBuffers;
+        }
+        const unsigned int captureId = mCaptureId;
+        const osg::Timer* timer = osg::Timer::instance();
+
+        stream << std::fixed << std::setprecision(3);
+        stream << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        bool first = true;
+        for (std::vector<std::shared_ptr<ThreadBuffer> >::const_iterator it = buffers.begin(); it != buffers.end(); ++it)
+        {
+            ThreadBuffer& buffer = **it;
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(buffer.mMutex);
+
+            if (!buffer.mName.empty())
+            {
+                stream << (first ? "" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer.mId
+                       << ",\"args\":{\"name\":";
+                writeJsonString(stream, buffer.mName);
+                stream << "}}";
+                first = false;
+            }
+
+            if (buffer.mCaptureId != captureId)
+                continue;
+
+            for (std::vector<Event>::const_iterator event = buffer.mEvents.begin(); event != buffer.mEvents.end(); ++event)
+            {
+                // zones that started before the capture
+                if (event->mStart < mCaptureStart)
+                    continue;
+
+                stream << (first ? "" : ",\n") << "{\"name\":";
+                writeJsonString(stream, event->mName);
+                stream << ",\"cat\":\"openmw\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.mId
+                       << ",\"ts\":" << timer->delta_u(mCaptureStart, event->mStart)
+                       << ",\"dur\":" << timer->delta_u(event->mStart, event->mEnd) << "}";
+                first = false;
+            }
+        }
+        stream << "\n]}\n";
+    }
+
+}
@@ -0,0 +1,148 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_PROFILER_H
+#define OPENMW_COMPONENTS_SCENEUTIL_PROFILER_H
+
+#include <memory>
+#include <ostream>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <OpenThreads/Atomic>
+#include <OpenThreads/Mutex>
+
+#include <osg/Timer>
+
+namespace SceneUtil
+{
+
+    /// @brief Records scoped zones of all threads, to be written as a Chrome trace_event file (chrome://tracing).
+    /// @par Each thread records into a ring buffer of its own, so recording a zone only takes a timer query and an uncontended
+    /// lock. While no capture is running, zones only check a flag. Add zones with OPENMW_PROFILE_ZONE, which is compiled out
+    /// unless OPENMW_ENABLE_PROFILER is defined.
+    class Profiler
+    {
+    public:
+        struct Event
+        {
+            /// Must stay valid until the trace is written, i.e. a string literal or a name from intern()
+            const char* mName;
+            osg::Timer_t mStart;
+            osg::Timer_t mEnd;
+        };
+
+        static Profiler& instance();
+
+        Profiler();
+
+        /// Directory that traces are written to by writeTraceFile(). Defaults to the working directory.
+        void setTraceDirectory(const std::string& directory);
+
+        /// Start recording, discarding anything that was recorded before.
+        void startCapture();
+
+        /// Stop recording.
+        /// @return If a capture was running.
+        bool stopCapture();
+
+        bool isCapturing() const { return mCapturing != 0; }
+
+        /// Capture the frames from @a first to @a last, both included, as they are reported by newFrame().
+        void captureFrames(unsigned int first, unsigned int last);
+
+        /// Report the start of a frame, to start or stop a capture scheduled with captureFrames().
+        void newFrame(unsigned int frameNumber);
+
+        /// Name the calling thread in traces.
+        void setThreadName(const std::string& name);
+
+        /// Get a copy of @a name that stays valid for the lifetime of the profiler, for zones with names that are not literals.
+        const char* intern(const std::string& name);
+
+        /// Record a zone of the calling thread. Ignored unless a capture is running.
+        void addEvent(const char* name, osg::Timer_t start, osg::Timer_t end);
+
+        /// Write all events recorded since the capture was started in Chrome's trace_event JSON format.
+        void writeTrace(std::ostream& stream);
+
+        /// Write the trace to a new file in the trace directory.
+        /// @return The path of the file, or an empty string if it could not be written.
+        std::string writeTraceFile();
+
+        /// Maximum number of events kept per thread; older events are overwritten.
+        static const std::size_t sBufferSize = 1 << 16;
+
+    private:
+        struct ThreadBuffer
+        {
+            ThreadBuffer(unsigned int id) : mId(id), mNumEvents(0), mCaptureId(0) {}
+
+            unsigned int mId;
+            std::string mName;
+            OpenThreads::Mutex mMutex;
+            std::vector<Event> mEvents;
+            /// Number of events recorded since the capture started, including overwritten ones
+            std::size_t mNumEvents;
+            /// The capture that the events belong to
+            unsigned int mCaptureId;
+        };
+
+        ThreadBuffer& getThreadBuffer();
+
+        OpenThreads::Atomic mCapturing;
+        /// Incremented on each startCapture(), so that thread buffers notice that their events are outdated
+        OpenThreads::Atomic mCaptureId;
+        osg::Timer_t mCaptureStart;
+
+        unsigned int mFirstFrame;
+        unsigned int mLastFrame;
+        bool mFramesScheduled;
+
+        std::string mTraceDirectory;
+
+        /// Protects the members below
+        OpenThreads::Mutex mMutex;
+        std::vector<std::shared_ptr<ThreadBuffer> > mThreadBuffers;
+        std::set<std::string> mNames;
+    };
+
+    /// Records the lifetime of the object as a zone in the profiler
+    class ProfileZone
+    {
+    public:
+        ProfileZone(const char* name)
+            : mName(Profiler::instance().isCapturing() ? name : NULL)
+            , mStart(mName ? osg::Timer::instance()->tick() : 0)
+        {
+        }
+
+        ProfileZone(const std::string& name)
+            : mName(Profiler::instance().isCapturing() ? Profiler::instance().intern(name) : NULL)
+            , mStart(mName ? osg::Timer::instance()->tick() : 0)
+        {
+        }
+
+        ~ProfileZone()
+        {
+            if (mName)
+                Profiler::instance().addEvent(mName, mStart, osg::Timer::instance()->tick());
+        }
+
+    private:
+        const char* mName;
+        osg::Timer_t mStart;
+    };
+
+}
+
+#define OPENMW_PROFILE_CONCAT_IMPL(a, b) a##b
+#define OPENMW_PROFILE_CONCAT(a, b) OPENMW_PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef OPENMW_ENABLE_PROFILER
+/// Record a zone from here to the end of the enclosing scope. @a name is a string literal, or a std::string for names that
+/// are only known at runtime (slower, as these have to be copied).
+#define OPENMW_PROFILE_ZONE(name) SceneUtil::ProfileZone OPENMW_PROFILE_CONCAT(profileZone, __LINE__)(name)
+#else
+#define OPENMW_PROFILE_ZONE(name)
+#endif
+
+#endif
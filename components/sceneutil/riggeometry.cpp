@@ -3,13 +3,88 @@
 #include <stdexcept>
 #include <iostream>
 #include <cstdlib>
+#include <algorithm>
 
 #include "skeleton.hpp"
 #include "util.hpp"
+#include "workqueue.hpp"
+
+namespace
+{
+
+    class SkinningWorkItem : public SceneUtil::WorkItem
+    {
+    public:
+        SkinningWorkItem(const SceneUtil::SkinningStreams& streams, const float* matrices,
+                         float* positions, float* normals, float* tangents)
+            : mStreams(streams)
+            , mMatrices(matrices)
+            , mPositions(positions)
+            , mNormals(normals)
+            , mTangents(tangents)
+        {
+        }
+
+        virtual const char* getName() const { return "Skinning"; }
+
+        virtual void doWork()
+        {
+            SceneUtil::skin(mStreams, mMatrices, mPositions, mNormals, mTangents);
+        }
+
+    private:
+        const SceneUtil::SkinningStreams& mStreams;
+        const float* mMatrices;
+        float* mPositions;
+        float* mNormals;
+        float* mTangents;
+    };
+
+}
 
 namespace SceneUtil
 {
 
+class RigGeometry::SkinningDrawCallback : public osg::Drawable::DrawCallback
+{
+public:
+    SkinningDrawCallback() {}
+    SkinningDrawCallback(const SkinningDrawCallback& copy, const osg::CopyOp& copyop)
+        : osg::Drawable::DrawCallback(copy, copyop)
+    {
+    }
+
+    META_Object(SceneUtil, SkinningDrawCallback)
+
+    /// Set the skinning in progress for the geometry, or NULL if it was skinned already.
+    void setWorkItem(WorkItem* item)
+    {
+        mWorkItem = item;
+    }
+
+    void waitTillDone() const
+    {
+        if (mWorkItem)
+            mWorkItem->waitTillDone();
+    }
+
+    virtual void drawImplementation(osg::RenderInfo& renderInfo, const osg::Drawable* drawable) const
+    {
+        waitTillDone();
+        drawable->drawImplementation(renderInfo);
+    }
+
+private:
+    osg::ref_ptr<WorkItem> mWorkItem;
+};
+
+WorkQueue* RigGeometry::sWorkQueue = NULL;
+
+void RigGeometry::setWorkQueue(WorkQueue* workQueue)
+{
+    sWorkQueue = workQueue;
+}
+
 RigGeometry::RigGeometry()
     : mSkeleton(NULL)
     , mLastFrameNumber(0)
@@ -29,6 +104,16 @@ RigGeometry::RigGeometry(const RigGeometry &copy, const osg::CopyOp &copyop)
     setSourceGeometry(copy.mSourceGeometry);
 }
 
+RigGeometry::~RigGeometry()
+{
+    // skinning in progress refers to our streams and arrays
+    for (unsigned int i=0; i<2; ++i)
+    {
+        if (mDrawCallbacks[i])
+            mDrawCallbacks[i]->waitTillDone();
+    }
+}
+
 void RigGeometry::setSourceGeometry(osg::ref_ptr<osg::Geometry> sourceGeometry)
 {
     mSourceGeometry = sourceGeometry;
@@ -42,6 +127,9 @@ void RigGeometry::setSourceGeometry(osg::ref_ptr<osg::Geometry> sourceGeometry)
         to.setUseVertexBufferObjects(true);
         to.setCullingActive(false); // make sure to disable culling since that's handled by this class
 
+        mDrawCallbacks[i] = new SkinningDrawCallback;
+        to.setDrawCallback(mDrawCallbacks[i]);
+
         // vertices and normals are modified every frame, so we need to deep copy them.
         // assign a dedicated VBO to make sure that modifications don't interfere with source geometry's VBO.
         osg::ref_ptr<osg::VertexBufferObject> vbo (new osg::VertexBufferObject);
@@ -137,9 +225,31 @@ bool RigGeometry::initFromParentSkeleton(osg::NodeVisitor* nv)
         mBone2VertexMap[it->second].push_back(it->first);
     }
 
+    initStreams();
+
     return true;
 }
 
+void RigGeometry::initStreams()
+{
+    const osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
+    const osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
+    const osg::Vec4Array* tangentSrc = mSourceTangents;
+
+    mStreams.clear();
+    for (Bone2VertexMap::const_iterator it = mBone2VertexMap.begin(); it != mBone2VertexMap.end(); ++it)
+    {
+        mStreams.beginGroup();
+        for (std::vector<unsigned short>::const_iterator vertexIt = it->second.begin(); vertexIt != it->second.end(); ++vertexIt)
+        {
+            unsigned short vertex = *vertexIt;
+            mStreams.addVertex(vertex, (*positionSrc)[vertex].ptr(),
+                               normalSrc ? (*normalSrc)[vertex].ptr() : NULL,
+                               tangentSrc ? (*tangentSrc)[vertex].ptr() : NULL);
+        }
+    }
+}
+
 void accumulateMatrix(const osg::Matrixf& invBindMatrix, const osg::Matrixf& matrix, float weight, osg::Matrixf& result)
 {
     osg::Matrixf m = invBindMatrix * matrix;
@@ -185,15 +295,21 @@ void RigGeometry::cull(osg::NodeVisitor* nv)
 
     mSkeleton->updateBoneMatrices(nv->getTraversalNumber());
 
-    // skinning
-    const osg::Vec3Array* positionSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getVertexArray());
-    const osg::Vec3Array* normalSrc = static_cast<osg::Vec3Array*>(mSourceGeometry->getNormalArray());
-    const osg::Vec4Array* tangentSrc = mSourceTangents;
+    // the previous skinning of this geometry has to be done before its matrices can be replaced
+    const unsigned int buffer = mLastFrameNumber%2;
+    SkinningDrawCallback& drawCallback = *mDrawCallbacks[buffer];
+    drawCallback.waitTillDone();
+    drawCallback.setWorkItem(NULL);
 
+    // skinning
     osg::Vec3Array* positionDst = static_cast<osg::Vec3Array*>(geom.getVertexArray());
     osg::Vec3Array* normalDst = static_cast<osg::Vec3Array*>(geom.getNormalArray());
     osg::Vec4Array* tangentDst = static_cast<osg::Vec4Array*>(geom.getTexCoordArray(7));
 
+    std::vector<float>& matrices = mSkinningMatrices[buffer];
+    matrices.resize(mStreams.getNumGroups() * 16);
+    std::vector<float>::iterator matrixIt = matrices.begin();
+
     for (Bone2VertexMap::const_iterator it = mBone2VertexMap.begin(); it != mBone2VertexMap.end(); ++it)
     {
         osg::Matrixf resultMat  (0, 0, 0, 0,
@@ -212,19 +328,23 @@ void RigGeometry::cull(osg::NodeVisitor* nv)
         if (mGeomToSkelMatrix)
             resultMat *= (*mGeomToSkelMatrix);
 
-        for (std::vector<unsigned short>::const_iterator vertexIt = it->second.begin(); vertexIt != it->second.end(); ++vertexIt)
+        matrixIt = std::copy(resultMat.ptr(), resultMat.ptr() + 16, matrixIt);
+    }
+
+    if (!mStreams.mVertices.empty())
+    {
+        float* positions = (*positionDst)[0].ptr();
+        float* normals = normalDst ? (*normalDst)[0].ptr() : NULL;
+        float* tangents = tangentDst ? (*tangentDst)[0].ptr() : NULL;
+
+        if (sWorkQueue)
         {
-            unsigned short vertex = *vertexIt;
-            (*positionDst)[vertex] = resultMat.preMult((*positionSrc)[vertex]);
-            if (normalDst)
-                (*normalDst)[vertex] = osg::Matrix::transform3x3((*normalSrc)[vertex], resultMat);
-            if (tangentDst)
-            {
-                osg::Vec4f srcTangent = (*tangentSrc)[vertex];
-                osg::Vec3f transformedTangent = osg::Matrix::transform3x3(osg::Vec3f(srcTangent.x(), srcTangent.y(), srcTangent.z()), resultMat);
-                (*tangentDst)[vertex] = osg::Vec4f(transformedTangent, srcTangent.w());
-            }
+            osg::ref_ptr<WorkItem> item (new SkinningWorkItem(mStreams, &matrices[0], positions, normals, tangents));
+            drawCallback.setWorkItem(item);
+            sWorkQueue->addWorkItem(item);
         }
+        else
+            skin(mStreams, &matrices[0], positions, normals, tangents);
     }
 
     positionDst->dirty();
@@ -326,6 +446,8 @@ void RigGeometry::accept(osg::NodeVisitor &nv)
 
 void RigGeometry::accept(osg::PrimitiveFunctor& func) const
 {
+    if (mDrawCallbacks[mLastFrameNumber%2])
+        mDrawCallbacks[mLastFrameNumber%2]->waitTillDone();
     getGeometry(mLastFrameNumber)->accept(func);
 }
 
@@ -4,22 +4,28 @@
 #include <osg/Geometry>
 #include <osg/Matrixf>
 
+#include "skinning.hpp"
+
 namespace SceneUtil
 {
 
     class Skeleton;
     class Bone;
+    class WorkQueue;
 
     /// @brief Mesh skinning implementation.
     /// @note A RigGeometry may be attached directly to a Skeleton, or somewhere below a Skeleton.
     /// Note though that the RigGeometry ignores any transforms below the Skeleton, so the attachment point is not that important.
     /// @note The internal Geometry used for rendering is double buffered, this allows updates to be done in a thread safe way while
     /// not compromising rendering performance. This is crucial when using osg's default threading model of DrawThreadPerContext.
+    /// @note Skinning is done on the cull thread by default. If a skinning work queue is set, the cull thread only computes the
+    /// bone matrices and the vertices are transformed on the work queue, while the drawing of the geometry waits for them.
     class RigGeometry : public osg::Drawable
     {
     public:
         RigGeometry();
         RigGeometry(const RigGeometry& copy, const osg::CopyOp& copyop);
+        ~RigGeometry();
 
         META_Object(SceneUtil, RigGeometry)
 
@@ -51,13 +57,24 @@ namespace SceneUtil
         virtual bool supports(const osg::PrimitiveFunctor&) const { return true; }
         virtual void accept(osg::PrimitiveFunctor&) const;
 
+        /// Set the work queue used to skin all RigGeometries, or NULL to skin on the cull thread.
+        /// @note The work queue must outlive any skinning in progress, so unset it before releasing the queue.
+        static void setWorkQueue(WorkQueue* workQueue);
+
     private:
+        class SkinningDrawCallback;
+
+        static WorkQueue* sWorkQueue;
+
         void cull(osg::NodeVisitor* nv);
         void updateBounds(osg::NodeVisitor* nv);
 
         osg::ref_ptr<osg::Geometry> mGeometry[2];
         osg::Geometry* getGeometry(unsigned int frame) const;
 
+        /// Waits for the skinning of the matching geometry before drawing it.
+        osg::ref_ptr<SkinningDrawCallback> mDrawCallbacks[2];
+
         osg::ref_ptr<osg::Geometry> mSourceGeometry;
         osg::ref_ptr<const osg::Vec4Array> mSourceTangents;
         Skeleton* mSkeleton;
@@ -76,6 +93,12 @@ namespace SceneUtil
 
         Bone2VertexMap mBone2VertexMap;
 
+        /// Source vertices in the order of mBone2VertexMap
+        SkinningStreams mStreams;
+
+        /// One matrix per influence group, for each geometry
+        std::vector<float> mSkinningMatrices[2];
+
         typedef std::map<Bone*, osg::BoundingSpheref> BoneSphereMap;
 
         BoneSphereMap mBoneSphereMap;
@@ -85,6 +108,8 @@ namespace SceneUtil
 
         bool initFromParentSkeleton(osg::NodeVisitor* nv);
 
+        void initStreams();
+
         void updateGeomToSkelMatrix(const osg::NodePath& nodePath);
     };
 
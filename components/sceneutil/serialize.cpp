@@ -88,6 +88,12 @@ public:
     }
 };
 
+// Set by registerGeometrySerializers()
+static bool sGeometryData = false;
+
+// OSG's own serializer of osg::Geometry, while it is replaced by GeometrySerializer
+static osg::ref_ptr<osgDB::ObjectWrapper> sGeometryWrapper;
+
 void registerSerializers()
 {
     static bool done = false;
@@ -102,8 +108,12 @@ void registerSerializers()
         mgr->addWrapper(new CameraRelativeTransformSerializer);
 
         // Don't serialize Geometry data as we are more interested in the overall structure rather than tons of vertex data that would make the file large and hard to read.
-        mgr->removeWrapper(mgr->findWrapper("osg::Geometry"));
-        mgr->addWrapper(new GeometrySerializer);
+        if (!sGeometryData)
+        {
+            sGeometryWrapper = mgr->findWrapper("osg::Geometry");
+            mgr->removeWrapper(sGeometryWrapper.get());
+            mgr->addWrapper(new GeometrySerializer);
+        }
 
         // ignore the below for now to avoid warning spam
         const char* ignore[] = {
@@ -142,4 +152,20 @@ void registerSerializers()
     }
 }
 
+void registerGeometrySerializers()
+{
+    if (sGeometryData)
+        return;
+
+    if (sGeometryWrapper)
+    {
+        osgDB::ObjectWrapperManager* mgr = osgDB::Registry::instance()->getObjectWrapperManager();
+        mgr->removeWrapper(mgr->findWrapper("osg::Geometry"));
+        mgr->addWrapper(sGeometryWrapper.get());
+        sGeometryWrapper = NULL;
+    }
+
+    sGeometryData = true;
+}
+
 }
@@ -5,8 +5,13 @@ namespace SceneUtil
 {
 
     /// Register osg node serializers for certain SceneUtil classes if not already done so
+    /// @note The vertex data of osg::Geometry is skipped, since these serializers are meant for inspecting the scene structure,
+    /// unless registerGeometrySerializers() is called, whether before or after this.
     void registerSerializers();
 
+    /// Keep serializing the vertex data of osg::Geometry, as needed by the scene file cache. Only the first call has any effect.
+    void registerGeometrySerializers();
+
 }
 
 #endif
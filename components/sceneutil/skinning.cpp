@@ -0,0 +1,208 @@
+#include "skinning.hpp"
+
+#include <cstddef>
+
+#if defined(__SSE__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 1)
+#include <xmmintrin.h>
+#define OPENMW_SKINNING_SSE
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define OPENMW_SKINNING_NEON
+#endif
+
+namespace
+{
+
+    void transformScalar(const float* m, float x, float y, float z, float* out)
+    {
+        out[0] = x * m[0] + y * m[4] + z * m[8] + m[12];
+        out[1] = x * m[1] + y * m[5] + z * m[9] + m[13];
+        out[2] = x * m[2] + y * m[6] + z * m[10] + m[14];
+    }
+
+    void transform3x3Scalar(const float* m, float x, float y, float z, float* out)
+    {
+        out[0] = x * m[0] + y * m[4] + z * m[8];
+        out[1] = x * m[1] + y * m[5] + z * m[9];
+        out[2] = x * m[2] + y * m[6] + z * m[10];
+    }
+
+    /// Transform the vertices [begin, end) of a group one at a time
+    void skinRange(const SceneUtil::SkinningStreams& streams, const float* m, std::size_t begin, std::size_t end,
+                   float* positions, float* normals, float* tangents)
+    {
+        for (std::size_t i = begin; i < end; ++i)
+        {
+            const std::size_t vertex = streams.mVertices[i];
+
+            transformScalar(m, streams.mPositions[0][i], streams.mPositions[1][i], streams.mPositions[2][i],
+                            positions + vertex * 3);
+            if (normals)
+                transform3x3Scalar(m, streams.mNormals[0][i], streams.mNormals[1][i], streams.mNormals[2][i],
+                                   normals + vertex * 3);
+            if (tangents)
+                transform3x3Scalar(m, streams.mTangents[0][i], streams.mTangents[1][i], streams.mTangents[2][i],
+                                   tangents + vertex * 4);
+        }
+    }
+
+#if defined(OPENMW_SKINNING_SSE)
+    typedef __m128 Vec4;
+    inline Vec4 load(const float* ptr) { return _mm_loadu_ps(ptr); }
+    inline Vec4 splat(float value) { return _mm_set1_ps(value); }
+    inline Vec4 madd(Vec4 a, Vec4 b, Vec4 c) { return _mm_add_ps(_mm_mul_ps(a, b), c); }
+    inline Vec4 add(Vec4 a, Vec4 b) { return _mm_add_ps(a, b); }
+    inline Vec4 mul(Vec4 a, Vec4 b) { return _mm_mul_ps(a, b); }
+    inline void store(float* ptr, Vec4 value) { _mm_storeu_ps(ptr, value); }
+#elif defined(OPENMW_SKINNING_NEON)
+    typedef float32x4_t Vec4;
+    inline Vec4 load(const float* ptr) { return vld1q_f32(ptr); }
+    inline Vec4 splat(float value) { return vdupq_n_f32(value); }
+    inline Vec4 madd(Vec4 a, Vec4 b, Vec4 c) { return vmlaq_f32(c, a, b); }
+    inline Vec4 add(Vec4 a, Vec4 b) { return vaddq_f32(a, b); }
+    inline Vec4 mul(Vec4 a, Vec4 b) { return vmulq_f32(a, b); }
+    inline void store(float* ptr, Vec4 value) { vst1q_f32(ptr, value); }
+#endif
+
+#if defined(OPENMW_SKINNING_SSE) || defined(OPENMW_SKINNING_NEON)
+    /// Rows of the 3x4 part of a matrix, each element broadcast to all lanes
+    struct Matrix4
+    {
+        Vec4 mElements[12];
+
+        explicit Matrix4(const float* m)
+        {
+            static const int indices[12] = { 0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14 };
+            for (int i = 0; i < 12; ++i)
+                mElements[i] = splat(m[indices[i]]);
+        }
+
+        /// Transform four directions given as x, y and z arrays; writes x, y and z arrays of four elements to \a out.
+        void transform3x3(const float* x, const float* y, const float* z, float out[3][4]) const
+        {
+            const Vec4 vx = load(x);
+            const Vec4 vy = load(y);
+            const Vec4 vz = load(z);
+            for (int i = 0; i < 3; ++i)
+                store(out[i], madd(vz, mElements[6 + i], madd(vy, mElements[3 + i], mul(vx, mElements[i]))));
+        }
+
+        /// Transform four points given as x, y and z arrays.
+        void transform(const float* x, const float* y, const float* z, float out[3][4]) const
+        {
+            const Vec4 vx = load(x);
+            const Vec4 vy = load(y);
+            const Vec4 vz = load(z);
+            for (int i = 0; i < 3; ++i)
+                store(out[i], add(madd(vz, mElements[6 + i], madd(vy, mElements[3 + i], mul(vx, mElements[i]))), mElements[9 + i]));
+        }
+    };
+
+    void scatter(const float in[3][4], const unsigned short* vertices, std::size_t stride, float* out)
+    {
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            float* dst = out + vertices[lane] * stride;
+            dst[0] = in[0][lane];
+            dst[1] = in[1][lane];
+            dst[2] = in[2][lane];
+        }
+    }
+#endif
+
+}
+
+namespace SceneUtil
+{
+
+    void SkinningStreams::clear()
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            mPositions[i].clear();
+            mNormals[i].clear();
+            mTangents[i].clear();
+        }
+        mVertices.clear();
+        mGroupEnds.clear();
+    }
+
+    void SkinningStreams::beginGroup()
+    {
+        mGroupEnds.push_back(static_cast<unsigned int>(mVertices.size()));
+    }
+
+    void SkinningStreams::addVertex(unsigned short index, const float* position, const float* normal, const float* tangent)
+    {
+        mVertices.push_back(index);
+        ++mGroupEnds.back();
+        for (int i = 0; i < 3; ++i)
+        {
+            mPositions[i].push_back(position[i]);
+            if (normal)
+                mNormals[i].push_back(normal[i]);
+            if (tangent)
+                mTangents[i].push_back(tangent[i]);
+        }
+    }
+
+    void skinScalar(const SkinningStreams& streams, const float* matrices, float* positions, float* normals, float* tangents)
+    {
+        if (streams.mNormals[0].empty())
+            normals = NULL;
+        if (streams.mTangents[0].empty())
+            tangents = NULL;
+
+        std::size_t begin = 0;
+        for (std::size_t group = 0; group < streams.mGroupEnds.size(); ++group)
+        {
+            const std::size_t end = streams.mGroupEnds[group];
+            skinRange(streams, matrices + group * 16, begin, end, positions, normals, tangents);
+            begin = end;
+        }
+    }
+
+    void skin(const SkinningStreams& streams, const float* matrices, float* positions, float* normals, float* tangents)
+    {
+#if defined(OPENMW_SKINNING_SSE) || defined(OPENMW_SKINNING_NEON)
+        if (streams.mNormals[0].empty())
+            normals = NULL;
+        if (streams.mTangents[0].empty())
+            tangents = NULL;
+
+        float result[3][4];
+        std::size_t begin = 0;
+        for (std::size_t group = 0; group < streams.mGroupEnds.size(); ++group)
+        {
+            const std::size_t end = streams.mGroupEnds[group];
+            const float* m = matrices + group * 16;
+            const Matrix4 matrix(m);
+
+            std::size_t i = begin;
+            for (; i + 4 <= end; i += 4)
+            {
+                const unsigned short* vertices = &streams.mVertices[i];
+
+                matrix.transform(&streams.mPositions[0][i], &streams.mPositions[1][i], &streams.mPositions[2][i], result);
+                scatter(result, vertices, 3, positions);
+                if (normals)
+                {
+                    matrix.transform3x3(&streams.mNormals[0][i], &streams.mNormals[1][i], &streams.mNormals[2][i], result);
+                    scatter(result, vertices, 3, normals);
+                }
+                if (tangents)
+                {
+                    matrix.transform3x3(&streams.mTangents[0][i], &streams.mTangents[1][i], &streams.mTangents[2][i], result);
+                    scatter(result, vertices, 4, tangents);
+                }
+            }
+
+            skinRange(streams, m, i, end, positions, normals, tangents);
+            begin = end;
+        }
+#else
+        skinScalar(streams, matrices, positions, normals, tangents);
+#endif
+    }
+
+}
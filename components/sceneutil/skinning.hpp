@@ -0,0 +1,50 @@
+#ifndef OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+#define OPENMW_COMPONENTS_SCENEUTIL_SKINNING_H
+
+#include <vector>
+
+namespace SceneUtil
+{
+
+    /// @brief Source vertex data of a skinned mesh, packed for the skinning kernel.
+    /// @par Vertices are ordered by influence group, so all vertices sharing the same bone weights are contiguous and
+    /// can be transformed by the same matrix. Each component is stored in its own array (structure of arrays), so the
+    /// kernel can load four vertices of a group at once.
+    struct SkinningStreams
+    {
+        /// x, y and z of the source positions, normals and tangents. Normals and tangents may be empty.
+        std::vector<float> mPositions[3];
+        std::vector<float> mNormals[3];
+        std::vector<float> mTangents[3];
+
+        /// Index of each packed vertex in the destination arrays.
+        std::vector<unsigned short> mVertices;
+
+        /// End of each influence group in the packed vertices.
+        std::vector<unsigned int> mGroupEnds;
+
+        void clear();
+
+        /// Start a new influence group; vertices added afterwards are transformed by the group's matrix.
+        void beginGroup();
+
+        /// Add a vertex to the current group. Pass NULL for the normal or tangent if the mesh does not have them.
+        void addVertex(unsigned short index, const float* position, const float* normal, const float* tangent);
+
+        unsigned int getNumGroups() const { return static_cast<unsigned int>(mGroupEnds.size()); }
+    };
+
+    /// @brief Transform the packed source vertices into the destination arrays.
+    /// @param matrices One osg::Matrixf (16 floats, row vector convention) per influence group. The matrices must be affine.
+    /// @param positions Destination positions, 3 floats per vertex.
+    /// @param normals Destination normals, 3 floats per vertex. May be NULL.
+    /// @param tangents Destination tangents, 4 floats per vertex; the w component is left untouched. May be NULL.
+    /// @note Uses SSE or NEON when available, four vertices at a time.
+    void skin(const SkinningStreams& streams, const float* matrices, float* positions, float* normals, float* tangents);
+
+    /// Reference implementation of skin() that transforms one vertex at a time.
+    void skinScalar(const SkinningStreams& streams, const float* matrices, float* positions, float* normals, float* tangents);
+
+}
+
+#endif
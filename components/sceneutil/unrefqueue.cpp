@@ -15,6 +15,8 @@ namespace SceneUtil
     public:
         std::deque<osg::ref_ptr<const osg::Referenced> > mObjects;
 
+        virtual const char* getName() const { return "Unref"; }
+
         virtual void doWork()
         {
             //osg::Timer timer;
@@ -1,6 +1,10 @@
 #include "workqueue.hpp"
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+
+#include "profiler.hpp"
 
 namespace SceneUtil
 {
@@ -27,6 +31,11 @@ void WorkItem::signalDone()
 }
 
 WorkItem::WorkItem()
+    : mPriority(0.f)
+    , mSequence(0)
+    , mAddTick(0)
+    , mStartTick(0)
+    , mEndTick(0)
 {
 }
 
@@ -39,12 +48,59 @@ bool WorkItem::isDone() const
     return (mDone > 0);
 }
 
+void WorkItem::cancel()
+{
+    mCancelled.exchange(1);
+    abort();
+}
+
+bool WorkItem::isCancelled() const
+{
+    return (mCancelled > 0);
+}
+
+void WorkItem::setPriority(float priority)
+{
+    mPriority = priority;
+}
+
+float WorkItem::getPriority() const
+{
+    return mPriority;
+}
+
+double WorkItem::getWaitTime() const
+{
+    if (!mStartTick)
+        return 0.0;
+    return osg::Timer::instance()->delta_s(mAddTick, mStartTick);
+}
+
+double WorkItem::getWorkTime() const
+{
+    if (!mEndTick)
+        return 0.0;
+    return osg::Timer::instance()->delta_s(mStartTick, mEndTick);
+}
+
 WorkQueue::WorkQueue(int workerThreads)
     : mIsReleased(false)
 {
+    mStats.mNumCompleted = 0;
+    mStats.mNumCancelled = 0;
+    mStats.mNumStolen = 0;
+    mStats.mWaitTime = 0.0;
+    mStats.mWorkTime = 0.0;
+
+    if (workerThreads <= 0)
+        workerThreads = getDefaultNumThreads();
+
+    for (int i=0; i<workerThreads; ++i)
+        mQueues.push_back(new ItemQueue);
+
     for (int i=0; i<workerThreads; ++i)
     {
-        WorkThread* thread = new WorkThread(this);
+        WorkThread* thread = new WorkThread(this, i);
         mThreads.push_back(thread);
         thread->startThread();
     }
@@ -54,8 +110,15 @@ WorkQueue::~WorkQueue()
 {
     {
         OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-        while (!mQueue.empty())
-            mQueue.pop_back();
+        for (unsigned int i=0; i<mQueues.size(); ++i)
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> queueLock(mQueues[i]->mMutex);
+            mQueues[i]->mItems.clear();
+        }
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> queueLock(mFrontItems.mMutex);
+            mFrontItems.mItems.clear();
+        }
         mIsReleased = true;
         mCondition.broadcast();
     }
@@ -65,6 +128,22 @@ WorkQueue::~WorkQueue()
         mThreads[i]->join();
         delete mThreads[i];
     }
+
+    for (unsigned int i=0; i<mQueues.size(); ++i)
+        delete mQueues[i];
+}
+
+int WorkQueue::getDefaultNumThreads()
+{
+    return std::max(1, OpenThreads::GetNumberOfProcessors() - 1);
+}
+
+bool WorkQueue::isMoreUrgent(const WorkItem *left, const WorkItem *right)
+{
+    if (left->mPriority != right->mPriority)
+        return left->mPriority > right->mPriority;
+    // compare the difference, to stay correct when the sequence number wraps around
+    return static_cast<int>(left->mSequence - right->mSequence) < 0;
 }
 
 void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item, bool front)
@@ -75,35 +154,129 @@ void WorkQueue::addWorkItem(osg::ref_ptr<WorkItem> item, bool front)
         return;
     }
 
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+    item->mSequence = ++mNextSequence;
+    item->mAddTick = osg::Timer::instance()->tick();
+
     if (front)
-        mQueue.push_front(item);
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mFrontItems.mMutex);
+        mFrontItems.mItems.push_back(item);
+        ++mFrontItems.mSize;
+    }
     else
-        mQueue.push_back(item);
-    mCondition.signal();
+    {
+        ItemQueue& queue = *mQueues[static_cast<unsigned int>(++mNextQueue) % mQueues.size()];
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queue.mMutex);
+        queue.mItems.push_back(item);
+        std::push_heap(queue.mItems.begin(), queue.mItems.end(), LessUrgent());
+        ++queue.mSize;
+    }
+    ++mNumItems;
+
+    // A thread about to wait counts itself in mNumWaiting before checking mNumItems, so either it sees the new item, or
+    // we see it waiting and lock, so that the signal can not get lost
+    if (mNumWaiting > 0)
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        mCondition.signal();
+    }
 }
 
-osg::ref_ptr<WorkItem> WorkQueue::removeWorkItem()
+osg::ref_ptr<WorkItem> WorkQueue::popWorkItem(ItemQueue& queue)
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-    while (mQueue.empty() && !mIsReleased)
+    if (queue.mSize == 0)
+        return NULL;
+
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(queue.mMutex);
+    if (queue.mItems.empty())
+        return NULL;
+    std::pop_heap(queue.mItems.begin(), queue.mItems.end(), LessUrgent());
+    osg::ref_ptr<WorkItem> item = queue.mItems.back();
+    queue.mItems.pop_back();
+    --queue.mSize;
+    return item;
+}
+
+osg::ref_ptr<WorkItem> WorkQueue::takeWorkItem(unsigned int threadIndex)
+{
+    osg::ref_ptr<WorkItem> item;
+    if (mFrontItems.mSize > 0)
     {
-        mCondition.wait(&mMutex);
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mFrontItems.mMutex);
+        if (!mFrontItems.mItems.empty())
+        {
+            item = mFrontItems.mItems.back();
+            mFrontItems.mItems.pop_back();
+            --mFrontItems.mSize;
+        }
     }
-    if (!mQueue.empty())
+
+    if (!item)
+        item = popWorkItem(*mQueues[threadIndex]);
+
+    for (unsigned int i=1; !item && i<mQueues.size(); ++i)
     {
-        osg::ref_ptr<WorkItem> item = mQueue.front();
-        mQueue.pop_front();
-        return item;
+        item = popWorkItem(*mQueues[(threadIndex + i) % mQueues.size()]);
+        if (item)
+        {
+            OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mStatsMutex);
+            ++mStats.mNumStolen;
+        }
     }
-    else
-        return NULL;
+
+    if (item)
+        --mNumItems;
+    return item;
+}
+
+osg::ref_ptr<WorkItem> WorkQueue::removeWorkItem(unsigned int threadIndex)
+{
+    while (true)
+    {
+        osg::ref_ptr<WorkItem> item = takeWorkItem(threadIndex);
+        if (item)
+        {
+            item->mStartTick = osg::Timer::instance()->tick();
+            if (!item->isCancelled())
+                return item;
+
+            // drop cancelled items without doing their work
+            {
+                OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mStatsMutex);
+                ++mStats.mNumCancelled;
+                mStats.mWaitTime += item->getWaitTime();
+            }
+            item->signalDone();
+            continue;
+        }
+
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
+        ++mNumWaiting;
+        while (mNumItems == 0 && !mIsReleased)
+        {
+            mCondition.wait(&mMutex);
+        }
+        --mNumWaiting;
+        if (mIsReleased)
+            return NULL;
+    }
+}
+
+void WorkQueue::finishWorkItem(WorkItem *item)
+{
+    item->mEndTick = osg::Timer::instance()->tick();
+    {
+        OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mStatsMutex);
+        ++mStats.mNumCompleted;
+        mStats.mWaitTime += item->getWaitTime();
+        mStats.mWorkTime += item->getWorkTime();
+    }
+    item->signalDone();
 }
 
 unsigned int WorkQueue::getNumItems() const
 {
-    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mMutex);
-    return mQueue.size();
+    return std::max(0, static_cast<int>(mNumItems));
 }
 
 unsigned int WorkQueue::getNumActiveThreads() const
@@ -117,22 +290,41 @@ unsigned int WorkQueue::getNumActiveThreads() const
     return count;
 }
 
-WorkThread::WorkThread(WorkQueue *workQueue)
+unsigned int WorkQueue::getNumThreads() const
+{
+    return mThreads.size();
+}
+
+WorkQueue::Stats WorkQueue::getStats() const
+{
+    OpenThreads::ScopedLock<OpenThreads::Mutex> lock(mStatsMutex);
+    return mStats;
+}
+
+WorkThread::WorkThread(WorkQueue *workQueue, unsigned int index)
     : mWorkQueue(workQueue)
+    , mIndex(index)
     , mActive(false)
 {
 }
 
 void WorkThread::run()
 {
+    std::ostringstream name;
+    name << "Work thread " << mIndex;
+    SceneUtil::Profiler::instance().setThreadName(name.str());
+
     while (true)
     {
-        osg::ref_ptr<WorkItem> item = mWorkQueue->removeWorkItem();
+        osg::ref_ptr<WorkItem> item = mWorkQueue->removeWorkItem(mIndex);
         if (!item)
             return;
         mActive = true;
-        item->doWork();
-        item->signalDone();
+        {
+            OPENMW_PROFILE_ZONE(item->getName());
+            item->doWork();
+        }
+        mWorkQueue->finishWorkItem(item.get());
         mActive = false;
     }
 }
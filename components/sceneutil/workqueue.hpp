@@ -8,8 +8,9 @@
 
 #include <osg/Referenced>
 #include <osg/ref_ptr>
+#include <osg/Timer>
 
-#include <queue>
+#include <vector>
 
 namespace SceneUtil
 {
@@ -23,6 +24,10 @@ namespace SceneUtil
         /// Override in a derived WorkItem to perform actual work.
         virtual void doWork() {}
 
+        /// Override in a derived WorkItem to name its kind of work in profiler traces.
+        /// @note Must stay valid for the lifetime of the item, e.g. a string literal.
+        virtual const char* getName() const { return "Work item"; }
+
         bool isDone() const;
 
         /// Wait until the work is completed. Usually called from the main thread.
@@ -34,43 +39,142 @@ namespace SceneUtil
         /// Set abort flag in order to return from doWork() as soon as possible. May not be respected by all WorkItems.
         virtual void abort() {}
 
+        /// Call abort(), and if no thread has started working on the item yet, have the WorkQueue drop it without calling doWork().
+        /// The item is marked as done once it is dropped or doWork() returns.
+        void cancel();
+
+        bool isCancelled() const;
+
+        /// Items with a higher priority are taken from the queue first, e.g. use the negated distance to the player.
+        /// Items with the same priority are taken in the order they were added. The default priority is 0.
+        /// @note Must be set before adding the item to a WorkQueue.
+        void setPriority(float priority);
+
+        float getPriority() const;
+
+        /// Time in seconds from adding the item to a WorkQueue until a thread started working on it, or until it was dropped.
+        double getWaitTime() const;
+
+        /// Time in seconds that doWork() took.
+        double getWorkTime() const;
+
     protected:
         OpenThreads::Atomic mDone;
         OpenThreads::Mutex mMutex;
         OpenThreads::Condition mCondition;
+
+    private:
+        friend class WorkQueue;
+
+        OpenThreads::Atomic mCancelled;
+        float mPriority;
+        /// Order in which the item was added, for items of the same priority
+        unsigned int mSequence;
+        osg::Timer_t mAddTick;
+        osg::Timer_t mStartTick;
+        osg::Timer_t mEndTick;
     };
 
     class WorkThread;
 
     /// @brief A work queue that users can push work items onto, to be completed by one or more background threads.
-    /// @note Work items will be processed in the order that they were given in, however
-    /// if multiple work threads are involved then it is possible for a later item to complete before earlier items.
+    /// @par Each thread has its own queue of items, and added items are spread over these queues. A thread takes the most
+    /// urgent item of its own queue, locking only that queue. Once its own queue is empty, it steals the most urgent item of
+    /// another thread's queue. Items have no affinity to the thread they were given to, so stealing the most urgent rather
+    /// than the least urgent item keeps the priority order as close as possible.
+    /// @par With a single thread, items are processed strictly in order of priority, and otherwise in the order that they
+    /// were given in. With multiple threads, the order only holds per queue, and a later item may complete before earlier items.
     class WorkQueue : public osg::Referenced
     {
     public:
+        /// @param numWorkerThreads The number of threads to start, or 0 to use getDefaultNumThreads().
         WorkQueue(int numWorkerThreads=1);
         ~WorkQueue();
 
-        /// Add a new work item to the back of the queue.
+        /// Add a new work item to the queue, to be processed according to its priority.
         /// @par The work item's waitTillDone() method may be used by the caller to wait until the work is complete.
-        /// @param front If true, add item to the front of the queue. If false (default), add to the back.
+        /// @param front If true, process the item before all items without this flag, regardless of its priority. Of several
+        /// such items, the one added last is processed first.
         void addWorkItem(osg::ref_ptr<WorkItem> item, bool front=false);
 
-        /// Get the next work item from the front of the queue. If the queue is empty, waits until a new item is added.
+        /// Get the most urgent work item for the given thread. Cancelled items are dropped.
+        /// If the queue is empty, waits until a new item is added.
         /// If the workqueue is in the process of being destroyed, may return NULL.
         /// @par Used internally by the WorkThread.
-        osg::ref_ptr<WorkItem> removeWorkItem();
+        osg::ref_ptr<WorkItem> removeWorkItem(unsigned int threadIndex);
+
+        /// Report that a work item returned by removeWorkItem() has been completed.
+        /// @par Used internally by the WorkThread.
+        void finishWorkItem(WorkItem* item);
 
         unsigned int getNumItems() const;
 
         unsigned int getNumActiveThreads() const;
 
+        unsigned int getNumThreads() const;
+
+        struct Stats
+        {
+            /// Number of items that were processed
+            unsigned int mNumCompleted;
+            /// Number of items that were dropped because they were cancelled
+            unsigned int mNumCancelled;
+            /// Number of items that were taken from the queue of another thread
+            unsigned int mNumStolen;
+            /// Total time in seconds that items waited in the queue
+            double mWaitTime;
+            /// Total time in seconds that doWork() took
+            double mWorkTime;
+        };
+
+        /// Statistics of all items since the queue was created.
+        Stats getStats() const;
+
+        /// One thread per hardware thread, minus one for the main thread, but at least one.
+        static int getDefaultNumThreads();
+
     private:
-        bool mIsReleased;
-        std::deque<osg::ref_ptr<WorkItem> > mQueue;
+        struct ItemQueue
+        {
+            OpenThreads::Mutex mMutex;
+            std::vector<osg::ref_ptr<WorkItem> > mItems;
+            /// Size of mItems, to skip empty queues without locking them
+            OpenThreads::Atomic mSize;
+        };
+
+        /// Take the top item of a queue ordered by isMoreUrgent(), if any.
+        static osg::ref_ptr<WorkItem> popWorkItem(ItemQueue& queue);
+
+        static bool isMoreUrgent(const WorkItem* left, const WorkItem* right);
+
+        struct LessUrgent
+        {
+            bool operator() (const osg::ref_ptr<WorkItem>& left, const osg::ref_ptr<WorkItem>& right) const
+            {
+                return isMoreUrgent(right, left);
+            }
+        };
+
+        /// Take the last front item, else the most urgent item of the thread's own queue, else steal one from another queue.
+        osg::ref_ptr<WorkItem> takeWorkItem(unsigned int threadIndex);
 
+        bool mIsReleased;
+        /// The items added to each thread, as heaps ordered by isMoreUrgent()
+        std::vector<ItemQueue*> mQueues;
+        /// The items added with the front flag, as a stack
+        ItemQueue mFrontItems;
+        OpenThreads::Atomic mNumItems;
+        OpenThreads::Atomic mNextQueue;
+        OpenThreads::Atomic mNextSequence;
+
+        /// Protects mIsReleased and mNumWaiting, for threads waiting on mCondition for items to be added
         mutable OpenThreads::Mutex mMutex;
         OpenThreads::Condition mCondition;
+        /// Number of threads waiting on mCondition; addWorkItem() only locks mMutex to wake them if there are any
+        OpenThreads::Atomic mNumWaiting;
+
+        mutable OpenThreads::Mutex mStatsMutex;
+        Stats mStats;
 
         std::vector<WorkThread*> mThreads;
     };
@@ -79,7 +183,7 @@ namespace SceneUtil
     class WorkThread : public OpenThreads::Thread
     {
     public:
-        WorkThread(WorkQueue* workQueue);
+        WorkThread(WorkQueue* workQueue, unsigned int index);
 
         virtual void run();
 
@@ -87,6 +191,7 @@ namespace SceneUtil
 
     private:
         WorkQueue* mWorkQueue;
+        unsigned int mIndex;
         volatile bool mActive;
     };
 
@@ -239,6 +239,7 @@ QuadTreeWorld::QuadTreeWorld(osg::Group *parent, osg::Group *compileRoot, Resour
     : World(parent, compileRoot, resourceSystem, storage, nodeMask, preCompileMask)
     , mViewDataMap(new ViewDataMap)
     , mQuadTreeBuilt(false)
+    , mProviderGeneration(0)
 {
     // No need for culling on the Drawable / Transform level as the quad tree performs the culling already.
     mChunkManager->setCullingActive(false);
@@ -341,6 +342,31 @@ void loadRenderingNode(ViewData::Entry& entry, ViewData* vd, ChunkManager* chunk
     }
 }
 
+void loadProviderNodes(ViewData::Entry& entry, const std::vector<ChunkProvider*>& providers, unsigned int generation, bool wait)
+{
+    if (providers.empty() || (entry.mProviderNodesLoaded && entry.mProviderGeneration == generation))
+        return;
+
+    std::vector<osg::ref_ptr<osg::Node> > nodes;
+    bool pending = false;
+    for (std::vector<ChunkProvider*>::const_iterator it = providers.begin(); it != providers.end(); ++it)
+    {
+        bool providerPending = false;
+        osg::ref_ptr<osg::Node> node = (*it)->getChunk(entry.mNode->getSize(), entry.mNode->getCenter(), wait, providerPending);
+        pending = pending || providerPending;
+        if (node)
+            nodes.push_back(node);
+    }
+
+    // keep drawing the previous nodes until all providers are done, and ask again in the next frame
+    if (pending)
+        return;
+
+    entry.mProviderNodes.swap(nodes);
+    entry.mProviderGeneration = generation;
+    entry.mProviderNodesLoaded = true;
+}
+
 void QuadTreeWorld::accept(osg::NodeVisitor &nv)
 {
     if (nv.getVisitorType() != osg::NodeVisitor::CULL_VISITOR && nv.getVisitorType() != osg::NodeVisitor::INTERSECTION_VISITOR)
@@ -372,6 +398,7 @@ void QuadTreeWorld::accept(osg::NodeVisitor &nv)
         ViewData::Entry& entry = vd->getEntry(i);
 
         loadRenderingNode(entry, vd, mChunkManager.get());
+        loadProviderNodes(entry, mChunkProviders, mProviderGeneration, false);
 
         if (entry.mVisible)
         {
@@ -383,6 +410,10 @@ void QuadTreeWorld::accept(osg::NodeVisitor &nv)
             }
             entry.mRenderingNode->accept(nv);
         }
+
+        // Provider nodes are culled on their own, as they can reach out of the bounds of the terrain (e.g. tall objects)
+        for (std::vector<osg::ref_ptr<osg::Node> >::const_iterator it = entry.mProviderNodes.begin(); it != entry.mProviderNodes.end(); ++it)
+            (*it)->accept(nv);
     }
 
     vd->reset(nv.getTraversalNumber());
@@ -429,6 +460,7 @@ void QuadTreeWorld::cacheCell(View *view, int x, int y)
     {
         ViewData::Entry& entry = vd->getEntry(i);
         loadRenderingNode(entry, vd, mChunkManager.get());
+        loadProviderNodes(entry, mChunkProviders, mProviderGeneration, true);
     }
 }
 
@@ -448,6 +480,7 @@ void QuadTreeWorld::preload(View *view, const osg::Vec3f &eyePoint)
     {
         ViewData::Entry& entry = vd->getEntry(i);
         loadRenderingNode(entry, vd, mChunkManager.get());
+        loadProviderNodes(entry, mChunkProviders, mProviderGeneration, true);
     }
 }
 
@@ -461,5 +494,15 @@ void QuadTreeWorld::setDefaultViewer(osg::Object *obj)
     mViewDataMap->setDefaultViewer(obj);
 }
 
+void QuadTreeWorld::addChunkProvider(ChunkProvider *provider)
+{
+    mChunkProviders.push_back(provider);
+}
+
+void QuadTreeWorld::resetProviderChunks()
+{
+    ++mProviderGeneration;
+}
+
 
 }
@@ -3,8 +3,14 @@
 
 #include "world.hpp"
 
+#include <vector>
+
+#include <OpenThreads/Atomic>
 #include <OpenThreads/Mutex>
 
+#include <osg/Node>
+#include <osg/Vec2f>
+
 namespace osg
 {
     class NodeVisitor;
@@ -15,6 +21,21 @@ namespace Terrain
     class RootNode;
     class ViewDataMap;
 
+    /// @brief Provides nodes that are drawn along with the terrain chunks of a QuadTreeWorld, e.g. distant objects.
+    class ChunkProvider
+    {
+    public:
+        virtual ~ChunkProvider() {}
+
+        /// @param size Size of the chunk in cell units
+        /// @param center Center of the chunk in cell units
+        /// @param wait Create the chunk on the calling thread if it is not ready, rather than in the background
+        /// @param pending Set if the chunk is still being created in the background, to ask for it again later
+        /// @return The chunk, or NULL if there is nothing to draw
+        /// @note Thread safe, called from the cull traversal as well as from preloading threads.
+        virtual osg::ref_ptr<osg::Node> getChunk(float size, const osg::Vec2f& center, bool wait, bool& pending) = 0;
+    };
+
     /// @brief Terrain implementation that loads cells into a Quad Tree, with geometry LOD and texture LOD. The entire world is displayed at all times.
     class QuadTreeWorld : public Terrain::World
     {
@@ -35,6 +56,15 @@ namespace Terrain
 
         virtual void setDefaultViewer(osg::Object* obj);
 
+        /// Draw the chunks of @a provider along with the terrain. Chunks are kept with the views like the terrain chunks.
+        /// @note Not thread safe, add providers before the terrain is drawn or preloaded.
+        void addChunkProvider(ChunkProvider* provider);
+
+        /// Get the chunks of all providers again, e.g. because the contents of the chunks changed.
+        /// The previous chunks are drawn until the new ones are ready.
+        /// @note Thread safe.
+        void resetProviderChunks();
+
     private:
         void ensureQuadTreeBuilt();
 
@@ -44,6 +74,9 @@ namespace Terrain
 
         OpenThreads::Mutex mQuadTreeMutex;
         bool mQuadTreeBuilt;
+
+        std::vector<ChunkProvider*> mChunkProviders;
+        OpenThreads::Atomic mProviderGeneration;
     };
 
 }
@@ -94,6 +94,8 @@ ViewData::Entry::Entry()
     : mNode(NULL)
     , mVisible(true)
     , mLodFlags(0)
+    , mProviderGeneration(0)
+    , mProviderNodesLoaded(false)
 {
 
 }
@@ -108,6 +110,8 @@ bool ViewData::Entry::set(QuadTreeNode *node, bool visible)
         mNode = node;
         // clear cached data
         mRenderingNode = NULL;
+        mProviderNodes.clear();
+        mProviderNodesLoaded = false;
         return true;
     }
 }
@@ -38,6 +38,12 @@ namespace Terrain
 
             unsigned int mLodFlags;
             osg::ref_ptr<osg::Node> mRenderingNode;
+
+            /// Nodes of the QuadTreeWorld's chunk providers for this node
+            std::vector<osg::ref_ptr<osg::Node> > mProviderNodes;
+            /// The provider generation that mProviderNodes were loaded for
+            unsigned int mProviderGeneration;
+            bool mProviderNodesLoaded;
         };
 
         unsigned int getNumEntries() const;
@@ -1,7 +1,9 @@
 #ifndef OPENMW_COMPONENTS_RESOURCE_ARCHIVE_H
 #define OPENMW_COMPONENTS_RESOURCE_ARCHIVE_H
 
+#include <cstddef>
 #include <map>
+#include <string>
 
 #include <components/files/constrainedfilestream.hpp>
 
@@ -14,6 +16,15 @@ namespace VFS
         virtual ~File() {}
 
         virtual Files::IStreamPtr open() = 0;
+
+        /// Get a string that changes whenever the file content may have changed, built from the file's size and modification time.
+        /// Used to check whether data derived from the file is still up to date.
+        virtual std::string getStamp() const = 0;
+
+        /// Get direct read-only access to the contents of the file, without copying.
+        /// @return false if the file is not held in memory, e.g. because its archive is not memory mapped; open() it instead.
+        /// @note The data stays valid for as long as the archive exists.
+        virtual bool getData(const char*& data, std::size_t& size) const { return false; }
     };
 
     class Archive
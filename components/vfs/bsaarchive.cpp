@@ -1,17 +1,25 @@
 #include "bsaarchive.hpp"
 
+#include <sstream>
+
+#include <boost/filesystem.hpp>
+
 namespace VFS
 {
 
 
-BsaArchive::BsaArchive(const std::string &filename)
+BsaArchive::BsaArchive(const std::string &filename, bool memoryMapped)
 {
-    mFile.open(filename);
+    mFile.open(filename, memoryMapped);
+
+    std::ostringstream stamp;
+    stamp << boost::filesystem::path(filename).filename().string() << ':' << boost::filesystem::last_write_time(filename);
+    mStamp = stamp.str();
 
     const Bsa::BSAFile::FileList &filelist = mFile.getList();
     for(Bsa::BSAFile::FileList::const_iterator it = filelist.begin();it != filelist.end();++it)
     {
-        mResources.push_back(BsaArchiveFile(&*it, &mFile));
+        mResources.push_back(BsaArchiveFile(&*it, &mFile, &mStamp));
     }
 }
 
@@ -28,9 +36,10 @@ void BsaArchive::listResources(std::map<std::string, File *> &out, char (*normal
 
 // ------------------------------------------------------------------------------
 
-BsaArchiveFile::BsaArchiveFile(const Bsa::BSAFile::FileStruct *info, Bsa::BSAFile* bsa)
+BsaArchiveFile::BsaArchiveFile(const Bsa::BSAFile::FileStruct *info, Bsa::BSAFile* bsa, const std::string* archiveStamp)
     : mInfo(info)
     , mFile(bsa)
+    , mArchiveStamp(archiveStamp)
 {
 
 }
@@ -40,4 +49,16 @@ Files::IStreamPtr BsaArchiveFile::open()
     return mFile->getFile(mInfo);
 }
 
+bool BsaArchiveFile::getData(const char *&data, std::size_t &size) const
+{
+    return mFile->getFileData(mInfo, data, size);
+}
+
+std::string BsaArchiveFile::getStamp() const
+{
+    std::ostringstream stream;
+    stream << *mArchiveStamp << ':' << mInfo->offset << ':' << mInfo->fileSize;
+    return stream.str();
+}
+
 }
@@ -11,24 +11,33 @@ namespace VFS
     class BsaArchiveFile : public File
     {
     public:
-        BsaArchiveFile(const Bsa::BSAFile::FileStruct* info, Bsa::BSAFile* bsa);
+        BsaArchiveFile(const Bsa::BSAFile::FileStruct* info, Bsa::BSAFile* bsa, const std::string* archiveStamp);
 
         virtual Files::IStreamPtr open();
 
+        virtual std::string getStamp() const;
+
+        virtual bool getData(const char*& data, std::size_t& size) const;
+
         const Bsa::BSAFile::FileStruct* mInfo;
         Bsa::BSAFile* mFile;
+        const std::string* mArchiveStamp;
     };
 
     class BsaArchive : public Archive
     {
     public:
-        BsaArchive(const std::string& filename);
+        /// @param memoryMapped Map the whole archive into memory, see Bsa::BSAFile::open.
+        BsaArchive(const std::string& filename, bool memoryMapped = false);
 
         virtual void listResources(std::map<std::string, File*>& out, char (*normalize_function) (char));
 
     private:
         Bsa::BSAFile mFile;
 
+        /// Name and modification time of the archive
+        std::string mStamp;
+
         std::vector<BsaArchiveFile> mResources;
     };
 
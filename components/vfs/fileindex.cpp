@@ -0,0 +1,139 @@
+#include "fileindex.hpp"
+
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+
+    struct EntryNameLess
+    {
+        bool operator()(const VFS::FileIndex::Entry& entry, const std::string& name) const
+        {
+            // Same ordering as std::string::compare, so the entries end up in the same order as in the source map
+            const int cmp = std::memcmp(entry.mName, name.data(), std::min(entry.mLength, name.size()));
+            return cmp < 0 || (cmp == 0 && entry.mLength < name.size());
+        }
+    };
+
+    bool startsWith(const VFS::FileIndex::Entry& entry, const std::string& prefix)
+    {
+        return entry.mLength >= prefix.size() && std::memcmp(entry.mName, prefix.data(), prefix.size()) == 0;
+    }
+
+}
+
+namespace VFS
+{
+
+    FileIndex::FileIndex()
+    {
+    }
+
+    void FileIndex::clear()
+    {
+        mNames.clear();
+        mEntries.clear();
+        mSlots.clear();
+    }
+
+    void FileIndex::build(const std::map<std::string, File*>& files)
+    {
+        clear();
+
+        std::size_t namesSize = 0;
+        for (std::map<std::string, File*>::const_iterator it = files.begin(); it != files.end(); ++it)
+            namesSize += it->first.size() + 1;
+
+        // The buffer must not be reallocated after this point, the entries point into it
+        mNames.reserve(namesSize);
+        mEntries.reserve(files.size());
+
+        for (std::map<std::string, File*>::const_iterator it = files.begin(); it != files.end(); ++it)
+        {
+            const std::string& name = it->first;
+
+            Entry entry;
+            entry.mName = mNames.data() + mNames.size();
+            entry.mLength = name.size();
+            entry.mHash = hash(name.data(), name.size(), nullptr);
+            entry.mFile = it->second;
+
+            mNames.insert(mNames.end(), name.begin(), name.end());
+            mNames.push_back('\0');
+
+            mEntries.push_back(entry);
+        }
+
+        // Keep the load factor at or below 0.5 so probe sequences stay short
+        std::size_t capacity = 16;
+        while (capacity < mEntries.size() * 2)
+            capacity *= 2;
+        mSlots.assign(capacity, 0);
+
+        const std::size_t mask = capacity - 1;
+        for (std::size_t i = 0; i < mEntries.size(); ++i)
+        {
+            std::size_t slot = mEntries[i].mHash & mask;
+            while (mSlots[slot] != 0)
+                slot = (slot + 1) & mask;
+            mSlots[slot] = static_cast<unsigned int>(i + 1);
+        }
+    }
+
+    std::size_t FileIndex::hash(const char* name, std::size_t length, NormalizeFunction normalize)
+    {
+        // 32-bit FNV-1a over the normalized characters
+        unsigned int result = 2166136261u;
+        for (std::size_t i = 0; i < length; ++i)
+        {
+            const char ch = normalize ? normalize(name[i]) : name[i];
+            result ^= static_cast<unsigned char>(ch);
+            result *= 16777619u;
+        }
+        return result;
+    }
+
+    File* FileIndex::find(const char* name, std::size_t length, NormalizeFunction normalize) const
+    {
+        return find(name, length, hash(name, length, normalize), normalize);
+    }
+
+    File* FileIndex::find(const char* name, std::size_t length, std::size_t hash, NormalizeFunction normalize) const
+    {
+        if (mSlots.empty())
+            return nullptr;
+
+        const std::size_t mask = mSlots.size() - 1;
+        for (std::size_t slot = hash & mask; mSlots[slot] != 0; slot = (slot + 1) & mask)
+        {
+            const Entry& entry = mEntries[mSlots[slot] - 1];
+            if (entry.mHash != hash || entry.mLength != length)
+                continue;
+
+            std::size_t i = 0;
+            if (normalize)
+            {
+                while (i < length && normalize(name[i]) == entry.mName[i])
+                    ++i;
+            }
+            else if (std::memcmp(name, entry.mName, length) == 0)
+                i = length;
+
+            if (i == length)
+                return entry.mFile;
+        }
+        return nullptr;
+    }
+
+    FileIndex::Range FileIndex::findPrefix(const std::string& prefix) const
+    {
+        Range range;
+        range.mBegin = std::lower_bound(mEntries.begin(), mEntries.end(), prefix, EntryNameLess());
+        range.mEnd = range.mBegin;
+        while (range.mEnd != mEntries.end() && startsWith(*range.mEnd, prefix))
+            ++range.mEnd;
+        return range;
+    }
+
+}
@@ -0,0 +1,86 @@
+#ifndef OPENMW_COMPONENTS_VFS_FILEINDEX_H
+#define OPENMW_COMPONENTS_VFS_FILEINDEX_H
+
+#include <cstddef>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace VFS
+{
+
+    class File;
+
+    /// @brief Flat, hashed index of normalized file names.
+    /// @par All names are interned into a single contiguous buffer and the entries are kept sorted,
+    /// so prefix queries are a binary search. Lookups by name go through an open-addressing hash table
+    /// and normalize the requested name on the fly, without allocating.
+    /// @note Not copyable, since the entries point into the interned name buffer.
+    class FileIndex
+    {
+    public:
+        typedef char (*NormalizeFunction)(char);
+
+        struct Entry
+        {
+            /// Normalized name, null-terminated, owned by the index.
+            const char* mName;
+            std::size_t mLength;
+            std::size_t mHash;
+            File* mFile;
+
+            std::string getName() const { return std::string(mName, mLength); }
+        };
+
+        typedef std::vector<Entry>::const_iterator const_iterator;
+
+        /// A range of entries, usable in range-based for loops.
+        struct Range
+        {
+            const_iterator mBegin;
+            const_iterator mEnd;
+
+            const_iterator begin() const { return mBegin; }
+            const_iterator end() const { return mEnd; }
+            bool empty() const { return mBegin == mEnd; }
+        };
+
+        FileIndex();
+
+        void clear();
+
+        /// Rebuild the index from the given map. The names in @a files must already be normalized.
+        void build(const std::map<std::string, File*>& files);
+
+        /// Hash a name as it would be after running each character through @a normalize.
+        static std::size_t hash(const char* name, std::size_t length, NormalizeFunction normalize);
+
+        /// Look up a file, normalizing @a name on the fly.
+        /// @return The file, or nullptr if there is no such file.
+        File* find(const char* name, std::size_t length, NormalizeFunction normalize) const;
+
+        /// Look up a file using a hash previously obtained from hash() with the same normalize function.
+        File* find(const char* name, std::size_t length, std::size_t hash, NormalizeFunction normalize) const;
+
+        /// Get all entries whose name starts with @a prefix (which must already be normalized), in sorted order.
+        Range findPrefix(const std::string& prefix) const;
+
+        const_iterator begin() const { return mEntries.begin(); }
+        const_iterator end() const { return mEntries.end(); }
+        std::size_t size() const { return mEntries.size(); }
+        bool empty() const { return mEntries.empty(); }
+
+    private:
+        FileIndex(const FileIndex&);
+        FileIndex& operator=(const FileIndex&);
+
+        std::vector<char> mNames;
+        std::vector<Entry> mEntries;
+
+        /// Open-addressing table with linear probing. Holds (index into mEntries) + 1, or 0 for an empty slot.
+        std::vector<unsigned int> mSlots;
+    };
+
+}
+
+#endif
@@ -1,5 +1,7 @@
 #include "filesystemarchive.hpp"
 
+#include <sstream>
+
 #include <boost/filesystem.hpp>
 
 namespace VFS
@@ -62,4 +64,11 @@ namespace VFS
         return Files::openConstrainedFileStream(mPath.c_str());
     }
 
+    std::string FileSystemArchiveFile::getStamp() const
+    {
+        std::ostringstream stream;
+        stream << boost::filesystem::file_size(mPath) << ':' << boost::filesystem::last_write_time(mPath);
+        return stream.str();
+    }
+
 }
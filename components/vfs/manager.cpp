@@ -59,42 +59,86 @@ namespace VFS
     {
         mIndex.clear();
 
+        std::map<std::string, File*> files;
         for (std::vector<Archive*>::const_iterator it = mArchives.begin(); it != mArchives.end(); ++it)
-            (*it)->listResources(mIndex, mStrict ? &strict_normalize_char : &nonstrict_normalize_char);
+            (*it)->listResources(files, getNormalizeFunction());
+
+        mIndex.build(files);
     }
 
     Files::IStreamPtr Manager::get(const std::string &name) const
     {
-        std::string normalized = name;
-        normalize_path(normalized, mStrict);
-
-        return getNormalized(normalized);
+        File* file = mIndex.find(name.data(), name.size(), getNormalizeFunction());
+        if (!file)
+        {
+            std::string normalized = name;
+            normalize_path(normalized, mStrict);
+            throw std::runtime_error("Resource '" + normalized + "' not found");
+        }
+        return file->open();
     }
 
     Files::IStreamPtr Manager::getNormalized(const std::string &normalizedName) const
     {
-        std::map<std::string, File*>::const_iterator found = mIndex.find(normalizedName);
-        if (found == mIndex.end())
+        File* file = mIndex.find(normalizedName.data(), normalizedName.size(), nullptr);
+        if (!file)
             throw std::runtime_error("Resource '" + normalizedName + "' not found");
-        return found->second->open();
+        return file->open();
+    }
+
+    bool Manager::getData(const std::string &name, const char *&data, std::size_t &size) const
+    {
+        File* file = mIndex.find(name.data(), name.size(), getNormalizeFunction());
+        if (!file)
+        {
+            std::string normalized = name;
+            normalize_path(normalized, mStrict);
+            throw std::runtime_error("Resource '" + normalized + "' not found");
+        }
+        return file->getData(data, size);
     }
 
     bool Manager::exists(const std::string &name) const
     {
-        std::string normalized = name;
-        normalize_path(normalized, mStrict);
+        return exists(name.data(), name.size());
+    }
 
-        return mIndex.find(normalized) != mIndex.end();
+    bool Manager::exists(const char *name, std::size_t length) const
+    {
+        return mIndex.find(name, length, getNormalizeFunction()) != nullptr;
     }
 
-    const std::map<std::string, File*>& Manager::getIndex() const
+    const FileIndex& Manager::getIndex() const
     {
         return mIndex;
     }
 
+    FileIndex::Range Manager::getFilesWithPrefix(const std::string &prefix) const
+    {
+        std::string normalized = prefix;
+        normalize_path(normalized, mStrict);
+
+        return mIndex.findPrefix(normalized);
+    }
+
+    std::size_t Manager::getHash(const char *name, std::size_t length) const
+    {
+        return FileIndex::hash(name, length, getNormalizeFunction());
+    }
+
+    File* Manager::find(const char *name, std::size_t length, std::size_t hash) const
+    {
+        return mIndex.find(name, length, hash, getNormalizeFunction());
+    }
+
     void Manager::normalizeFilename(std::string &name) const
     {
         normalize_path(name, mStrict);
     }
 
+    FileIndex::NormalizeFunction Manager::getNormalizeFunction() const
+    {
+        return mStrict ? &strict_normalize_char : &nonstrict_normalize_char;
+    }
+
 }
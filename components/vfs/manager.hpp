@@ -6,6 +6,8 @@
 #include <vector>
 #include <map>
 
+#include "fileindex.hpp"
+
 namespace VFS
 {
 
@@ -40,9 +42,19 @@ namespace VFS
         /// @note May be called from any thread once the index has been built.
         bool exists(const std::string& name) const;
 
-        /// Get a complete list of files from all archives
+        /// Does a file with this name exist?
+        /// @note The name is normalized on the fly, without allocating.
+        /// @note May be called from any thread once the index has been built.
+        bool exists(const char* name, std::size_t length) const;
+
+        /// Get a complete list of files from all archives, sorted by their normalized name.
         /// @note May be called from any thread once the index has been built.
-        const std::map<std::string, File*>& getIndex() const;
+        const FileIndex& getIndex() const;
+
+        /// Get all files whose normalized name starts with the given prefix, in sorted order.
+        /// @note The prefix will be normalized before searching.
+        /// @note May be called from any thread once the index has been built.
+        FileIndex::Range getFilesWithPrefix(const std::string& prefix) const;
 
         /// Normalize the given filename, making slashes/backslashes consistent, and lower-casing if mStrict is false.
         /// @note May be called from any thread once the index has been built.
@@ -58,12 +70,29 @@ namespace VFS
         /// @note May be called from any thread once the index has been built.
         Files::IStreamPtr getNormalized(const std::string& normalizedName) const;
 
+        /// Get direct read-only access to the contents of a file, without copying.
+        /// @return false if the file is not held in memory, see File::getData; use get() instead.
+        /// @note Throws an exception if the file can not be found.
+        /// @note May be called from any thread once the index has been built.
+        bool getData(const std::string& name, const char*& data, std::size_t& size) const;
+
+        /// Compute the lookup hash of the given name, as it would be after normalization.
+        /// @note The result can be stored by callers that look up the same name repeatedly, and passed to find().
+        std::size_t getHash(const char* name, std::size_t length) const;
+
+        /// Look up a file by name and a hash obtained from getHash(), without allocating.
+        /// @return The file, or nullptr if the file can not be found.
+        /// @note May be called from any thread once the index has been built.
+        File* find(const char* name, std::size_t length, std::size_t hash) const;
+
     private:
+        FileIndex::NormalizeFunction getNormalizeFunction() const;
+
         bool mStrict;
 
         std::vector<Archive*> mArchives;
 
-        std::map<std::string, File*> mIndex;
+        FileIndex mIndex;
     };
 
 }
@@ -10,7 +10,7 @@
 namespace VFS
 {
 
-    void registerArchives(VFS::Manager *vfs, const Files::Collections &collections, const std::vector<std::string> &archives, bool useLooseFiles)
+    void registerArchives(VFS::Manager *vfs, const Files::Collections &collections, const std::vector<std::string> &archives, bool useLooseFiles, bool memoryMapArchives)
     {
         const Files::PathContainer& dataDirs = collections.getPaths();
 
@@ -22,7 +22,7 @@ namespace VFS
                 const std::string archivePath = collections.getPath(*archive).string();
                 std::cout << "Adding BSA archive " << archivePath << std::endl;
 
-                vfs->addArchive(new BsaArchive(archivePath));
+                vfs->addArchive(new BsaArchive(archivePath, memoryMapArchives));
             }
             else
             {